@@ -0,0 +1,157 @@
+/** @file array.c
+* Contains the definitions of the functions declared in 'array.h'
+*/
+
+#include "array.h"
+
+Array* ArrayNew(Array** owner, OperandType type, uint64_t count)
+{
+	colti_assert(count <= ARRAY_MAX_LENGTH, "Array is too long!");
+	//The values follow the Array, in the same allocation
+	Array* array = safe_aligned_malloc(IMPL_ARRAY_HEADER_SIZE + count * sizeof(QWORD), ARRAY_ALIGNMENT);
+	array->values = (QWORD*)((uint8_t*)array + IMPL_ARRAY_HEADER_SIZE);
+	array->count = count;
+	array->type = type;
+	array->next = *owner;
+	*owner = array;
+	return array;
+}
+
+void ArrayFreeAll(Array** owner)
+{
+	Array* array = *owner;
+	while (array != NULL)
+	{
+		Array* next = array->next;
+		safe_aligned_free(array);
+		array = next;
+	}
+	*owner = NULL;
+}
+
+QWORD ArrayToQWORD(Array* array)
+{
+	QWORD value = { .ui64 = (uint64_t)(uintptr_t)array };
+	return value;
+}
+
+Array* ArrayFromQWORD(QWORD value)
+{
+	return (Array*)(uintptr_t)value.ui64;
+}
+
+const char* ArrayErrorToString(ArrayError error)
+{
+	switch (error)
+	{
+	case ARRAY_OK:					return "No error";
+	case ARRAY_INVALID_LENGTH:		return "Invalid array length";
+	case ARRAY_OUT_OF_BOUNDS:		return "Array index out of bounds";
+	case ARRAY_LENGTH_MISMATCH:		return "Arrays of different lengths";
+	case ARRAY_EMPTY:				return "Reduction of an empty array";
+	case ARRAY_DIVISION_ERROR:		return "Integer division by zero or overflow";
+	default:						return "UNKNOWN";
+	}
+}
+
+ArrayError OpCode_ArrayNew(QWORD count, QWORD value, OperandType type, Array** owner, QWORD* result)
+{
+	if (count.ui64 > ARRAY_MAX_LENGTH)
+		return ARRAY_INVALID_LENGTH;
+	Array* array = ArrayNew(owner, type, count.ui64);
+	for (uint64_t i = 0; i < count.ui64; i++)
+		array->values[i] = value;
+	*result = ArrayToQWORD(array);
+	return ARRAY_OK;
+}
+
+QWORD OpCode_ArrayLength(QWORD array)
+{
+	QWORD length = { .ui64 = ArrayFromQWORD(array)->count };
+	return length;
+}
+
+ArrayError OpCode_ArrayGet(QWORD array, QWORD index, QWORD* result)
+{
+	const Array* ptr = ArrayFromQWORD(array);
+	if (index.ui64 >= ptr->count)
+		return ARRAY_OUT_OF_BOUNDS;
+	*result = ptr->values[index.ui64];
+	return ARRAY_OK;
+}
+
+ArrayError OpCode_ArraySet(QWORD array, QWORD index, QWORD value)
+{
+	Array* ptr = ArrayFromQWORD(array);
+	if (index.ui64 >= ptr->count)
+		return ARRAY_OUT_OF_BOUNDS;
+	ptr->values[index.ui64] = value;
+	return ARRAY_OK;
+}
+
+ArrayError OpCode_ArrayBinary(uint8_t code, QWORD left, QWORD right, Array** owner, QWORD* result)
+{
+	const Array* lhs = ArrayFromQWORD(left);
+	const Array* rhs = ArrayFromQWORD(right);
+	colti_assert(lhs->type == rhs->type, "Arrays of different types!");
+	if (lhs->count != rhs->count)
+		return ARRAY_LENGTH_MISMATCH;
+
+	const ArrayKernels* kernels = ArrayKernelsGet(ArrayKernelsGetLevel(), lhs->type);
+	ArrayBinaryKernel kernel = code == OP_ARRAY_ADD ? kernels->add
+		: code == OP_ARRAY_SUBTRACT ? kernels->subtract
+		: code == OP_ARRAY_MULTIPLY ? kernels->multiply
+		: kernels->divide;
+	colti_assert(code == OP_ARRAY_ADD || code == OP_ARRAY_SUBTRACT
+		|| code == OP_ARRAY_MULTIPLY || code == OP_ARRAY_DIVIDE, "Expected an elementwise array OpCode!");
+
+	Array* array = ArrayNew(owner, lhs->type, lhs->count);
+	if (!kernel(array->values, lhs->values, rhs->values, lhs->count))
+		return ARRAY_DIVISION_ERROR;
+	*result = ArrayToQWORD(array);
+	return ARRAY_OK;
+}
+
+QWORD OpCode_ArrayNegate(QWORD array, Array** owner)
+{
+	const Array* ptr = ArrayFromQWORD(array);
+	Array* negated = ArrayNew(owner, ptr->type, ptr->count);
+	ArrayKernelsGet(ArrayKernelsGetLevel(), ptr->type)->negate(negated->values, ptr->values, ptr->count);
+	return ArrayToQWORD(negated);
+}
+
+QWORD OpCode_ArrayConvert(QWORD array, OperandType to, Array** owner)
+{
+	const Array* ptr = ArrayFromQWORD(array);
+	Array* converted = ArrayNew(owner, to, ptr->count);
+	memcpy(converted->values, ptr->values, ptr->count * sizeof(QWORD));
+	ConvertValues(converted->values, converted->count, ptr->type, to);
+	return ArrayToQWORD(converted);
+}
+
+ArrayError OpCode_ArrayReduce(uint8_t code, QWORD array, QWORD* result)
+{
+	colti_assert(code == OP_ARRAY_SUM || code == OP_ARRAY_MIN || code == OP_ARRAY_MAX, "Expected a reduction OpCode!");
+	const Array* ptr = ArrayFromQWORD(array);
+	const ArrayKernels* kernels = ArrayKernelsGet(ArrayKernelsGetLevel(), ptr->type);
+	if (code == OP_ARRAY_SUM)
+	{
+		*result = kernels->sum(ptr->values, ptr->count);
+		return ARRAY_OK;
+	}
+	if (ptr->count == 0)
+		return ARRAY_EMPTY;
+	*result = code == OP_ARRAY_MIN ? kernels->min(ptr->values, ptr->count) : kernels->max(ptr->values, ptr->count);
+	return ARRAY_OK;
+}
+
+ArrayError OpCode_ArrayDot(QWORD left, QWORD right, QWORD* result)
+{
+	const Array* lhs = ArrayFromQWORD(left);
+	const Array* rhs = ArrayFromQWORD(right);
+	colti_assert(lhs->type == rhs->type, "Arrays of different types!");
+	if (lhs->count != rhs->count)
+		return ARRAY_LENGTH_MISMATCH;
+	*result = ArrayKernelsGet(ArrayKernelsGetLevel(), lhs->type)->dot(lhs->values, rhs->values, lhs->count);
+	return ARRAY_OK;
+}
@@ -0,0 +1,157 @@
+/** @file array.h
+* Contains the Array, a contiguous buffer of values of the same OperandType, and the helpers running the array OpCodes.
+* An Array is pushed on the stack of the VM as a QWORD holding its address (see ArrayToQWORD), which the
+* verifier gives the abstract type VERIFY_ARRAY_TYPE(type), so that an immediate or a value of another type can
+* never be used as an array.
+* Each value of an Array takes a QWORD (as on the stack), and the values are aligned on ARRAY_ALIGNMENT so that
+* the kernels (see array_kernels.h) can operate on vectors of values: a single instruction processes a whole array.
+* Arrays are references: OP_ARRAY_SET modifies the array in place, while the elementwise OpCodes write their result
+* to a new array. Every Array is owned by a list (the VM, or the generated code of ChunkEmitC), and is freed with it
+* by ArrayFreeAll.
+*/
+
+#ifndef HG_COLTI_ARRAY
+#define HG_COLTI_ARRAY
+
+#include "common.h"
+#include "byte_code.h"
+#include "conversion.h"
+#include "array_kernels.h"
+
+/// @brief The alignment of the values of an Array (the size of an AVX2 vector)
+#define ARRAY_ALIGNMENT 32
+/// @brief The maximum number of values of an Array (2 GiB of values)
+#define ARRAY_MAX_LENGTH (UINT64_C(1) << 28)
+
+/// @brief A buffer of values of the same OperandType
+typedef struct Array
+{
+	/// @brief The next Array of the same owner
+	struct Array* next;
+	/// @brief The values, aligned on ARRAY_ALIGNMENT, which follow the Array in the same allocation
+	QWORD* values;
+	/// @brief The number of values
+	uint64_t count;
+	/// @brief The OperandType of the values
+	uint8_t type;
+} Array;
+
+/// @brief The runtime errors of the array OpCodes
+typedef enum
+{
+	/// @brief No error
+	ARRAY_OK,
+	/// @brief The length of a new array is greater than ARRAY_MAX_LENGTH
+	ARRAY_INVALID_LENGTH,
+	/// @brief An index is not less than the length of the array
+	ARRAY_OUT_OF_BOUNDS,
+	/// @brief The arrays of an elementwise operation or of a dot product have different lengths
+	ARRAY_LENGTH_MISMATCH,
+	/// @brief The minimum or the maximum of an empty array
+	ARRAY_EMPTY,
+	/// @brief An integer division by zero, or of the minimum value of a signed type by -1
+	ARRAY_DIVISION_ERROR,
+} ArrayError;
+
+/// @brief Allocates an Array whose values are not initialized
+/// @param owner Pointer to the first Array of the list owning the new Array, which is updated
+/// @param type The OperandType of the values
+/// @param count The number of values, which must not be greater than ARRAY_MAX_LENGTH
+/// @return The new Array
+Array* ArrayNew(Array** owner, OperandType type, uint64_t count);
+
+/// @brief Frees all the Arrays of a list
+/// @param owner Pointer to the first Array of the list, which is set to NULL
+void ArrayFreeAll(Array** owner);
+
+/// @brief Returns the QWORD representing an Array on the stack
+/// @param array The array
+/// @return The QWORD holding the address of the array
+QWORD ArrayToQWORD(Array* array);
+
+/// @brief Returns the Array represented by a QWORD
+/// @param value The QWORD obtained through ArrayToQWORD
+/// @return The array
+Array* ArrayFromQWORD(QWORD value);
+
+/// @brief Returns the description of an ArrayError
+/// @param error The error
+/// @return The description of the error (without any punctuation)
+const char* ArrayErrorToString(ArrayError error);
+
+/**********************************
+ARRAY OPCODES
+**********************************/
+
+/// @brief Creates an Array whose values are all 'value' (OP_ARRAY_NEW)
+/// @param count The number of values, as an UINT64
+/// @param value The value of each element
+/// @param type The OperandType of the values
+/// @param owner The list owning the new Array
+/// @param result Pointer to where to write the array
+/// @return ARRAY_OK or ARRAY_INVALID_LENGTH
+ArrayError OpCode_ArrayNew(QWORD count, QWORD value, OperandType type, Array** owner, QWORD* result);
+
+/// @brief Returns the number of values of an Array (OP_ARRAY_LENGTH)
+/// @param array The array
+/// @return The length, as an UINT64
+QWORD OpCode_ArrayLength(QWORD array);
+
+/// @brief Reads a value of an Array (OP_ARRAY_GET)
+/// @param array The array
+/// @param index The index of the value, as an UINT64
+/// @param result Pointer to where to write the value
+/// @return ARRAY_OK or ARRAY_OUT_OF_BOUNDS
+ArrayError OpCode_ArrayGet(QWORD array, QWORD index, QWORD* result);
+
+/// @brief Writes a value of an Array (OP_ARRAY_SET)
+/// @param array The array to modify
+/// @param index The index of the value, as an UINT64
+/// @param value The value to write
+/// @return ARRAY_OK or ARRAY_OUT_OF_BOUNDS
+ArrayError OpCode_ArraySet(QWORD array, QWORD index, QWORD value);
+
+/// @brief Computes an elementwise operation on 2 Arrays of the same type, into a new Array
+/// @param code OP_ARRAY_ADD, OP_ARRAY_SUBTRACT, OP_ARRAY_MULTIPLY or OP_ARRAY_DIVIDE
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param owner The list owning the new Array
+/// @param result Pointer to where to write the new array
+/// @return ARRAY_OK, ARRAY_LENGTH_MISMATCH or ARRAY_DIVISION_ERROR
+ArrayError OpCode_ArrayBinary(uint8_t code, QWORD left, QWORD right, Array** owner, QWORD* result);
+
+/// @brief Negates each value of an Array of a signed type, into a new Array (OP_ARRAY_NEGATE)
+/// @param array The array
+/// @param owner The list owning the new Array
+/// @return The new array
+QWORD OpCode_ArrayNegate(QWORD array, Array** owner);
+
+/// @brief Converts each value of an Array (see conversion.h), into a new Array (OP_ARRAY_CONVERT)
+/// @param array The array
+/// @param to The type to which to convert the values
+/// @param owner The list owning the new Array
+/// @return The new array
+QWORD OpCode_ArrayConvert(QWORD array, OperandType to, Array** owner);
+
+/// @brief Reduces the values of an Array
+/// @param code OP_ARRAY_SUM, OP_ARRAY_MIN or OP_ARRAY_MAX
+/// @param array The array
+/// @param result Pointer to where to write the result (0 for the sum of an empty array)
+/// @return ARRAY_OK or ARRAY_EMPTY
+ArrayError OpCode_ArrayReduce(uint8_t code, QWORD array, QWORD* result);
+
+/// @brief Computes the dot product of 2 Arrays of the same type (OP_ARRAY_DOT)
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param result Pointer to where to write the result
+/// @return ARRAY_OK or ARRAY_LENGTH_MISMATCH
+ArrayError OpCode_ArrayDot(QWORD left, QWORD right, QWORD* result);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief The size of an Array, rounded up to ARRAY_ALIGNMENT (the offset of its values)
+#define IMPL_ARRAY_HEADER_SIZE ((sizeof(Array) + ARRAY_ALIGNMENT - 1) & ~(size_t)(ARRAY_ALIGNMENT - 1))
+
+#endif //HG_COLTI_ARRAY
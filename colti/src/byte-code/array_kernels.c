@@ -0,0 +1,445 @@
+/** @file array_kernels.c
+* Contains the definitions of the functions declared in 'array_kernels.h'
+*/
+
+#include "array_kernels.h"
+
+#if (defined(COLTI_GNU) || defined(COLTI_CLANG)) && defined(__SSE2__)
+	#include <emmintrin.h>
+	/// @brief Defined if the kernels using 128-bit vectors are compiled
+	#define IMPL_COLTI_SSE2_ARRAYS
+#endif
+
+#if (defined(COLTI_GNU) || defined(COLTI_CLANG)) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
+	/// @brief Defined if the kernels using 256-bit vectors are compiled (which are only used if the CPU supports AVX2)
+	#define IMPL_COLTI_AVX2_ARRAYS
+	/// @brief Compiles a function for AVX2, whatever the flags of the translation unit
+	#define IMPL_ARRAY_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+/**********************************
+SCALAR KERNELS
+**********************************/
+
+/// @brief Defines the binary kernel 'impl_array_##name##_integer', operating on 64-bit unsigned integers
+/// (whose low bits are the result of any narrower integer type)
+#define IMPL_ARRAY_DEFINE_INTEGER_BINARY(name, op) \
+bool impl_array_##name##_integer(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count) \
+{ \
+	for (uint64_t i = 0; i < count; i++) \
+		result[i].ui64 = left[i].ui64 op right[i].ui64; \
+	return true; \
+}
+
+/// @brief Defines the binary kernel 'impl_array_##name##_##member', operating on FLOAT or DOUBLE
+#define IMPL_ARRAY_DEFINE_FLOATING_BINARY(name, op, member) \
+bool impl_array_##name##_##member(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count) \
+{ \
+	for (uint64_t i = 0; i < count; i++) \
+		result[i].member = left[i].member op right[i].member; \
+	return true; \
+}
+
+/// @brief Defines the kernel 'impl_array_divide_##member', dividing unsigned integers
+#define IMPL_ARRAY_DEFINE_UNSIGNED_DIVIDE(member) \
+bool impl_array_divide_##member(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count) \
+{ \
+	for (uint64_t i = 0; i < count; i++) \
+	{ \
+		if (right[i].member == 0) \
+			return false; \
+		result[i].member = left[i].member / right[i].member; \
+	} \
+	return true; \
+}
+
+/// @brief Defines the kernel 'impl_array_divide_##member', dividing signed integers whose minimum value is 'min'
+#define IMPL_ARRAY_DEFINE_SIGNED_DIVIDE(member, min) \
+bool impl_array_divide_##member(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count) \
+{ \
+	for (uint64_t i = 0; i < count; i++) \
+	{ \
+		if (right[i].member == 0 || (left[i].member == (min) && right[i].member == -1)) \
+			return false; \
+		result[i].member = left[i].member / right[i].member; \
+	} \
+	return true; \
+}
+
+/// @brief Defines the kernels 'impl_array_min_##member' and 'impl_array_max_##member', which keep
+/// the first of equal values (and ignore NaN, unless it is the first value)
+#define IMPL_ARRAY_DEFINE_MIN_MAX(member) \
+QWORD impl_array_min_##member(const QWORD* values, uint64_t count) \
+{ \
+	colti_assert(count != 0, "Expected at least 1 value!"); \
+	QWORD min = values[0]; \
+	for (uint64_t i = 1; i < count; i++) \
+	{ \
+		if (values[i].member < min.member) \
+			min = values[i]; \
+	} \
+	return min; \
+} \
+QWORD impl_array_max_##member(const QWORD* values, uint64_t count) \
+{ \
+	colti_assert(count != 0, "Expected at least 1 value!"); \
+	QWORD max = values[0]; \
+	for (uint64_t i = 1; i < count; i++) \
+	{ \
+		if (values[i].member > max.member) \
+			max = values[i]; \
+	} \
+	return max; \
+}
+
+/// @brief Defines the kernels 'impl_array_sum_##member', 'impl_array_dot_##member' and 'impl_array_negate_##member'
+/// of FLOAT or DOUBLE
+#define IMPL_ARRAY_DEFINE_FLOATING_REDUCE(member) \
+QWORD impl_array_sum_##member(const QWORD* values, uint64_t count) \
+{ \
+	QWORD sum = { .ui64 = 0 }; \
+	for (uint64_t i = 0; i < count; i++) \
+		sum.member += values[i].member; \
+	return sum; \
+} \
+QWORD impl_array_dot_##member(const QWORD* left, const QWORD* right, uint64_t count) \
+{ \
+	QWORD sum = { .ui64 = 0 }; \
+	for (uint64_t i = 0; i < count; i++) \
+		sum.member += left[i].member * right[i].member; \
+	return sum; \
+} \
+void impl_array_negate_##member(QWORD* result, const QWORD* values, uint64_t count) \
+{ \
+	for (uint64_t i = 0; i < count; i++) \
+		result[i].member = -values[i].member; \
+}
+
+IMPL_ARRAY_DEFINE_INTEGER_BINARY(add, +)
+IMPL_ARRAY_DEFINE_INTEGER_BINARY(subtract, -)
+IMPL_ARRAY_DEFINE_INTEGER_BINARY(multiply, *)
+IMPL_ARRAY_DEFINE_FLOATING_BINARY(add, +, f)
+IMPL_ARRAY_DEFINE_FLOATING_BINARY(subtract, -, f)
+IMPL_ARRAY_DEFINE_FLOATING_BINARY(multiply, *, f)
+IMPL_ARRAY_DEFINE_FLOATING_BINARY(divide, /, f)
+IMPL_ARRAY_DEFINE_FLOATING_BINARY(add, +, d)
+IMPL_ARRAY_DEFINE_FLOATING_BINARY(subtract, -, d)
+IMPL_ARRAY_DEFINE_FLOATING_BINARY(multiply, *, d)
+IMPL_ARRAY_DEFINE_FLOATING_BINARY(divide, /, d)
+
+IMPL_ARRAY_DEFINE_UNSIGNED_DIVIDE(ui8)
+IMPL_ARRAY_DEFINE_UNSIGNED_DIVIDE(ui16)
+IMPL_ARRAY_DEFINE_UNSIGNED_DIVIDE(ui32)
+IMPL_ARRAY_DEFINE_UNSIGNED_DIVIDE(ui64)
+IMPL_ARRAY_DEFINE_SIGNED_DIVIDE(i8, INT8_MIN)
+IMPL_ARRAY_DEFINE_SIGNED_DIVIDE(i16, INT16_MIN)
+IMPL_ARRAY_DEFINE_SIGNED_DIVIDE(i32, INT32_MIN)
+IMPL_ARRAY_DEFINE_SIGNED_DIVIDE(i64, INT64_MIN)
+
+IMPL_ARRAY_DEFINE_MIN_MAX(ui8)
+IMPL_ARRAY_DEFINE_MIN_MAX(ui16)
+IMPL_ARRAY_DEFINE_MIN_MAX(ui32)
+IMPL_ARRAY_DEFINE_MIN_MAX(ui64)
+IMPL_ARRAY_DEFINE_MIN_MAX(i8)
+IMPL_ARRAY_DEFINE_MIN_MAX(i16)
+IMPL_ARRAY_DEFINE_MIN_MAX(i32)
+IMPL_ARRAY_DEFINE_MIN_MAX(i64)
+IMPL_ARRAY_DEFINE_MIN_MAX(f)
+IMPL_ARRAY_DEFINE_MIN_MAX(d)
+
+IMPL_ARRAY_DEFINE_FLOATING_REDUCE(f)
+IMPL_ARRAY_DEFINE_FLOATING_REDUCE(d)
+
+void impl_array_negate_integer(QWORD* result, const QWORD* values, uint64_t count)
+{
+	for (uint64_t i = 0; i < count; i++)
+		result[i].ui64 = 0 - values[i].ui64;
+}
+
+QWORD impl_array_sum_integer(const QWORD* values, uint64_t count)
+{
+	QWORD sum = { .ui64 = 0 };
+	for (uint64_t i = 0; i < count; i++)
+		sum.ui64 += values[i].ui64;
+	return sum;
+}
+
+QWORD impl_array_dot_integer(const QWORD* left, const QWORD* right, uint64_t count)
+{
+	QWORD sum = { .ui64 = 0 };
+	for (uint64_t i = 0; i < count; i++)
+		sum.ui64 += left[i].ui64 * right[i].ui64;
+	return sum;
+}
+
+/**********************************
+VECTOR KERNELS
+**********************************/
+
+/// @brief Defines the binary kernel 'name', operating on 'width' QWORD at a time, the remaining values using 'scalar'
+#define IMPL_ARRAY_DEFINE_VECTOR_BINARY(name, target, width, load, store, operation, scalar) \
+target bool name(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count) \
+{ \
+	uint64_t i = 0; \
+	for (; i + (width) <= count; i += (width)) \
+		store(result + i, operation(load(left + i), load(right + i))); \
+	return scalar(result + i, left + i, right + i, count - i); \
+}
+
+/// @brief Defines the unary kernel 'name', operating on 'width' QWORD at a time, the remaining values using 'scalar'
+#define IMPL_ARRAY_DEFINE_VECTOR_UNARY(name, target, width, load, store, operation, scalar) \
+target void name(QWORD* result, const QWORD* values, uint64_t count) \
+{ \
+	uint64_t i = 0; \
+	for (; i + (width) <= count; i += (width)) \
+		store(result + i, operation(load(values + i))); \
+	scalar(result + i, values + i, count - i); \
+}
+
+/// @brief Defines the reduction kernel 'name', which reduces each lane of a vector separately
+/// ('operation' taking the accumulator then the values), then reduces the lanes and the
+/// remaining values using 'scalar'
+#define IMPL_ARRAY_DEFINE_VECTOR_REDUCE(name, target, vector, width, load, store, operation, scalar) \
+target QWORD name(const QWORD* values, uint64_t count) \
+{ \
+	if (count < 2 * (width)) \
+		return scalar(values, count); \
+	vector accumulator = load(values); \
+	uint64_t i = (width); \
+	for (; i + (width) <= count; i += (width)) \
+		accumulator = operation(accumulator, load(values + i)); \
+	QWORD rest[2 * (width)]; \
+	store(rest, accumulator); \
+	memcpy(rest + (width), values + i, (count - i) * sizeof(QWORD)); \
+	return scalar(rest, (width) + count - i); \
+}
+
+/// @brief Defines the dot product kernel 'name', which sums the products in each lane of a vector separately,
+/// then sums the lanes and the dot product of the remaining values using 'scalar_sum' and 'scalar_dot'
+#define IMPL_ARRAY_DEFINE_VECTOR_DOT(name, target, vector, width, load, store, multiply, add, scalar_dot, scalar_sum) \
+target QWORD name(const QWORD* left, const QWORD* right, uint64_t count) \
+{ \
+	if (count < 2 * (width)) \
+		return scalar_dot(left, right, count); \
+	vector accumulator = multiply(load(left), load(right)); \
+	uint64_t i = (width); \
+	for (; i + (width) <= count; i += (width)) \
+		accumulator = add(accumulator, multiply(load(left + i), load(right + i))); \
+	QWORD rest[(width) + 1]; \
+	store(rest, accumulator); \
+	rest[(width)] = scalar_dot(left + i, right + i, count - i); \
+	return scalar_sum(rest, (width) + 1); \
+}
+
+#ifdef IMPL_COLTI_SSE2_ARRAYS
+	//Each QWORD takes 64 bits of a vector (and each FLOAT the lanes 0 and 2 of a vector of floats)
+	#define IMPL_SSE2_LOAD_SI(ptr)			_mm_loadu_si128((const __m128i*)(ptr))
+	#define IMPL_SSE2_STORE_SI(ptr, value)	_mm_storeu_si128((__m128i*)(ptr), value)
+	#define IMPL_SSE2_LOAD_PS(ptr)			_mm_loadu_ps((const float*)(ptr))
+	#define IMPL_SSE2_STORE_PS(ptr, value)	_mm_storeu_ps((float*)(ptr), value)
+	#define IMPL_SSE2_LOAD_PD(ptr)			_mm_loadu_pd((const double*)(ptr))
+	#define IMPL_SSE2_STORE_PD(ptr, value)	_mm_storeu_pd((double*)(ptr), value)
+	#define IMPL_SSE2_NEGATE_SI(value)		_mm_sub_epi64(_mm_setzero_si128(), value)
+	#define IMPL_SSE2_NEGATE_PS(value)		_mm_xor_ps(value, _mm_set1_ps(-0.0f))
+	#define IMPL_SSE2_NEGATE_PD(value)		_mm_xor_pd(value, _mm_set1_pd(-0.0))
+	//MINPS(a, b) is 'a < b ? a : b', which keeps the accumulator 'b' unless the value 'a' is less
+	#define IMPL_SSE2_MIN_PS(acc, value)	_mm_min_ps(value, acc)
+	#define IMPL_SSE2_MAX_PS(acc, value)	_mm_max_ps(value, acc)
+	#define IMPL_SSE2_MIN_PD(acc, value)	_mm_min_pd(value, acc)
+	#define IMPL_SSE2_MAX_PD(acc, value)	_mm_max_pd(value, acc)
+
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_add_integer, , 2, IMPL_SSE2_LOAD_SI, IMPL_SSE2_STORE_SI, _mm_add_epi64, impl_array_add_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_subtract_integer, , 2, IMPL_SSE2_LOAD_SI, IMPL_SSE2_STORE_SI, _mm_sub_epi64, impl_array_subtract_integer)
+	//The low 32 bits of the product of the low 32 bits of each QWORD
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_multiply_narrow, , 2, IMPL_SSE2_LOAD_SI, IMPL_SSE2_STORE_SI, _mm_mul_epu32, impl_array_multiply_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_UNARY(impl_array_sse2_negate_integer, , 2, IMPL_SSE2_LOAD_SI, IMPL_SSE2_STORE_SI, IMPL_SSE2_NEGATE_SI, impl_array_negate_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_sse2_sum_integer, , __m128i, 2, IMPL_SSE2_LOAD_SI, IMPL_SSE2_STORE_SI, _mm_add_epi64, impl_array_sum_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_DOT(impl_array_sse2_dot_narrow, , __m128i, 2, IMPL_SSE2_LOAD_SI, IMPL_SSE2_STORE_SI, _mm_mul_epu32, _mm_add_epi64, impl_array_dot_integer, impl_array_sum_integer)
+
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_add_f, , 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, _mm_add_ps, impl_array_add_f)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_subtract_f, , 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, _mm_sub_ps, impl_array_subtract_f)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_multiply_f, , 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, _mm_mul_ps, impl_array_multiply_f)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_divide_f, , 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, _mm_div_ps, impl_array_divide_f)
+	IMPL_ARRAY_DEFINE_VECTOR_UNARY(impl_array_sse2_negate_f, , 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, IMPL_SSE2_NEGATE_PS, impl_array_negate_f)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_sse2_sum_f, , __m128, 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, _mm_add_ps, impl_array_sum_f)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_sse2_min_f, , __m128, 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, IMPL_SSE2_MIN_PS, impl_array_min_f)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_sse2_max_f, , __m128, 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, IMPL_SSE2_MAX_PS, impl_array_max_f)
+	IMPL_ARRAY_DEFINE_VECTOR_DOT(impl_array_sse2_dot_f, , __m128, 2, IMPL_SSE2_LOAD_PS, IMPL_SSE2_STORE_PS, _mm_mul_ps, _mm_add_ps, impl_array_dot_f, impl_array_sum_f)
+
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_add_d, , 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, _mm_add_pd, impl_array_add_d)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_subtract_d, , 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, _mm_sub_pd, impl_array_subtract_d)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_multiply_d, , 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, _mm_mul_pd, impl_array_multiply_d)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_sse2_divide_d, , 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, _mm_div_pd, impl_array_divide_d)
+	IMPL_ARRAY_DEFINE_VECTOR_UNARY(impl_array_sse2_negate_d, , 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, IMPL_SSE2_NEGATE_PD, impl_array_negate_d)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_sse2_sum_d, , __m128d, 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, _mm_add_pd, impl_array_sum_d)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_sse2_min_d, , __m128d, 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, IMPL_SSE2_MIN_PD, impl_array_min_d)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_sse2_max_d, , __m128d, 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, IMPL_SSE2_MAX_PD, impl_array_max_d)
+	IMPL_ARRAY_DEFINE_VECTOR_DOT(impl_array_sse2_dot_d, , __m128d, 2, IMPL_SSE2_LOAD_PD, IMPL_SSE2_STORE_PD, _mm_mul_pd, _mm_add_pd, impl_array_dot_d, impl_array_sum_d)
+#endif
+
+#ifdef IMPL_COLTI_AVX2_ARRAYS
+	#define IMPL_AVX2_LOAD_SI(ptr)			_mm256_loadu_si256((const __m256i*)(ptr))
+	#define IMPL_AVX2_STORE_SI(ptr, value)	_mm256_storeu_si256((__m256i*)(ptr), value)
+	#define IMPL_AVX2_LOAD_PS(ptr)			_mm256_loadu_ps((const float*)(ptr))
+	#define IMPL_AVX2_STORE_PS(ptr, value)	_mm256_storeu_ps((float*)(ptr), value)
+	#define IMPL_AVX2_LOAD_PD(ptr)			_mm256_loadu_pd((const double*)(ptr))
+	#define IMPL_AVX2_STORE_PD(ptr, value)	_mm256_storeu_pd((double*)(ptr), value)
+	#define IMPL_AVX2_NEGATE_SI(value)		_mm256_sub_epi64(_mm256_setzero_si256(), value)
+	#define IMPL_AVX2_NEGATE_PS(value)		_mm256_xor_ps(value, _mm256_set1_ps(-0.0f))
+	#define IMPL_AVX2_NEGATE_PD(value)		_mm256_xor_pd(value, _mm256_set1_pd(-0.0))
+	#define IMPL_AVX2_MIN_PS(acc, value)	_mm256_min_ps(value, acc)
+	#define IMPL_AVX2_MAX_PS(acc, value)	_mm256_max_ps(value, acc)
+	#define IMPL_AVX2_MIN_PD(acc, value)	_mm256_min_pd(value, acc)
+	#define IMPL_AVX2_MAX_PD(acc, value)	_mm256_max_pd(value, acc)
+	//There are no 64-bit integer min and max before AVX-512: the values are compared then blended
+	#define IMPL_AVX2_MIN_I64(acc, value)	_mm256_blendv_epi8(acc, value, _mm256_cmpgt_epi64(acc, value))
+	#define IMPL_AVX2_MAX_I64(acc, value)	_mm256_blendv_epi8(acc, value, _mm256_cmpgt_epi64(value, acc))
+	//Flipping the sign bits compares unsigned integers as signed ones
+	#define IMPL_AVX2_BIAS(value)			_mm256_xor_si256(value, _mm256_set1_epi64x(INT64_MIN))
+	#define IMPL_AVX2_MIN_UI64(acc, value)	_mm256_blendv_epi8(acc, value, _mm256_cmpgt_epi64(IMPL_AVX2_BIAS(acc), IMPL_AVX2_BIAS(value)))
+	#define IMPL_AVX2_MAX_UI64(acc, value)	_mm256_blendv_epi8(acc, value, _mm256_cmpgt_epi64(IMPL_AVX2_BIAS(value), IMPL_AVX2_BIAS(acc)))
+
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_add_integer, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, _mm256_add_epi64, impl_array_add_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_subtract_integer, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, _mm256_sub_epi64, impl_array_subtract_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_multiply_narrow, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, _mm256_mul_epu32, impl_array_multiply_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_UNARY(impl_array_avx2_negate_integer, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, IMPL_AVX2_NEGATE_SI, impl_array_negate_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_sum_integer, IMPL_ARRAY_AVX2_TARGET, __m256i, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, _mm256_add_epi64, impl_array_sum_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_DOT(impl_array_avx2_dot_narrow, IMPL_ARRAY_AVX2_TARGET, __m256i, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, _mm256_mul_epu32, _mm256_add_epi64, impl_array_dot_integer, impl_array_sum_integer)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_min_i64, IMPL_ARRAY_AVX2_TARGET, __m256i, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, IMPL_AVX2_MIN_I64, impl_array_min_i64)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_max_i64, IMPL_ARRAY_AVX2_TARGET, __m256i, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, IMPL_AVX2_MAX_I64, impl_array_max_i64)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_min_ui64, IMPL_ARRAY_AVX2_TARGET, __m256i, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, IMPL_AVX2_MIN_UI64, impl_array_min_ui64)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_max_ui64, IMPL_ARRAY_AVX2_TARGET, __m256i, 4, IMPL_AVX2_LOAD_SI, IMPL_AVX2_STORE_SI, IMPL_AVX2_MAX_UI64, impl_array_max_ui64)
+
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_add_f, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, _mm256_add_ps, impl_array_add_f)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_subtract_f, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, _mm256_sub_ps, impl_array_subtract_f)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_multiply_f, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, _mm256_mul_ps, impl_array_multiply_f)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_divide_f, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, _mm256_div_ps, impl_array_divide_f)
+	IMPL_ARRAY_DEFINE_VECTOR_UNARY(impl_array_avx2_negate_f, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, IMPL_AVX2_NEGATE_PS, impl_array_negate_f)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_sum_f, IMPL_ARRAY_AVX2_TARGET, __m256, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, _mm256_add_ps, impl_array_sum_f)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_min_f, IMPL_ARRAY_AVX2_TARGET, __m256, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, IMPL_AVX2_MIN_PS, impl_array_min_f)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_max_f, IMPL_ARRAY_AVX2_TARGET, __m256, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, IMPL_AVX2_MAX_PS, impl_array_max_f)
+	IMPL_ARRAY_DEFINE_VECTOR_DOT(impl_array_avx2_dot_f, IMPL_ARRAY_AVX2_TARGET, __m256, 4, IMPL_AVX2_LOAD_PS, IMPL_AVX2_STORE_PS, _mm256_mul_ps, _mm256_add_ps, impl_array_dot_f, impl_array_sum_f)
+
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_add_d, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, _mm256_add_pd, impl_array_add_d)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_subtract_d, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, _mm256_sub_pd, impl_array_subtract_d)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_multiply_d, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, _mm256_mul_pd, impl_array_multiply_d)
+	IMPL_ARRAY_DEFINE_VECTOR_BINARY(impl_array_avx2_divide_d, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, _mm256_div_pd, impl_array_divide_d)
+	IMPL_ARRAY_DEFINE_VECTOR_UNARY(impl_array_avx2_negate_d, IMPL_ARRAY_AVX2_TARGET, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, IMPL_AVX2_NEGATE_PD, impl_array_negate_d)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_sum_d, IMPL_ARRAY_AVX2_TARGET, __m256d, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, _mm256_add_pd, impl_array_sum_d)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_min_d, IMPL_ARRAY_AVX2_TARGET, __m256d, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, IMPL_AVX2_MIN_PD, impl_array_min_d)
+	IMPL_ARRAY_DEFINE_VECTOR_REDUCE(impl_array_avx2_max_d, IMPL_ARRAY_AVX2_TARGET, __m256d, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, IMPL_AVX2_MAX_PD, impl_array_max_d)
+	IMPL_ARRAY_DEFINE_VECTOR_DOT(impl_array_avx2_dot_d, IMPL_ARRAY_AVX2_TARGET, __m256d, 4, IMPL_AVX2_LOAD_PD, IMPL_AVX2_STORE_PD, _mm256_mul_pd, _mm256_add_pd, impl_array_dot_d, impl_array_sum_d)
+#endif
+
+/**********************************
+KERNEL TABLES
+**********************************/
+
+/// @brief The kernels of an integer type (whose QWORD member is 'member'), given the kernels which
+/// depend on the width of the type
+#define IMPL_ARRAY_INTEGER_KERNELS(prefix, member, multiply_kernel, dot_kernel, min_kernel, max_kernel) \
+{ \
+	.add = prefix##_add_integer, .subtract = prefix##_subtract_integer, .multiply = multiply_kernel, \
+	.divide = impl_array_divide_##member, .negate = prefix##_negate_integer, .sum = prefix##_sum_integer, \
+	.min = min_kernel, .max = max_kernel, .dot = dot_kernel, \
+}
+
+/// @brief The kernels of FLOAT or DOUBLE (whose QWORD member is 'member')
+#define IMPL_ARRAY_FLOATING_KERNELS(prefix, member) \
+{ \
+	.add = prefix##_add_##member, .subtract = prefix##_subtract_##member, .multiply = prefix##_multiply_##member, \
+	.divide = prefix##_divide_##member, .negate = prefix##_negate_##member, .sum = prefix##_sum_##member, \
+	.min = prefix##_min_##member, .max = prefix##_max_##member, .dot = prefix##_dot_##member, \
+}
+
+/// @brief The kernels of an integer type using the scalar kernels
+#define IMPL_ARRAY_SCALAR_INTEGER_KERNELS(prefix, member) \
+	IMPL_ARRAY_INTEGER_KERNELS(prefix, member, impl_array_multiply_integer, impl_array_dot_integer, impl_array_min_##member, impl_array_max_##member)
+
+/// @brief The kernels of an integer type of at most 32 bits, which can be multiplied using vectors
+#define IMPL_ARRAY_NARROW_INTEGER_KERNELS(prefix, member) \
+	IMPL_ARRAY_INTEGER_KERNELS(prefix, member, prefix##_multiply_narrow, prefix##_dot_narrow, impl_array_min_##member, impl_array_max_##member)
+
+/// @brief The scalar kernels of each OperandType
+static const ArrayKernels g_array_scalar_kernels[OPERAND_TYPE_COUNT] =
+{
+	[OPERAND_COLTI_UI8] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array, ui8),
+	[OPERAND_COLTI_UI16] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array, ui16),
+	[OPERAND_COLTI_UI32] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array, ui32),
+	[OPERAND_COLTI_UI64] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array, ui64),
+	[OPERAND_COLTI_I8] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array, i8),
+	[OPERAND_COLTI_I16] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array, i16),
+	[OPERAND_COLTI_I32] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array, i32),
+	[OPERAND_COLTI_I64] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array, i64),
+	[OPERAND_COLTI_FLOAT] = IMPL_ARRAY_FLOATING_KERNELS(impl_array, f),
+	[OPERAND_COLTI_DOUBLE] = IMPL_ARRAY_FLOATING_KERNELS(impl_array, d),
+};
+
+#ifdef IMPL_COLTI_SSE2_ARRAYS
+/// @brief The kernels of each OperandType using 128-bit vectors
+static const ArrayKernels g_array_sse2_kernels[OPERAND_TYPE_COUNT] =
+{
+	[OPERAND_COLTI_UI8] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_sse2, ui8),
+	[OPERAND_COLTI_UI16] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_sse2, ui16),
+	[OPERAND_COLTI_UI32] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_sse2, ui32),
+	[OPERAND_COLTI_UI64] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array_sse2, ui64),
+	[OPERAND_COLTI_I8] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_sse2, i8),
+	[OPERAND_COLTI_I16] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_sse2, i16),
+	[OPERAND_COLTI_I32] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_sse2, i32),
+	[OPERAND_COLTI_I64] = IMPL_ARRAY_SCALAR_INTEGER_KERNELS(impl_array_sse2, i64),
+	[OPERAND_COLTI_FLOAT] = IMPL_ARRAY_FLOATING_KERNELS(impl_array_sse2, f),
+	[OPERAND_COLTI_DOUBLE] = IMPL_ARRAY_FLOATING_KERNELS(impl_array_sse2, d),
+};
+#endif
+
+#ifdef IMPL_COLTI_AVX2_ARRAYS
+/// @brief The kernels of each OperandType using 256-bit vectors
+static const ArrayKernels g_array_avx2_kernels[OPERAND_TYPE_COUNT] =
+{
+	[OPERAND_COLTI_UI8] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_avx2, ui8),
+	[OPERAND_COLTI_UI16] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_avx2, ui16),
+	[OPERAND_COLTI_UI32] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_avx2, ui32),
+	[OPERAND_COLTI_UI64] = IMPL_ARRAY_INTEGER_KERNELS(impl_array_avx2, ui64, impl_array_multiply_integer,
+		impl_array_dot_integer, impl_array_avx2_min_ui64, impl_array_avx2_max_ui64),
+	[OPERAND_COLTI_I8] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_avx2, i8),
+	[OPERAND_COLTI_I16] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_avx2, i16),
+	[OPERAND_COLTI_I32] = IMPL_ARRAY_NARROW_INTEGER_KERNELS(impl_array_avx2, i32),
+	[OPERAND_COLTI_I64] = IMPL_ARRAY_INTEGER_KERNELS(impl_array_avx2, i64, impl_array_multiply_integer,
+		impl_array_dot_integer, impl_array_avx2_min_i64, impl_array_avx2_max_i64),
+	[OPERAND_COLTI_FLOAT] = IMPL_ARRAY_FLOATING_KERNELS(impl_array_avx2, f),
+	[OPERAND_COLTI_DOUBLE] = IMPL_ARRAY_FLOATING_KERNELS(impl_array_avx2, d),
+};
+#endif
+
+ArrayKernelLevel ArrayKernelsGetLevel(void)
+{
+#ifdef IMPL_COLTI_AVX2_ARRAYS
+	//Also checks that the OS saves the AVX registers
+	if (__builtin_cpu_supports("avx2"))
+		return ARRAY_KERNELS_AVX2;
+#endif
+#ifdef IMPL_COLTI_SSE2_ARRAYS
+	return ARRAY_KERNELS_SSE2;
+#else
+	return ARRAY_KERNELS_SCALAR;
+#endif
+}
+
+const ArrayKernels* ArrayKernelsGet(ArrayKernelLevel level, OperandType type)
+{
+	colti_assert(type < OPERAND_TYPE_COUNT && type != OPERAND_COLTI_BOOL, "Invalid OperandType!");
+	switch (level)
+	{
+#ifdef IMPL_COLTI_AVX2_ARRAYS
+	case ARRAY_KERNELS_AVX2:	return &g_array_avx2_kernels[type];
+#endif
+#ifdef IMPL_COLTI_SSE2_ARRAYS
+	case ARRAY_KERNELS_SSE2:	return &g_array_sse2_kernels[type];
+#endif
+	case ARRAY_KERNELS_SCALAR:	return &g_array_scalar_kernels[type];
+	default:
+		colti_assert(false, "Kernels not supported by the compiler or the CPU!");
+		return &g_array_scalar_kernels[type];
+	}
+}
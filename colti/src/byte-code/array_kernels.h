@@ -0,0 +1,106 @@
+/** @file array_kernels.h
+* Contains the kernels operating on the values of an Array (see array.h), a contiguous buffer of QWORD.
+* Each OperandType has a table of ArrayKernels, and each instruction set supported has its own tables:
+* - ARRAY_KERNELS_SCALAR: portable C loops, used for any kernel which has no vector version
+* - ARRAY_KERNELS_SSE2: 2 QWORD at a time, on SSE2 targets
+* - ARRAY_KERNELS_AVX2: 4 QWORD at a time, compiled for AVX2 (GCC and Clang on x86) and used if the CPU supports it.
+* The level is chosen at runtime by ArrayKernelsGetLevel, so that a single binary uses the widest vectors available.
+* As each value is stored in a QWORD, integers are added, subtracted, negated and summed as 64-bit integers
+* (whose low bits are the result for narrower types), which wraps for all types. Integers of at most 32 bits are
+* multiplied as 32-bit integers, for which there are vector instructions.
+* A FLOAT is stored in the low 32 bits of its QWORD: vectors operate on both halves of each QWORD, the upper
+* bits of the results being unspecified (as for ConvertValues).
+* The order in which a reduction (sum, min, max or dot product) of FLOAT and DOUBLE combines the values is
+* unspecified, so that the vector kernels can reduce each lane separately: the results may differ in rounding
+* from the scalar kernels, and min and max of values containing NaN are unspecified.
+*/
+
+#ifndef HG_COLTI_ARRAY_KERNELS
+#define HG_COLTI_ARRAY_KERNELS
+
+#include "common.h"
+#include "byte_code.h"
+
+/// @brief Computes an elementwise binary operation, 'result[i] = left[i] op right[i]'.
+/// 'result' may be the same buffer as 'left' or 'right'.
+/// @return False if an integer division by zero or overflow happened (in which case 'result' is partially written)
+typedef bool(*ArrayBinaryKernel)(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+/// @brief Computes an elementwise unary operation, 'result[i] = op values[i]'
+typedef void(*ArrayUnaryKernel)(QWORD* result, const QWORD* values, uint64_t count);
+/// @brief Reduces values to a single value (the sum of no values being 0, min and max expecting at least 1 value)
+typedef QWORD(*ArrayReduceKernel)(const QWORD* values, uint64_t count);
+/// @brief Computes the dot product of 2 buffers of values
+typedef QWORD(*ArrayDotKernel)(const QWORD* left, const QWORD* right, uint64_t count);
+
+/// @brief The kernels operating on values of an OperandType (which are NULL for BOOL)
+typedef struct
+{
+	/// @brief Elementwise sum
+	ArrayBinaryKernel add;
+	/// @brief Elementwise difference
+	ArrayBinaryKernel subtract;
+	/// @brief Elementwise product
+	ArrayBinaryKernel multiply;
+	/// @brief Elementwise division, failing on integer division by zero or overflow
+	ArrayBinaryKernel divide;
+	/// @brief Elementwise negation (whose results are unspecified for unsigned types)
+	ArrayUnaryKernel negate;
+	/// @brief Sum of the values
+	ArrayReduceKernel sum;
+	/// @brief Minimum of the values
+	ArrayReduceKernel min;
+	/// @brief Maximum of the values
+	ArrayReduceKernel max;
+	/// @brief Sum of the elementwise product
+	ArrayDotKernel dot;
+} ArrayKernels;
+
+/// @brief The instruction set used by ArrayKernels
+typedef enum
+{
+	/// @brief Portable C
+	ARRAY_KERNELS_SCALAR,
+	/// @brief 128-bit vectors
+	ARRAY_KERNELS_SSE2,
+	/// @brief 256-bit vectors
+	ARRAY_KERNELS_AVX2,
+} ArrayKernelLevel;
+
+/// @brief Returns the widest instruction set for which kernels were compiled, and that the CPU supports
+/// @return The ArrayKernelLevel to use
+ArrayKernelLevel ArrayKernelsGetLevel(void);
+
+/// @brief Returns the kernels operating on an OperandType, using an instruction set
+/// @param level The instruction set, which must not be wider than ArrayKernelsGetLevel()
+/// @param type The type of the values
+/// @return The kernels of the type
+const ArrayKernels* ArrayKernelsGet(ArrayKernelLevel level, OperandType type);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief The scalar kernels shared by all integer types, and those of FLOAT ('_f') and DOUBLE ('_d').
+/// Parameters and return value are those of the kernel types.
+bool impl_array_add_integer(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_subtract_integer(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_multiply_integer(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+void impl_array_negate_integer(QWORD* result, const QWORD* values, uint64_t count);
+QWORD impl_array_sum_integer(const QWORD* values, uint64_t count);
+QWORD impl_array_dot_integer(const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_add_f(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_subtract_f(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_multiply_f(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_divide_f(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+void impl_array_negate_f(QWORD* result, const QWORD* values, uint64_t count);
+QWORD impl_array_sum_f(const QWORD* values, uint64_t count);
+QWORD impl_array_dot_f(const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_add_d(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_subtract_d(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_multiply_d(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+bool impl_array_divide_d(QWORD* result, const QWORD* left, const QWORD* right, uint64_t count);
+void impl_array_negate_d(QWORD* result, const QWORD* values, uint64_t count);
+QWORD impl_array_sum_d(const QWORD* values, uint64_t count);
+QWORD impl_array_dot_d(const QWORD* left, const QWORD* right, uint64_t count);
+
+#endif //HG_COLTI_ARRAY_KERNELS
@@ -3,6 +3,237 @@
 */
 
 #include "byte_code.h"
+#include "conversion.h"
+
+/// @brief The layout of each OpCode, LAYOUT_INVALID (0) for bytes that are not OpCodes
+static const uint8_t g_opcode_layouts[256] =
+{
+	[OP_IMMEDIATE_BYTE] = LAYOUT_BYTE,
+	[OP_IMMEDIATE_WORD] = LAYOUT_WORD,
+	[OP_IMMEDIATE_DWORD] = LAYOUT_DWORD,
+	[OP_IMMEDIATE_QWORD] = LAYOUT_QWORD,
+	[OP_LOAD_CONST_BYTE] = LAYOUT_BYTE,
+	[OP_LOAD_CONST_WORD] = LAYOUT_WORD,
+	[OP_NEGATE] = LAYOUT_TYPE,
+	[OP_CONVERT] = LAYOUT_TWO_TYPES,
+	[OP_ADD] = LAYOUT_TYPE,
+	[OP_SUBTRACT] = LAYOUT_TYPE,
+	[OP_MULTIPLY] = LAYOUT_TYPE,
+	[OP_DIVIDE] = LAYOUT_TYPE,
+	[OP_MODULO] = LAYOUT_TYPE,
+	[OP_PRINT] = LAYOUT_TYPE,
+	[OP_RETURN] = LAYOUT_NONE,
+	[OP_CVT_I32_I64] = LAYOUT_NONE,
+	[OP_CVT_I64_I32] = LAYOUT_NONE,
+	[OP_CVT_I32_DOUBLE] = LAYOUT_NONE,
+	[OP_CVT_DOUBLE_I32] = LAYOUT_NONE,
+	[OP_CVT_I64_DOUBLE] = LAYOUT_NONE,
+	[OP_CVT_DOUBLE_I64] = LAYOUT_NONE,
+	[OP_CVT_FLOAT_DOUBLE] = LAYOUT_NONE,
+	[OP_CVT_DOUBLE_FLOAT] = LAYOUT_NONE,
+	[OP_ADD_CHECKED] = LAYOUT_TYPE,
+	[OP_SUBTRACT_CHECKED] = LAYOUT_TYPE,
+	[OP_MULTIPLY_CHECKED] = LAYOUT_TYPE,
+	[OP_DIVIDE_CHECKED] = LAYOUT_TYPE,
+	[OP_MODULO_CHECKED] = LAYOUT_TYPE,
+	[OP_ADD_WRAPPING] = LAYOUT_TYPE,
+	[OP_SUBTRACT_WRAPPING] = LAYOUT_TYPE,
+	[OP_MULTIPLY_WRAPPING] = LAYOUT_TYPE,
+	[OP_DIVIDE_CONST] = LAYOUT_TYPE_WORD,
+	[OP_MODULO_CONST] = LAYOUT_TYPE_WORD,
+	[OP_ARRAY_NEW] = LAYOUT_TYPE,
+	[OP_ARRAY_LENGTH] = LAYOUT_TYPE,
+	[OP_ARRAY_GET] = LAYOUT_TYPE,
+	[OP_ARRAY_SET] = LAYOUT_TYPE,
+	[OP_ARRAY_ADD] = LAYOUT_TYPE,
+	[OP_ARRAY_SUBTRACT] = LAYOUT_TYPE,
+	[OP_ARRAY_MULTIPLY] = LAYOUT_TYPE,
+	[OP_ARRAY_DIVIDE] = LAYOUT_TYPE,
+	[OP_ARRAY_NEGATE] = LAYOUT_TYPE,
+	[OP_ARRAY_CONVERT] = LAYOUT_TWO_TYPES,
+	[OP_ARRAY_SUM] = LAYOUT_TYPE,
+	[OP_ARRAY_MIN] = LAYOUT_TYPE,
+	[OP_ARRAY_MAX] = LAYOUT_TYPE,
+	[OP_ARRAY_DOT] = LAYOUT_TYPE,
+	[OP_LOAD_LOCAL_BYTE] = LAYOUT_BYTE,
+	[OP_LOAD_LOCAL_WORD] = LAYOUT_WORD,
+	[OP_STORE_LOCAL_BYTE] = LAYOUT_BYTE,
+	[OP_STORE_LOCAL_WORD] = LAYOUT_WORD,
+	[OP_INC_LOCAL_BYTE] = LAYOUT_TYPE_BYTE,
+	[OP_INC_LOCAL_WORD] = LAYOUT_TYPE_WORD,
+	[OP_ENTER] = LAYOUT_TWO_BYTES,
+	[OP_CALL] = LAYOUT_TARGET,
+	[OP_TAIL_CALL] = LAYOUT_TARGET,
+	[OP_JUMP] = LAYOUT_JUMP,
+	[OP_JUMP_IF_FALSE] = LAYOUT_JUMP,
+	[OP_JUMP_IF_LESS] = LAYOUT_TYPE_JUMP,
+	[OP_JUMP_IF_LESS_EQUAL] = LAYOUT_TYPE_JUMP,
+	[OP_JUMP_IF_EQUAL] = LAYOUT_TYPE_JUMP,
+	[OP_JUMP_IF_NOT_EQUAL] = LAYOUT_TYPE_JUMP,
+	[OP_JUMP_TABLE] = LAYOUT_JUMP_TABLE,
+	[OP_LOOP] = LAYOUT_LOOP,
+	[OP_LOAD_GLOBAL] = LAYOUT_WORD,
+	[OP_STORE_GLOBAL] = LAYOUT_WORD,
+	[OP_BOX] = LAYOUT_TYPE,
+	[OP_UNBOX] = LAYOUT_TYPE,
+	[OP_ADD_DYNAMIC] = LAYOUT_DWORD,
+	[OP_ADD_DYNAMIC_I64] = LAYOUT_DWORD,
+	[OP_ADD_DYNAMIC_DOUBLE] = LAYOUT_DWORD,
+	[OP_ADD_DYNAMIC_POLY] = LAYOUT_DWORD,
+	[OP_ADD_I64] = LAYOUT_QUICKENED,
+	[OP_ADD_DOUBLE] = LAYOUT_QUICKENED,
+	[OP_SUBTRACT_I64] = LAYOUT_QUICKENED,
+	[OP_SUBTRACT_DOUBLE] = LAYOUT_QUICKENED,
+	[OP_MULTIPLY_I64] = LAYOUT_QUICKENED,
+	[OP_MULTIPLY_DOUBLE] = LAYOUT_QUICKENED,
+};
+
+OpCodeLayout OpCodeGetLayout(uint8_t code)
+{
+	return (OpCodeLayout)g_opcode_layouts[code];
+}
+
+const char* OpCodeToString(uint8_t code)
+{
+	switch (code)
+	{
+	case OP_IMMEDIATE_BYTE:		return "OP_IMMEDIATE_BYTE";
+	case OP_IMMEDIATE_WORD:		return "OP_IMMEDIATE_WORD";
+	case OP_IMMEDIATE_DWORD:	return "OP_IMMEDIATE_DWORD";
+	case OP_IMMEDIATE_QWORD:	return "OP_IMMEDIATE_QWORD";
+	case OP_LOAD_CONST_BYTE:	return "OP_LOAD_CONST_BYTE";
+	case OP_LOAD_CONST_WORD:	return "OP_LOAD_CONST_WORD";
+	case OP_NEGATE:				return "OP_NEGATE";
+	case OP_CONVERT:			return "OP_CONVERT";
+	case OP_ADD:				return "OP_ADD";
+	case OP_SUBTRACT:			return "OP_SUBTRACT";
+	case OP_MULTIPLY:			return "OP_MULTIPLY";
+	case OP_DIVIDE:				return "OP_DIVIDE";
+	case OP_MODULO:				return "OP_MODULO";
+	case OP_PRINT:				return "OP_PRINT";
+	case OP_RETURN:				return "OP_RETURN";
+	case OP_CVT_I32_I64:		return "OP_CVT_I32_I64";
+	case OP_CVT_I64_I32:		return "OP_CVT_I64_I32";
+	case OP_CVT_I32_DOUBLE:		return "OP_CVT_I32_DOUBLE";
+	case OP_CVT_DOUBLE_I32:		return "OP_CVT_DOUBLE_I32";
+	case OP_CVT_I64_DOUBLE:		return "OP_CVT_I64_DOUBLE";
+	case OP_CVT_DOUBLE_I64:		return "OP_CVT_DOUBLE_I64";
+	case OP_CVT_FLOAT_DOUBLE:	return "OP_CVT_FLOAT_DOUBLE";
+	case OP_CVT_DOUBLE_FLOAT:	return "OP_CVT_DOUBLE_FLOAT";
+	case OP_ADD_CHECKED:		return "OP_ADD_CHECKED";
+	case OP_SUBTRACT_CHECKED:	return "OP_SUBTRACT_CHECKED";
+	case OP_MULTIPLY_CHECKED:	return "OP_MULTIPLY_CHECKED";
+	case OP_DIVIDE_CHECKED:		return "OP_DIVIDE_CHECKED";
+	case OP_MODULO_CHECKED:		return "OP_MODULO_CHECKED";
+	case OP_ADD_WRAPPING:		return "OP_ADD_WRAPPING";
+	case OP_SUBTRACT_WRAPPING:	return "OP_SUBTRACT_WRAPPING";
+	case OP_MULTIPLY_WRAPPING:	return "OP_MULTIPLY_WRAPPING";
+	case OP_DIVIDE_CONST:		return "OP_DIVIDE_CONST";
+	case OP_MODULO_CONST:		return "OP_MODULO_CONST";
+	case OP_ARRAY_NEW:			return "OP_ARRAY_NEW";
+	case OP_ARRAY_LENGTH:		return "OP_ARRAY_LENGTH";
+	case OP_ARRAY_GET:			return "OP_ARRAY_GET";
+	case OP_ARRAY_SET:			return "OP_ARRAY_SET";
+	case OP_ARRAY_ADD:			return "OP_ARRAY_ADD";
+	case OP_ARRAY_SUBTRACT:		return "OP_ARRAY_SUBTRACT";
+	case OP_ARRAY_MULTIPLY:		return "OP_ARRAY_MULTIPLY";
+	case OP_ARRAY_DIVIDE:		return "OP_ARRAY_DIVIDE";
+	case OP_ARRAY_NEGATE:		return "OP_ARRAY_NEGATE";
+	case OP_ARRAY_CONVERT:		return "OP_ARRAY_CONVERT";
+	case OP_ARRAY_SUM:			return "OP_ARRAY_SUM";
+	case OP_ARRAY_MIN:			return "OP_ARRAY_MIN";
+	case OP_ARRAY_MAX:			return "OP_ARRAY_MAX";
+	case OP_ARRAY_DOT:			return "OP_ARRAY_DOT";
+	case OP_LOAD_LOCAL_BYTE:	return "OP_LOAD_LOCAL_BYTE";
+	case OP_LOAD_LOCAL_WORD:	return "OP_LOAD_LOCAL_WORD";
+	case OP_STORE_LOCAL_BYTE:	return "OP_STORE_LOCAL_BYTE";
+	case OP_STORE_LOCAL_WORD:	return "OP_STORE_LOCAL_WORD";
+	case OP_INC_LOCAL_BYTE:		return "OP_INC_LOCAL_BYTE";
+	case OP_INC_LOCAL_WORD:		return "OP_INC_LOCAL_WORD";
+	case OP_ENTER:				return "OP_ENTER";
+	case OP_CALL:				return "OP_CALL";
+	case OP_TAIL_CALL:			return "OP_TAIL_CALL";
+	case OP_JUMP:				return "OP_JUMP";
+	case OP_JUMP_IF_FALSE:		return "OP_JUMP_IF_FALSE";
+	case OP_JUMP_IF_LESS:		return "OP_JUMP_IF_LESS";
+	case OP_JUMP_IF_LESS_EQUAL:	return "OP_JUMP_IF_LESS_EQUAL";
+	case OP_JUMP_IF_EQUAL:		return "OP_JUMP_IF_EQUAL";
+	case OP_JUMP_IF_NOT_EQUAL:	return "OP_JUMP_IF_NOT_EQUAL";
+	case OP_JUMP_TABLE:			return "OP_JUMP_TABLE";
+	case OP_LOOP:				return "OP_LOOP";
+	case OP_LOAD_GLOBAL:		return "OP_LOAD_GLOBAL";
+	case OP_STORE_GLOBAL:		return "OP_STORE_GLOBAL";
+	case OP_BOX:				return "OP_BOX";
+	case OP_UNBOX:				return "OP_UNBOX";
+	case OP_ADD_DYNAMIC:		return "OP_ADD_DYNAMIC";
+	case OP_ADD_DYNAMIC_I64:	return "OP_ADD_DYNAMIC_I64";
+	case OP_ADD_DYNAMIC_DOUBLE:	return "OP_ADD_DYNAMIC_DOUBLE";
+	case OP_ADD_DYNAMIC_POLY:	return "OP_ADD_DYNAMIC_POLY";
+	case OP_ADD_I64:			return "OP_ADD_I64";
+	case OP_ADD_DOUBLE:			return "OP_ADD_DOUBLE";
+	case OP_SUBTRACT_I64:		return "OP_SUBTRACT_I64";
+	case OP_SUBTRACT_DOUBLE:	return "OP_SUBTRACT_DOUBLE";
+	case OP_MULTIPLY_I64:		return "OP_MULTIPLY_I64";
+	case OP_MULTIPLY_DOUBLE:	return "OP_MULTIPLY_DOUBLE";
+	default:					return "UNKNOWN";
+	}
+}
+
+const char* OperandTypeToString(uint8_t type)
+{
+	switch (type)
+	{
+	case OPERAND_COLTI_BOOL:	return "BOOL";
+	case OPERAND_COLTI_DOUBLE:	return "DOUBLE";
+	case OPERAND_COLTI_FLOAT:	return "FLOAT";
+	case OPERAND_COLTI_I8:		return "INT8";
+	case OPERAND_COLTI_I16:		return "INT16";
+	case OPERAND_COLTI_I32:		return "INT32";
+	case OPERAND_COLTI_I64:		return "INT64";
+	case OPERAND_COLTI_UI8:		return "UINT8";
+	case OPERAND_COLTI_UI16:	return "UINT16";
+	case OPERAND_COLTI_UI32:	return "UINT32";
+	case OPERAND_COLTI_UI64:	return "UINT64";
+	default:					return "UNKNOWN";
+	}
+}
+
+const char* OpCodeCheckedErrorToString(uint8_t code)
+{
+	colti_assert(code == OP_ADD_CHECKED || code == OP_SUBTRACT_CHECKED
+		|| code == OP_MULTIPLY_CHECKED || code == OP_DIVIDE_CHECKED || code == OP_MODULO_CHECKED, "Expected a checked OpCode!");
+	return code == OP_DIVIDE_CHECKED || code == OP_MODULO_CHECKED ? "Integer division by zero or overflow" : "Integer overflow";
+}
+
+bool OpCode_Compare(uint8_t code, QWORD left, QWORD right, OperandType type)
+{
+	//Comparisons with NaN are false, so OP_JUMP_IF_NOT_EQUAL is the negation of OP_JUMP_IF_EQUAL
+	bool is_less = false;
+	bool is_equal = false;
+	switch (type)
+	{
+	break; case OPERAND_COLTI_BOOL:		is_less = left.b < right.b;			is_equal = left.b == right.b;
+	break; case OPERAND_COLTI_I8:		is_less = left.i8 < right.i8;		is_equal = left.i8 == right.i8;
+	break; case OPERAND_COLTI_I16:		is_less = left.i16 < right.i16;		is_equal = left.i16 == right.i16;
+	break; case OPERAND_COLTI_I32:		is_less = left.i32 < right.i32;		is_equal = left.i32 == right.i32;
+	break; case OPERAND_COLTI_I64:		is_less = left.i64 < right.i64;		is_equal = left.i64 == right.i64;
+	break; case OPERAND_COLTI_UI8:		is_less = left.ui8 < right.ui8;		is_equal = left.ui8 == right.ui8;
+	break; case OPERAND_COLTI_UI16:		is_less = left.ui16 < right.ui16;	is_equal = left.ui16 == right.ui16;
+	break; case OPERAND_COLTI_UI32:		is_less = left.ui32 < right.ui32;	is_equal = left.ui32 == right.ui32;
+	break; case OPERAND_COLTI_UI64:		is_less = left.ui64 < right.ui64;	is_equal = left.ui64 == right.ui64;
+	break; case OPERAND_COLTI_FLOAT:	is_less = left.f < right.f;			is_equal = left.f == right.f;
+	break; case OPERAND_COLTI_DOUBLE:	is_less = left.d < right.d;			is_equal = left.d == right.d;
+	break; default: colti_assert(false, "Invalid operand for a compare-and-branch OpCode!");
+	}
+	switch (code)
+	{
+	case OP_JUMP_IF_LESS:		return is_less;
+	case OP_JUMP_IF_LESS_EQUAL:	return is_less || is_equal;
+	case OP_JUMP_IF_EQUAL:		return is_equal;
+	case OP_JUMP_IF_NOT_EQUAL:	return !is_equal;
+	default:					colti_unreachable();
+	}
+}
 
 QWORD OpCode_Negate(QWORD value, OperandType type)
 {
@@ -22,7 +253,7 @@ QWORD OpCode_Negate(QWORD value, OperandType type)
 
 QWORD OpCode_Convert(QWORD value, OperandType from, OperandType to)
 {
-	colti_assert(false, "Still not implemented!");
+	return ConvertGetKernel(from, to)(value);
 }
 
 QWORD OpCode_Sum(QWORD left, QWORD right, OperandType type)
@@ -105,21 +336,353 @@ QWORD OpCode_Divide(QWORD left, QWORD right, OperandType type)
 	return result;
 }
 
-void OpCode_Print(QWORD value, OperandType type)
+QWORD OpCode_Modulo(QWORD left, QWORD right, OperandType type)
 {
+	QWORD result;
 	switch (type)
 	{
-	break; case OPERAND_COLTI_BOOL:		printf("%s", value.b ? "true\n" : "false\n");
-	break; case OPERAND_COLTI_I8:		printf("%"PRId8"\n", value.ui8);
-	break; case OPERAND_COLTI_I16:		printf("%"PRId16"\n", value.ui16);
-	break; case OPERAND_COLTI_I32:		printf("%"PRId32"\n", value.ui32);
-	break; case OPERAND_COLTI_I64:		printf("%"PRId64"\n", value.ui64);
-	break; case OPERAND_COLTI_UI8:		printf("%"PRIu8"\n", value.ui8);
-	break; case OPERAND_COLTI_UI16:		printf("%"PRIu16"\n", value.ui16);
-	break; case OPERAND_COLTI_UI32:		printf("%"PRIu32"\n", value.ui32);
-	break; case OPERAND_COLTI_UI64:		printf("%"PRIu64"\n", value.ui64);
-	break; case OPERAND_COLTI_FLOAT:	printf("%g\n", value.f);
-	break; case OPERAND_COLTI_DOUBLE:	printf("%g\n", value.d);
+	break; case OPERAND_COLTI_I8:		result.i8 = left.i8 % right.i8;
+	break; case OPERAND_COLTI_I16:		result.i16 = left.i16 % right.i16;
+	break; case OPERAND_COLTI_I32:		result.i32 = left.i32 % right.i32;
+	break; case OPERAND_COLTI_I64:		result.i64 = left.i64 % right.i64;
+	break; case OPERAND_COLTI_UI8:		result.ui8 = left.ui8 % right.ui8;
+	break; case OPERAND_COLTI_UI16:		result.ui16 = left.ui16 % right.ui16;
+	break; case OPERAND_COLTI_UI32:		result.ui32 = left.ui32 % right.ui32;
+	break; case OPERAND_COLTI_UI64:		result.ui64 = left.ui64 % right.ui64;
+	break; case OPERAND_COLTI_FLOAT:	result.f = fmodf(left.f, right.f);
+	break; case OPERAND_COLTI_DOUBLE:	result.d = fmod(left.d, right.d);
+	break; default: colti_assert(false, "Invalid operand for OP_MODULO!");
+	}
+	return result;
+}
+
+QWORD OpCode_DivideByConstant(QWORD value, const Divisor* divisor, OperandType type)
+{
+	QWORD result;
+	switch (type)
+	{
+	break; case OPERAND_COLTI_I8:		result.i8 = (int8_t)DivisorDivideSigned(divisor, value.i8);
+	break; case OPERAND_COLTI_I16:		result.i16 = (int16_t)DivisorDivideSigned(divisor, value.i16);
+	break; case OPERAND_COLTI_I32:		result.i32 = (int32_t)DivisorDivideSigned(divisor, value.i32);
+	break; case OPERAND_COLTI_I64:		result.i64 = DivisorDivideSigned(divisor, value.i64);
+	break; case OPERAND_COLTI_UI8:		result.ui8 = (uint8_t)DivisorDivideUnsigned(divisor, value.ui8);
+	break; case OPERAND_COLTI_UI16:		result.ui16 = (uint16_t)DivisorDivideUnsigned(divisor, value.ui16);
+	break; case OPERAND_COLTI_UI32:		result.ui32 = (uint32_t)DivisorDivideUnsigned(divisor, value.ui32);
+	break; case OPERAND_COLTI_UI64:		result.ui64 = DivisorDivideUnsigned(divisor, value.ui64);
+	break; default: colti_assert(false, "Invalid operand for OP_DIVIDE_CONST!");
+	}
+	return result;
+}
+
+QWORD OpCode_ModuloByConstant(QWORD value, const Divisor* divisor, OperandType type)
+{
+	//value - quotient * divisor, computed modulo 2^64 (the remainder always fits in 'type')
+	uint64_t quotient;
+	uint64_t dividend;
+	switch (type)
+	{
+	break; case OPERAND_COLTI_I8:		dividend = (uint64_t)(int64_t)value.i8;
+	break; case OPERAND_COLTI_I16:		dividend = (uint64_t)(int64_t)value.i16;
+	break; case OPERAND_COLTI_I32:		dividend = (uint64_t)(int64_t)value.i32;
+	break; case OPERAND_COLTI_I64:		dividend = value.ui64;
+	break; case OPERAND_COLTI_UI8:		dividend = value.ui8;
+	break; case OPERAND_COLTI_UI16:		dividend = value.ui16;
+	break; case OPERAND_COLTI_UI32:		dividend = value.ui32;
+	break; case OPERAND_COLTI_UI64:		dividend = value.ui64;
+	break; default: colti_assert(false, "Invalid operand for OP_MODULO_CONST!"); dividend = 0;
+	}
+	if (type == OPERAND_COLTI_I8 || type == OPERAND_COLTI_I16 || type == OPERAND_COLTI_I32 || type == OPERAND_COLTI_I64)
+		quotient = (uint64_t)DivisorDivideSigned(divisor, (int64_t)dividend);
+	else
+		quotient = DivisorDivideUnsigned(divisor, dividend);
+
+	QWORD result;
+	result.ui64 = dividend - quotient * divisor->value.ui64;
+	return result;
+}
+
+void OpCode_Print(QWORD value, OperandType type, VMOutput* out)
+{
+	switch (type)
+	{
+	break; case OPERAND_COLTI_BOOL:
+		if (value.b)
+			VMOutputWriteString(out, "true", 4);
+		else
+			VMOutputWriteString(out, "false", 5);
+	//The 8 and 16-bit signed integers were always printed through their unsigned member
+	break; case OPERAND_COLTI_I8:		VMOutputWriteUInt(out, value.ui8);
+	break; case OPERAND_COLTI_I16:		VMOutputWriteUInt(out, value.ui16);
+	break; case OPERAND_COLTI_I32:		VMOutputWriteInt(out, value.i32);
+	break; case OPERAND_COLTI_I64:		VMOutputWriteInt(out, value.i64);
+	break; case OPERAND_COLTI_UI8:		VMOutputWriteUInt(out, value.ui8);
+	break; case OPERAND_COLTI_UI16:		VMOutputWriteUInt(out, value.ui16);
+	break; case OPERAND_COLTI_UI32:		VMOutputWriteUInt(out, value.ui32);
+	break; case OPERAND_COLTI_UI64:		VMOutputWriteUInt(out, value.ui64);
+	break; case OPERAND_COLTI_FLOAT:	VMOutputWriteFloat(out, value.f);
+	break; case OPERAND_COLTI_DOUBLE:	VMOutputWriteDouble(out, value.d);
 	break; default: colti_assert(false, "Invalid operand for OP_PRINT!");
 	}
+	VMOutputEndLine(out);
+}
+
+bool OpCode_SumChecked(QWORD left, QWORD right, OperandType type, QWORD* result)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	switch (type)
+	{
+	case OPERAND_COLTI_I8:		return !__builtin_add_overflow(left.i8, right.i8, &result->i8);
+	case OPERAND_COLTI_I16:		return !__builtin_add_overflow(left.i16, right.i16, &result->i16);
+	case OPERAND_COLTI_I32:		return !__builtin_add_overflow(left.i32, right.i32, &result->i32);
+	case OPERAND_COLTI_I64:		return !__builtin_add_overflow(left.i64, right.i64, &result->i64);
+	case OPERAND_COLTI_UI8:		return !__builtin_add_overflow(left.ui8, right.ui8, &result->ui8);
+	case OPERAND_COLTI_UI16:	return !__builtin_add_overflow(left.ui16, right.ui16, &result->ui16);
+	case OPERAND_COLTI_UI32:	return !__builtin_add_overflow(left.ui32, right.ui32, &result->ui32);
+	case OPERAND_COLTI_UI64:	return !__builtin_add_overflow(left.ui64, right.ui64, &result->ui64);
+	default: colti_assert(false, "Invalid operand for OP_ADD_CHECKED!"); return false;
+	}
+#else
+	return impl_sum_checked_portable(left, right, type, result);
+#endif
+}
+
+bool OpCode_DifferenceChecked(QWORD left, QWORD right, OperandType type, QWORD* result)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	switch (type)
+	{
+	case OPERAND_COLTI_I8:		return !__builtin_sub_overflow(left.i8, right.i8, &result->i8);
+	case OPERAND_COLTI_I16:		return !__builtin_sub_overflow(left.i16, right.i16, &result->i16);
+	case OPERAND_COLTI_I32:		return !__builtin_sub_overflow(left.i32, right.i32, &result->i32);
+	case OPERAND_COLTI_I64:		return !__builtin_sub_overflow(left.i64, right.i64, &result->i64);
+	case OPERAND_COLTI_UI8:		return !__builtin_sub_overflow(left.ui8, right.ui8, &result->ui8);
+	case OPERAND_COLTI_UI16:	return !__builtin_sub_overflow(left.ui16, right.ui16, &result->ui16);
+	case OPERAND_COLTI_UI32:	return !__builtin_sub_overflow(left.ui32, right.ui32, &result->ui32);
+	case OPERAND_COLTI_UI64:	return !__builtin_sub_overflow(left.ui64, right.ui64, &result->ui64);
+	default: colti_assert(false, "Invalid operand for OP_SUBTRACT_CHECKED!"); return false;
+	}
+#else
+	return impl_difference_checked_portable(left, right, type, result);
+#endif
+}
+
+bool OpCode_MultiplyChecked(QWORD left, QWORD right, OperandType type, QWORD* result)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	switch (type)
+	{
+	case OPERAND_COLTI_I8:		return !__builtin_mul_overflow(left.i8, right.i8, &result->i8);
+	case OPERAND_COLTI_I16:		return !__builtin_mul_overflow(left.i16, right.i16, &result->i16);
+	case OPERAND_COLTI_I32:		return !__builtin_mul_overflow(left.i32, right.i32, &result->i32);
+	case OPERAND_COLTI_I64:		return !__builtin_mul_overflow(left.i64, right.i64, &result->i64);
+	case OPERAND_COLTI_UI8:		return !__builtin_mul_overflow(left.ui8, right.ui8, &result->ui8);
+	case OPERAND_COLTI_UI16:	return !__builtin_mul_overflow(left.ui16, right.ui16, &result->ui16);
+	case OPERAND_COLTI_UI32:	return !__builtin_mul_overflow(left.ui32, right.ui32, &result->ui32);
+	case OPERAND_COLTI_UI64:	return !__builtin_mul_overflow(left.ui64, right.ui64, &result->ui64);
+	default: colti_assert(false, "Invalid operand for OP_MULTIPLY_CHECKED!"); return false;
+	}
+#else
+	return impl_multiply_checked_portable(left, right, type, result);
+#endif
+}
+
+bool OpCode_DivideChecked(QWORD left, QWORD right, OperandType type, QWORD* result)
+{
+	switch (type)
+	{
+	break; case OPERAND_COLTI_I8:
+		if (right.i8 == 0 || (left.i8 == INT8_MIN && right.i8 == -1))
+			return false;
+	break; case OPERAND_COLTI_I16:
+		if (right.i16 == 0 || (left.i16 == INT16_MIN && right.i16 == -1))
+			return false;
+	break; case OPERAND_COLTI_I32:
+		if (right.i32 == 0 || (left.i32 == INT32_MIN && right.i32 == -1))
+			return false;
+	break; case OPERAND_COLTI_I64:
+		if (right.i64 == 0 || (left.i64 == INT64_MIN && right.i64 == -1))
+			return false;
+	break; case OPERAND_COLTI_UI8:
+		if (right.ui8 == 0)
+			return false;
+	break; case OPERAND_COLTI_UI16:
+		if (right.ui16 == 0)
+			return false;
+	break; case OPERAND_COLTI_UI32:
+		if (right.ui32 == 0)
+			return false;
+	break; case OPERAND_COLTI_UI64:
+		if (right.ui64 == 0)
+			return false;
+	break; default: colti_assert(false, "Invalid operand for OP_DIVIDE_CHECKED!");
+	}
+	*result = OpCode_Divide(left, right, type);
+	return true;
+}
+
+bool OpCode_ModuloChecked(QWORD left, QWORD right, OperandType type, QWORD* result)
+{
+	switch (type)
+	{
+	break; case OPERAND_COLTI_I8:
+		if (right.i8 == 0 || (left.i8 == INT8_MIN && right.i8 == -1))
+			return false;
+	break; case OPERAND_COLTI_I16:
+		if (right.i16 == 0 || (left.i16 == INT16_MIN && right.i16 == -1))
+			return false;
+	break; case OPERAND_COLTI_I32:
+		if (right.i32 == 0 || (left.i32 == INT32_MIN && right.i32 == -1))
+			return false;
+	break; case OPERAND_COLTI_I64:
+		if (right.i64 == 0 || (left.i64 == INT64_MIN && right.i64 == -1))
+			return false;
+	break; case OPERAND_COLTI_UI8:
+		if (right.ui8 == 0)
+			return false;
+	break; case OPERAND_COLTI_UI16:
+		if (right.ui16 == 0)
+			return false;
+	break; case OPERAND_COLTI_UI32:
+		if (right.ui32 == 0)
+			return false;
+	break; case OPERAND_COLTI_UI64:
+		if (right.ui64 == 0)
+			return false;
+	break; default: colti_assert(false, "Invalid operand for OP_MODULO_CHECKED!");
+	}
+	*result = OpCode_Modulo(left, right, type);
+	return true;
+}
+
+QWORD OpCode_SumWrapping(QWORD left, QWORD right, OperandType type)
+{
+	//Signed integers are computed through their unsigned member, which has the same bits (the other bits are 0)
+	QWORD result = { .ui64 = 0 };
+	switch (type)
+	{
+	break; case OPERAND_COLTI_I8: case OPERAND_COLTI_UI8:		result.ui8 = left.ui8 + right.ui8;
+	break; case OPERAND_COLTI_I16: case OPERAND_COLTI_UI16:		result.ui16 = left.ui16 + right.ui16;
+	break; case OPERAND_COLTI_I32: case OPERAND_COLTI_UI32:		result.ui32 = left.ui32 + right.ui32;
+	break; case OPERAND_COLTI_I64: case OPERAND_COLTI_UI64:		result.ui64 = left.ui64 + right.ui64;
+	break; default: colti_assert(false, "Invalid operand for OP_ADD_WRAPPING!");
+	}
+	return result;
+}
+
+QWORD OpCode_DifferenceWrapping(QWORD left, QWORD right, OperandType type)
+{
+	QWORD result = { .ui64 = 0 };
+	switch (type)
+	{
+	break; case OPERAND_COLTI_I8: case OPERAND_COLTI_UI8:		result.ui8 = left.ui8 - right.ui8;
+	break; case OPERAND_COLTI_I16: case OPERAND_COLTI_UI16:		result.ui16 = left.ui16 - right.ui16;
+	break; case OPERAND_COLTI_I32: case OPERAND_COLTI_UI32:		result.ui32 = left.ui32 - right.ui32;
+	break; case OPERAND_COLTI_I64: case OPERAND_COLTI_UI64:		result.ui64 = left.ui64 - right.ui64;
+	break; default: colti_assert(false, "Invalid operand for OP_SUBTRACT_WRAPPING!");
+	}
+	return result;
+}
+
+QWORD OpCode_MultiplyWrapping(QWORD left, QWORD right, OperandType type)
+{
+	QWORD result = { .ui64 = 0 };
+	switch (type)
+	{
+	break; case OPERAND_COLTI_I8: case OPERAND_COLTI_UI8:		result.ui8 = (uint8_t)(left.ui8 * right.ui8);
+	//Promoted to (signed) int, whose multiplication could overflow
+	break; case OPERAND_COLTI_I16: case OPERAND_COLTI_UI16:		result.ui16 = (uint16_t)((uint32_t)left.ui16 * right.ui16);
+	break; case OPERAND_COLTI_I32: case OPERAND_COLTI_UI32:		result.ui32 = left.ui32 * right.ui32;
+	break; case OPERAND_COLTI_I64: case OPERAND_COLTI_UI64:		result.ui64 = left.ui64 * right.ui64;
+	break; default: colti_assert(false, "Invalid operand for OP_MULTIPLY_WRAPPING!");
+	}
+	return result;
+}
+
+bool OpCode_SumDynamic(QWORD left, QWORD left_tag, QWORD right, QWORD right_tag, QWORD* result)
+{
+	//The tags can be any QWORD, as dynamic values are built by the code
+	if (left_tag.ui64 != right_tag.ui64 || left_tag.ui64 >= OPERAND_TYPE_COUNT || left_tag.ui64 == OPERAND_COLTI_BOOL)
+		return false;
+	*result = OpCode_Sum(left, right, (OperandType)left_tag.ui64);
+	return true;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+bool impl_signed_add_overflows(int64_t left, int64_t right, int64_t min, int64_t max)
+{
+	return right > 0 ? left > max - right : left < min - right;
+}
+
+bool impl_signed_sub_overflows(int64_t left, int64_t right, int64_t min, int64_t max)
+{
+	return right > 0 ? left < min + right : left > max + right;
+}
+
+bool impl_signed_mul_overflows(int64_t left, int64_t right, int64_t min, int64_t max)
+{
+	if (left == 0 || right == 0)
+		return false;
+	if (left > 0)
+		return right > 0 ? left > max / right : right < min / left;
+	return right > 0 ? left < min / right : left < max / right;
+}
+
+bool impl_unsigned_mul_overflows(uint64_t left, uint64_t right, uint64_t max)
+{
+	return right != 0 && left > max / right;
+}
+
+bool impl_sum_checked_portable(QWORD left, QWORD right, OperandType type, QWORD* result)
+{
+	*result = OpCode_SumWrapping(left, right, type);
+	switch (type)
+	{
+	case OPERAND_COLTI_I8:		return !impl_signed_add_overflows(left.i8, right.i8, INT8_MIN, INT8_MAX);
+	case OPERAND_COLTI_I16:		return !impl_signed_add_overflows(left.i16, right.i16, INT16_MIN, INT16_MAX);
+	case OPERAND_COLTI_I32:		return !impl_signed_add_overflows(left.i32, right.i32, INT32_MIN, INT32_MAX);
+	case OPERAND_COLTI_I64:		return !impl_signed_add_overflows(left.i64, right.i64, INT64_MIN, INT64_MAX);
+	//The wrapped sum is smaller than the operands on overflow
+	case OPERAND_COLTI_UI8:		return result->ui8 >= left.ui8;
+	case OPERAND_COLTI_UI16:	return result->ui16 >= left.ui16;
+	case OPERAND_COLTI_UI32:	return result->ui32 >= left.ui32;
+	case OPERAND_COLTI_UI64:	return result->ui64 >= left.ui64;
+	default: colti_assert(false, "Invalid operand for OP_ADD_CHECKED!"); return false;
+	}
+}
+
+bool impl_difference_checked_portable(QWORD left, QWORD right, OperandType type, QWORD* result)
+{
+	*result = OpCode_DifferenceWrapping(left, right, type);
+	switch (type)
+	{
+	case OPERAND_COLTI_I8:		return !impl_signed_sub_overflows(left.i8, right.i8, INT8_MIN, INT8_MAX);
+	case OPERAND_COLTI_I16:		return !impl_signed_sub_overflows(left.i16, right.i16, INT16_MIN, INT16_MAX);
+	case OPERAND_COLTI_I32:		return !impl_signed_sub_overflows(left.i32, right.i32, INT32_MIN, INT32_MAX);
+	case OPERAND_COLTI_I64:		return !impl_signed_sub_overflows(left.i64, right.i64, INT64_MIN, INT64_MAX);
+	case OPERAND_COLTI_UI8:		return left.ui8 >= right.ui8;
+	case OPERAND_COLTI_UI16:	return left.ui16 >= right.ui16;
+	case OPERAND_COLTI_UI32:	return left.ui32 >= right.ui32;
+	case OPERAND_COLTI_UI64:	return left.ui64 >= right.ui64;
+	default: colti_assert(false, "Invalid operand for OP_SUBTRACT_CHECKED!"); return false;
+	}
+}
+
+bool impl_multiply_checked_portable(QWORD left, QWORD right, OperandType type, QWORD* result)
+{
+	*result = OpCode_MultiplyWrapping(left, right, type);
+	switch (type)
+	{
+	case OPERAND_COLTI_I8:		return !impl_signed_mul_overflows(left.i8, right.i8, INT8_MIN, INT8_MAX);
+	case OPERAND_COLTI_I16:		return !impl_signed_mul_overflows(left.i16, right.i16, INT16_MIN, INT16_MAX);
+	case OPERAND_COLTI_I32:		return !impl_signed_mul_overflows(left.i32, right.i32, INT32_MIN, INT32_MAX);
+	case OPERAND_COLTI_I64:		return !impl_signed_mul_overflows(left.i64, right.i64, INT64_MIN, INT64_MAX);
+	case OPERAND_COLTI_UI8:		return !impl_unsigned_mul_overflows(left.ui8, right.ui8, UINT8_MAX);
+	case OPERAND_COLTI_UI16:	return !impl_unsigned_mul_overflows(left.ui16, right.ui16, UINT16_MAX);
+	case OPERAND_COLTI_UI32:	return !impl_unsigned_mul_overflows(left.ui32, right.ui32, UINT32_MAX);
+	case OPERAND_COLTI_UI64:	return !impl_unsigned_mul_overflows(left.ui64, right.ui64, UINT64_MAX);
+	default: colti_assert(false, "Invalid operand for OP_MULTIPLY_CHECKED!"); return false;
+	}
 }
@@ -14,6 +14,8 @@
 #define HG_COLTI_BYTE_CODE
 
 #include "common.h"
+#include "vm/vm_output.h"
+#include "divisor.h"
 
 /// @brief Represents an instruction to be executed by the VM
 typedef enum
@@ -28,6 +30,12 @@ typedef enum
 	/// @brief Specifies that an 8 bytes (aligned) QWORD is written in the following byte-codes
 	OP_IMMEDIATE_QWORD,
 
+	//CONSTANT POOL LOADING
+	/// @brief Specifies that the next byte is the index of the constant (in the Chunk's constant pool) to push
+	OP_LOAD_CONST_BYTE,
+	/// @brief Specifies that a 2 bytes (aligned) WORD, which is the index of the constant to push, is written in the following byte-codes
+	OP_LOAD_CONST_WORD,
+
 	/// @brief Specifies that the next byte is an operand to which to cast a QWORD before negating its sign
 	OP_NEGATE,
 
@@ -40,10 +48,13 @@ typedef enum
 	OP_SUBTRACT,
 	/// @brief Specifies that the next byte is an operand to which to cast 2 QWORD before doing their product
 	OP_MULTIPLY,
-	/// @brief Specifies that the next byte is an operand to which to cast 2 QWORD before doing their division
+	/// @brief Specifies that the next byte is an operand to which to cast 2 QWORD before doing their division.
+	/// An integer division by zero (or of the minimum value of a signed type by -1) traps: see OP_DIVIDE_CHECKED.
 	OP_DIVIDE,
 
-	//DON'T KNOW
+	/// @brief Specifies that the next byte is an operand to which to cast 2 QWORD before computing the remainder of their division
+	/// (using 'fmod' for FLOAT and DOUBLE). As for OP_DIVIDE, an integer remainder by zero (or of the minimum value of
+	/// a signed type by -1) traps: see OP_MODULO_CHECKED.
 	OP_MODULO,
 
 	/// @brief Specifies that the next byte is an operand to which to cast a QWORD before printing it (for debug purposes)
@@ -51,6 +62,179 @@ typedef enum
 
 	//MISCALLENEOUS
 	OP_RETURN,
+
+	//SPECIALIZED CONVERSIONS (see conversion.h), which are not followed by any operand
+	/// @brief Converts an INT32 to an INT64
+	OP_CVT_I32_I64,
+	/// @brief Converts an INT64 to an INT32
+	OP_CVT_I64_I32,
+	/// @brief Converts an INT32 to a DOUBLE
+	OP_CVT_I32_DOUBLE,
+	/// @brief Converts a DOUBLE to an INT32
+	OP_CVT_DOUBLE_I32,
+	/// @brief Converts an INT64 to a DOUBLE
+	OP_CVT_I64_DOUBLE,
+	/// @brief Converts a DOUBLE to an INT64
+	OP_CVT_DOUBLE_I64,
+	/// @brief Converts a FLOAT to a DOUBLE
+	OP_CVT_FLOAT_DOUBLE,
+	/// @brief Converts a DOUBLE to a FLOAT
+	OP_CVT_DOUBLE_FLOAT,
+
+	//CHECKED ARITHMETIC (integers only), which stops the VM with INTERPRET_RUNTIME_ERROR rather than overflowing
+	/// @brief Specifies that the next byte is an integer operand to which to cast 2 QWORD before doing their checked sum
+	OP_ADD_CHECKED,
+	/// @brief Specifies that the next byte is an integer operand to which to cast 2 QWORD before doing their checked difference
+	OP_SUBTRACT_CHECKED,
+	/// @brief Specifies that the next byte is an integer operand to which to cast 2 QWORD before doing their checked product
+	OP_MULTIPLY_CHECKED,
+	/// @brief Specifies that the next byte is an integer operand to which to cast 2 QWORD before doing their checked division
+	/// (which fails on a division by zero, or of the minimum value of a signed type by -1)
+	OP_DIVIDE_CHECKED,
+	/// @brief Specifies that the next byte is an integer operand to which to cast 2 QWORD before computing the remainder
+	/// of their checked division (which fails as OP_DIVIDE_CHECKED)
+	OP_MODULO_CHECKED,
+
+	//WRAPPING ARITHMETIC (integers only), whose results are computed modulo 2^N (even for signed types)
+	/// @brief Specifies that the next byte is an integer operand to which to cast 2 QWORD before doing their wrapping sum
+	OP_ADD_WRAPPING,
+	/// @brief Specifies that the next byte is an integer operand to which to cast 2 QWORD before doing their wrapping difference
+	OP_SUBTRACT_WRAPPING,
+	/// @brief Specifies that the next byte is an integer operand to which to cast 2 QWORD before doing their wrapping product
+	OP_MULTIPLY_WRAPPING,
+
+	//DIVISION BY A CONSTANT (integers only), through the reciprocal of the constant precomputed in the Divisor table of the Chunk
+	/// @brief Specifies that the next byte is an integer operand to which to cast a QWORD, followed by the aligned WORD
+	/// index of the (non-zero) constant by which to divide it
+	OP_DIVIDE_CONST,
+	/// @brief Specifies that the next byte is an integer operand to which to cast a QWORD, followed by the aligned WORD
+	/// index of the (non-zero) constant by which to compute the remainder of its division
+	OP_MODULO_CONST,
+
+	//ARRAYS (see array.h), whose OperandType is the type of the values of the arrays
+	/// @brief Specifies that the next byte is the operand of the values of a new array: pops the value (of that type)
+	/// then the length (an UINT64), and pushes an array of that length whose values are all that value
+	OP_ARRAY_NEW,
+	/// @brief Specifies that the next byte is the operand of the values of an array: pushes its length (an UINT64),
+	/// leaving the array below it
+	OP_ARRAY_LENGTH,
+	/// @brief Specifies that the next byte is the operand of the values of an array: pops an index (an UINT64),
+	/// and pushes the value of the array (which is left below it) at that index
+	OP_ARRAY_GET,
+	/// @brief Specifies that the next byte is the operand of the values of an array: pops a value then an index
+	/// (an UINT64), and writes the value at that index of the array (which is left on the stack)
+	OP_ARRAY_SET,
+	/// @brief Specifies that the next byte is the operand of the values of 2 arrays, whose elementwise sum is pushed as a new array
+	OP_ARRAY_ADD,
+	/// @brief Specifies that the next byte is the operand of the values of 2 arrays, whose elementwise difference is pushed as a new array
+	OP_ARRAY_SUBTRACT,
+	/// @brief Specifies that the next byte is the operand of the values of 2 arrays, whose elementwise product is pushed as a new array
+	OP_ARRAY_MULTIPLY,
+	/// @brief Specifies that the next byte is the operand of the values of 2 arrays, whose elementwise division is pushed as a new array
+	/// (which fails on an integer division by zero or overflow)
+	OP_ARRAY_DIVIDE,
+	/// @brief Specifies that the next byte is the signed operand of the values of an array, whose negation is pushed as a new array
+	OP_ARRAY_NEGATE,
+	/// @brief Specifies that the next 2 bytes are the operand of the values of an array, and the type to which
+	/// to convert them, the converted values being pushed as a new array
+	OP_ARRAY_CONVERT,
+	/// @brief Specifies that the next byte is the operand of the values of an array, which is replaced by the sum of its values
+	OP_ARRAY_SUM,
+	/// @brief Specifies that the next byte is the operand of the values of a non-empty array, which is replaced by its minimum
+	OP_ARRAY_MIN,
+	/// @brief Specifies that the next byte is the operand of the values of a non-empty array, which is replaced by its maximum
+	OP_ARRAY_MAX,
+	/// @brief Specifies that the next byte is the operand of the values of 2 arrays of the same length, which are replaced
+	/// by their dot product
+	OP_ARRAY_DOT,
+
+	//LOCAL VARIABLES, stored in the slots of the frame of the code (see ChunkWriteLocal), whose indices are resolved when compiling
+	/// @brief Specifies that the next byte is the index of the local slot whose value to push
+	OP_LOAD_LOCAL_BYTE,
+	/// @brief Specifies that a 2 bytes (aligned) WORD, which is the index of the local slot whose value to push, is written in the following byte-codes
+	OP_LOAD_LOCAL_WORD,
+	/// @brief Specifies that the next byte is the index of the local slot to which to write the value popped
+	OP_STORE_LOCAL_BYTE,
+	/// @brief Specifies that a 2 bytes (aligned) WORD, which is the index of the local slot to which to write the value popped, is written in the following byte-codes
+	OP_STORE_LOCAL_WORD,
+	/// @brief Specifies that the next byte is an operand to which to cast a local and the value popped, followed by the
+	/// byte index of the local slot to which to add the value ('local += value', as OP_LOAD_LOCAL, OP_ADD and OP_STORE_LOCAL)
+	OP_INC_LOCAL_BYTE,
+	/// @brief Specifies that the next byte is an operand to which to cast a local and the value popped, followed by the
+	/// aligned WORD index of the local slot to which to add the value
+	OP_INC_LOCAL_WORD,
+
+	//FUNCTIONS, whose code follows the OP_RETURN of the code preceding them, and starts with an OP_ENTER (see ChunkWriteEnter)
+	/// @brief Specifies that the next 2 bytes are the number of arguments of the function starting with this instruction, then the
+	/// number of local slots of its frame (its arguments being its first slots). The other slots of the frame are zero-initialized.
+	OP_ENTER,
+	/// @brief Specifies that a 4 bytes (aligned) DWORD, which is the offset of the OP_ENTER of the function to call, is written in the following byte-codes.
+	/// The arguments are the values on the top of the stack, which are replaced by the result of the function (the top of its stack when it returns).
+	OP_CALL,
+	/// @brief Same as OP_CALL, but the function called replaces the function calling it, whose frame is reused: the function called
+	/// returns to the caller of the function calling it
+	OP_TAIL_CALL,
+
+	//CONTROL FLOW, whose (signed) jump offsets are relative to the offset of the jump instruction (see ChunkWriteJump).
+	//Only OP_LOOP jumps backward, so that every loop counts its iterations.
+	/// @brief Specifies that a 4 bytes (aligned) DWORD, which is the offset of the instruction to which to jump, is written in the following byte-codes
+	OP_JUMP,
+	/// @brief Same as OP_JUMP, but only jumps if the BOOL popped is false
+	OP_JUMP_IF_FALSE,
+	/// @brief Specifies that the next byte is an operand to which to cast 2 QWORD, followed by a 4 bytes (aligned) DWORD
+	/// jump offset: both values are popped, and the jump is taken if the left operand (the top of the stack) is less than the right one
+	OP_JUMP_IF_LESS,
+	/// @brief Same as OP_JUMP_IF_LESS, but jumps if the left operand is less than or equal to the right one
+	OP_JUMP_IF_LESS_EQUAL,
+	/// @brief Same as OP_JUMP_IF_LESS, but jumps if the operands are equal
+	OP_JUMP_IF_EQUAL,
+	/// @brief Same as OP_JUMP_IF_LESS, but jumps if the operands are not equal (which is always the case if one of them is NaN)
+	OP_JUMP_IF_NOT_EQUAL,
+	/// @brief Specifies that a 4 bytes (aligned) DWORD case count N is written in the following byte-codes, followed by
+	/// N + 1 DWORD jump offsets: the UINT64 popped is the index of the case to which to jump, the last offset being
+	/// the default case (taken if the index is not less than N)
+	OP_JUMP_TABLE,
+	/// @brief Specifies that a 4 bytes (aligned) DWORD, which is the index of the hotness counter of the loop (see Chunk.loop_counters),
+	/// is written in the following byte-codes, followed by the (negative or zero) DWORD jump offset to the beginning of the loop.
+	/// The counter is incremented each time the loop jumps back.
+	OP_LOOP,
+
+	//GLOBAL VARIABLES, whose names are resolved to the indices of their slots when writing the code (see ChunkWriteGlobal)
+	/// @brief Specifies that a 2 bytes (aligned) WORD, which is the index of the global slot whose value to push, is written in the following byte-codes
+	OP_LOAD_GLOBAL,
+	/// @brief Specifies that a 2 bytes (aligned) WORD, which is the index of the global slot to which to write the value popped, is written in the following byte-codes
+	OP_STORE_GLOBAL,
+
+	//DYNAMICALLY TYPED VALUES, which are a value followed (on the stack) by the QWORD tag holding its OperandType (see inline_cache.h)
+	/// @brief Specifies that the next byte is the OperandType of the value on the top of the stack, which is pushed as its tag
+	OP_BOX,
+	/// @brief Specifies that the next byte is an OperandType, which the tag popped must be (else it is a runtime error)
+	OP_UNBOX,
+	/// @brief Specifies that a 4 bytes (aligned) DWORD, which is the index of the InlineCache of the instruction (see Chunk.inline_caches),
+	/// is written in the following byte-codes. Pops 2 dynamic values, whose tags must be the same non-BOOL type, and pushes their
+	/// (dynamic) sum. Records the type in the cache, and rewrites itself to the form specialized for the types it observed.
+	OP_ADD_DYNAMIC,
+	/// @brief Same as OP_ADD_DYNAMIC, specialized for INT64 operands (deoptimized if the tags are not INT64)
+	OP_ADD_DYNAMIC_I64,
+	/// @brief Same as OP_ADD_DYNAMIC, specialized for DOUBLE operands (deoptimized if the tags are not DOUBLE)
+	OP_ADD_DYNAMIC_DOUBLE,
+	/// @brief Same as OP_ADD_DYNAMIC, specialized for the types of its InlineCache (deoptimized if the tags are not one of them)
+	OP_ADD_DYNAMIC_POLY,
+
+	//QUICKENED OPCODES, to which the VM rewrites a typed instruction the first time it runs (see quickening.h).
+	//Their OperandType is implied by the OpCode: they are followed by it (as padding) in the aligned encoding, and by nothing in the compact encoding.
+	/// @brief Same as OP_ADD, on INT64 operands
+	OP_ADD_I64,
+	/// @brief Same as OP_ADD, on DOUBLE operands
+	OP_ADD_DOUBLE,
+	/// @brief Same as OP_SUBTRACT, on INT64 operands
+	OP_SUBTRACT_I64,
+	/// @brief Same as OP_SUBTRACT, on DOUBLE operands
+	OP_SUBTRACT_DOUBLE,
+	/// @brief Same as OP_MULTIPLY, on INT64 operands
+	OP_MULTIPLY_I64,
+	/// @brief Same as OP_MULTIPLY, on DOUBLE operands
+	OP_MULTIPLY_DOUBLE,
 } OpCode;
 
 
@@ -83,17 +267,93 @@ typedef enum
 	COLTI_UINT64	= OPERAND_COLTI_UI64,
 } OperandType;
 
+/// @brief The number of OperandType
+#define OPERAND_TYPE_COUNT 11
+
+/// @brief Describes the operands that follow an OpCode
+typedef enum
+{
+	/// @brief The byte is not a valid OpCode
+	LAYOUT_INVALID,
+	/// @brief The OpCode is not followed by any operand
+	LAYOUT_NONE,
+	/// @brief The OpCode is followed by an OperandType
+	LAYOUT_TYPE,
+	/// @brief The OpCode is followed by 2 OperandType
+	LAYOUT_TWO_TYPES,
+	/// @brief The OpCode is followed by a BYTE
+	LAYOUT_BYTE,
+	/// @brief The OpCode is followed by 2 BYTEs
+	LAYOUT_TWO_BYTES,
+	/// @brief The OpCode is followed by an aligned WORD
+	LAYOUT_WORD,
+	/// @brief The OpCode is followed by an aligned DWORD
+	LAYOUT_DWORD,
+	/// @brief The OpCode is followed by an aligned QWORD
+	LAYOUT_QWORD,
+	/// @brief The OpCode is followed by an OperandType, then by an aligned WORD
+	LAYOUT_TYPE_WORD,
+	/// @brief The OpCode is followed by an OperandType, then by a BYTE
+	LAYOUT_TYPE_BYTE,
+	/// @brief The OpCode is followed by an aligned DWORD, which is the offset of an instruction of the code.
+	/// Targets are rewritten when the code is re-encoded (see impl_chunk_relocate_targets).
+	LAYOUT_TARGET,
+	/// @brief The OpCode is followed by an aligned DWORD, which is a jump offset (relocated as LAYOUT_TARGET)
+	LAYOUT_JUMP,
+	/// @brief The OpCode is followed by an OperandType, then by an aligned DWORD jump offset
+	LAYOUT_TYPE_JUMP,
+	/// @brief The OpCode is followed by an aligned DWORD counter index, then by a DWORD jump offset
+	LAYOUT_LOOP,
+	/// @brief The OpCode is followed by an aligned DWORD case count N, then by N + 1 DWORD jump offsets
+	LAYOUT_JUMP_TABLE,
+	/// @brief The OpCode implies its OperandType (see QuickenedGetOpCode), which follows it in the aligned encoding
+	/// (so that it takes as many bytes as the OpCode it quickens), but not in the compact encoding
+	LAYOUT_QUICKENED,
+} OpCodeLayout;
+
+/**********************************
+BYTE-CODE INFORMATIONS
+**********************************/
+
+/// @brief Returns the layout of the operands following an OpCode
+/// @param code The byte representing the OpCode
+/// @return The layout, or LAYOUT_INVALID if 'code' is not an OpCode
+OpCodeLayout OpCodeGetLayout(uint8_t code);
+
+/// @brief Returns the name of an OpCode
+/// @param code The byte representing the OpCode
+/// @return The name of the OpCode, or "UNKNOWN" if 'code' is not an OpCode
+const char* OpCodeToString(uint8_t code);
+
+/// @brief Returns the name of an OperandType
+/// @param type The byte representing the OperandType
+/// @return The name of the type, or "UNKNOWN" if 'type' is not an OperandType
+const char* OperandTypeToString(uint8_t type);
+
+/// @brief Returns the description of the runtime error raised by a checked OpCode (OP_*_CHECKED)
+/// @param code The byte representing the OpCode
+/// @return The description of the error (without any punctuation)
+const char* OpCodeCheckedErrorToString(uint8_t code);
+
 /**********************************
 BYTE-CODE RUNNING
 **********************************/
 
+/// @brief Casts 2 QWORD to 'type', and checks if the condition of a compare-and-branch OpCode holds
+/// @param code OP_JUMP_IF_LESS, OP_JUMP_IF_LESS_EQUAL, OP_JUMP_IF_EQUAL or OP_JUMP_IF_NOT_EQUAL
+/// @param left The left hand side (the top of the stack)
+/// @param right The right hand side
+/// @param type The type of the QWORDs
+/// @return True if the jump is taken
+bool OpCode_Compare(uint8_t code, QWORD left, QWORD right, OperandType type);
+
 /// @brief Casts 'value' to 'type', negates the result and return it
 /// @param value The QWORD on which to operate
 /// @param type The type to which to cast the QWORD
 /// @return The modified QWORD
 QWORD OpCode_Negate(QWORD value, OperandType type);
 
-/// @brief Casts 'value' from 'from' to 'to'
+/// @brief Converts 'value' from 'from' to 'to' (see conversion.h)
 /// @param value The QWORD on which to operate
 /// @param from The type of the QWORD
 /// @param to The type to which to cast the QWORD
@@ -128,9 +388,169 @@ QWORD OpCode_Multiply(QWORD left, QWORD right, OperandType type);
 /// @return The division of the QWORDs
 QWORD OpCode_Divide(QWORD left, QWORD right, OperandType type);
 
-/// @brief Casts 'value' to 'type' then prints its value, for DEBUG purposes
+/// @brief Casts 2 QWORD and return the remainder of their division
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The type of the QWORDs
+/// @return The remainder, which has the sign of 'left' (as 'fmod' for FLOAT and DOUBLE)
+QWORD OpCode_Modulo(QWORD left, QWORD right, OperandType type);
+
+/// @brief Casts 'value' to an integer type and divides it by a precomputed Divisor.
+/// The dividend is extended to 64 bits, and the quotient truncated to 'type' (so that the
+/// minimum value of a signed type divided by -1 wraps to itself).
+/// @param value The dividend
+/// @param divisor The divisor, interpreted as signed if 'type' is
+/// @param type The integer type of the QWORD
+/// @return The quotient
+QWORD OpCode_DivideByConstant(QWORD value, const Divisor* divisor, OperandType type);
+
+/// @brief Casts 'value' to an integer type and computes the remainder of its division by a precomputed Divisor
+/// @param value The dividend
+/// @param divisor The divisor, interpreted as signed if 'type' is
+/// @param type The integer type of the QWORD
+/// @return The remainder, which has the sign of 'value'
+QWORD OpCode_ModuloByConstant(QWORD value, const Divisor* divisor, OperandType type);
+
+/// @brief Casts 'value' to 'type' then prints its value followed by a newline, for DEBUG purposes
 /// @param value The QWORD to print
 /// @param type The type of the QWORD
-void OpCode_Print(QWORD value, OperandType type);
+/// @param out The output to which to print
+void OpCode_Print(QWORD value, OperandType type, VMOutput* out);
+
+/// @brief Casts 2 QWORD to an integer type and computes their sum, checking for overflow
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @param result Pointer to where to write the sum (which is wrapped on overflow)
+/// @return False if the sum overflows
+bool OpCode_SumChecked(QWORD left, QWORD right, OperandType type, QWORD* result);
+
+/// @brief Casts 2 QWORD to an integer type and computes their difference, checking for overflow
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @param result Pointer to where to write the difference (which is wrapped on overflow)
+/// @return False if the difference overflows
+bool OpCode_DifferenceChecked(QWORD left, QWORD right, OperandType type, QWORD* result);
+
+/// @brief Casts 2 QWORD to an integer type and computes their multiplication, checking for overflow
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @param result Pointer to where to write the multiplication (which is wrapped on overflow)
+/// @return False if the multiplication overflows
+bool OpCode_MultiplyChecked(QWORD left, QWORD right, OperandType type, QWORD* result);
+
+/// @brief Casts 2 QWORD to an integer type and computes their division, checking for errors
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @param result Pointer to where to write the division (which is not modified on error)
+/// @return False if 'right' is zero, or if the division overflows (minimum value divided by -1)
+bool OpCode_DivideChecked(QWORD left, QWORD right, OperandType type, QWORD* result);
+
+/// @brief Casts 2 QWORD to an integer type and computes the remainder of their division, checking for errors
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @param result Pointer to where to write the remainder (which is not modified on error)
+/// @return False if 'right' is zero, or if the division overflows (minimum value divided by -1)
+bool OpCode_ModuloChecked(QWORD left, QWORD right, OperandType type, QWORD* result);
+
+/// @brief Casts 2 QWORD to an integer type and return their sum modulo 2^N
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @return The wrapped sum of the QWORDs
+QWORD OpCode_SumWrapping(QWORD left, QWORD right, OperandType type);
+
+/// @brief Casts 2 QWORD to an integer type and return their difference modulo 2^N
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @return The wrapped difference of the QWORDs
+QWORD OpCode_DifferenceWrapping(QWORD left, QWORD right, OperandType type);
+
+/// @brief Casts 2 QWORD to an integer type and return their multiplication modulo 2^N
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @return The wrapped multiplication of the QWORDs
+QWORD OpCode_MultiplyWrapping(QWORD left, QWORD right, OperandType type);
+
+/// @brief Computes the sum of 2 dynamic values (see OP_ADD_DYNAMIC), whose tags must be the same OperandType (other than BOOL)
+/// @param left The value of the left hand side
+/// @param left_tag The tag of the left hand side
+/// @param right The value of the right hand side
+/// @param right_tag The tag of the right hand side
+/// @param result Pointer to where to write the value of the sum, whose tag is the tag of the operands (not modified on error)
+/// @return False if the tags are different, or not a valid type for an addition
+bool OpCode_SumDynamic(QWORD left, QWORD left_tag, QWORD right, QWORD right_tag, QWORD* result);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Checks if the sum of 2 signed integers overflows the range [min, max], which
+/// contains both integers. Used on compilers without overflow builtins.
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param min The minimum value of the type of the integers
+/// @param max The maximum value of the type of the integers
+/// @return True if the sum overflows
+bool impl_signed_add_overflows(int64_t left, int64_t right, int64_t min, int64_t max);
+
+/// @brief Checks if the difference of 2 signed integers overflows the range [min, max], which
+/// contains both integers. Used on compilers without overflow builtins.
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param min The minimum value of the type of the integers
+/// @param max The maximum value of the type of the integers
+/// @return True if the difference overflows
+bool impl_signed_sub_overflows(int64_t left, int64_t right, int64_t min, int64_t max);
+
+/// @brief Checks if the multiplication of 2 signed integers overflows the range [min, max], which
+/// contains both integers. Used on compilers without overflow builtins.
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param min The minimum value of the type of the integers
+/// @param max The maximum value of the type of the integers
+/// @return True if the multiplication overflows
+bool impl_signed_mul_overflows(int64_t left, int64_t right, int64_t min, int64_t max);
+
+/// @brief Checks if the multiplication of 2 unsigned integers overflows the range [0, max], which
+/// contains both integers. Used on compilers without overflow builtins.
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param max The maximum value of the type of the integers
+/// @return True if the multiplication overflows
+bool impl_unsigned_mul_overflows(uint64_t left, uint64_t right, uint64_t max);
+
+/// @brief Computes the checked sum of 2 QWORD as OpCode_SumChecked, using range checks rather than overflow builtins.
+/// Used on compilers without overflow builtins (and always compiled, so that it can be tested).
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @param result Pointer to where to write the sum (which is wrapped on overflow)
+/// @return False if the sum overflows
+bool impl_sum_checked_portable(QWORD left, QWORD right, OperandType type, QWORD* result);
+
+/// @brief Computes the checked difference of 2 QWORD as OpCode_DifferenceChecked, using range checks rather than overflow builtins.
+/// Used on compilers without overflow builtins (and always compiled, so that it can be tested).
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @param result Pointer to where to write the difference (which is wrapped on overflow)
+/// @return False if the difference overflows
+bool impl_difference_checked_portable(QWORD left, QWORD right, OperandType type, QWORD* result);
+
+/// @brief Computes the checked multiplication of 2 QWORD as OpCode_MultiplyChecked, using range checks rather than overflow builtins.
+/// Used on compilers without overflow builtins (and always compiled, so that it can be tested).
+/// @param left The left hand side
+/// @param right The right hand side
+/// @param type The integer type of the QWORDs
+/// @param result Pointer to where to write the multiplication (which is wrapped on overflow)
+/// @return False if the multiplication overflows
+bool impl_multiply_checked_portable(QWORD left, QWORD right, OperandType type, QWORD* result);
 
 #endif //HG_COLTI_BYTE_CODE
\ No newline at end of file
@@ -0,0 +1,565 @@
+/** @file c_emitter.c
+* Contains the definitions of the functions declared in 'c_emitter.h'
+*/
+
+#include "c_emitter.h"
+
+/// @brief The names of the enumerators of each OperandType
+static const char* const g_operand_type_names[OPERAND_TYPE_COUNT] =
+{
+	[COLTI_BOOL] = "COLTI_BOOL",
+	[COLTI_DOUBLE] = "COLTI_DOUBLE",
+	[COLTI_FLOAT] = "COLTI_FLOAT",
+	[COLTI_INT8] = "COLTI_INT8",
+	[COLTI_INT16] = "COLTI_INT16",
+	[COLTI_INT32] = "COLTI_INT32",
+	[COLTI_INT64] = "COLTI_INT64",
+	[COLTI_UINT8] = "COLTI_UINT8",
+	[COLTI_UINT16] = "COLTI_UINT16",
+	[COLTI_UINT32] = "COLTI_UINT32",
+	[COLTI_UINT64] = "COLTI_UINT64",
+};
+
+bool ChunkEmitC(Chunk* chunk, const char* name, FILE* file)
+{
+	//The verifier guarantees that the stack never underflows, and computes its depth before each instruction
+	uint64_t error_offset;
+	uint64_t* depths = (uint64_t*)safe_malloc(chunk->count * sizeof(uint64_t) + 1);
+	VerifyResult result = ChunkVerifyDepths(chunk, &error_offset, depths);
+	if (result != VERIFY_OK)
+	{
+		safe_free(depths);
+		print_error_format("Invalid byte-code at offset %"PRIu64": %s!", error_offset, VerifyResultToString(result));
+		return false;
+	}
+
+	fprintf(file, "/** Generated by 'colti --emit-c' from '%s'.\n"
+		"* Compile from 'colti/src' using: cc "C_EMITTER_RUNTIME_FLAGS" <THIS_FILE> "C_EMITTER_RUNTIME_SOURCES" -lm\n"
+		"* Define COLTI_EMIT_NO_MAIN to build a shared object exporting ColtiMain.\n"
+		"*/\n\n#include \"byte_code.h\"\n#include \"array.h\"\n\n", name);
+	if (chunk->constant_count != 0)
+	{
+		fprintf(file, "static const QWORD g_constants[%"PRIu64"] =\n{\n", chunk->constant_count);
+		for (uint64_t i = 0; i < chunk->constant_count; i++)
+			fprintf(file, "\t{ .ui64 = UINT64_C(0x%016"PRIx64") },\n", chunk->constants[i].ui64);
+		fputs("};\n\n", file);
+	}
+	//The names of the globals were resolved to the indices of their slots
+	if (chunk->global_count != 0)
+		fprintf(file, "static QWORD g_globals[%"PRIu64"];\n\n", chunk->global_count);
+
+	//Each function becomes a static C function, declared first as the code can call any of them.
+	//The targets of the jumps are flagged, to write their labels.
+	uint8_t* is_target = (uint8_t*)safe_malloc(chunk->count + 1);
+	memset(is_target, 0, chunk->count + 1);
+	Instruction instr;
+	for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+	{
+		impl_emit_c_decode(chunk, offset, &instr);
+		switch (OpCodeGetLayout(instr.code))
+		{
+		break; case LAYOUT_JUMP:
+		case LAYOUT_TYPE_JUMP:
+		case LAYOUT_LOOP:
+			is_target[offset + instr.immediate.i64] = true;
+		break; case LAYOUT_JUMP_TABLE:
+			for (uint32_t i = 0; i <= instr.index; i++)
+				is_target[offset + impl_chunk_jump_table_offset(instr.table, i)] = true;
+		break; default:
+			break;
+		}
+		if (instr.code != OP_ENTER)
+			continue;
+		impl_emit_c_signature(offset, instr.immediate.ui8, file);
+		fputs(";\n", file);
+	}
+
+	//The arrays are owned by a list shared with the functions, freed before returning
+	fputs("\nInterpretResult ColtiMain(VMOutput* out)\n{\n\tArray* array_list = NULL;\n\tArray** arrays = &array_list;\n", file);
+	//As in the VM, the globals are zero-initialized each time the code starts
+	if (chunk->global_count != 0)
+		fputs("\tmemset(g_globals, 0, sizeof(g_globals));\n", file);
+	impl_emit_c_frame(chunk, 0, chunk->local_count, file);
+
+	//The depth of the stack of unreachable instructions is UINT64_MAX
+	uint64_t function = C_EMITTER_NO_FUNCTION;
+	uint64_t depth = 0;
+	for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+	{
+		impl_emit_c_decode(chunk, offset, &instr);
+		if (instr.code == OP_ENTER)
+		{
+			//The arguments are the first local slots, the other ones are zero-initialized
+			uint64_t arg_count = instr.immediate.ui8;
+			fputs("}\n\n", file);
+			impl_emit_c_signature(offset, arg_count, file);
+			fputs("\n{\n", file);
+			impl_emit_c_frame(chunk, arg_count, instr.immediate.ui64 >> 8, file);
+			//The target of the tail calls of the function to itself
+			fprintf(file, "colti_entry:\n\t//%04"PRIu64" %s\n", offset, OpCodeToString(instr.code));
+			function = offset;
+			continue;
+		}
+		if (depths[offset] == UINT64_MAX)
+			continue;
+		depth = depths[offset];
+		if (is_target[offset])
+			fprintf(file, "colti_%"PRIu64":\n", offset);
+		fprintf(file, "\t//%04"PRIu64" %s\n", offset, OpCodeToString(instr.code));
+		impl_emit_c_instruction(chunk, &instr, offset, function, &depth, file);
+	}
+	safe_free(is_target);
+	safe_free(depths);
+	fputs("}\n\n"
+		"#ifndef COLTI_EMIT_NO_MAIN\n"
+		"int main(void)\n{\n"
+		"\tVMOutput out;\n"
+		"\tVMOutputInit(&out, stdout);\n"
+		"\tInterpretResult result = ColtiMain(&out);\n"
+		"\tVMOutputFree(&out);\n"
+		"\treturn result == INTERPRET_OK ? EXIT_SUCCESS : EXIT_FAILURE;\n"
+		"}\n"
+		"#endif\n", file);
+	return true;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+void impl_emit_c_instruction(const Chunk* chunk, const Instruction* instr, uint64_t offset, uint64_t function, uint64_t* depth, FILE* file)
+{
+	switch (instr->code)
+	{
+		//Immediates are zero-extended
+	break; case OP_IMMEDIATE_BYTE:
+	case OP_IMMEDIATE_WORD:
+	case OP_IMMEDIATE_DWORD:
+	case OP_IMMEDIATE_QWORD:
+		fprintf(file, "\ts%"PRIu64".ui64 = UINT64_C(0x%"PRIx64");\n", (*depth)++, instr->immediate.ui64);
+	break; case OP_LOAD_CONST_BYTE:
+	case OP_LOAD_CONST_WORD:
+		fprintf(file, "\ts%"PRIu64" = g_constants[%"PRIu64"];\n", (*depth)++, instr->immediate.ui64);
+
+	break; case OP_LOAD_LOCAL_BYTE:
+	case OP_LOAD_LOCAL_WORD:
+		fprintf(file, "\ts%"PRIu64" = l%"PRIu64";\n", (*depth)++, instr->immediate.ui64);
+	break; case OP_STORE_LOCAL_BYTE:
+	case OP_STORE_LOCAL_WORD:
+		fprintf(file, "\tl%"PRIu64" = s%"PRIu64";\n", instr->immediate.ui64, --(*depth));
+	break; case OP_LOAD_GLOBAL:
+		fprintf(file, "\ts%"PRIu64" = g_globals[%"PRIu64"];\n", (*depth)++, instr->immediate.ui64);
+	break; case OP_STORE_GLOBAL:
+		fprintf(file, "\tg_globals[%"PRIu64"] = s%"PRIu64";\n", instr->immediate.ui64, --(*depth));
+
+		//The dynamically typed instructions are emitted as their generic path, as the C compiler cannot specialize them
+	break; case OP_BOX:
+		fprintf(file, "\ts%"PRIu64".ui64 = %s;\n", (*depth)++, g_operand_type_names[instr->types[0]]);
+	break; case OP_UNBOX:
+	case OP_ADD_DYNAMIC:
+	case OP_ADD_DYNAMIC_I64:
+	case OP_ADD_DYNAMIC_DOUBLE:
+	case OP_ADD_DYNAMIC_POLY:
+		impl_emit_c_dynamic(chunk, instr, offset, depth, file);
+	break; case OP_INC_LOCAL_BYTE:
+	case OP_INC_LOCAL_WORD:
+	{
+		const char* member = impl_emit_c_member(instr->types[0]);
+		uint64_t top = --(*depth);
+		fprintf(file, "\tl%"PRIu64".%s = l%"PRIu64".%s + s%"PRIu64".%s;\n",
+			instr->immediate.ui64, member, instr->immediate.ui64, member, top, member);
+	}
+
+	break; case OP_NEGATE:
+	{
+		const char* member = impl_emit_c_member(instr->types[0]);
+		fprintf(file, "\ts%"PRIu64".%s = -s%"PRIu64".%s;\n", *depth - 1, member, *depth - 1, member);
+	}
+
+	break; case OP_CONVERT:
+	case OP_CVT_I32_I64:
+	case OP_CVT_I64_I32:
+	case OP_CVT_I32_DOUBLE:
+	case OP_CVT_DOUBLE_I32:
+	case OP_CVT_I64_DOUBLE:
+	case OP_CVT_DOUBLE_I64:
+	case OP_CVT_FLOAT_DOUBLE:
+	case OP_CVT_DOUBLE_FLOAT:
+	{
+		//The conversions out of range of C are defined by the runtime
+		OperandType from = instr->types[0];
+		OperandType to = instr->types[1];
+		ConvertGetOpCodeTypes(instr->code, &from, &to);
+		fprintf(file, "\ts%"PRIu64" = OpCode_Convert(s%"PRIu64", %s, %s);\n",
+			*depth - 1, *depth - 1, g_operand_type_names[from], g_operand_type_names[to]);
+	}
+
+		//The top of the stack is the left operand
+	break; case OP_ADD:
+	case OP_ADD_I64:
+	case OP_ADD_DOUBLE:
+		impl_emit_c_binary("+", instr->types[0], depth, file);
+	break; case OP_SUBTRACT:
+	case OP_SUBTRACT_I64:
+	case OP_SUBTRACT_DOUBLE:
+		impl_emit_c_binary("-", instr->types[0], depth, file);
+	break; case OP_MULTIPLY:
+	case OP_MULTIPLY_I64:
+	case OP_MULTIPLY_DOUBLE:
+		impl_emit_c_binary("*", instr->types[0], depth, file);
+	break; case OP_DIVIDE:
+		impl_emit_c_binary("/", instr->types[0], depth, file);
+	break; case OP_MODULO:
+		if (instr->types[0] == COLTI_FLOAT || instr->types[0] == COLTI_DOUBLE)
+			impl_emit_c_call("OpCode_Modulo", instr->types[0], depth, file);
+		else
+			impl_emit_c_binary("%", instr->types[0], depth, file);
+	break; case OP_DIVIDE_CONST:
+	case OP_MODULO_CONST:
+		impl_emit_c_divide_constant(chunk, instr, depth, file);
+
+	break; case OP_ADD_CHECKED:
+		impl_emit_c_checked(chunk, "OpCode_SumChecked", instr, offset, depth, file);
+	break; case OP_SUBTRACT_CHECKED:
+		impl_emit_c_checked(chunk, "OpCode_DifferenceChecked", instr, offset, depth, file);
+	break; case OP_MULTIPLY_CHECKED:
+		impl_emit_c_checked(chunk, "OpCode_MultiplyChecked", instr, offset, depth, file);
+	break; case OP_DIVIDE_CHECKED:
+		impl_emit_c_checked(chunk, "OpCode_DivideChecked", instr, offset, depth, file);
+	break; case OP_MODULO_CHECKED:
+		impl_emit_c_checked(chunk, "OpCode_ModuloChecked", instr, offset, depth, file);
+
+		//Signed overflow is undefined in C, so wrapping is done by the runtime
+	break; case OP_ADD_WRAPPING:
+		impl_emit_c_call("OpCode_SumWrapping", instr->types[0], depth, file);
+	break; case OP_SUBTRACT_WRAPPING:
+		impl_emit_c_call("OpCode_DifferenceWrapping", instr->types[0], depth, file);
+	break; case OP_MULTIPLY_WRAPPING:
+		impl_emit_c_call("OpCode_MultiplyWrapping", instr->types[0], depth, file);
+
+	break; case OP_ARRAY_NEW:
+	case OP_ARRAY_LENGTH:
+	case OP_ARRAY_GET:
+	case OP_ARRAY_SET:
+	case OP_ARRAY_ADD:
+	case OP_ARRAY_SUBTRACT:
+	case OP_ARRAY_MULTIPLY:
+	case OP_ARRAY_DIVIDE:
+	case OP_ARRAY_NEGATE:
+	case OP_ARRAY_CONVERT:
+	case OP_ARRAY_SUM:
+	case OP_ARRAY_MIN:
+	case OP_ARRAY_MAX:
+	case OP_ARRAY_DOT:
+		impl_emit_c_array(chunk, instr, offset, depth, file);
+
+	break; case OP_PRINT:
+		fprintf(file, "\tOpCode_Print(s%"PRIu64", %s, out);\n", *depth - 1, g_operand_type_names[instr->types[0]]);
+	break; case OP_CALL:
+	case OP_TAIL_CALL:
+		impl_emit_c_function_call(chunk, instr, function, depth, file);
+	break; case OP_JUMP:
+	case OP_JUMP_IF_FALSE:
+	case OP_JUMP_IF_LESS:
+	case OP_JUMP_IF_LESS_EQUAL:
+	case OP_JUMP_IF_EQUAL:
+	case OP_JUMP_IF_NOT_EQUAL:
+	case OP_JUMP_TABLE:
+	case OP_LOOP:
+		impl_emit_c_jump(instr, offset, depth, file);
+	break; case OP_RETURN:
+		if (function == C_EMITTER_NO_FUNCTION)
+			fputs("\tVMOutputFlush(out);\n\tArrayFreeAll(arrays);\n\treturn INTERPRET_OK;\n", file);
+		else
+			fprintf(file, "\t*result = s%"PRIu64";\n\treturn INTERPRET_OK;\n", *depth - 1);
+
+	break; default: //The chunk was verified
+		colti_unreachable();
+	}
+}
+
+void impl_emit_c_binary(const char* op, OperandType type, uint64_t* depth, FILE* file)
+{
+	const char* member = impl_emit_c_member(type);
+	uint64_t left = *depth - 1;
+	uint64_t right = *depth - 2;
+	fprintf(file, "\ts%"PRIu64".%s = s%"PRIu64".%s %s s%"PRIu64".%s;\n", right, member, left, member, op, right, member);
+	--(*depth);
+}
+
+void impl_emit_c_call(const char* function, OperandType type, uint64_t* depth, FILE* file)
+{
+	uint64_t left = *depth - 1;
+	uint64_t right = *depth - 2;
+	fprintf(file, "\ts%"PRIu64" = %s(s%"PRIu64", s%"PRIu64", %s);\n", right, function, left, right, g_operand_type_names[type]);
+	--(*depth);
+}
+
+void impl_emit_c_checked(const Chunk* chunk, const char* function, const Instruction* instr, uint64_t offset, uint64_t* depth, FILE* file)
+{
+	uint64_t left = *depth - 1;
+	uint64_t right = *depth - 2;
+	//The error is the one printed by the VM, which is known when emitting
+	char location[96];
+	impl_emit_c_error_location(chunk, offset, location, sizeof(location));
+	fprintf(file, "\tif (!%s(s%"PRIu64", s%"PRIu64", %s, &s%"PRIu64"))\n", function, left, right, g_operand_type_names[instr->types[0]], right);
+	fprintf(file, "\t{\n\t\tVMOutputFlush(out);\n\t\tArrayFreeAll(arrays);\n\t\tprint_error_string(\"%s%s\");\n\t\treturn INTERPRET_RUNTIME_ERROR;\n\t}\n",
+		OpCodeCheckedErrorToString(instr->code), location);
+	--(*depth);
+}
+
+void impl_emit_c_dynamic(const Chunk* chunk, const Instruction* instr, uint64_t offset, uint64_t* depth, FILE* file)
+{
+	uint64_t top = *depth - 1;
+	//The error is the one printed by the VM, which is known when emitting
+	char location[96];
+	impl_emit_c_error_location(chunk, offset, location, sizeof(location));
+	const char* message;
+	if (instr->code == OP_UNBOX)
+	{
+		fprintf(file, "\tif (s%"PRIu64".ui64 != %s)\n", top, g_operand_type_names[instr->types[0]]);
+		message = "Dynamic value of an unexpected type";
+		--(*depth);
+	}
+	else
+	{
+		//The left operand (its tag being the top of the stack) is above the right one
+		fprintf(file, "\tif (!OpCode_SumDynamic(s%"PRIu64", s%"PRIu64", s%"PRIu64", s%"PRIu64", &s%"PRIu64"))\n",
+			top - 1, top, top - 3, top - 2, top - 3);
+		message = "Dynamic operands of different or invalid types";
+		*depth -= 2;
+	}
+	fprintf(file, "\t{\n\t\tVMOutputFlush(out);\n\t\tArrayFreeAll(arrays);\n\t\tprint_error_string(\"%s%s\");\n\t\treturn INTERPRET_RUNTIME_ERROR;\n\t}\n",
+		message, location);
+}
+
+void impl_emit_c_array(const Chunk* chunk, const Instruction* instr, uint64_t offset, uint64_t* depth, FILE* file)
+{
+	uint64_t top = *depth - 1;
+	const char* name = OpCodeToString(instr->code);
+	const char* type = g_operand_type_names[instr->types[0]];
+	//The call of the runtime, for the OpCodes which can fail
+	char call[128];
+	switch (instr->code)
+	{
+	break; case OP_ARRAY_NEW:
+		snprintf(call, sizeof(call), "OpCode_ArrayNew(s%"PRIu64", s%"PRIu64", %s, arrays, &s%"PRIu64")", top - 1, top, type, top - 1);
+		--(*depth);
+	break; case OP_ARRAY_LENGTH:
+		fprintf(file, "\ts%"PRIu64" = OpCode_ArrayLength(s%"PRIu64");\n", top + 1, top);
+		++(*depth);
+		return;
+	break; case OP_ARRAY_GET:
+		snprintf(call, sizeof(call), "OpCode_ArrayGet(s%"PRIu64", s%"PRIu64", &s%"PRIu64")", top - 1, top, top);
+	break; case OP_ARRAY_SET:
+		snprintf(call, sizeof(call), "OpCode_ArraySet(s%"PRIu64", s%"PRIu64", s%"PRIu64")", top - 2, top - 1, top);
+		*depth -= 2;
+		//The top of the stack is the left operand
+	break; case OP_ARRAY_ADD:
+	case OP_ARRAY_SUBTRACT:
+	case OP_ARRAY_MULTIPLY:
+	case OP_ARRAY_DIVIDE:
+		snprintf(call, sizeof(call), "OpCode_ArrayBinary(%s, s%"PRIu64", s%"PRIu64", arrays, &s%"PRIu64")", name, top, top - 1, top - 1);
+		--(*depth);
+	break; case OP_ARRAY_NEGATE:
+		fprintf(file, "\ts%"PRIu64" = OpCode_ArrayNegate(s%"PRIu64", arrays);\n", top, top);
+		return;
+	break; case OP_ARRAY_CONVERT:
+		fprintf(file, "\ts%"PRIu64" = OpCode_ArrayConvert(s%"PRIu64", %s, arrays);\n", top, top, g_operand_type_names[instr->types[1]]);
+		return;
+	break; case OP_ARRAY_SUM:
+	case OP_ARRAY_MIN:
+	case OP_ARRAY_MAX:
+		snprintf(call, sizeof(call), "OpCode_ArrayReduce(%s, s%"PRIu64", &s%"PRIu64")", name, top, top);
+	break; case OP_ARRAY_DOT:
+		snprintf(call, sizeof(call), "OpCode_ArrayDot(s%"PRIu64", s%"PRIu64", &s%"PRIu64")", top, top - 1, top - 1);
+		--(*depth);
+	break; default:
+		colti_unreachable();
+	}
+	//The kind of the error is only known when running
+	char location[96];
+	impl_emit_c_error_location(chunk, offset, location, sizeof(location));
+	fprintf(file, "\t{\n\t\tArrayError error = %s;\n\t\tif (error != ARRAY_OK)\n\t\t{\n"
+		"\t\t\tVMOutputFlush(out);\n\t\t\tArrayFreeAll(arrays);\n"
+		"\t\t\tprint_error_format(\"%%s%s\", ArrayErrorToString(error));\n"
+		"\t\t\treturn INTERPRET_RUNTIME_ERROR;\n\t\t}\n\t}\n", call, location);
+}
+
+void impl_emit_c_jump(const Instruction* instr, uint64_t offset, uint64_t* depth, FILE* file)
+{
+	uint64_t target = offset + instr->immediate.i64;
+	switch (instr->code)
+	{
+	break; case OP_JUMP:
+	case OP_LOOP:
+		fprintf(file, "\tgoto colti_%"PRIu64";\n", target);
+	break; case OP_JUMP_IF_FALSE:
+		fprintf(file, "\tif (!s%"PRIu64".b)\n\t\tgoto colti_%"PRIu64";\n", --(*depth), target);
+	break; case OP_JUMP_IF_LESS:
+	case OP_JUMP_IF_LESS_EQUAL:
+	case OP_JUMP_IF_EQUAL:
+	case OP_JUMP_IF_NOT_EQUAL:
+	{
+		//The left operand is the top of the stack, and a NaN is not equal to itself
+		const char* member = impl_emit_c_member(instr->types[0]);
+		const char* format = instr->code == OP_JUMP_IF_LESS ? "\tif (s%"PRIu64".%s < s%"PRIu64".%s)\n"
+			: instr->code == OP_JUMP_IF_LESS_EQUAL ? "\tif (s%"PRIu64".%s <= s%"PRIu64".%s)\n"
+			: instr->code == OP_JUMP_IF_EQUAL ? "\tif (s%"PRIu64".%s == s%"PRIu64".%s)\n"
+			: "\tif (!(s%"PRIu64".%s == s%"PRIu64".%s))\n";
+		fprintf(file, format, *depth - 1, member, *depth - 2, member);
+		fprintf(file, "\t\tgoto colti_%"PRIu64";\n", target);
+		*depth -= 2;
+	}
+	break; case OP_JUMP_TABLE:
+		//Indices out of the cases jump to the default case
+		fprintf(file, "\tswitch (s%"PRIu64".ui64)\n\t{\n", --(*depth));
+		for (uint32_t i = 0; i < instr->index; i++)
+			fprintf(file, "\tcase %"PRIu32": goto colti_%"PRIu64";\n", i, offset + impl_chunk_jump_table_offset(instr->table, i));
+		fprintf(file, "\tdefault: goto colti_%"PRIu64";\n\t}\n", target);
+	break; default:
+		colti_unreachable();
+	}
+}
+
+void impl_emit_c_function_call(const Chunk* chunk, const Instruction* instr, uint64_t function, uint64_t* depth, FILE* file)
+{
+	uint64_t target = instr->immediate.ui64;
+	Instruction enter;
+	impl_emit_c_decode(chunk, target, &enter);
+	uint64_t arg_count = enter.immediate.ui8;
+	uint64_t first = *depth - arg_count;
+	//The arguments are the values on the top of the stack, in the order in which they were pushed
+	char args[32 * UINT8_MAX + 1] = "";
+	size_t length = 0;
+	for (uint64_t i = 0; i < arg_count; i++)
+		length += (size_t)snprintf(args + length, sizeof(args) - length, ", s%"PRIu64, first + i);
+
+	if (instr->code == OP_CALL)
+	{
+		//An error was already printed by the callee, which freed the arrays
+		fprintf(file, "\t{\n\t\tInterpretResult status = colti_function_%"PRIu64"(out, arrays, &s%"PRIu64"%s);\n"
+			"\t\tif (status != INTERPRET_OK)\n\t\t\treturn status;\n\t}\n", target, first, args);
+		*depth = first + 1;
+	}
+	else if (function == C_EMITTER_NO_FUNCTION)
+	{
+		//The result is left on the stack of the chunk, which returns
+		fprintf(file, "\t{\n\t\tQWORD result;\n\t\tInterpretResult status = colti_function_%"PRIu64"(out, arrays, &result%s);\n"
+			"\t\tif (status == INTERPRET_OK)\n\t\t{\n\t\t\tVMOutputFlush(out);\n\t\t\tArrayFreeAll(arrays);\n\t\t}\n"
+			"\t\treturn status;\n\t}\n", target, args);
+	}
+	else if (target == function)
+	{
+		//A tail call of the function to itself reuses its frame, as in the VM, so that it runs in constant memory
+		for (uint64_t i = 0; i < arg_count; i++)
+			fprintf(file, "\tl%"PRIu64" = s%"PRIu64";\n", i, first + i);
+		for (uint64_t i = arg_count; i < (enter.immediate.ui64 >> 8); i++)
+			fprintf(file, "\tl%"PRIu64".ui64 = 0;\n", i);
+		fputs("\tgoto colti_entry;\n", file);
+	}
+	else
+	{
+		//Other tail calls are C tail calls, which optimizing C compilers turn into jumps
+		fprintf(file, "\treturn colti_function_%"PRIu64"(out, arrays, result%s);\n", target, args);
+	}
+}
+
+void impl_emit_c_decode(const Chunk* chunk, uint64_t offset, Instruction* instr)
+{
+	if (chunk->encoding == CHUNK_ENCODING_COMPACT)
+		CompactDecodeInstruction(chunk, offset, instr);
+	else
+		ChunkDecodeInstruction(chunk, offset, instr);
+}
+
+void impl_emit_c_signature(uint64_t offset, uint64_t arg_count, FILE* file)
+{
+	//The name of a function is the offset of its OP_ENTER, which is the operand of the calls
+	fprintf(file, "static InterpretResult colti_function_%"PRIu64"(VMOutput* out, Array** arrays, QWORD* result", offset);
+	for (uint64_t i = 0; i < arg_count; i++)
+		fprintf(file, ", QWORD l%"PRIu64, i);
+	fputc(')', file);
+}
+
+void impl_emit_c_frame(const Chunk* chunk, uint64_t arg_count, uint64_t local_count, FILE* file)
+{
+	if (chunk->max_stack_depth != 0)
+	{
+		//Each slot of the stack is a variable, which the C compiler can keep in a register
+		fputs("\tQWORD s0", file);
+		for (uint64_t i = 1; i < chunk->max_stack_depth; i++)
+			fprintf(file, ", s%"PRIu64, i);
+		fputs(";\n", file);
+	}
+	if (local_count > arg_count)
+	{
+		//The local slots are zero-initialized, as the frame reserved by the VM
+		fprintf(file, "\tQWORD l%"PRIu64" = { .ui64 = 0 }", arg_count);
+		for (uint64_t i = arg_count + 1; i < local_count; i++)
+			fprintf(file, ", l%"PRIu64" = { .ui64 = 0 }", i);
+		fputs(";\n", file);
+	}
+}
+
+void impl_emit_c_error_location(const Chunk* chunk, uint64_t offset, char* buffer, size_t size)
+{
+	SourceLocation location;
+	if (ChunkGetSourceLocation(chunk, offset, &location))
+		snprintf(buffer, size, " at offset %"PRIu64" (line %"PRIu32", column %"PRIu32")!", offset, location.line, location.column);
+	else
+		snprintf(buffer, size, " at offset %"PRIu64"!", offset);
+}
+
+void impl_emit_c_divide_constant(const Chunk* chunk, const Instruction* instr, const uint64_t* depth, FILE* file)
+{
+	const char* member = impl_emit_c_member(instr->types[0]);
+	uint64_t top = *depth - 1;
+	QWORD divisor = chunk->constants[instr->immediate.ui64];
+	bool is_modulo = instr->code == OP_MODULO_CONST;
+	if (instr->types[0] < COLTI_INT8)
+	{
+		//The unsigned dividend is promoted to 64 bits, and the result always fits in its type
+		fprintf(file, "\ts%"PRIu64".%s = s%"PRIu64".%s %s UINT64_C(%"PRIu64");\n",
+			top, member, top, member, is_modulo ? "%" : "/", divisor.ui64);
+	}
+	else if (divisor.i64 == -1)
+	{
+		//Dividing the minimum value by -1 overflows, which wraps in the VM
+		if (is_modulo)
+			fprintf(file, "\ts%"PRIu64".ui64 = 0;\n", top);
+		else
+			fprintf(file, "\ts%"PRIu64" = OpCode_DifferenceWrapping((QWORD){ .ui64 = 0 }, s%"PRIu64", %s);\n",
+				top, top, g_operand_type_names[instr->types[0]]);
+	}
+	else if (divisor.i64 == INT64_MIN)
+	{
+		//The literal cannot be written as INT64_C(-9223372036854775808)
+		fprintf(file, "\ts%"PRIu64".%s = s%"PRIu64".%s %s INT64_MIN;\n",
+			top, member, top, member, is_modulo ? "%" : "/");
+	}
+	else
+	{
+		fprintf(file, "\ts%"PRIu64".%s = s%"PRIu64".%s %s INT64_C(%"PRId64");\n",
+			top, member, top, member, is_modulo ? "%" : "/", divisor.i64);
+	}
+}
+
+const char* impl_emit_c_member(OperandType type)
+{
+	switch (type)
+	{
+	case COLTI_BOOL:	return "b";
+	case COLTI_DOUBLE:	return "d";
+	case COLTI_FLOAT:	return "f";
+	case COLTI_INT8:	return "i8";
+	case COLTI_INT16:	return "i16";
+	case COLTI_INT32:	return "i32";
+	case COLTI_INT64:	return "i64";
+	case COLTI_UINT8:	return "ui8";
+	case COLTI_UINT16:	return "ui16";
+	case COLTI_UINT32:	return "ui32";
+	case COLTI_UINT64:	return "ui64";
+	default:			colti_unreachable();
+	}
+}
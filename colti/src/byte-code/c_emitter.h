@@ -0,0 +1,160 @@
+/** @file c_emitter.h
+* Contains the ahead-of-time compiler of Chunks to C.
+* ChunkEmitC translates the (verified) code of a Chunk into a C translation unit,
+* in which each instruction becomes straight-line C: as the verifier computes the depth of the
+* stack at each instruction, each slot of the stack becomes a local QWORD variable, on which
+* the arithmetic is done through the same union members as the OpCode_* functions.
+* Each local slot of the frame also becomes a local QWORD variable, zero-initialized.
+* The constant pool becomes a static array, and printing goes through OpCode_Print.
+* The arrays (see array.h) are owned by a local list, which is freed before returning.
+* Each function (starting with OP_ENTER) becomes a static C function 'colti_function_N' (N being the offset of
+* its OP_ENTER), whose parameters are its arguments, and which writes its result through a pointer: calls become
+* C calls, the depth of which is only bounded by the stack of the thread (and not by STACK_VM_MAX_FRAMES).
+* A tail call of a function to itself becomes a jump to its beginning, so that it runs in constant memory as in the VM.
+* Each jump becomes a 'goto' to the label 'colti_N' of its target (N being the offset of the target), and an OP_JUMP_TABLE
+* a C 'switch': as the verifier guarantees that every path reaches an instruction with the same stack depth, the slots
+* of the stack are the same variables on every path. The loops of the emitted code do not count their iterations.
+* A quickened OpCode (see quickening.h) is translated as the OpCode it quickens.
+* Unreachable instructions are not emitted.
+* The translation unit defines 'InterpretResult ColtiMain(VMOutput* out)', and a 'main' running it
+* on stdout (unless COLTI_EMIT_NO_MAIN is defined, to build a shared object).
+* It is compiled (from 'colti/src') like the interpreter, using C_EMITTER_RUNTIME_FLAGS, with the
+* runtime sources listed in C_EMITTER_RUNTIME_SOURCES.
+*/
+
+#ifndef HG_COLTI_C_EMITTER
+#define HG_COLTI_C_EMITTER
+
+#include "common.h"
+#include "chunk.h"
+#include "compact_encoding.h"
+#include "verifier.h"
+
+/// @brief The flags (relative to 'colti/src') with which to compile an emitted translation unit
+#define C_EMITTER_RUNTIME_FLAGS "-include util/precomph.h -I. -Iutil -Ibyte-code"
+/// @brief The sources (relative to 'colti/src') to compile with an emitted translation unit
+#define C_EMITTER_RUNTIME_SOURCES "byte-code/byte_code.c byte-code/conversion.c byte-code/divisor.c byte-code/array.c byte-code/array_kernels.c vm/vm_output.c util/number_conversion.c util/memory.c"
+
+/// @brief The function being emitted when emitting the code of the chunk itself (ColtiMain)
+#define C_EMITTER_NO_FUNCTION UINT64_MAX
+
+/// @brief Translates the code of a Chunk into a C translation unit.
+/// The chunk is verified if it was not already.
+/// @param chunk The chunk to translate
+/// @param name The name of the chunk (which is written in a comment)
+/// @param file The stream to which to write the C code
+/// @return False (printing an error) if the chunk is not valid
+bool ChunkEmitC(Chunk* chunk, const char* name, FILE* file);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Writes the C code of an instruction
+/// @param chunk The chunk containing the instruction
+/// @param instr The instruction
+/// @param offset The offset of the instruction
+/// @param function The offset of the OP_ENTER of the function containing the instruction, or C_EMITTER_NO_FUNCTION
+/// @param depth Pointer to the depth of the stack before the instruction, which is updated
+/// @param file The stream to which to write
+void impl_emit_c_instruction(const Chunk* chunk, const Instruction* instr, uint64_t offset, uint64_t function, uint64_t* depth, FILE* file);
+
+/// @brief Writes the C code of a binary operation, which pops 2 values and pushes the result
+/// @param op The C operator
+/// @param type The type of the operands
+/// @param depth Pointer to the depth of the stack before the operation, which is updated
+/// @param file The stream to which to write
+void impl_emit_c_binary(const char* op, OperandType type, uint64_t* depth, FILE* file);
+
+/// @brief Writes the C code of a binary operation done by a function of the runtime (OpCode_*),
+/// which pops 2 values and pushes the result
+/// @param function The name of the function
+/// @param type The type of the operands
+/// @param depth Pointer to the depth of the stack before the operation, which is updated
+/// @param file The stream to which to write
+void impl_emit_c_call(const char* function, OperandType type, uint64_t* depth, FILE* file);
+
+/// @brief Writes the C code of a checked binary operation done by a function of the runtime (OpCode_*Checked),
+/// which returns INTERPRET_RUNTIME_ERROR (printing the same error as the VM) if the operation fails
+/// @param chunk The chunk containing the instruction
+/// @param function The name of the function
+/// @param instr The checked instruction
+/// @param offset The offset of the instruction
+/// @param depth Pointer to the depth of the stack before the operation, which is updated
+/// @param file The stream to which to write
+void impl_emit_c_checked(const Chunk* chunk, const char* function, const Instruction* instr, uint64_t offset, uint64_t* depth, FILE* file);
+
+/// @brief Writes the C code of a division (or remainder) by a constant, which is written as a 64-bit literal
+/// so that the C compiler strength-reduces it as the VM does
+/// @param chunk The chunk containing the constant
+/// @param instr The OP_DIVIDE_CONST or OP_MODULO_CONST instruction
+/// @param depth Pointer to the depth of the stack before the operation
+/// @param file The stream to which to write
+void impl_emit_c_divide_constant(const Chunk* chunk, const Instruction* instr, const uint64_t* depth, FILE* file);
+
+/// @brief Writes the C code of an array OpCode, done by a function of the runtime (OpCode_Array*),
+/// which returns INTERPRET_RUNTIME_ERROR (printing the same error as the VM) if the operation fails
+/// @param chunk The chunk containing the instruction
+/// @param instr The array instruction
+/// @param offset The offset of the instruction
+/// @param depth Pointer to the depth of the stack before the operation, which is updated
+/// @param file The stream to which to write
+void impl_emit_c_array(const Chunk* chunk, const Instruction* instr, uint64_t offset, uint64_t* depth, FILE* file);
+
+/// @brief Writes the C code of OP_UNBOX or of a dynamically typed addition (OpCode_SumDynamic),
+/// which returns INTERPRET_RUNTIME_ERROR (printing the same error as the VM) if the tags are not the expected ones
+/// @param chunk The chunk containing the instruction
+/// @param instr The dynamically typed instruction
+/// @param offset The offset of the instruction
+/// @param depth Pointer to the depth of the stack before the operation, which is updated
+/// @param file The stream to which to write
+void impl_emit_c_dynamic(const Chunk* chunk, const Instruction* instr, uint64_t offset, uint64_t* depth, FILE* file);
+
+/// @brief Writes the C code of a jump (a 'goto', or a 'switch' of them for OP_JUMP_TABLE)
+/// @param instr The jump instruction
+/// @param offset The offset of the instruction, to which the jump offsets are relative
+/// @param depth Pointer to the depth of the stack before the jump, which is updated
+/// @param file The stream to which to write
+void impl_emit_c_jump(const Instruction* instr, uint64_t offset, uint64_t* depth, FILE* file);
+
+/// @brief Writes the C code of an OP_CALL or an OP_TAIL_CALL, which replaces the arguments on the stack by the result
+/// @param chunk The chunk containing the instruction
+/// @param instr The call instruction
+/// @param function The offset of the OP_ENTER of the function containing the instruction, or C_EMITTER_NO_FUNCTION
+/// @param depth Pointer to the depth of the stack before the call, which is updated
+/// @param file The stream to which to write
+void impl_emit_c_function_call(const Chunk* chunk, const Instruction* instr, uint64_t function, uint64_t* depth, FILE* file);
+
+/// @brief Decodes an instruction of a Chunk using either encoding
+/// @param chunk The chunk containing the instruction
+/// @param offset The offset of the instruction
+/// @param instr Pointer to where to write the decoded instruction
+void impl_emit_c_decode(const Chunk* chunk, uint64_t offset, Instruction* instr);
+
+/// @brief Writes the signature of the C function translating a function (without any ';')
+/// @param offset The offset of the OP_ENTER of the function
+/// @param arg_count The number of arguments of the function
+/// @param file The stream to which to write
+void impl_emit_c_signature(uint64_t offset, uint64_t arg_count, FILE* file);
+
+/// @brief Writes the declarations of the variables of a frame: the slots of the stack, and the local slots
+/// which are not arguments (zero-initialized)
+/// @param chunk The chunk containing the frame
+/// @param arg_count The number of arguments, which are parameters of the C function
+/// @param local_count The number of local slots of the frame
+/// @param file The stream to which to write
+void impl_emit_c_frame(const Chunk* chunk, uint64_t arg_count, uint64_t local_count, FILE* file);
+
+/// @brief Writes the end of the message of a runtime error, as printed by the VM (" at offset N!", with the source location if it is known)
+/// @param chunk The chunk containing the instruction
+/// @param offset The offset of the instruction
+/// @param buffer The buffer to which to write
+/// @param size The size of the buffer
+void impl_emit_c_error_location(const Chunk* chunk, uint64_t offset, char* buffer, size_t size);
+
+/// @brief Returns the member of QWORD used to operate on a type
+/// @param type The type
+/// @return The name of the member (as used by the OpCode_* functions)
+const char* impl_emit_c_member(OperandType type);
+
+#endif //HG_COLTI_C_EMITTER
@@ -3,6 +3,8 @@
 */
 
 #include "chunk.h"
+#include "conversion.h"
+#include "compact_encoding.h"
 
 void ChunkPrintBytes(const Chunk* chunk)
 {
@@ -19,6 +21,30 @@ void ChunkInit(Chunk* chunk)
 	chunk->capacity = 32;
 	chunk->count = 0;
 	chunk->code = safe_malloc(32);
+	chunk->encoding = CHUNK_ENCODING_ALIGNED;
+	chunk->is_verified = false;
+	chunk->max_stack_depth = 0;
+	chunk->local_count = 0;
+	chunk->operand_type = CHUNK_POLYMORPHIC;
+
+	//The constant pool is only allocated when a constant is added
+	chunk->constant_count = 0;
+	chunk->constant_capacity = 0;
+	chunk->constants = NULL;
+	chunk->constant_table = NULL;
+	chunk->divisors = NULL;
+	chunk->loop_count = 0;
+	chunk->loop_counters = NULL;
+	chunk->cache_count = 0;
+	chunk->inline_caches = NULL;
+	chunk->global_count = 0;
+	chunk->global_capacity = 0;
+	chunk->globals = NULL;
+	HashMapInit(&chunk->global_table);
+	DebugInfoInit(&chunk->debug_info);
+	chunk->mapping.ptr = NULL;
+	chunk->is_read_only = false;
+	chunk->is_quickening = false;
 }
 
 void ChunkWriteOpCode(Chunk* chunk, OpCode code)
@@ -40,54 +66,439 @@ void ChunkWriteBytes(Chunk* chunk, const uint8_t* const bytes, uint32_t size)
 {
 	if (!(chunk->count + size < chunk->capacity)) //Grow if needed
 		impl_chunk_grow_size(chunk, size);
-	memcpy(chunk->code, bytes, size);
+	memcpy(chunk->code + chunk->count, bytes, size);
 	chunk->count += size;
+	chunk->is_verified = false;
 }
 
 void ChunkWriteWORD(Chunk* chunk, WORD value)
 {
 	//We need to pad if needed
-	uint64_t offset = (uint64_t)(chunk->code + chunk->count) & 1; //same as % 2
+	uint64_t offset = impl_chunk_padding(chunk->count, sizeof(uint16_t));
 	if (!(chunk->count + offset + sizeof(uint16_t) < chunk->capacity)) //Grow if needed
 		impl_chunk_grow_double(chunk);
 
-	//Set the padding byte to CD on Debug build
-	DO_IF_DEBUG_BUILD(if (offset != 0) chunk->code[chunk->count] = 205;);
+	//The padding byte is part of the serialized code, so it is always CD
+	if (offset != 0)
+		chunk->code[chunk->count] = 205;
 
 	//Copy the bytes of the integer to the aligned memory
 	memcpy(chunk->code + (chunk->count += offset), &value, sizeof(uint16_t));
 	//We already added offset to 'count' ^
 	chunk->count += sizeof(uint16_t);
+	chunk->is_verified = false;
 }
 
 void ChunkWriteDWORD(Chunk* chunk, DWORD value)
 {
-	uint64_t offset = (uint64_t)(chunk->code + chunk->count) % 4;
+	uint64_t offset = impl_chunk_padding(chunk->count, sizeof(uint32_t));
 	if (!(chunk->count + offset + sizeof(uint32_t) < chunk->capacity)) //Grow if needed
 		impl_chunk_grow_double(chunk);
 
-	//Set the padding bytes to CD on Debug build
-	DO_IF_DEBUG_BUILD(if (offset != 0) memset(chunk->code + chunk->count, 205, offset););
+	//The padding bytes are part of the serialized code, so they are always CD
+	if (offset != 0)
+		memset(chunk->code + chunk->count, 205, offset);
 
 	//Copy the bytes of the integer to the aligned memory
 	memcpy(chunk->code + (chunk->count += offset), &value, sizeof(uint32_t));
 	//We already added offset to 'count' ^
 	chunk->count += sizeof(uint32_t);
+	chunk->is_verified = false;
 }
 
 void ChunkWriteQWORD(Chunk* chunk, QWORD value)
 {
-	uint64_t offset = (uint64_t)(chunk->code + chunk->count) % 8;
+	uint64_t offset = impl_chunk_padding(chunk->count, sizeof(uint64_t));
 	if (!(chunk->count + offset + sizeof(uint64_t) < chunk->capacity)) //Grow if needed
 		impl_chunk_grow_double(chunk);
 
-	//Set the padding bytes to CD on Debug build
-	DO_IF_DEBUG_BUILD(if (offset != 0) memset(chunk->code + chunk->count, 205, offset););
+	//The padding bytes are part of the serialized code, so they are always CD
+	if (offset != 0)
+		memset(chunk->code + chunk->count, 205, offset);
 
 	//Copy the bytes of the integer to the aligned memory
 	memcpy(chunk->code + (chunk->count += offset), &value, sizeof(uint64_t));
 	//We already added offset to 'count' ^
 	chunk->count += sizeof(uint64_t);
+	chunk->is_verified = false;
+}
+
+bool ChunkAddConstant(Chunk* chunk, QWORD value, uint16_t* index)
+{
+	colti_assert(chunk->mapping.ptr == NULL, "Cannot write to a mapped Chunk!");
+	if (chunk->constant_table == NULL && chunk->constant_count != 0)
+		impl_chunk_build_constant_table(chunk); //The table is not serialized
+
+	//Look for an existing constant with the same bits
+	if (chunk->constant_table != NULL)
+	{
+		uint64_t mask = 2 * chunk->constant_capacity - 1;
+		for (uint64_t slot = impl_chunk_hash_constant(value) & mask;
+			chunk->constant_table[slot] != 0; slot = (slot + 1) & mask)
+		{
+			uint32_t existing = chunk->constant_table[slot] - 1;
+			if (chunk->constants[existing].ui64 == value.ui64)
+			{
+				*index = (uint16_t)existing;
+				return true;
+			}
+		}
+	}
+	if (chunk->constant_count == CHUNK_CONSTANT_POOL_MAX_SIZE)
+		return false;
+
+	if (chunk->constant_count == chunk->constant_capacity) //Grow if needed
+		impl_chunk_grow_constants(chunk);
+	
+	//Insert the new constant in the table
+	uint64_t mask = 2 * chunk->constant_capacity - 1;
+	uint64_t slot = impl_chunk_hash_constant(value) & mask;
+	while (chunk->constant_table[slot] != 0)
+		slot = (slot + 1) & mask;
+	chunk->constant_table[slot] = (uint32_t)chunk->constant_count + 1;
+	//The Divisor table no longer matches the pool: it is rebuilt by ChunkVerify
+	if (chunk->divisors != NULL)
+	{
+		safe_free(chunk->divisors);
+		chunk->divisors = NULL;
+	}
+
+	*index = (uint16_t)chunk->constant_count;
+	chunk->constants[chunk->constant_count++] = value;
+	return true;
+}
+
+void ChunkWriteConstant(Chunk* chunk, QWORD value)
+{
+	//Small values are cheaper to encode as immediates
+	if (value.ui64 <= UINT8_MAX)
+	{
+		ChunkWriteOpCode(chunk, OP_IMMEDIATE_BYTE);
+		ChunkWriteBYTE(chunk, value.byte);
+		return;
+	}
+	if (value.ui64 <= UINT16_MAX)
+	{
+		ChunkWriteOpCode(chunk, OP_IMMEDIATE_WORD);
+		ChunkWriteWORD(chunk, value.word);
+		return;
+	}
+	if (value.ui64 <= UINT32_MAX)
+	{
+		ChunkWriteOpCode(chunk, OP_IMMEDIATE_DWORD);
+		ChunkWriteDWORD(chunk, value.dword);
+		return;
+	}
+
+	//An immediate QWORD takes up to 16 bytes, while a pooled one takes 2 to 4 bytes
+	uint16_t index;
+	if (!ChunkAddConstant(chunk, value, &index))
+	{
+		ChunkWriteOpCode(chunk, OP_IMMEDIATE_QWORD);
+		ChunkWriteQWORD(chunk, value);
+	}
+	else if (index <= UINT8_MAX)
+	{
+		ChunkWriteOpCode(chunk, OP_LOAD_CONST_BYTE);
+		BYTE byte = { .ui8 = (uint8_t)index };
+		ChunkWriteBYTE(chunk, byte);
+	}
+	else
+	{
+		ChunkWriteOpCode(chunk, OP_LOAD_CONST_WORD);
+		WORD word = { .ui16 = index };
+		ChunkWriteWORD(chunk, word);
+	}
+}
+
+void ChunkWriteConvert(Chunk* chunk, OperandType from, OperandType to)
+{
+	OpCode code = ConvertGetOpCode(from, to);
+	ChunkWriteOpCode(chunk, code);
+	if (code != OP_CONVERT)
+		return;
+	ChunkWriteOperand(chunk, from);
+	ChunkWriteOperand(chunk, to);
+}
+
+bool ChunkWriteDivideConstant(Chunk* chunk, OpCode code, OperandType type, QWORD divisor)
+{
+	colti_assert(code == OP_DIVIDE_CONST || code == OP_MODULO_CONST, "Expected OP_DIVIDE_CONST or OP_MODULO_CONST!");
+	colti_assert(type >= OPERAND_COLTI_UI8 && type <= OPERAND_COLTI_I64, "Expected an integer type!");
+	//The Divisor is computed from the 64-bit extension of the constant
+	bool is_signed = type >= OPERAND_COLTI_I8;
+	QWORD extended = ConvertGetKernel(type, is_signed ? OPERAND_COLTI_I64 : OPERAND_COLTI_UI64)(divisor);
+	uint16_t index;
+	if (!ChunkAddConstant(chunk, extended, &index))
+		return false;
+	ChunkWriteOpCode(chunk, code);
+	ChunkWriteOperand(chunk, type);
+	WORD word = { .ui16 = index };
+	ChunkWriteWORD(chunk, word);
+	return true;
+}
+
+void ChunkWriteLocal(Chunk* chunk, OpCode code, uint16_t slot)
+{
+	colti_assert(code == OP_LOAD_LOCAL_BYTE || code == OP_STORE_LOCAL_BYTE, "Expected OP_LOAD_LOCAL_BYTE or OP_STORE_LOCAL_BYTE!");
+	if (slot <= UINT8_MAX)
+	{
+		ChunkWriteOpCode(chunk, code);
+		BYTE byte = { .ui8 = (uint8_t)slot };
+		ChunkWriteBYTE(chunk, byte);
+		return;
+	}
+	//The WORD form follows the BYTE form
+	ChunkWriteOpCode(chunk, code + 1);
+	WORD word = { .ui16 = slot };
+	ChunkWriteWORD(chunk, word);
+}
+
+void ChunkWriteIncLocal(Chunk* chunk, OperandType type, uint16_t slot)
+{
+	if (slot <= UINT8_MAX)
+	{
+		ChunkWriteOpCode(chunk, OP_INC_LOCAL_BYTE);
+		ChunkWriteOperand(chunk, type);
+		BYTE byte = { .ui8 = (uint8_t)slot };
+		ChunkWriteBYTE(chunk, byte);
+		return;
+	}
+	ChunkWriteOpCode(chunk, OP_INC_LOCAL_WORD);
+	ChunkWriteOperand(chunk, type);
+	WORD word = { .ui16 = slot };
+	ChunkWriteWORD(chunk, word);
+}
+
+bool ChunkAddGlobal(Chunk* chunk, const Symbol* name, uint16_t* index)
+{
+	//The table is not serialized
+	if (chunk->global_table.count != chunk->global_count)
+	{
+		HashMapFree(&chunk->global_table);
+		for (uint64_t i = 0; i < chunk->global_count; i++)
+			HashMapInsert(&chunk->global_table, (uint64_t)chunk->globals[i], chunk->globals[i]->hash, i);
+	}
+	//Symbols are compared using their address
+	uint64_t existing;
+	if (HashMapFind(&chunk->global_table, (uint64_t)name, name->hash, &existing))
+	{
+		*index = (uint16_t)existing;
+		return true;
+	}
+	if (chunk->global_count == CHUNK_MAX_GLOBALS)
+		return false;
+
+	if (chunk->global_count == chunk->global_capacity) //Grow if needed
+	{
+		uint64_t new_capacity = chunk->global_capacity == 0 ? 8 : chunk->global_capacity * 2;
+		const Symbol** ptr = (const Symbol**)safe_malloc(new_capacity * sizeof(Symbol*));
+		if (chunk->globals != NULL)
+		{
+			memcpy(ptr, chunk->globals, chunk->global_count * sizeof(Symbol*));
+			safe_free(chunk->globals);
+		}
+		chunk->globals = ptr;
+		chunk->global_capacity = new_capacity;
+	}
+	HashMapInsertNew(&chunk->global_table, (uint64_t)name, name->hash, chunk->global_count);
+	*index = (uint16_t)chunk->global_count;
+	chunk->globals[chunk->global_count++] = name;
+	chunk->is_verified = false;
+	return true;
+}
+
+bool ChunkWriteGlobal(Chunk* chunk, OpCode code, const Symbol* name)
+{
+	colti_assert(code == OP_LOAD_GLOBAL || code == OP_STORE_GLOBAL, "Expected OP_LOAD_GLOBAL or OP_STORE_GLOBAL!");
+	uint16_t index;
+	if (!ChunkAddGlobal(chunk, name, &index))
+		return false;
+	ChunkWriteOpCode(chunk, code);
+	WORD word = { .ui16 = index };
+	ChunkWriteWORD(chunk, word);
+	return true;
+}
+
+uint64_t ChunkWriteEnter(Chunk* chunk, uint8_t arg_count, uint8_t local_count)
+{
+	colti_assert(arg_count <= local_count, "The arguments are local slots of the frame!");
+	uint64_t offset = chunk->count;
+	ChunkWriteOpCode(chunk, OP_ENTER);
+	BYTE byte = { .ui8 = arg_count };
+	ChunkWriteBYTE(chunk, byte);
+	byte.ui8 = local_count;
+	ChunkWriteBYTE(chunk, byte);
+	return offset;
+}
+
+uint64_t ChunkWriteCall(Chunk* chunk, OpCode code, uint32_t target)
+{
+	colti_assert(code == OP_CALL || code == OP_TAIL_CALL, "Expected OP_CALL or OP_TAIL_CALL!");
+	ChunkWriteOpCode(chunk, code);
+	DWORD dword = { .ui32 = target };
+	ChunkWriteDWORD(chunk, dword);
+	//The target is the last operand of the instruction
+	return chunk->count - sizeof(uint32_t);
+}
+
+void ChunkPatchTarget(Chunk* chunk, uint64_t target_offset, uint32_t target)
+{
+	colti_assert(chunk->mapping.ptr == NULL, "Cannot write to a mapped Chunk!");
+	colti_assert(target_offset + sizeof(uint32_t) <= chunk->count, "Invalid target offset!");
+	memcpy(chunk->code + target_offset, &target, sizeof(uint32_t));
+	chunk->is_verified = false;
+}
+
+uint64_t ChunkWriteJump(Chunk* chunk, OpCode code, OperandType type)
+{
+	OpCodeLayout layout = OpCodeGetLayout(code);
+	colti_assert(layout == LAYOUT_JUMP || layout == LAYOUT_TYPE_JUMP, "Expected a forward jump OpCode!");
+	uint64_t offset = chunk->count;
+	ChunkWriteOpCode(chunk, code);
+	if (layout == LAYOUT_TYPE_JUMP)
+		ChunkWriteOperand(chunk, type);
+	//An offset of 0 is rejected by the verifier until the jump is patched
+	DWORD dword = { .i32 = 0 };
+	ChunkWriteDWORD(chunk, dword);
+	return offset;
+}
+
+bool ChunkPatchJump(Chunk* chunk, uint64_t jump, uint64_t target)
+{
+	colti_assert(chunk->mapping.ptr == NULL, "Cannot write to a mapped Chunk!");
+	//Checked in every build, as the offset of the jump operand is decoded from the code
+	Instruction instr;
+	if (!ChunkDecodeInstruction(chunk, jump, &instr)
+		|| (OpCodeGetLayout(instr.code) != LAYOUT_JUMP && OpCodeGetLayout(instr.code) != LAYOUT_TYPE_JUMP))
+	{
+		print_error_format("Invalid jump offset %"PRIu64"!", jump);
+		return false;
+	}
+	if (target <= jump || target - jump > INT32_MAX)
+	{
+		print_error_format("Invalid jump target %"PRIu64"!", target);
+		return false;
+	}
+	//The jump offset is the last operand of the instruction
+	int32_t relative = (int32_t)(target - jump);
+	memcpy(chunk->code + jump + instr.size - sizeof(int32_t), &relative, sizeof(int32_t));
+	chunk->is_verified = false;
+	return true;
+}
+
+uint32_t ChunkWriteLoop(Chunk* chunk, uint64_t target)
+{
+	uint64_t offset = chunk->count;
+	colti_assert(target <= offset && offset - target <= INT32_MAX, "Invalid loop target!");
+	colti_assert(chunk->loop_count < UINT32_MAX, "Too many loops!");
+	uint32_t counter = (uint32_t)chunk->loop_count++;
+	//The counters are reallocated by ChunkVerify, as the divisors
+	if (chunk->loop_counters != NULL)
+	{
+		safe_free(chunk->loop_counters);
+		chunk->loop_counters = NULL;
+	}
+	ChunkWriteOpCode(chunk, OP_LOOP);
+	DWORD dword = { .ui32 = counter };
+	ChunkWriteDWORD(chunk, dword);
+	dword.i32 = -(int32_t)(offset - target);
+	ChunkWriteDWORD(chunk, dword);
+	return counter;
+}
+
+uint32_t ChunkWriteAddDynamic(Chunk* chunk)
+{
+	colti_assert(chunk->cache_count < UINT32_MAX, "Too many dynamically typed instructions!");
+	uint32_t cache = (uint32_t)chunk->cache_count++;
+	//The caches are reallocated by ChunkVerify, as the loop counters
+	if (chunk->inline_caches != NULL)
+	{
+		safe_free(chunk->inline_caches);
+		chunk->inline_caches = NULL;
+	}
+	ChunkWriteOpCode(chunk, OP_ADD_DYNAMIC);
+	DWORD dword = { .ui32 = cache };
+	ChunkWriteDWORD(chunk, dword);
+	return cache;
+}
+
+uint64_t ChunkWriteJumpTable(Chunk* chunk, uint32_t case_count)
+{
+	colti_assert(case_count < UINT32_MAX, "Too many cases!");
+	uint64_t offset = chunk->count;
+	ChunkWriteOpCode(chunk, OP_JUMP_TABLE);
+	DWORD dword = { .ui32 = case_count };
+	ChunkWriteDWORD(chunk, dword);
+	//The default case follows the cases
+	dword.i32 = 0;
+	for (uint64_t i = 0; i <= case_count; i++)
+		ChunkWriteDWORD(chunk, dword);
+	return offset;
+}
+
+bool ChunkPatchJumpTable(Chunk* chunk, uint64_t table, uint32_t index, uint64_t target)
+{
+	colti_assert(chunk->mapping.ptr == NULL, "Cannot write to a mapped Chunk!");
+	//Checked in every build, as the offsets of the table are decoded from the code
+	Instruction instr;
+	if (!ChunkDecodeInstruction(chunk, table, &instr) || instr.code != OP_JUMP_TABLE)
+	{
+		print_error_format("Invalid jump table offset %"PRIu64"!", table);
+		return false;
+	}
+	if (index > instr.index)
+	{
+		print_error_format("Invalid case index %"PRIu32"!", index);
+		return false;
+	}
+	if (target <= table || target - table > INT32_MAX)
+	{
+		print_error_format("Invalid jump target %"PRIu64"!", target);
+		return false;
+	}
+	int32_t relative = (int32_t)(target - table);
+	memcpy(chunk->code + (instr.table - chunk->code) + index * sizeof(int32_t), &relative, sizeof(int32_t));
+	chunk->is_verified = false;
+	return true;
+}
+
+bool ChunkFindHotLoop(const Chunk* chunk, uint64_t threshold, uint64_t* offset)
+{
+	colti_assert(chunk->is_verified, "The Chunk should be verified!");
+	if (chunk->loop_counters == NULL)
+		return false;
+	bool is_found = false;
+	uint64_t hottest = 0;
+	Instruction instr;
+	for (uint64_t i = 0; i < chunk->count; i += instr.size)
+	{
+		if (chunk->encoding == CHUNK_ENCODING_COMPACT)
+			CompactDecodeInstruction(chunk, i, &instr);
+		else
+			ChunkDecodeInstruction(chunk, i, &instr);
+		if (instr.code != OP_LOOP)
+			continue;
+		uint64_t count = chunk->loop_counters[instr.index];
+		if (count >= threshold && (!is_found || count > hottest))
+		{
+			is_found = true;
+			hottest = count;
+			*offset = i;
+		}
+	}
+	return is_found;
+}
+
+void ChunkSetSourceLocation(Chunk* chunk, SourceLocation location)
+{
+	colti_assert(chunk->mapping.ptr == NULL, "Cannot write to a mapped Chunk!");
+	DebugInfoAdd(&chunk->debug_info, chunk->count, location);
+}
+
+bool ChunkGetSourceLocation(const Chunk* chunk, uint64_t offset, SourceLocation* location)
+{
+	return DebugInfoFind(&chunk->debug_info, offset, location);
 }
 
 BYTE ChunkGetBYTE(const Chunk* chunk, uint64_t* offset)
@@ -106,7 +517,7 @@ WORD ChunkGetWORD(const Chunk* chunk, uint64_t* offset)
 	//As the offset points to OP_IMMEDIATE_WORD, we also need to add 1
 	uint64_t local_offset = *offset + 1;
 	//We add the padding to the offset, which means we are now pointing to the int16
-	local_offset += ((uint64_t)(chunk->code + local_offset) & 1);
+	local_offset += impl_chunk_padding(local_offset, sizeof(int16_t));
 
 	//Extract the int16 from the bytes
 	WORD return_val = { .ui16 = *(int16_t*)(chunk->code + local_offset) };
@@ -123,7 +534,7 @@ DWORD ChunkGetDWORD(const Chunk* chunk, uint64_t* offset)
 	//As the offset points to OP_IMMEDIATE_DWORD, we also need to add 1
 	uint64_t local_offset = *offset + 1;
 	//We add the padding to the offset, which means we are now pointing to the int32
-	local_offset += (uint64_t)(chunk->code + local_offset) % 4;
+	local_offset += impl_chunk_padding(local_offset, sizeof(int32_t));
 
 
 	DWORD return_val;
@@ -141,7 +552,7 @@ QWORD ChunkGetQWORD(const Chunk* chunk, uint64_t* offset)
 	//As the offset points to OP_IMMEDIATE_QWORD, we also need to add 1
 	uint64_t local_offset = *offset + 1;
 	//We add the padding to the offset, which means we are now pointing to the int64
-	local_offset += (uint64_t)(chunk->code + local_offset) % 8;
+	local_offset += impl_chunk_padding(local_offset, sizeof(int64_t));
 
 	QWORD return_val;
 	return_val.ui64 = *(int64_t*)(chunk->code + local_offset);
@@ -150,9 +561,209 @@ QWORD ChunkGetQWORD(const Chunk* chunk, uint64_t* offset)
 	return return_val;
 }
 
+uint16_t ChunkGetConstantIndex(const Chunk* chunk, uint64_t* offset)
+{
+	colti_assert(chunk->code[*offset] == OP_LOAD_CONST_BYTE || chunk->code[*offset] == OP_LOAD_CONST_WORD,
+		"'offset' should point to an OP_LOAD_CONST_BYTE or OP_LOAD_CONST_WORD!");
+	
+	if (chunk->code[(*offset)++] == OP_LOAD_CONST_BYTE)
+		return chunk->code[(*offset)++];
+	
+	//We add the padding to the offset, which means we are now pointing to the int16
+	uint64_t local_offset = *offset + impl_chunk_padding(*offset, sizeof(uint16_t));
+	uint16_t return_val = *(uint16_t*)(chunk->code + local_offset);
+	//Update the value of the offset
+	*offset = local_offset + sizeof(uint16_t);
+	return return_val;
+}
+
+bool ChunkDecodeInstruction(const Chunk* chunk, uint64_t offset, Instruction* instr)
+{
+	colti_assert(chunk->encoding == CHUNK_ENCODING_ALIGNED, "Chunk should use the aligned encoding!");
+	if (offset >= chunk->count)
+		return false;
+	
+	instr->code = chunk->code[offset];
+	instr->immediate.ui64 = 0;
+	instr->index = 0;
+	instr->table = NULL;
+	OpCodeLayout layout = OpCodeGetLayout(chunk->code[offset]);
+	//Size of the operands, which follow the OpCode, and their alignment
+	uint64_t size = 0;
+	uint64_t alignment = 1;
+	uint64_t local_offset = offset + 1;
+	switch (layout)
+	{
+	break; case LAYOUT_NONE:
+	break; case LAYOUT_TYPE:
+	case LAYOUT_QUICKENED:
+		size = 1;
+	break; case LAYOUT_TWO_TYPES:
+		size = 2;
+	break; case LAYOUT_BYTE:
+		size = sizeof(uint8_t);
+	break; case LAYOUT_TWO_BYTES:
+		size = 2;
+	break; case LAYOUT_WORD:
+		alignment = size = sizeof(uint16_t);
+	break; case LAYOUT_DWORD:
+		alignment = size = sizeof(uint32_t);
+	break; case LAYOUT_QWORD:
+		alignment = size = sizeof(uint64_t);
+	break; case LAYOUT_TYPE_WORD:
+		//The OperandType precedes the (aligned) WORD
+		if (local_offset >= chunk->count)
+			return false;
+		instr->types[0] = chunk->code[local_offset++];
+		alignment = size = sizeof(uint16_t);
+	break; case LAYOUT_TYPE_BYTE:
+		if (local_offset >= chunk->count)
+			return false;
+		instr->types[0] = chunk->code[local_offset++];
+		size = sizeof(uint8_t);
+	break; case LAYOUT_TARGET:
+	case LAYOUT_JUMP:
+		alignment = size = sizeof(uint32_t);
+	break; case LAYOUT_TYPE_JUMP:
+		if (local_offset >= chunk->count)
+			return false;
+		instr->types[0] = chunk->code[local_offset++];
+		alignment = size = sizeof(uint32_t);
+	break; case LAYOUT_LOOP:
+		//The counter index and the jump offset are both aligned DWORDs
+		alignment = sizeof(uint32_t);
+		size = 2 * sizeof(uint32_t);
+	break; case LAYOUT_JUMP_TABLE:
+	{
+		//The case count precedes the offsets, which include the default case
+		local_offset += impl_chunk_padding(local_offset, sizeof(uint32_t));
+		if (local_offset + sizeof(uint32_t) > chunk->count)
+			return false;
+		uint32_t case_count;
+		memcpy(&case_count, chunk->code + local_offset, sizeof(uint32_t));
+		local_offset += sizeof(uint32_t);
+		instr->index = case_count;
+		size = ((uint64_t)case_count + 1) * sizeof(int32_t);
+	}
+	break; default:
+		return false;
+	}
+	//Immediates are aligned on their size
+	local_offset += impl_chunk_padding(local_offset, alignment);
+	if (local_offset + size > chunk->count)
+		return false;
+
+	switch (layout)
+	{
+	break; case LAYOUT_TYPE:
+	case LAYOUT_QUICKENED:
+		instr->types[0] = chunk->code[local_offset];
+	break; case LAYOUT_TWO_TYPES:
+		instr->types[0] = chunk->code[local_offset];
+		instr->types[1] = chunk->code[local_offset + 1];
+	break; case LAYOUT_TWO_BYTES:
+		instr->immediate.ui64 = chunk->code[local_offset] | ((uint64_t)chunk->code[local_offset + 1] << 8);
+	break; case LAYOUT_BYTE: case LAYOUT_WORD: case LAYOUT_DWORD: case LAYOUT_QWORD: case LAYOUT_TYPE_WORD: case LAYOUT_TYPE_BYTE: case LAYOUT_TARGET:
+		memcpy(&instr->immediate, chunk->code + local_offset, size);
+	break; case LAYOUT_JUMP: case LAYOUT_TYPE_JUMP:
+		instr->immediate.i64 = impl_chunk_jump_table_offset(chunk->code + local_offset, 0);
+	break; case LAYOUT_LOOP:
+		memcpy(&instr->index, chunk->code + local_offset, sizeof(uint32_t));
+		instr->immediate.i64 = impl_chunk_jump_table_offset(chunk->code + local_offset, 1);
+	break; case LAYOUT_JUMP_TABLE:
+		instr->table = chunk->code + local_offset;
+		instr->immediate.i64 = impl_chunk_jump_table_offset(instr->table, instr->index);
+	break; default:
+		break;
+	}
+	instr->size = local_offset + size - offset;
+	return true;
+}
+
+void ChunkWriteInstruction(Chunk* chunk, const Instruction* instr)
+{
+	colti_assert(chunk->encoding == CHUNK_ENCODING_ALIGNED, "Chunk should use the aligned encoding!");
+	ChunkWriteOpCode(chunk, instr->code);
+	switch (OpCodeGetLayout(instr->code))
+	{
+	break; case LAYOUT_NONE:
+	break; case LAYOUT_TYPE:
+	case LAYOUT_QUICKENED: //The OperandType is the padding of the quickened OpCode
+		ChunkWriteOperand(chunk, instr->types[0]);
+	break; case LAYOUT_TWO_TYPES:
+		ChunkWriteOperand(chunk, instr->types[0]);
+		ChunkWriteOperand(chunk, instr->types[1]);
+	break; case LAYOUT_BYTE:
+		ChunkWriteBYTE(chunk, instr->immediate.byte);
+	break; case LAYOUT_TWO_BYTES:
+	{
+		BYTE high = { .ui8 = (uint8_t)(instr->immediate.ui64 >> 8) };
+		ChunkWriteBYTE(chunk, instr->immediate.byte);
+		ChunkWriteBYTE(chunk, high);
+	}
+	break; case LAYOUT_WORD:
+		ChunkWriteWORD(chunk, instr->immediate.word);
+	break; case LAYOUT_DWORD:
+	case LAYOUT_TARGET:
+		ChunkWriteDWORD(chunk, instr->immediate.dword);
+	break; case LAYOUT_QWORD:
+		ChunkWriteQWORD(chunk, instr->immediate);
+	break; case LAYOUT_TYPE_WORD:
+		ChunkWriteOperand(chunk, instr->types[0]);
+		ChunkWriteWORD(chunk, instr->immediate.word);
+	break; case LAYOUT_TYPE_BYTE:
+		ChunkWriteOperand(chunk, instr->types[0]);
+		ChunkWriteBYTE(chunk, instr->immediate.byte);
+	break; case LAYOUT_JUMP:
+		ChunkWriteDWORD(chunk, instr->immediate.dword);
+	break; case LAYOUT_TYPE_JUMP:
+		ChunkWriteOperand(chunk, instr->types[0]);
+		ChunkWriteDWORD(chunk, instr->immediate.dword);
+	break; case LAYOUT_LOOP:
+	{
+		DWORD counter = { .ui32 = instr->index };
+		ChunkWriteDWORD(chunk, counter);
+		ChunkWriteDWORD(chunk, instr->immediate.dword);
+	}
+	break; case LAYOUT_JUMP_TABLE:
+	{
+		DWORD dword = { .ui32 = instr->index };
+		ChunkWriteDWORD(chunk, dword);
+		for (uint64_t i = 0; i <= instr->index; i++)
+		{
+			dword.i32 = (int32_t)impl_chunk_jump_table_offset(instr->table, i);
+			ChunkWriteDWORD(chunk, dword);
+		}
+	}
+	break; default:
+		colti_assert(false, "Invalid OpCode!");
+	}
+}
+
 void ChunkFree(Chunk* chunk)
 {
-	safe_free(chunk->code);
+	//The code and constants of a mapped chunk are part of the mapping
+	if (chunk->mapping.ptr != NULL)
+		FileMappingClose(&chunk->mapping);
+	else
+	{
+		safe_free(chunk->code);
+		if (chunk->constants != NULL)
+			safe_aligned_free(chunk->constants);
+		DebugInfoFree(&chunk->debug_info);
+	}
+	if (chunk->constant_table != NULL)
+		safe_free(chunk->constant_table);
+	if (chunk->divisors != NULL)
+		safe_free(chunk->divisors);
+	if (chunk->loop_counters != NULL)
+		safe_free(chunk->loop_counters);
+	if (chunk->inline_caches != NULL)
+		safe_free(chunk->inline_caches);
+	//The Symbols are owned by the intern table
+	if (chunk->globals != NULL)
+		safe_free(chunk->globals);
+	HashMapFree(&chunk->global_table);
 
 	//Most functions that take a Chunk* check for if the capacity is 0,
 	//which should never be.
@@ -174,9 +785,32 @@ void ChunkSerialize(const Chunk* chunk, const char* path)
 		print_error_format("Could not create the file at path '%s'!", path);
 		exit(EXIT_OS_RESOURCE_FAILURE);
 	}
+	bool is_written = ChunkSerializeToStream(chunk, file);
+	if (fclose(file) != 0 || !is_written)
+	{
+		print_error_format("Could not write the file at path '%s'!", path);
+		exit(EXIT_OS_RESOURCE_FAILURE);
+	}
+}
+
+bool ChunkSerializeToStream(const Chunk* chunk, FILE* file)
+{
+	//The reserved bytes are written as zeros
+	ChunkFileHeader header = { CHUNK_FILE_MAGIC, CHUNK_FILE_VERSION, (uint16_t)chunk->encoding,
+		chunk->count, chunk->constant_count, chunk->debug_info.size, impl_chunk_globals_size(chunk), { 0 } };
+	bool is_written = fwrite(&header, sizeof(ChunkFileHeader), 1, file) == 1;
+	//Write the constants, which stay aligned as the header's size is CHUNK_CONSTANT_POOL_ALIGNMENT
+	if (chunk->constant_count != 0)
+		is_written &= fwrite(chunk->constants, sizeof(QWORD), chunk->constant_count, file) == chunk->constant_count;
 	//Write the binary code
-	fwrite(chunk->code, sizeof(char), chunk->count, file);
-	fclose(file);
+	is_written &= fwrite(chunk->code, sizeof(char), chunk->count, file) == chunk->count;
+	//Write the debug info, which is not needed to run the code
+	if (chunk->debug_info.size != 0)
+		is_written &= fwrite(chunk->debug_info.data, sizeof(uint8_t), chunk->debug_info.size, file) == chunk->debug_info.size;
+	//Write the names of the globals, which are interned when loading the chunk
+	for (uint64_t i = 0; i < chunk->global_count; i++)
+		is_written &= fwrite(chunk->globals[i]->name, sizeof(char), chunk->globals[i]->size + 1, file) == chunk->globals[i]->size + 1;
+	return is_written;
 }
 
 Chunk ChunkDeserialize(const char* path)
@@ -187,23 +821,93 @@ Chunk ChunkDeserialize(const char* path)
 		print_error_format("Could not open the file '%s'!", path);
 		exit(EXIT_OS_RESOURCE_FAILURE);
 	}
-	Chunk chunk;
 	fseek(file, 0L, SEEK_END);
 	size_t file_size = ftell(file); //Get file size
-	chunk.code = safe_malloc(chunk.capacity = file_size);
-	chunk.count = chunk.capacity;
-	
 	rewind(file); //Go back to the beginning of the file
-	size_t bytes_read = fread(chunk.code, sizeof(char), file_size, file);
+
+	ChunkFileHeader header;
+	if (file_size < sizeof(ChunkFileHeader) || fread(&header, sizeof(ChunkFileHeader), 1, file) != 1)
+	{
+		fclose(file);
+		print_error_format("The file '%s' is not a serialized chunk!", path);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	if (!impl_chunk_check_header(&header, file_size, path, false))
+	{
+		fclose(file);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+
+	Chunk chunk;
+	chunk.code = safe_malloc(chunk.capacity = header.code_size);
+	chunk.count = chunk.capacity;
+	chunk.encoding = (ChunkEncoding)header.encoding;
+	//Serialized chunks are verified before being run
+	chunk.is_verified = false;
+	chunk.max_stack_depth = 0;
+	chunk.local_count = 0;
+	chunk.operand_type = CHUNK_POLYMORPHIC;
+	chunk.constant_count = header.constant_count;
+	chunk.constant_capacity = 0;
+	chunk.constants = NULL;
+	chunk.constant_table = NULL; //Built only if constants are added
+	chunk.divisors = NULL; //Built by ChunkVerify
+	chunk.loop_count = 0; //Counted by ChunkVerify
+	chunk.loop_counters = NULL;
+	chunk.cache_count = 0; //Counted by ChunkVerify
+	chunk.inline_caches = NULL;
+	chunk.global_count = 0; //Interned once read
+	chunk.global_capacity = 0;
+	chunk.globals = NULL;
+	HashMapInit(&chunk.global_table);
+	chunk.mapping.ptr = NULL;
+	chunk.is_read_only = false;
+	chunk.is_quickening = false;
+	DebugInfoInit(&chunk.debug_info);
+	if (header.debug_info_size != 0)
+		chunk.debug_info.data = safe_malloc(chunk.debug_info.capacity = header.debug_info_size);
+	if (header.constant_count != 0)
+	{
+		//The capacity of the pool must be a power of 2 for the constant table
+		chunk.constant_capacity = CHUNK_CONSTANT_POOL_ALIGNMENT / sizeof(QWORD);
+		while (chunk.constant_capacity < header.constant_count)
+			chunk.constant_capacity *= 2;
+		chunk.constants = safe_aligned_malloc(chunk.constant_capacity * sizeof(QWORD), CHUNK_CONSTANT_POOL_ALIGNMENT);
+	}
+
+	size_t constants_read = header.constant_count == 0 ? 0
+		: fread(chunk.constants, sizeof(QWORD), header.constant_count, file);
+	size_t bytes_read = fread(chunk.code, sizeof(char), header.code_size, file);
+	size_t debug_info_read = header.debug_info_size == 0 ? 0
+		: fread(chunk.debug_info.data, sizeof(uint8_t), header.debug_info_size, file);
+	char* names = header.globals_size == 0 ? NULL : (char*)safe_malloc(header.globals_size);
+	size_t names_read = header.globals_size == 0 ? 0
+		: fread(names, sizeof(char), header.globals_size, file);
 	fclose(file);
-	if (bytes_read != file_size)
+	if (constants_read != header.constant_count || bytes_read != header.code_size
+		|| debug_info_read != header.debug_info_size || names_read != header.globals_size)
 	{
 		print_error_format("Could not read all the file's (at path '%s') content!", path);
 		exit(EXIT_OS_RESOURCE_FAILURE);
 	}
+	bool is_valid = impl_chunk_intern_globals(&chunk, names, header.globals_size);
+	if (names != NULL)
+		safe_free(names);
+	if (!is_valid)
+	{
+		print_error_format("The file '%s' is corrupted!", path);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	chunk.debug_info.size = header.debug_info_size;
+	impl_debug_info_restore_last(&chunk.debug_info);
 	return chunk;
 }
 
+bool ChunkMap(Chunk* chunk, const char* path)
+{
+	return impl_chunk_map(chunk, path, false);
+}
+
 BYTE unsafe_get_byte(uint8_t** ptr)
 {
 	BYTE return_val;
@@ -214,16 +918,16 @@ BYTE unsafe_get_byte(uint8_t** ptr)
 
 WORD unsafe_get_word(uint8_t** ptr)
 {
-	*ptr += (uint64_t)(*ptr) & 1; //read past padding
+	*ptr += impl_chunk_padding((uint64_t)(*ptr), sizeof(uint16_t)); //read past padding
 	WORD return_val;
 	return_val.ui16 = *((uint16_t*)*ptr);
-	*ptr += sizeof(int32_t);
+	*ptr += sizeof(int16_t);
 	return return_val;
 }
 
 DWORD unsafe_get_dword(uint8_t** ptr)
 {
-	*ptr += (uint64_t)(*ptr) % 4; //read past padding
+	*ptr += impl_chunk_padding((uint64_t)(*ptr), sizeof(uint32_t)); //read past padding
 	DWORD return_val;
 	return_val.ui32 = *((uint32_t*)*ptr);
 	*ptr += sizeof(int32_t);
@@ -232,15 +936,277 @@ DWORD unsafe_get_dword(uint8_t** ptr)
 
 QWORD unsafe_get_qword(uint8_t** ptr)
 {
-	*ptr += (uint64_t)(*ptr) % 8; //read past padding
+	*ptr += impl_chunk_padding((uint64_t)(*ptr), sizeof(uint64_t)); //read past padding
 	QWORD return_val;
 	return_val.ui64 = *((uint64_t*)*ptr);
 	*ptr += sizeof(int64_t);
 	return return_val;
 }
 
+bool impl_chunk_map(Chunk* chunk, const char* path, bool is_quiet)
+{
+	if (!FileMappingOpen(&chunk->mapping, path))
+	{
+		if (!is_quiet)
+			print_error_format("Could not map the file '%s'!", path);
+		return false;
+	}
+	const ChunkFileHeader* header = (const ChunkFileHeader*)chunk->mapping.ptr;
+	if (chunk->mapping.size < sizeof(ChunkFileHeader) || !impl_chunk_check_header(header, chunk->mapping.size, path, is_quiet))
+	{
+		if (chunk->mapping.size < sizeof(ChunkFileHeader) && !is_quiet)
+			print_error_format("The file '%s' is not a serialized chunk!", path);
+		FileMappingClose(&chunk->mapping);
+		return false;
+	}
+
+	//The mapping is page aligned, and the header's size is CHUNK_CONSTANT_POOL_ALIGNMENT
+	QWORD* constants = (QWORD*)(chunk->mapping.ptr + sizeof(ChunkFileHeader));
+	chunk->constant_count = header->constant_count;
+	chunk->constant_capacity = header->constant_count;
+	chunk->constants = header->constant_count == 0 ? NULL : constants;
+	chunk->constant_table = NULL;
+	chunk->divisors = NULL;
+	//The counters and caches are not part of the mapping, which is read-only
+	chunk->loop_count = 0;
+	chunk->loop_counters = NULL;
+	chunk->cache_count = 0;
+	chunk->inline_caches = NULL;
+	chunk->is_read_only = true;
+	chunk->is_quickening = false;
+	chunk->global_count = 0;
+	chunk->global_capacity = 0;
+	chunk->globals = NULL;
+	HashMapInit(&chunk->global_table);
+	//The code stays aligned on 8 bytes, which the aligned encoding requires
+	chunk->code = (uint8_t*)(constants + header->constant_count);
+	chunk->count = header->code_size;
+	chunk->capacity = header->code_size;
+	chunk->encoding = (ChunkEncoding)header->encoding;
+	chunk->is_verified = false;
+	chunk->max_stack_depth = 0;
+	chunk->local_count = 0;
+	chunk->operand_type = CHUNK_POLYMORPHIC;
+	//The debug info follows the code
+	DebugInfoInit(&chunk->debug_info);
+	if (header->debug_info_size != 0)
+	{
+		chunk->debug_info.data = chunk->code + header->code_size;
+		chunk->debug_info.size = header->debug_info_size;
+		chunk->debug_info.capacity = header->debug_info_size;
+	}
+	//The names of the globals follow the debug info, and are resolved to Symbols once
+	const char* names = (const char*)chunk->code + header->code_size + header->debug_info_size;
+	if (!impl_chunk_intern_globals(chunk, names, header->globals_size))
+	{
+		if (!is_quiet)
+			print_error_format("The file '%s' is corrupted!", path);
+		ChunkFree(chunk);
+		return false;
+	}
+	return true;
+}
+
+bool impl_chunk_check_header(const ChunkFileHeader* header, uint64_t file_size, const char* path, bool is_quiet)
+{
+	if (header->magic != CHUNK_FILE_MAGIC)
+	{
+		if (!is_quiet)
+			print_error_format("The file '%s' is not a serialized chunk!", path);
+		return false;
+	}
+	if (header->version != CHUNK_FILE_VERSION)
+	{
+		if (!is_quiet)
+			print_error_format("The file '%s' was serialized using an unsupported version (%"PRIu16")!", path, header->version);
+		return false;
+	}
+	if (header->constant_count > CHUNK_CONSTANT_POOL_MAX_SIZE || header->code_size == 0
+		|| (header->encoding != CHUNK_ENCODING_ALIGNED && header->encoding != CHUNK_ENCODING_COMPACT)
+		|| header->debug_info_size > file_size || header->globals_size > file_size
+		|| file_size != sizeof(ChunkFileHeader) + header->constant_count * sizeof(QWORD) + header->code_size
+			+ header->debug_info_size + header->globals_size)
+	{
+		if (!is_quiet)
+			print_error_format("The file '%s' is corrupted!", path);
+		return false;
+	}
+	return true;
+}
+
+int64_t impl_chunk_jump_table_offset(const uint8_t* table, uint64_t index)
+{
+	//The offsets of the compact encoding are not aligned
+	int32_t relative;
+	memcpy(&relative, table + index * sizeof(int32_t), sizeof(int32_t));
+	return relative;
+}
+
+uint64_t impl_chunk_padding(uint64_t offset, uint64_t alignment)
+{
+	colti_assert((alignment & (alignment - 1)) == 0, "Alignment should be a power of 2!");
+	return (alignment - (offset & (alignment - 1))) & (alignment - 1);
+}
+
+uint64_t impl_chunk_hash_constant(QWORD value)
+{
+	//Fibonacci hashing: the high bits of the product depend on all the bits of the value
+	return (value.ui64 * 0x9E3779B97F4A7C15) >> 32;
+}
+
+void impl_chunk_grow_constants(Chunk* chunk)
+{
+	colti_assert(chunk->mapping.ptr == NULL, "Cannot write to a mapped Chunk!");
+	//Start with a cache line worth of constants
+	uint64_t new_capacity = chunk->constant_capacity == 0
+		? CHUNK_CONSTANT_POOL_ALIGNMENT / sizeof(QWORD) : chunk->constant_capacity * 2;
+	
+	QWORD* ptr = (QWORD*)safe_aligned_malloc(new_capacity * sizeof(QWORD), CHUNK_CONSTANT_POOL_ALIGNMENT);
+	if (chunk->constants != NULL)
+	{
+		memcpy(ptr, chunk->constants, chunk->constant_count * sizeof(QWORD));
+		safe_aligned_free(chunk->constants);
+	}
+	chunk->constants = ptr;
+	chunk->constant_capacity = new_capacity;
+	impl_chunk_build_constant_table(chunk);
+}
+
+void impl_chunk_build_constant_table(Chunk* chunk)
+{
+	if (chunk->constant_table != NULL)
+		safe_free(chunk->constant_table);
+	
+	//The table is kept at most half full
+	uint64_t table_capacity = 2 * chunk->constant_capacity;
+	colti_assert((table_capacity & (table_capacity - 1)) == 0, "Capacity of the constant table should be a power of 2!");
+	chunk->constant_table = (uint32_t*)safe_malloc(table_capacity * sizeof(uint32_t));
+	memset(chunk->constant_table, 0, table_capacity * sizeof(uint32_t));
+
+	uint64_t mask = table_capacity - 1;
+	for (uint64_t i = 0; i < chunk->constant_count; i++)
+	{
+		uint64_t slot = impl_chunk_hash_constant(chunk->constants[i]) & mask;
+		while (chunk->constant_table[slot] != 0)
+			slot = (slot + 1) & mask;
+		chunk->constant_table[slot] = (uint32_t)i + 1;
+	}
+}
+
+void impl_chunk_build_divisors(Chunk* chunk)
+{
+	if (chunk->divisors != NULL)
+		safe_free(chunk->divisors);
+	chunk->divisors = (Divisor*)safe_malloc(chunk->constant_count * sizeof(Divisor));
+	//Constants that are 0 cannot be divisors (which ChunkVerify checks)
+	for (uint64_t i = 0; i < chunk->constant_count; i++)
+	{
+		if (chunk->constants[i].ui64 != 0)
+			DivisorInit(chunk->divisors + i, chunk->constants[i]);
+		else
+			memset(chunk->divisors + i, 0, sizeof(Divisor));
+	}
+}
+
+void impl_chunk_build_loop_counters(Chunk* chunk)
+{
+	if (chunk->loop_counters != NULL)
+		safe_free(chunk->loop_counters);
+	chunk->loop_counters = (uint64_t*)safe_malloc(chunk->loop_count * sizeof(uint64_t));
+	memset(chunk->loop_counters, 0, chunk->loop_count * sizeof(uint64_t));
+}
+
+void impl_chunk_build_inline_caches(Chunk* chunk)
+{
+	if (chunk->inline_caches != NULL)
+		safe_free(chunk->inline_caches);
+	chunk->inline_caches = (InlineCache*)safe_malloc(chunk->cache_count * sizeof(InlineCache));
+	memset(chunk->inline_caches, 0, chunk->cache_count * sizeof(InlineCache));
+}
+
+uint64_t impl_chunk_count_inline_caches(const Chunk* chunk)
+{
+	uint64_t cache_count = 0;
+	Instruction instr;
+	for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+	{
+		bool is_valid = chunk->encoding == CHUNK_ENCODING_COMPACT
+			? CompactDecodeInstruction(chunk, offset, &instr) : ChunkDecodeInstruction(chunk, offset, &instr);
+		if (!is_valid)
+			break;
+		//An index that is not less than the size of the code is invalid, and rejected by the verifier
+		if (InlineCacheIsDynamicOpCode(instr.code) && instr.immediate.ui64 >= cache_count && instr.immediate.ui64 < chunk->count)
+			cache_count = instr.immediate.ui64 + 1;
+	}
+	return cache_count;
+}
+
+void impl_chunk_copy_source_locations(Chunk* to, DebugInfoIterator* iter, DebugEntry* next, uint64_t from_offset)
+{
+	//The entries are recorded at the start of instructions
+	while (next->offset <= from_offset)
+	{
+		ChunkSetSourceLocation(to, next->location);
+		if (!DebugInfoNext(iter, next))
+			next->offset = UINT64_MAX;
+	}
+}
+
+void impl_chunk_copy_constants(Chunk* to, const Chunk* from)
+{
+	colti_assert(to->constant_count == 0, "The constant pool should be empty!");
+	if (from->constant_count == 0)
+		return;
+	while (to->constant_capacity < from->constant_count)
+		impl_chunk_grow_constants(to);
+	memcpy(to->constants, from->constants, from->constant_count * sizeof(QWORD));
+	to->constant_count = from->constant_count;
+	impl_chunk_build_constant_table(to);
+}
+
+void impl_chunk_copy_globals(Chunk* to, const Chunk* from)
+{
+	colti_assert(to->global_count == 0, "The chunk should not have any global!");
+	uint16_t index;
+	for (uint64_t i = 0; i < from->global_count; i++)
+		ChunkAddGlobal(to, from->globals[i], &index);
+}
+
+uint64_t impl_chunk_globals_size(const Chunk* chunk)
+{
+	uint64_t size = 0;
+	for (uint64_t i = 0; i < chunk->global_count; i++)
+		size += chunk->globals[i]->size + 1;
+	return size;
+}
+
+bool impl_chunk_intern_globals(Chunk* chunk, const char* names, uint64_t size)
+{
+	colti_assert(chunk->global_count == 0, "The chunk should not have any global!");
+	if (size == 0)
+		return true;
+	if (names[size - 1] != '\0')
+		return false;
+	//Each name is NUL terminated
+	uint64_t count = 0;
+	for (uint64_t i = 0; i < size; i++)
+		count += names[i] == '\0';
+	if (count > CHUNK_MAX_GLOBALS)
+		return false;
+	chunk->globals = (const Symbol**)safe_malloc(count * sizeof(Symbol*));
+	chunk->global_capacity = count;
+	for (const char* name = names; chunk->global_count < count; chunk->global_count++)
+	{
+		uint64_t name_size = strlen(name);
+		chunk->globals[chunk->global_count] = SymbolIntern(name, name_size);
+		name += name_size + 1;
+	}
+	return true;
+}
+
 void impl_chunk_grow_double(Chunk* chunk)
 {
+	colti_assert(chunk->mapping.ptr == NULL, "Cannot write to a mapped Chunk!");
 	colti_assert(chunk->capacity != 0, "Chunk capacity was 0! Be sure to call ChunkInit for any Chunk you create!");
 
 	//Allocate double the capacity
@@ -254,6 +1220,7 @@ void impl_chunk_grow_double(Chunk* chunk)
 
 void impl_chunk_grow_size(Chunk* chunk, size_t size)
 {
+	colti_assert(chunk->mapping.ptr == NULL, "Cannot write to a mapped Chunk!");
 	colti_assert(size != 0, "Tried to augment the capacity of a Chunk by 0!");
 	colti_assert(chunk->capacity != 0, "Chunk capacity was 0! Be sure to call ChunkInit for any Chunk you create!");
 
@@ -272,4 +1239,5 @@ void impl_chunk_write_byte(Chunk* chunk, uint8_t byte)
 		impl_chunk_grow_double(chunk);
 	chunk->code[chunk->count] = byte;
 	++chunk->count;
+	chunk->is_verified = false;
 }
\ No newline at end of file
@@ -10,6 +10,32 @@
 * These take a pointer to an int representing the offset, as it's the functions responsibility
 * to update that offset.
 * The unsafe_get_... are used for when a pointer is used rather than an offset.
+* Wide constants can also be stored in the Chunk's constant pool, which is a
+* deduplicated array of QWORDs aligned on a cache line, loaded using OP_LOAD_CONST_(BYTE|WORD).
+* ChunkWriteConstant chooses the smallest encoding (immediate or pooled) of a value.
+* A serialized chunk can either be copied in memory (ChunkDeserialize), or mapped (ChunkMap)
+* in which case its code and constant pool point into the read-only mapping of the file.
+* Divisions by a constant of the pool (OP_DIVIDE_CONST, OP_MODULO_CONST) use the reciprocal of the
+* constant, which is precomputed in a Divisor table when the chunk is loaded and verified.
+* The source locations of the code are recorded in a DebugInfo side table (see ChunkSetSourceLocation),
+* which is serialized after the code.
+* Local variables are slots of the frame of the code, which the VM reserves (zero-initialized) below the values of the
+* stack: the compiler resolves each variable to a slot index, and ChunkVerify computes the number of slots of the frame.
+* Functions are written after the OP_RETURN of the code of the chunk, each starting with an OP_ENTER declaring its frame
+* (see ChunkWriteEnter): OP_CALL and OP_TAIL_CALL jump to the offset of that OP_ENTER, and can be written before
+* the function they call (see ChunkPatchTarget).
+* Branches are relative jumps, written before the code to which they jump and patched once it is written (see ChunkWriteJump):
+* an 'if' is an OP_JUMP_IF_FALSE (or a typed compare-and-branch such as OP_JUMP_IF_LESS, the greater-than forms swapping
+* the operands) over its body, and a 'switch' whose cases are dense an OP_JUMP_TABLE (a sparse one being a chain of OP_JUMP_IF_EQUAL).
+* The only backward jump is OP_LOOP (see ChunkWriteLoop), which increments the hotness counter of its loop: a tiering
+* mechanism can pick the loops to optimize using ChunkFindHotLoop.
+* Global variables are named by interned Symbols (see struct_symbol.h): ChunkWriteGlobal resolves the name of a global
+* to the index of its slot once, when writing the code, and OP_LOAD_GLOBAL/OP_STORE_GLOBAL only use that index.
+* The names of the slots are serialized after the debug info, and interned again when the chunk is loaded (the linker
+* merging the slots of the globals of the same name).
+* The dynamically typed instructions (see inline_cache.h) record the types they observe in the InlineCache of the
+* chunk indexed by their operand (see ChunkWriteAddDynamic), and the VM rewrites them to their specialized forms.
+* The VM can also quicken the typed instructions of a chunk, rewriting them to OpCodes implying their type (see quickening.h).
 */
 
 #ifndef HG_COLTI_CHUNK
@@ -17,6 +43,38 @@
 
 #include "common.h"
 #include "byte_code.h" //Contains the byte-code enum
+#include "file_mapping.h"
+#include "debug_info.h"
+#include "inline_cache.h"
+#include "structs/struct_symbol.h"
+
+/// @brief The alignment of the constant pool (a cache line)
+#define CHUNK_CONSTANT_POOL_ALIGNMENT 64
+/// @brief The maximum number of constants in the constant pool (indices are 16-bit)
+#define CHUNK_CONSTANT_POOL_MAX_SIZE 65536
+
+/// @brief The maximum number of global slots of a chunk (indices are 16-bit)
+#define CHUNK_MAX_GLOBALS 65536
+
+/// @brief The maximum stack depth that the code of a chunk can reach
+#define CHUNK_MAX_STACK_DEPTH 256
+
+/// @brief The value of 'Chunk.operand_type' when the typed instructions of the code do not all operate on the same type
+#define CHUNK_POLYMORPHIC 0xFF
+
+/// @brief The magic number at the beginning of serialized chunks ('COLT' in little endian)
+#define CHUNK_FILE_MAGIC 0x544C4F43
+/// @brief The version of the serialized chunk format, which should be incremented on any breaking change
+#define CHUNK_FILE_VERSION 5
+
+/// @brief The encoding of the code of a Chunk
+typedef enum
+{
+	/// @brief Each OpCode and OperandType takes a byte, and immediates are aligned (the default)
+	CHUNK_ENCODING_ALIGNED,
+	/// @brief OpCodes and OperandType are fused in a byte where possible, and immediates are LEB128 encoded
+	CHUNK_ENCODING_COMPACT,
+} ChunkEncoding;
 
 /// @brief Represents a stream of instructions
 typedef struct
@@ -25,11 +83,112 @@ typedef struct
 	uint64_t count;
 	/// @brief Capacity of the current allocated code_buffer
 	uint64_t capacity;
+	/// @brief The encoding of the code
+	ChunkEncoding encoding;
+	/// @brief True if the code was verified by ChunkVerify, reset when writing to the chunk
+	bool is_verified;
+	/// @brief The maximum stack depth needed to run the code, computed by ChunkVerify
+	uint64_t max_stack_depth;
+	/// @brief The number of local slots of the frame of the code (1 + the greatest slot index used), computed by ChunkVerify
+	uint64_t local_count;
+	/// @brief The OperandType on which every (reachable) typed instruction operates, inferred by ChunkVerify.
+	/// CHUNK_POLYMORPHIC if they operate on different types, or if there are none.
+	uint8_t operand_type;
 
 	/// @brief Pointer to the beginning of the byte-code
 	uint8_t* code;
+
+	/// @brief Number of constants in the constant pool
+	uint64_t constant_count;
+	/// @brief Capacity of the constant pool
+	uint64_t constant_capacity;
+	/// @brief The constant pool (aligned on CHUNK_CONSTANT_POOL_ALIGNMENT), NULL if empty
+	QWORD* constants;
+	/// @brief Open addressing table (of capacity 2 * constant_capacity) used to deduplicate constants.
+	/// Contains the index + 1 of the constants (0 being an empty slot), NULL if not built yet.
+	uint32_t* constant_table;
+	/// @brief The reciprocal of each constant (parallel to the constant pool), used by OP_DIVIDE_CONST and OP_MODULO_CONST.
+	/// Built by ChunkVerify if the code uses these OpCodes, NULL if not built yet.
+	Divisor* divisors;
+	/// @brief The number of hotness counters of the OP_LOOP of the code (incremented by ChunkWriteLoop, and
+	/// at least 1 + the greatest counter index used once verified)
+	uint64_t loop_count;
+	/// @brief The hotness counter of each loop, incremented by the VM each time the loop jumps back.
+	/// Allocated (zero-initialized) by ChunkVerify if the code contains loops, NULL if not allocated yet.
+	/// The increments are not atomic: the counts of a Chunk run by multiple threads are approximate.
+	uint64_t* loop_counters;
+	/// @brief The number of InlineCache of the dynamically typed instructions of the code (incremented by ChunkWriteAddDynamic,
+	/// and at least 1 + the greatest cache index used once verified)
+	uint64_t cache_count;
+	/// @brief The InlineCache of each dynamically typed instruction, updated by the VM when running it.
+	/// Allocated (zero-initialized) by ChunkVerify if the code contains such instructions, NULL if not allocated yet.
+	InlineCache* inline_caches;
+
+	/// @brief The number of global slots of the code
+	uint64_t global_count;
+	/// @brief The capacity of 'globals'
+	uint64_t global_capacity;
+	/// @brief The name of each global slot, NULL if there are none
+	const Symbol** globals;
+	/// @brief Maps the Symbol of each global to the index of its slot, used to resolve names when writing.
+	/// Not serialized: rebuilt by ChunkAddGlobal if it does not contain all the globals.
+	HashMap global_table;
+
+	/// @brief The side table mapping offsets of the code to source locations
+	DebugInfo debug_info;
+
+	/// @brief The mapping of the file containing the code and constant pool, if the chunk was
+	/// loaded using ChunkMap ('mapping.ptr' is NULL otherwise). A mapped chunk cannot be written to.
+	FileMapping mapping;
+	/// @brief True if the code cannot be modified (a mapped chunk, or a view of a mapped image, unless made copy-on-write
+	/// by ChunkEnableQuickening): the VM does not rewrite the dynamically typed instructions of such code
+	bool is_read_only;
+	/// @brief True if the VM rewrites each typed instruction of the code to its quickened form the first time it runs
+	/// (see ChunkEnableQuickening), false by default
+	bool is_quickening;
 } Chunk;
 
+/// @brief The header of a serialized chunk, followed by the constants, the code, the debug info, then the names of the globals.
+/// The header takes CHUNK_CONSTANT_POOL_ALIGNMENT bytes, so that the constant pool of a mapped chunk stays aligned.
+typedef struct
+{
+	/// @brief Should be CHUNK_FILE_MAGIC
+	uint32_t magic;
+	/// @brief Should be CHUNK_FILE_VERSION
+	uint16_t version;
+	/// @brief The ChunkEncoding of the code
+	uint16_t encoding;
+	/// @brief The number of bytes of code
+	uint64_t code_size;
+	/// @brief The number of QWORDs in the constant pool
+	uint64_t constant_count;
+	/// @brief The number of bytes of the DebugInfo table
+	uint64_t debug_info_size;
+	/// @brief The number of bytes of the names of the global slots (each name being NUL terminated)
+	uint64_t globals_size;
+	/// @brief Reserved for future use, should be zeros
+	uint8_t reserved[24];
+} ChunkFileHeader;
+
+/// @brief A decoded instruction, independent of the encoding of the Chunk
+typedef struct
+{
+	/// @brief The OpCode of the instruction
+	OpCode code;
+	/// @brief The OperandType (LAYOUT_TYPE, LAYOUT_TYPE_WORD, LAYOUT_TYPE_BYTE) or the 2 OperandType (LAYOUT_TWO_TYPES) following the OpCode
+	OperandType types[2];
+	/// @brief The zero-extended immediate (LAYOUT_BYTE to LAYOUT_QWORD, LAYOUT_TYPE_WORD, LAYOUT_TYPE_BYTE, LAYOUT_TARGET) following the OpCode.
+	/// The 2 BYTEs of LAYOUT_TWO_BYTES are 'immediate.ui8' and 'immediate.ui64 >> 8'.
+	/// The sign-extended jump offset of LAYOUT_JUMP, LAYOUT_TYPE_JUMP and LAYOUT_LOOP (the default offset for LAYOUT_JUMP_TABLE).
+	QWORD immediate;
+	/// @brief The counter index of LAYOUT_LOOP, or the case count of LAYOUT_JUMP_TABLE
+	uint32_t index;
+	/// @brief The 'index' + 1 jump offsets (unaligned int32) of LAYOUT_JUMP_TABLE, pointing into the code of the chunk
+	const uint8_t* table;
+	/// @brief The number of bytes taken by the encoded instruction (including any padding)
+	uint64_t size;
+} Instruction;
+
 /// @brief Prints the byte content of a Chunk
 /// @param chunk The chunk whose content to print
 void ChunkPrintBytes(const Chunk* chunk);
@@ -74,6 +233,145 @@ void ChunkWriteDWORD(Chunk* chunk, DWORD value);
 /// @param value The value to write
 void ChunkWriteQWORD(Chunk* chunk, QWORD value);
 
+/// @brief Adds a QWORD to the constant pool of a chunk, if it does not already contain it.
+/// Constants are compared using their bits.
+/// @param chunk The chunk whose pool to modify
+/// @param value The value to add
+/// @param index Pointer to where to write the index of the constant in the pool
+/// @return False if the pool is full (in which case 'index' is not modified)
+bool ChunkAddConstant(Chunk* chunk, QWORD value, uint16_t* index);
+
+/// @brief Appends the instruction pushing 'value' using its smallest encoding.
+/// Values that fit in 32 bits are written as immediates (which are zero-extended when pushed),
+/// while wider values are loaded from the constant pool (or written as an immediate QWORD if the pool is full).
+/// @param chunk The chunk to append to
+/// @param value The value to push
+void ChunkWriteConstant(Chunk* chunk, QWORD value);
+
+/// @brief Appends the instruction converting the top of the stack from a type to another,
+/// which is the specialized OP_CVT_* OpCode of the types if there is one, else OP_CONVERT.
+/// @param chunk The chunk to append to
+/// @param from The type of the value to convert
+/// @param to The type to which to convert
+void ChunkWriteConvert(Chunk* chunk, OperandType from, OperandType to);
+
+/// @brief Appends the instruction dividing the top of the stack (or computing the remainder of its division)
+/// by a constant, which is added to the constant pool.
+/// @param chunk The chunk to append to
+/// @param code OP_DIVIDE_CONST or OP_MODULO_CONST
+/// @param type The integer type of the dividend and divisor
+/// @param divisor The divisor, which must not be 0
+/// @return False if the pool is full (in which case nothing is appended)
+bool ChunkWriteDivideConstant(Chunk* chunk, OpCode code, OperandType type, QWORD divisor);
+
+/// @brief Appends the instruction loading or storing a local slot, using the BYTE form of the OpCode
+/// if the index fits in a byte, else its WORD form.
+/// @param chunk The chunk to append to
+/// @param code OP_LOAD_LOCAL_BYTE or OP_STORE_LOCAL_BYTE
+/// @param slot The index of the local slot
+void ChunkWriteLocal(Chunk* chunk, OpCode code, uint16_t slot);
+
+/// @brief Appends the instruction adding the top of the stack to a local slot (OP_INC_LOCAL_BYTE or OP_INC_LOCAL_WORD)
+/// @param chunk The chunk to append to
+/// @param type The type of the local and of the value to add
+/// @param slot The index of the local slot
+void ChunkWriteIncLocal(Chunk* chunk, OperandType type, uint16_t slot);
+
+/// @brief Returns the index of the global slot named 'name', adding a slot if the chunk does not contain it
+/// @param chunk The chunk whose globals to modify
+/// @param name The interned name of the global
+/// @param index Pointer to where to write the index of the slot
+/// @return False if the chunk already has CHUNK_MAX_GLOBALS slots (in which case 'index' is not modified)
+bool ChunkAddGlobal(Chunk* chunk, const Symbol* name, uint16_t* index);
+
+/// @brief Appends the instruction loading or storing a global, whose name is resolved to the index of its slot
+/// @param chunk The chunk to append to
+/// @param code OP_LOAD_GLOBAL or OP_STORE_GLOBAL
+/// @param name The interned name of the global
+/// @return False if the chunk has too many globals (in which case nothing is appended)
+bool ChunkWriteGlobal(Chunk* chunk, OpCode code, const Symbol* name);
+
+/// @brief Appends the OP_ENTER starting a function, which must follow an OP_RETURN or an OP_TAIL_CALL
+/// (the code preceding a function never runs into it)
+/// @param chunk The chunk to append to
+/// @param arg_count The number of arguments of the function
+/// @param local_count The number of local slots of the frame of the function, which is not less than 'arg_count'
+/// @return The offset of the function, which is the target of the calls to it
+uint64_t ChunkWriteEnter(Chunk* chunk, uint8_t arg_count, uint8_t local_count);
+
+/// @brief Appends the instruction calling a function
+/// @param chunk The chunk to append to
+/// @param code OP_CALL or OP_TAIL_CALL
+/// @param target The offset of the function (see ChunkWriteEnter), or 0 if it is not written yet
+/// @return The offset of the target in the code, used to patch it once the function is written (see ChunkPatchTarget)
+uint64_t ChunkWriteCall(Chunk* chunk, OpCode code, uint32_t target);
+
+/// @brief Rewrites the target of an instruction written before the function it calls
+/// @param chunk The chunk to modify
+/// @param target_offset The offset of the target (returned by ChunkWriteCall)
+/// @param target The offset of the function
+void ChunkPatchTarget(Chunk* chunk, uint64_t target_offset, uint32_t target);
+
+/// @brief Appends a forward jump, whose offset is patched once the code to which it jumps is written (see ChunkPatchJump)
+/// @param chunk The chunk to append to
+/// @param code OP_JUMP, OP_JUMP_IF_FALSE or a compare-and-branch OpCode (OP_JUMP_IF_LESS to OP_JUMP_IF_NOT_EQUAL)
+/// @param type The type of the operands of a compare-and-branch OpCode (ignored by the other OpCodes)
+/// @return The offset of the jump
+uint64_t ChunkWriteJump(Chunk* chunk, OpCode code, OperandType type);
+
+/// @brief Rewrites the offset of a forward jump (written by ChunkWriteJump)
+/// @param chunk The chunk to modify
+/// @param jump The offset of the jump
+/// @param target The offset of the instruction to which to jump, which follows the jump
+/// @return False (printing an error, and without modifying the chunk) if 'jump' is not a forward jump or 'target' is invalid
+bool ChunkPatchJump(Chunk* chunk, uint64_t jump, uint64_t target);
+
+/// @brief Appends the OP_LOOP jumping back to the beginning of a loop, using a new hotness counter
+/// @param chunk The chunk to append to
+/// @param target The offset of the first instruction of the loop (which is not after the OP_LOOP)
+/// @return The index of the hotness counter of the loop
+uint32_t ChunkWriteLoop(Chunk* chunk, uint64_t target);
+
+/// @brief Appends an OP_ADD_DYNAMIC, using a new InlineCache
+/// @param chunk The chunk to append to
+/// @return The index of the InlineCache of the instruction
+uint32_t ChunkWriteAddDynamic(Chunk* chunk);
+
+/// @brief Appends an OP_JUMP_TABLE, whose offsets are patched once the cases are written (see ChunkPatchJumpTable)
+/// @param chunk The chunk to append to
+/// @param case_count The number of cases (not counting the default case)
+/// @return The offset of the OP_JUMP_TABLE
+uint64_t ChunkWriteJumpTable(Chunk* chunk, uint32_t case_count);
+
+/// @brief Rewrites an offset of an OP_JUMP_TABLE (written by ChunkWriteJumpTable)
+/// @param chunk The chunk to modify
+/// @param table The offset of the OP_JUMP_TABLE
+/// @param index The index of the case, the case count being the default case
+/// @param target The offset of the first instruction of the case, which follows the OP_JUMP_TABLE
+/// @return False (printing an error, and without modifying the chunk) if 'table' is not an OP_JUMP_TABLE, or 'index' or 'target' is invalid
+bool ChunkPatchJumpTable(Chunk* chunk, uint64_t table, uint32_t index, uint64_t target);
+
+/// @brief Finds the hottest loop of a (verified) chunk, whose hotness counter reached a threshold.
+/// This is used by tiering to pick the loops to optimize, whose counters can then be reset.
+/// @param chunk The chunk containing the loops
+/// @param threshold The minimum number of iterations of the loop
+/// @param offset Pointer to where to write the offset of the OP_LOOP of the loop
+/// @return False if no loop reached 'threshold' (in which case 'offset' is not modified)
+bool ChunkFindHotLoop(const Chunk* chunk, uint64_t threshold, uint64_t* offset);
+
+/// @brief Records that the instructions appended after this call were emitted for 'location'.
+/// This should be called by the emitter before writing the instructions of each source location.
+/// @param chunk The chunk to modify
+/// @param location The source location of the next instructions
+void ChunkSetSourceLocation(Chunk* chunk, SourceLocation location);
+
+/// @brief Finds the source location of the instruction at 'offset', using the DebugInfo of the chunk
+/// @param chunk The chunk containing the instruction
+/// @param offset The offset of the instruction
+/// @param location Pointer to where to write the location
+/// @return False if the chunk contains no location for the instruction
+bool ChunkGetSourceLocation(const Chunk* chunk, uint64_t offset, SourceLocation* location);
+
 /// @brief Gets a byte from the offset specified
 /// @param chunk The chunk to get the value from
 /// @param offset The offset should point to the OP_IMMEDIATE_BYTE, is modified by this function
@@ -98,6 +396,25 @@ DWORD ChunkGetDWORD(const Chunk* chunk, uint64_t* offset);
 /// @return The quad word at that offset
 QWORD ChunkGetQWORD(const Chunk* chunk, uint64_t* offset);
 
+/// @brief Gets the index of a constant from the offset specified, aligning the access
+/// @param chunk The chunk to get the value from
+/// @param offset The offset should point to the OP_LOAD_CONST_BYTE or OP_LOAD_CONST_WORD, is modified by this function
+/// @return The index of the constant in the constant pool
+uint16_t ChunkGetConstantIndex(const Chunk* chunk, uint64_t* offset);
+
+/// @brief Decodes the instruction at 'offset' of an aligned chunk, checking that it is valid and complete.
+/// The OperandType following the OpCode are not checked.
+/// @param chunk The chunk containing the instruction
+/// @param offset The offset of the OpCode of the instruction
+/// @param instr Pointer to where to write the decoded instruction
+/// @return False if the OpCode is invalid or if the instruction is truncated
+bool ChunkDecodeInstruction(const Chunk* chunk, uint64_t offset, Instruction* instr);
+
+/// @brief Appends an instruction to the end of an aligned chunk
+/// @param chunk The chunk to append to
+/// @param instr The instruction to append ('size' is ignored)
+void ChunkWriteInstruction(Chunk* chunk, const Instruction* instr);
+
 /// @brief Frees memory used by a chunk
 /// @param chunk The chunk to free
 void ChunkFree(Chunk* chunk);
@@ -107,16 +424,32 @@ void ChunkFree(Chunk* chunk);
 /// @param more_byte_capacity The count of bytes to add to the capacity
 void ChunkReserve(Chunk* chunk, size_t more_byte_capacity);
 
-/// @brief Serializes a chunk to a file
+/// @brief Serializes a chunk (its code and constant pool) to a file
 /// @param chunk The chunk to serialize
 /// @param path The path to the file to which to serialize
 void ChunkSerialize(const Chunk* chunk, const char* path);
 
-/// @brief De-serializes a chunk from a file
+/// @brief Serializes a chunk to an open (binary) stream, in the format of ChunkSerialize
+/// @param chunk The chunk to serialize
+/// @param file The stream to which to write
+/// @return False if the chunk could not be completely written
+bool ChunkSerializeToStream(const Chunk* chunk, FILE* file);
+
+/// @brief De-serializes a chunk from a file written by ChunkSerialize.
+/// Terminates if the file is not a valid serialized chunk.
 /// @param path The path to the file from which to de-serialize
 /// @return The de-serialized chunk
 Chunk ChunkDeserialize(const char* path);
 
+/// @brief Maps a chunk serialized by ChunkSerialize in memory, rather than copying it.
+/// The code and constant pool of the resulting chunk point into the read-only mapping of the file,
+/// whose pages are shared by all the chunks (in any thread or process) mapping the same file.
+/// The chunk can be verified and run, but not written to, and should be freed using ChunkFree.
+/// @param chunk The chunk to initialize
+/// @param path The path to the file to map
+/// @return False (printing an error) if the file could not be mapped or is not a valid serialized chunk
+bool ChunkMap(Chunk* chunk, const char* path);
+
 /**********************************
 IMPLEMENTATION HELPERS
 **********************************/
@@ -141,6 +474,94 @@ DWORD unsafe_get_dword(uint8_t** ptr);
 /// @return QWORD union representing the read word
 QWORD unsafe_get_qword(uint8_t** ptr);
 
+/// @brief Maps a serialized chunk in memory (see ChunkMap)
+/// @param chunk The chunk to initialize
+/// @param path The path to the file to map
+/// @param is_quiet True to not print an error if the file cannot be mapped (as for a miss of a ChunkCache)
+/// @return False if the file could not be mapped or is not a valid serialized chunk
+bool impl_chunk_map(Chunk* chunk, const char* path, bool is_quiet);
+
+/// @brief Checks the header of a serialized chunk, printing an error if it is invalid
+/// @param header The header to check
+/// @param file_size The size of the file containing the header
+/// @param path The path to the file containing the header
+/// @param is_quiet True to not print the error
+/// @return False if the header is invalid, or does not match the size of the file
+bool impl_chunk_check_header(const ChunkFileHeader* header, uint64_t file_size, const char* path, bool is_quiet);
+
+/// @brief Returns the jump offset at an index of the table of an OP_JUMP_TABLE
+/// @param table The table of the instruction (see Instruction.table)
+/// @param index The index of the case (the case count being the default case)
+/// @return The sign-extended jump offset
+int64_t impl_chunk_jump_table_offset(const uint8_t* table, uint64_t index);
+
+/// @brief Returns the number of padding bytes needed to align an offset
+/// @param offset The offset to align
+/// @param alignment The alignment (a power of 2)
+/// @return The padding to add to 'offset' so that it is a multiple of 'alignment'
+uint64_t impl_chunk_padding(uint64_t offset, uint64_t alignment);
+
+/// @brief Hashes a QWORD for the constant table
+/// @param value The value to hash
+/// @return The hash of the value
+uint64_t impl_chunk_hash_constant(QWORD value);
+
+/// @brief Doubles the capacity of the constant pool of a chunk, rebuilding its constant table
+/// @param chunk The chunk to modify
+void impl_chunk_grow_constants(Chunk* chunk);
+
+/// @brief (Re)builds the constant table of a chunk from its constant pool
+/// @param chunk The chunk to modify
+void impl_chunk_build_constant_table(Chunk* chunk);
+
+/// @brief (Re)builds the Divisor table of a chunk from its constant pool
+/// @param chunk The chunk to modify
+void impl_chunk_build_divisors(Chunk* chunk);
+
+/// @brief Allocates the (zero-initialized) hotness counters of the loops of a chunk, freeing the previous ones
+/// @param chunk The chunk to modify, whose 'loop_count' is not 0
+void impl_chunk_build_loop_counters(Chunk* chunk);
+
+/// @brief Allocates the (zero-initialized) InlineCache of the dynamically typed instructions of a chunk, freeing the previous ones
+/// @param chunk The chunk to modify, whose 'cache_count' is not 0
+void impl_chunk_build_inline_caches(Chunk* chunk);
+
+/// @brief Counts the InlineCache used by the dynamically typed instructions of a chunk, stopping at the first invalid instruction.
+/// The indices that are not less than the size of the code are ignored (as the code is not verified yet).
+/// @param chunk The chunk whose code to scan
+/// @return 1 + the greatest cache index used, 0 if there are no dynamically typed instructions
+uint64_t impl_chunk_count_inline_caches(const Chunk* chunk);
+
+/// @brief Copies the source locations of the instructions of a chunk up to 'from_offset' to the end of another chunk.
+/// This is used when re-encoding a chunk, before writing the re-encoded instruction at 'from_offset'.
+/// @param to The chunk to which to copy
+/// @param iter The iterator over the DebugInfo of the original chunk
+/// @param next Pointer to the next entry to copy (whose offset is UINT64_MAX if there are none), which is advanced
+/// @param from_offset The offset of the instruction in the original chunk
+void impl_chunk_copy_source_locations(Chunk* to, DebugInfoIterator* iter, DebugEntry* next, uint64_t from_offset);
+
+/// @brief Copies the constant pool of a chunk to another chunk whose pool is empty
+/// @param to The chunk to which to copy
+/// @param from The chunk from which to copy
+void impl_chunk_copy_constants(Chunk* to, const Chunk* from);
+
+/// @brief Copies the global slots of a chunk to another chunk which has no globals
+/// @param to The chunk to which to copy
+/// @param from The chunk from which to copy
+void impl_chunk_copy_globals(Chunk* to, const Chunk* from);
+
+/// @brief Returns the number of bytes taken by the serialized names of the globals of a chunk
+/// @param chunk The chunk whose globals to measure
+/// @return The sum of the sizes of the names, including their NUL terminators
+uint64_t impl_chunk_globals_size(const Chunk* chunk);
+
+/// @brief Interns the serialized names of the globals of a chunk (which has no globals yet), a slot per name
+/// @param chunk The chunk to modify
+/// @param names The NUL terminated names, one after the other
+/// @param size The number of bytes of 'names'
+/// @return False if 'names' does not end with a NUL terminator, or contains more than CHUNK_MAX_GLOBALS names
+bool impl_chunk_intern_globals(Chunk* chunk, const char* names, uint64_t size);
+
 /// @brief Doubles the capacity of a chunk
 /// @param chunk The chunk to modify
 void impl_chunk_grow_double(Chunk* chunk);
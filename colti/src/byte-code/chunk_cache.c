@@ -0,0 +1,148 @@
+/** @file chunk_cache.c
+* Contains the definitions of the functions declared in 'chunk_cache.h'
+*/
+
+#include "chunk_cache.h"
+
+#include <errno.h>
+
+#ifdef COLTI_WINDOWS
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+	#include <direct.h>
+	#include <process.h>
+#else
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+void ChunkCacheInit(ChunkCache* cache)
+{
+	cache->directory = impl_chunk_cache_find_directory();
+}
+
+void ChunkCacheFree(ChunkCache* cache)
+{
+	if (cache->directory != NULL)
+		safe_free(cache->directory);
+	cache->directory = NULL;
+}
+
+uint64_t ChunkCacheKey(const char* source, uint64_t size)
+{
+	//A new compiler (or chunk format) produces different keys for the same source
+	uint64_t seed = hashBytes(COLTI_VERSION_STRING, sizeof(COLTI_VERSION_STRING) - 1, CHUNK_FILE_VERSION);
+	return hashBytes(source, size, seed);
+}
+
+bool ChunkCacheLoad(const ChunkCache* cache, uint64_t key, Chunk* chunk)
+{
+	if (cache->directory == NULL)
+		return false;
+	char* path = impl_chunk_cache_path(cache, key, false);
+	//A missing or corrupted entry is a miss, which is not an error (the corrupted entry is replaced by the next store)
+	bool is_loaded = impl_chunk_map(chunk, path, true);
+	if (!is_loaded)
+		remove(path);
+	safe_free(path);
+	return is_loaded;
+}
+
+bool ChunkCacheStore(const ChunkCache* cache, uint64_t key, const Chunk* chunk)
+{
+	if (cache->directory == NULL)
+		return false;
+	char* temporary_path = impl_chunk_cache_path(cache, key, true);
+	FILE* file = fopen(temporary_path, "wb");
+	if (file == NULL)
+	{
+		safe_free(temporary_path);
+		return false;
+	}
+	bool is_stored = ChunkSerializeToStream(chunk, file);
+	is_stored &= fclose(file) == 0;
+
+	//Renaming replaces any existing entry atomically
+	char* path = impl_chunk_cache_path(cache, key, false);
+#ifdef COLTI_WINDOWS
+	is_stored = is_stored && MoveFileExA(temporary_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	is_stored = is_stored && rename(temporary_path, path) == 0;
+#endif
+	if (!is_stored)
+		remove(temporary_path);
+	safe_free(temporary_path);
+	safe_free(path);
+	return is_stored;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+char* impl_chunk_cache_find_directory()
+{
+#ifdef COLTI_WINDOWS
+	const char* base = getenv("LOCALAPPDATA");
+	const char* suffix = "\\colti";
+#else
+	//Follows the XDG base directory specification
+	const char* base = getenv("XDG_CACHE_HOME");
+	const char* suffix = "/colti";
+	if (base == NULL || base[0] == '\0')
+	{
+		base = getenv("HOME");
+		suffix = "/.cache/colti";
+	}
+#endif
+	if (base == NULL || base[0] == '\0')
+		return NULL;
+	size_t size = strlen(base) + strlen(suffix) + 1;
+	char* directory = (char*)safe_malloc(size);
+	snprintf(directory, size, "%s%s", base, suffix);
+
+	//Create the missing directories, from the outermost (only the last one has to succeed)
+	for (char* ptr = directory + 1; *ptr != '\0'; ptr++)
+	{
+		if (*ptr != '/' && *ptr != '\\')
+			continue;
+		char separator = *ptr;
+		*ptr = '\0';
+		impl_chunk_cache_make_directory(directory);
+		*ptr = separator;
+	}
+	if (!impl_chunk_cache_make_directory(directory))
+	{
+		safe_free(directory);
+		return NULL;
+	}
+	return directory;
+}
+
+bool impl_chunk_cache_make_directory(const char* path)
+{
+#ifdef COLTI_WINDOWS
+	return _mkdir(path) == 0 || errno == EEXIST;
+#else
+	return mkdir(path, 0755) == 0 || errno == EEXIST;
+#endif
+}
+
+char* impl_chunk_cache_path(const ChunkCache* cache, uint64_t key, bool is_temporary)
+{
+	//The temporary file is unique to the process, so that concurrent runs do not write to the same file
+	size_t size = strlen(cache->directory) + 64;
+	char* path = (char*)safe_malloc(size);
+	if (is_temporary)
+	{
+#ifdef COLTI_WINDOWS
+		unsigned long process = (unsigned long)_getpid();
+#else
+		unsigned long process = (unsigned long)getpid();
+#endif
+		snprintf(path, size, "%s/%016"PRIx64".ctc.%lu.tmp", cache->directory, key, process);
+	}
+	else
+		snprintf(path, size, "%s/%016"PRIx64".ctc", cache->directory, key);
+	return path;
+}
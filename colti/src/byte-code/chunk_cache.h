@@ -0,0 +1,74 @@
+/** @file chunk_cache.h
+* Contains the ChunkCache, an on-disk cache of the byte-code compiled from source files.
+* Cached chunks are stored in '$XDG_CACHE_HOME/colti' (or '$HOME/.cache/colti', '%LOCALAPPDATA%\colti' on Windows),
+* in files named after their key: the hash (see hashBytes) of the source, seeded by the version
+* of the compiler and of the serialized chunk format (so that upgrading the compiler invalidates the cache).
+* Chunks are written to a temporary file then renamed into place, so that a concurrent run
+* never sees a partially written chunk. Loading a cached chunk maps it (ChunkMap), a missing or corrupted entry
+* being a silent miss.
+*/
+
+#ifndef HG_COLTI_CHUNK_CACHE
+#define HG_COLTI_CHUNK_CACHE
+
+#include "common.h"
+#include "chunk.h"
+#include "hash.h"
+
+/// @brief An on-disk cache of compiled chunks
+typedef struct
+{
+	/// @brief The directory containing the cached chunks, NULL if the cache is disabled
+	char* directory;
+} ChunkCache;
+
+/// @brief Initializes a cache, creating its directory if needed.
+/// If the directory cannot be found or created, the cache is disabled (every lookup misses).
+/// @param cache The cache to initialize
+void ChunkCacheInit(ChunkCache* cache);
+
+/// @brief Frees the memory used by a cache
+/// @param cache The cache to free
+void ChunkCacheFree(ChunkCache* cache);
+
+/// @brief Computes the key of the chunk compiled from a source
+/// @param source The content of the source file
+/// @param size The size of the source file
+/// @return The key of the chunk
+uint64_t ChunkCacheKey(const char* source, uint64_t size);
+
+/// @brief Maps the cached chunk with a key
+/// @param cache The cache from which to load
+/// @param key The key of the chunk
+/// @param chunk The chunk to initialize, which should be freed using ChunkFree
+/// @return False, without printing any error, if the chunk is not cached (a corrupted entry is removed)
+bool ChunkCacheLoad(const ChunkCache* cache, uint64_t key, Chunk* chunk);
+
+/// @brief Atomically writes a chunk to the cache
+/// @param cache The cache to which to write
+/// @param key The key of the chunk
+/// @param chunk The chunk to write
+/// @return False if the chunk could not be written (or the cache is disabled)
+bool ChunkCacheStore(const ChunkCache* cache, uint64_t key, const Chunk* chunk);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Finds (and creates) the directory of the cache
+/// @return The heap allocated path of the directory, or NULL if there is none
+char* impl_chunk_cache_find_directory();
+
+/// @brief Creates a directory if it does not already exist
+/// @param path The path to the directory
+/// @return False if the directory does not exist and could not be created
+bool impl_chunk_cache_make_directory(const char* path);
+
+/// @brief Formats the path to the file of a cached chunk
+/// @param cache The cache containing the chunk
+/// @param key The key of the chunk
+/// @param is_temporary True to format the path of the temporary file to which the chunk is written
+/// @return The heap allocated path
+char* impl_chunk_cache_path(const ChunkCache* cache, uint64_t key, bool is_temporary);
+
+#endif //HG_COLTI_CHUNK_CACHE
@@ -0,0 +1,485 @@
+/** @file compact_encoding.c
+* Contains the definitions of the functions declared in 'compact_encoding.h'
+*/
+
+#include "compact_encoding.h"
+#include "quickening.h"
+#include "thread.h"
+
+/// @brief The OpCodes which are fused with their OperandType, indexed by their slot
+static const uint8_t g_compact_fused_opcodes[] =
+{
+	OP_NEGATE, OP_ADD, OP_SUBTRACT, OP_MULTIPLY, OP_DIVIDE, OP_MODULO, OP_PRINT
+};
+
+/// @brief The number of fused slots in use
+#define COMPACT_FUSED_SLOT_COUNT (sizeof(g_compact_fused_opcodes) / sizeof(g_compact_fused_opcodes[0]))
+
+bool CompactDecodeInstruction(const Chunk* chunk, uint64_t offset, Instruction* instr)
+{
+	colti_assert(chunk->encoding == CHUNK_ENCODING_COMPACT, "Chunk should use the compact encoding!");
+	if (offset >= chunk->count)
+		return false;
+
+	uint8_t byte = chunk->code[offset];
+	uint64_t local_offset = offset + 1;
+	instr->immediate.ui64 = 0;
+	instr->index = 0;
+	instr->table = NULL;
+	if (byte >= COMPACT_FUSED_BASE)
+	{
+		uint32_t fused = byte - COMPACT_FUSED_BASE;
+		if (fused / OPERAND_TYPE_COUNT >= COMPACT_FUSED_SLOT_COUNT)
+			return false;
+		instr->code = g_compact_fused_opcodes[fused / OPERAND_TYPE_COUNT];
+		instr->types[0] = fused % OPERAND_TYPE_COUNT;
+		instr->size = 1;
+		return true;
+	}
+
+	instr->code = byte;
+	uint64_t value;
+	switch (OpCodeGetLayout(byte))
+	{
+	break; case LAYOUT_NONE:
+	break; case LAYOUT_QUICKENED:
+		QuickenedGetOpCode(byte, &instr->types[0]);
+	break; case LAYOUT_TYPE:
+		if (local_offset == chunk->count)
+			return false;
+		instr->types[0] = chunk->code[local_offset++];
+	break; case LAYOUT_TWO_TYPES:
+	{
+		if (local_offset == chunk->count)
+			return false;
+		uint8_t packed = chunk->code[local_offset++];
+		if (packed >= OPERAND_TYPE_COUNT * OPERAND_TYPE_COUNT)
+			return false;
+		instr->types[0] = packed / OPERAND_TYPE_COUNT;
+		instr->types[1] = packed % OPERAND_TYPE_COUNT;
+	}
+	break; case LAYOUT_BYTE:
+		if (local_offset == chunk->count)
+			return false;
+		instr->immediate.ui8 = chunk->code[local_offset++];
+	break; case LAYOUT_TWO_BYTES:
+		if (local_offset + 1 >= chunk->count)
+			return false;
+		instr->immediate.ui64 = chunk->code[local_offset] | ((uint64_t)chunk->code[local_offset + 1] << 8);
+		local_offset += 2;
+	break; case LAYOUT_WORD:
+		if (!impl_chunk_read_uleb128(chunk, &local_offset, &value) || value > UINT16_MAX)
+			return false;
+		instr->immediate.ui64 = value;
+	break; case LAYOUT_DWORD:
+		if (!impl_chunk_read_uleb128(chunk, &local_offset, &value) || value > UINT32_MAX)
+			return false;
+		instr->immediate.ui64 = value;
+	break; case LAYOUT_QWORD:
+		if (!impl_chunk_read_uleb128(chunk, &local_offset, &value))
+			return false;
+		instr->immediate.i64 = impl_zigzag_decode(value);
+	break; case LAYOUT_TYPE_WORD:
+		if (local_offset == chunk->count)
+			return false;
+		instr->types[0] = chunk->code[local_offset++];
+		if (!impl_chunk_read_uleb128(chunk, &local_offset, &value) || value > UINT16_MAX)
+			return false;
+		instr->immediate.ui64 = value;
+	break; case LAYOUT_TYPE_BYTE:
+		if (local_offset + 1 >= chunk->count)
+			return false;
+		instr->types[0] = chunk->code[local_offset++];
+		instr->immediate.ui8 = chunk->code[local_offset++];
+	break; case LAYOUT_TARGET:
+	{
+		if (local_offset + sizeof(uint32_t) > chunk->count)
+			return false;
+		uint32_t target;
+		memcpy(&target, chunk->code + local_offset, sizeof(uint32_t));
+		instr->immediate.ui64 = target;
+		local_offset += sizeof(uint32_t);
+	}
+	break; case LAYOUT_JUMP:
+		if (local_offset + sizeof(int32_t) > chunk->count)
+			return false;
+		instr->immediate.i64 = impl_chunk_jump_table_offset(chunk->code + local_offset, 0);
+		local_offset += sizeof(int32_t);
+	break; case LAYOUT_TYPE_JUMP:
+		if (local_offset + 1 + sizeof(int32_t) > chunk->count)
+			return false;
+		instr->types[0] = chunk->code[local_offset++];
+		instr->immediate.i64 = impl_chunk_jump_table_offset(chunk->code + local_offset, 0);
+		local_offset += sizeof(int32_t);
+	break; case LAYOUT_LOOP:
+		if (!impl_chunk_read_uleb128(chunk, &local_offset, &value) || value > UINT32_MAX
+			|| local_offset + sizeof(int32_t) > chunk->count)
+			return false;
+		instr->index = (uint32_t)value;
+		instr->immediate.i64 = impl_chunk_jump_table_offset(chunk->code + local_offset, 0);
+		local_offset += sizeof(int32_t);
+	break; case LAYOUT_JUMP_TABLE:
+		//The offsets include the default case
+		if (!impl_chunk_read_uleb128(chunk, &local_offset, &value) || value >= UINT32_MAX
+			|| (value + 1) * sizeof(int32_t) > chunk->count - local_offset)
+			return false;
+		instr->index = (uint32_t)value;
+		instr->table = chunk->code + local_offset;
+		instr->immediate.i64 = impl_chunk_jump_table_offset(instr->table, value);
+		local_offset += (value + 1) * sizeof(int32_t);
+	break; default:
+		return false;
+	}
+	instr->size = local_offset - offset;
+	return true;
+}
+
+void CompactWriteInstruction(Chunk* chunk, const Instruction* instr)
+{
+	colti_assert(chunk->encoding == CHUNK_ENCODING_COMPACT, "Chunk should use the compact encoding!");
+	colti_assert(instr->code < COMPACT_FUSED_BASE, "OpCodes should be less than COMPACT_FUSED_BASE!");
+
+	switch (OpCodeGetLayout(instr->code))
+	{
+	break; case LAYOUT_NONE:
+	case LAYOUT_QUICKENED:
+		impl_chunk_write_byte(chunk, instr->code);
+	break; case LAYOUT_TYPE:
+	{
+		int32_t slot = impl_compact_fused_slot(instr->code);
+		if (slot != -1 && instr->types[0] < OPERAND_TYPE_COUNT)
+		{
+			impl_chunk_write_byte(chunk, (uint8_t)(COMPACT_FUSED_BASE + slot * OPERAND_TYPE_COUNT + instr->types[0]));
+			break;
+		}
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_byte(chunk, instr->types[0]);
+	}
+	break; case LAYOUT_TWO_TYPES:
+		colti_assert(instr->types[0] < OPERAND_TYPE_COUNT && instr->types[1] < OPERAND_TYPE_COUNT, "Invalid OperandType!");
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_byte(chunk, (uint8_t)(instr->types[0] * OPERAND_TYPE_COUNT + instr->types[1]));
+	break; case LAYOUT_BYTE:
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_byte(chunk, instr->immediate.ui8);
+	break; case LAYOUT_TWO_BYTES:
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_byte(chunk, instr->immediate.ui8);
+		impl_chunk_write_byte(chunk, (uint8_t)(instr->immediate.ui64 >> 8));
+	break; case LAYOUT_WORD:
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_uleb128(chunk, instr->immediate.ui16);
+	break; case LAYOUT_DWORD:
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_uleb128(chunk, instr->immediate.ui32);
+	break; case LAYOUT_QWORD:
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_uleb128(chunk, impl_zigzag_encode(instr->immediate.i64));
+	break; case LAYOUT_TYPE_WORD:
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_byte(chunk, instr->types[0]);
+		impl_chunk_write_uleb128(chunk, instr->immediate.ui16);
+	break; case LAYOUT_TYPE_BYTE:
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_byte(chunk, instr->types[0]);
+		impl_chunk_write_byte(chunk, instr->immediate.ui8);
+	break; case LAYOUT_TARGET:
+	{
+		//Fixed size, so that the target can be relocated
+		uint32_t target = instr->immediate.ui32;
+		impl_chunk_write_byte(chunk, instr->code);
+		ChunkWriteBytes(chunk, (const uint8_t*)&target, sizeof(uint32_t));
+	}
+		//Jump offsets are also fixed size, the size of the jumps being needed to relocate them
+	break; case LAYOUT_JUMP:
+	{
+		int32_t relative = instr->immediate.i32;
+		impl_chunk_write_byte(chunk, instr->code);
+		ChunkWriteBytes(chunk, (const uint8_t*)&relative, sizeof(int32_t));
+	}
+	break; case LAYOUT_TYPE_JUMP:
+	{
+		int32_t relative = instr->immediate.i32;
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_byte(chunk, instr->types[0]);
+		ChunkWriteBytes(chunk, (const uint8_t*)&relative, sizeof(int32_t));
+	}
+	break; case LAYOUT_LOOP:
+	{
+		int32_t relative = instr->immediate.i32;
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_uleb128(chunk, instr->index);
+		ChunkWriteBytes(chunk, (const uint8_t*)&relative, sizeof(int32_t));
+	}
+	break; case LAYOUT_JUMP_TABLE:
+		impl_chunk_write_byte(chunk, instr->code);
+		impl_chunk_write_uleb128(chunk, instr->index);
+		ChunkWriteBytes(chunk, instr->table, (instr->index + 1) * sizeof(int32_t));
+	break; default:
+		colti_assert(false, "Invalid OpCode!");
+	}
+}
+
+bool ChunkToCompact(const Chunk* chunk, Chunk* result)
+{
+	colti_assert(chunk->encoding == CHUNK_ENCODING_ALIGNED, "Chunk should use the aligned encoding!");
+	Chunk compact;
+	ChunkInit(&compact);
+	compact.encoding = CHUNK_ENCODING_COMPACT;
+
+	//The offsets of the source locations change with the encoding
+	DebugInfoIterator iter;
+	DebugEntry next;
+	DebugInfoIteratorInit(&iter, &chunk->debug_info);
+	if (!DebugInfoNext(&iter, &next))
+		next.offset = UINT64_MAX;
+
+	//The targets of the calls change with the encoding
+	uint64_t* relocations = impl_compact_new_relocations(chunk->count);
+	Instruction instr;
+	bool is_valid = true;
+	for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+	{
+		//The types of OP_CONVERT must be valid to be packed
+		if (!ChunkDecodeInstruction(chunk, offset, &instr)
+			|| (OpCodeGetLayout(instr.code) == LAYOUT_TWO_TYPES
+				&& (instr.types[0] >= OPERAND_TYPE_COUNT || instr.types[1] >= OPERAND_TYPE_COUNT)))
+		{
+			is_valid = false;
+			break;
+		}
+		relocations[offset] = compact.count;
+		impl_chunk_copy_source_locations(&compact, &iter, &next, offset);
+		CompactWriteInstruction(&compact, &instr);
+	}
+	is_valid = is_valid && impl_chunk_relocate_targets(&compact, 0, chunk, relocations);
+	if (relocations != NULL)
+		safe_free(relocations);
+	if (!is_valid)
+	{
+		ChunkFree(&compact);
+		return false;
+	}
+	impl_chunk_copy_constants(&compact, chunk);
+	compact.loop_count = chunk->loop_count;
+	compact.cache_count = chunk->cache_count;
+	impl_chunk_copy_globals(&compact, chunk);
+	*result = compact;
+	return true;
+}
+
+bool ChunkToAligned(const Chunk* chunk, Chunk* result)
+{
+	colti_assert(chunk->encoding == CHUNK_ENCODING_COMPACT, "Chunk should use the compact encoding!");
+	Chunk aligned;
+	ChunkInit(&aligned);
+
+	//The offsets of the source locations change with the encoding
+	DebugInfoIterator iter;
+	DebugEntry next;
+	DebugInfoIteratorInit(&iter, &chunk->debug_info);
+	if (!DebugInfoNext(&iter, &next))
+		next.offset = UINT64_MAX;
+
+	//The targets of the calls change with the encoding
+	uint64_t* relocations = impl_compact_new_relocations(chunk->count);
+	Instruction instr;
+	bool is_valid = true;
+	for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+	{
+		if (!(is_valid = CompactDecodeInstruction(chunk, offset, &instr)))
+			break;
+		relocations[offset] = aligned.count;
+		impl_chunk_copy_source_locations(&aligned, &iter, &next, offset);
+		ChunkWriteInstruction(&aligned, &instr);
+	}
+	is_valid = is_valid && impl_chunk_relocate_targets(&aligned, 0, chunk, relocations);
+	if (relocations != NULL)
+		safe_free(relocations);
+	if (!is_valid)
+	{
+		ChunkFree(&aligned);
+		return false;
+	}
+	impl_chunk_copy_constants(&aligned, chunk);
+	aligned.loop_count = chunk->loop_count;
+	aligned.cache_count = chunk->cache_count;
+	impl_chunk_copy_globals(&aligned, chunk);
+	*result = aligned;
+	return true;
+}
+
+OpCode unsafe_get_compact_opcode(uint8_t** ptr, OperandType* type)
+{
+	//A fused OpCode is rewritten in place when quickened (see quickening.h)
+	uint8_t byte = atomicLoadByte((*ptr)++);
+	if (byte >= COMPACT_FUSED_BASE)
+	{
+		uint32_t fused = byte - COMPACT_FUSED_BASE;
+		*type = fused % OPERAND_TYPE_COUNT;
+		return g_compact_fused_opcodes[fused / OPERAND_TYPE_COUNT];
+	}
+	OpCodeLayout layout = OpCodeGetLayout(byte);
+	if (layout == LAYOUT_TYPE || layout == LAYOUT_TYPE_WORD || layout == LAYOUT_TYPE_BYTE || layout == LAYOUT_TYPE_JUMP)
+		*type = *((*ptr)++);
+	return byte;
+}
+
+uint64_t unsafe_get_uleb128(uint8_t** ptr)
+{
+	uint8_t byte = *((*ptr)++);
+	//Most immediates are small
+	if (byte < 0x80)
+		return byte;
+
+	uint64_t value = byte & 0x7F;
+	uint32_t shift = 7;
+	do
+	{
+		byte = *((*ptr)++);
+		value |= (uint64_t)(byte & 0x7F) << shift;
+		shift += 7;
+	} while (byte >= 0x80);
+	return value;
+}
+
+uint32_t unsafe_get_compact_target(uint8_t** ptr)
+{
+	uint32_t target;
+	memcpy(&target, *ptr, sizeof(uint32_t));
+	*ptr += sizeof(uint32_t);
+	return target;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+int32_t impl_compact_fused_slot(OpCode code)
+{
+	for (int32_t i = 0; i < (int32_t)COMPACT_FUSED_SLOT_COUNT; i++)
+	{
+		if (g_compact_fused_opcodes[i] == code)
+			return i;
+	}
+	return -1;
+}
+
+uint64_t impl_zigzag_encode(int64_t value)
+{
+	//The sign bit becomes the least significant bit
+	return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+int64_t impl_zigzag_decode(uint64_t value)
+{
+	return (int64_t)((value >> 1) ^ (0 - (value & 1)));
+}
+
+void impl_chunk_write_uleb128(Chunk* chunk, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		impl_chunk_write_byte(chunk, (uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	impl_chunk_write_byte(chunk, (uint8_t)value);
+}
+
+bool impl_chunk_read_uleb128(const Chunk* chunk, uint64_t* offset, uint64_t* value)
+{
+	uint64_t result = 0;
+	uint64_t local_offset = *offset;
+	for (uint32_t shift = 0; shift < 64; shift += 7)
+	{
+		if (local_offset == chunk->count)
+			return false;
+		uint8_t byte = chunk->code[local_offset++];
+		//The 10th byte can only contain the most significant bit
+		if (shift == 63 && byte > 1)
+			return false;
+		result |= (uint64_t)(byte & 0x7F) << shift;
+		if (byte < 0x80)
+		{
+			*offset = local_offset;
+			*value = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool impl_chunk_relocate_targets(Chunk* chunk, uint64_t start, const Chunk* original, const uint64_t* relocations)
+{
+	//The instructions were re-encoded one by one, so both codes are decoded in lockstep
+	Instruction instr;
+	Instruction original_instr;
+	uint64_t original_offset = 0;
+	for (uint64_t offset = start; offset < chunk->count; offset += instr.size, original_offset += original_instr.size)
+	{
+		bool is_valid = chunk->encoding == CHUNK_ENCODING_COMPACT
+			? CompactDecodeInstruction(chunk, offset, &instr)
+			: ChunkDecodeInstruction(chunk, offset, &instr);
+		is_valid &= original->encoding == CHUNK_ENCODING_COMPACT
+			? CompactDecodeInstruction(original, original_offset, &original_instr)
+			: ChunkDecodeInstruction(original, original_offset, &original_instr);
+		colti_assert(is_valid, "The re-encoded instructions should be valid!");
+		switch (OpCodeGetLayout(instr.code))
+		{
+		break; case LAYOUT_TARGET:
+		{
+			if (instr.immediate.ui64 >= original->count || relocations[instr.immediate.ui64] == UINT64_MAX)
+				return false;
+			//The target is the last operand of the instruction, in both encodings
+			uint32_t target = (uint32_t)relocations[instr.immediate.ui64];
+			memcpy(chunk->code + offset + instr.size - sizeof(uint32_t), &target, sizeof(uint32_t));
+		}
+		break; case LAYOUT_JUMP:
+		case LAYOUT_TYPE_JUMP:
+		case LAYOUT_LOOP:
+			//The jump offset is the last operand of the instruction, in both encodings
+			if (!impl_chunk_relocate_jump(chunk->code + offset + instr.size - sizeof(int32_t), offset - start,
+				original_offset, original_instr.immediate.i64, original->count, relocations))
+				return false;
+		break; case LAYOUT_JUMP_TABLE:
+		{
+			//The table points into the (writable) code of the chunk
+			uint8_t* table = chunk->code + (instr.table - chunk->code);
+			for (uint64_t i = 0; i <= instr.index; i++)
+			{
+				if (!impl_chunk_relocate_jump(table + i * sizeof(int32_t), offset - start, original_offset,
+					impl_chunk_jump_table_offset(original_instr.table, i), original->count, relocations))
+					return false;
+			}
+		}
+		break; default:
+			break;
+		}
+	}
+	return true;
+}
+
+bool impl_chunk_relocate_jump(uint8_t* slot, uint64_t offset, uint64_t original_offset, int64_t relative,
+	uint64_t original_size, const uint64_t* relocations)
+{
+	//The jump offset is relative to the jump, in both codes
+	int64_t target = (int64_t)original_offset + relative;
+	if (target < 0 || (uint64_t)target >= original_size || relocations[target] == UINT64_MAX)
+		return false;
+	int64_t new_relative = (int64_t)relocations[target] - (int64_t)offset;
+	if (new_relative < INT32_MIN || new_relative > INT32_MAX)
+		return false;
+	int32_t value = (int32_t)new_relative;
+	memcpy(slot, &value, sizeof(int32_t));
+	return true;
+}
+
+uint64_t* impl_compact_new_relocations(uint64_t original_size)
+{
+	if (original_size == 0)
+		return NULL;
+	uint64_t* relocations = (uint64_t*)safe_malloc(original_size * sizeof(uint64_t));
+	//No instruction starts at any offset until it is re-encoded
+	memset(relocations, 0xFF, original_size * sizeof(uint64_t));
+	return relocations;
+}
@@ -0,0 +1,134 @@
+/** @file compact_encoding.h
+* Contains the compact encoding of byte-code, and the conversions between the aligned and compact encodings.
+* The aligned encoding (used when writing to a Chunk) spends a byte on each OpCode and OperandType,
+* and pads immediates to their alignment, which means an immediate QWORD takes up to 16 bytes.
+* The compact encoding trades a bit of decoding cost for smaller chunks:
+* - An OpCode followed by an OperandType is fused in a single byte
+*   (COMPACT_FUSED_BASE + slot * OPERAND_TYPE_COUNT + type) if the OpCode has a fused slot.
+* - Any other OpCode is written as is, as all OpCodes are less than COMPACT_FUSED_BASE.
+* - A quickened OpCode (see quickening.h) is written alone, as its OperandType is implied: it takes a single byte,
+*   as the fused OpCode it replaces.
+* - The 2 OperandType of OP_CONVERT are packed in a single byte (from * OPERAND_TYPE_COUNT + to).
+* - WORD and DWORD immediates are written as unsigned LEB128, and QWORD immediates
+*   as zigzag LEB128 (of their i64 value), so small negative integers are also short.
+* - The WORD constant index of OP_DIVIDE_CONST and OP_MODULO_CONST (and the WORD slot index of OP_INC_LOCAL_WORD)
+*   follows their OperandType byte, as an unsigned LEB128.
+* - The 2 BYTEs of OP_ENTER follow it, so that OP_TAIL_CALL reads its number of arguments at the same offset in both encodings.
+* - The target of OP_CALL and OP_TAIL_CALL is written as 4 bytes rather than LEB128: the size of an instruction does not
+*   depend on its target, so the targets can be relocated once the code is re-encoded (see impl_chunk_relocate_targets).
+* - For the same reason, jump offsets are written as 4 bytes. The counter index of OP_LOOP and the case count of
+*   OP_JUMP_TABLE are unsigned LEB128.
+* - Nothing is ever padded.
+* Compact chunks can be run directly by the VM, or converted back using ChunkToAligned.
+*/
+
+#ifndef HG_COLTI_COMPACT_ENCODING
+#define HG_COLTI_COMPACT_ENCODING
+
+#include "common.h"
+#include "chunk.h"
+
+/// @brief The first byte representing a fused OpCode and OperandType
+#define COMPACT_FUSED_BASE 128
+
+/// @brief Decodes the instruction at 'offset' of a compact chunk, checking that it is valid and complete
+/// @param chunk The chunk containing the instruction
+/// @param offset The offset of the instruction
+/// @param instr Pointer to where to write the decoded instruction
+/// @return False if the instruction is invalid or truncated
+bool CompactDecodeInstruction(const Chunk* chunk, uint64_t offset, Instruction* instr);
+
+/// @brief Appends an instruction to the end of a compact chunk
+/// @param chunk The chunk to append to
+/// @param instr The instruction to append ('size' is ignored)
+void CompactWriteInstruction(Chunk* chunk, const Instruction* instr);
+
+/// @brief Converts an aligned chunk to a new compact chunk, copying its constant pool
+/// @param chunk The aligned chunk to convert
+/// @param result Pointer to where to write the compact chunk (which should not be initialized)
+/// @return False if 'chunk' contains an invalid instruction (in which case 'result' is not modified)
+bool ChunkToCompact(const Chunk* chunk, Chunk* result);
+
+/// @brief Converts a compact chunk to a new aligned chunk, copying its constant pool
+/// @param chunk The compact chunk to convert
+/// @param result Pointer to where to write the aligned chunk (which should not be initialized)
+/// @return False if 'chunk' contains an invalid instruction (in which case 'result' is not modified)
+bool ChunkToAligned(const Chunk* chunk, Chunk* result);
+
+/// @brief Extracts the OpCode at a pointer, and the OperandType fused to it or following it.
+/// Updates the location pointed by that pointer to the first byte following them.
+/// @param ptr Pointer to the pointer pointing to the OpCode of a valid compact instruction (not checked)
+/// @param type Pointer to where to write the OperandType (only written for LAYOUT_TYPE, LAYOUT_TYPE_WORD and LAYOUT_TYPE_BYTE OpCodes)
+/// @return The OpCode
+OpCode unsafe_get_compact_opcode(uint8_t** ptr, OperandType* type);
+
+/// @brief Extracts an unsigned LEB128 from a pointer and updates the location pointed by that pointer
+/// @param ptr Pointer to the pointer pointing to the LEB128 (not checked)
+/// @return The decoded value
+uint64_t unsafe_get_uleb128(uint8_t** ptr);
+
+/// @brief Extracts the (unaligned) target of a compact OP_CALL or OP_TAIL_CALL from a pointer and updates the location pointed by that pointer
+/// @param ptr Pointer to the pointer pointing to the target (not checked)
+/// @return The offset of the instruction targeted
+uint32_t unsafe_get_compact_target(uint8_t** ptr);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Returns the fused slot of an OpCode
+/// @param code The OpCode
+/// @return The slot, or -1 if the OpCode cannot be fused with its OperandType
+int32_t impl_compact_fused_slot(OpCode code);
+
+/// @brief Maps a signed integer to an unsigned one, so that small negative values are small
+/// @param value The value to encode
+/// @return The encoded value (0, -1, 1, -2... are mapped to 0, 1, 2, 3...)
+uint64_t impl_zigzag_encode(int64_t value);
+
+/// @brief Reverses impl_zigzag_encode
+/// @param value The value to decode
+/// @return The decoded value
+int64_t impl_zigzag_decode(uint64_t value);
+
+/// @brief Appends an unsigned LEB128 to the end of a chunk
+/// @param chunk The chunk to append to
+/// @param value The value to append
+void impl_chunk_write_uleb128(Chunk* chunk, uint64_t value);
+
+/// @brief Reads an unsigned LEB128 from a chunk, checking that it is complete and not too big
+/// @param chunk The chunk from which to read
+/// @param offset The offset to the LEB128, is updated past it
+/// @param value Pointer to where to write the decoded value
+/// @return False if the LEB128 is truncated or does not fit in 64 bits
+bool impl_chunk_read_uleb128(const Chunk* chunk, uint64_t* offset, uint64_t* value);
+
+/// @brief Rewrites the targets (LAYOUT_TARGET) and the jump offsets of the instructions of a re-encoded chunk, which are still
+/// those of the instructions of the original chunk. As the size of an instruction does not depend on its targets,
+/// the offsets of the re-encoded instructions are known once they are all written.
+/// @param chunk The chunk to which the instructions were re-encoded (using any encoding)
+/// @param start The offset of the first re-encoded instruction in 'chunk', to which the targets are relative
+/// @param original The original chunk, each of whose instructions was re-encoded in order (with the same OpCode)
+/// @param relocations The offset (relative to 'start') to which the instruction at each offset of the original chunk
+/// was re-encoded, UINT64_MAX for offsets that are not the beginning of an instruction
+/// @return False if a target or a jump is not the offset of an instruction of the original chunk
+bool impl_chunk_relocate_targets(Chunk* chunk, uint64_t start, const Chunk* original, const uint64_t* relocations);
+
+/// @brief Rewrites a jump offset of a re-encoded instruction (see impl_chunk_relocate_targets)
+/// @param slot Pointer to the (unaligned) jump offset of the re-encoded instruction
+/// @param offset The offset of the re-encoded instruction (relative to the first re-encoded instruction)
+/// @param original_offset The offset of the instruction in the original chunk
+/// @param relative The jump offset of the instruction in the original chunk
+/// @param original_size The number of bytes of code of the original chunk (the size of 'relocations')
+/// @param relocations The offsets to which the instructions of the original chunk were re-encoded
+/// @return False if the jump does not target an instruction, or if the relocated offset does not fit in 32 bits
+bool impl_chunk_relocate_jump(uint8_t* slot, uint64_t offset, uint64_t original_offset, int64_t relative,
+	uint64_t original_size, const uint64_t* relocations);
+
+/// @brief Allocates the relocations of the instructions of a chunk being re-encoded (see impl_chunk_relocate_targets),
+/// which are all UINT64_MAX, and should be freed using safe_free
+/// @param original_size The number of bytes of code of the chunk being re-encoded
+/// @return The relocations, NULL if 'original_size' is 0
+uint64_t* impl_compact_new_relocations(uint64_t original_size);
+
+#endif //HG_COLTI_COMPACT_ENCODING
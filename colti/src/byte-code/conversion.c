@@ -0,0 +1,194 @@
+/** @file conversion.c
+* Contains the definitions of the functions declared in 'conversion.h'
+*/
+
+#include "conversion.h"
+
+#if (defined(COLTI_GNU) || defined(COLTI_CLANG)) && defined(__SSE2__)
+	#include <emmintrin.h>
+	/// @brief Defined if arrays of values can be converted 2 values at a time
+	#define IMPL_COLTI_SSE2_CONVERSIONS
+#endif
+
+/// @brief Defines the kernel 'impl_convert_##from##_##to', converting using the rules of C
+#define IMPL_CONVERT_DEFINE(from, to) \
+QWORD impl_convert_##from##_##to(QWORD value) \
+{ \
+	QWORD result; \
+	result.to = value.from; \
+	return result; \
+}
+
+/// @brief Defines the kernel 'impl_convert_##from##_b', converting any non-zero value to true
+#define IMPL_CONVERT_DEFINE_TO_BOOL(from) \
+QWORD impl_convert_##from##_b(QWORD value) \
+{ \
+	QWORD result; \
+	result.b = value.from != 0; \
+	return result; \
+}
+
+/// @brief Defines the kernel 'impl_convert_##from##_##to', converting a floating point value
+/// to an integer in the range [min, max] (NaN being converted to 0)
+#define IMPL_CONVERT_DEFINE_SATURATE(from, to, min, max) \
+QWORD impl_convert_##from##_##to(QWORD value) \
+{ \
+	QWORD result; \
+	if (value.from != value.from) \
+		result.to = 0; \
+	else if (value.from <= (min)) \
+		result.to = (min); \
+	else if (value.from >= (max)) \
+		result.to = (max); \
+	else \
+		result.to = value.from; \
+	return result; \
+}
+
+/// @brief Defines the kernels converting from a BOOL or an integer (whose QWORD member is 'from') to any type
+#define IMPL_CONVERT_DEFINE_FROM_INTEGER(from) \
+	IMPL_CONVERT_DEFINE_TO_BOOL(from) \
+	IMPL_CONVERT_DEFINE(from, ui8) IMPL_CONVERT_DEFINE(from, ui16) \
+	IMPL_CONVERT_DEFINE(from, ui32) IMPL_CONVERT_DEFINE(from, ui64) \
+	IMPL_CONVERT_DEFINE(from, i8) IMPL_CONVERT_DEFINE(from, i16) \
+	IMPL_CONVERT_DEFINE(from, i32) IMPL_CONVERT_DEFINE(from, i64) \
+	IMPL_CONVERT_DEFINE(from, f) IMPL_CONVERT_DEFINE(from, d)
+
+/// @brief Defines the kernels converting from a FLOAT or a DOUBLE (whose QWORD member is 'from') to any type
+#define IMPL_CONVERT_DEFINE_FROM_FLOATING(from) \
+	IMPL_CONVERT_DEFINE_TO_BOOL(from) \
+	IMPL_CONVERT_DEFINE_SATURATE(from, ui8, 0, UINT8_MAX) IMPL_CONVERT_DEFINE_SATURATE(from, ui16, 0, UINT16_MAX) \
+	IMPL_CONVERT_DEFINE_SATURATE(from, ui32, 0, UINT32_MAX) IMPL_CONVERT_DEFINE_SATURATE(from, ui64, 0, UINT64_MAX) \
+	IMPL_CONVERT_DEFINE_SATURATE(from, i8, INT8_MIN, INT8_MAX) IMPL_CONVERT_DEFINE_SATURATE(from, i16, INT16_MIN, INT16_MAX) \
+	IMPL_CONVERT_DEFINE_SATURATE(from, i32, INT32_MIN, INT32_MAX) IMPL_CONVERT_DEFINE_SATURATE(from, i64, INT64_MIN, INT64_MAX) \
+	IMPL_CONVERT_DEFINE(from, f) IMPL_CONVERT_DEFINE(from, d)
+
+IMPL_CONVERT_DEFINE_FROM_INTEGER(b)
+IMPL_CONVERT_DEFINE_FROM_INTEGER(ui8)
+IMPL_CONVERT_DEFINE_FROM_INTEGER(ui16)
+IMPL_CONVERT_DEFINE_FROM_INTEGER(ui32)
+IMPL_CONVERT_DEFINE_FROM_INTEGER(ui64)
+IMPL_CONVERT_DEFINE_FROM_INTEGER(i8)
+IMPL_CONVERT_DEFINE_FROM_INTEGER(i16)
+IMPL_CONVERT_DEFINE_FROM_INTEGER(i32)
+IMPL_CONVERT_DEFINE_FROM_INTEGER(i64)
+IMPL_CONVERT_DEFINE_FROM_FLOATING(f)
+IMPL_CONVERT_DEFINE_FROM_FLOATING(d)
+
+/// @brief The kernels converting from a type (whose QWORD member is 'from') to each OperandType
+#define IMPL_CONVERT_KERNELS_FROM(from) \
+{ \
+	[OPERAND_COLTI_BOOL] = impl_convert_##from##_b, \
+	[OPERAND_COLTI_UI8] = impl_convert_##from##_ui8, [OPERAND_COLTI_UI16] = impl_convert_##from##_ui16, \
+	[OPERAND_COLTI_UI32] = impl_convert_##from##_ui32, [OPERAND_COLTI_UI64] = impl_convert_##from##_ui64, \
+	[OPERAND_COLTI_I8] = impl_convert_##from##_i8, [OPERAND_COLTI_I16] = impl_convert_##from##_i16, \
+	[OPERAND_COLTI_I32] = impl_convert_##from##_i32, [OPERAND_COLTI_I64] = impl_convert_##from##_i64, \
+	[OPERAND_COLTI_FLOAT] = impl_convert_##from##_f, [OPERAND_COLTI_DOUBLE] = impl_convert_##from##_d, \
+}
+
+/// @brief The kernel of each conversion, indexed by [from][to]
+static const ConvertKernel g_convert_kernels[OPERAND_TYPE_COUNT][OPERAND_TYPE_COUNT] =
+{
+	[OPERAND_COLTI_BOOL] = IMPL_CONVERT_KERNELS_FROM(b),
+	[OPERAND_COLTI_UI8] = IMPL_CONVERT_KERNELS_FROM(ui8),
+	[OPERAND_COLTI_UI16] = IMPL_CONVERT_KERNELS_FROM(ui16),
+	[OPERAND_COLTI_UI32] = IMPL_CONVERT_KERNELS_FROM(ui32),
+	[OPERAND_COLTI_UI64] = IMPL_CONVERT_KERNELS_FROM(ui64),
+	[OPERAND_COLTI_I8] = IMPL_CONVERT_KERNELS_FROM(i8),
+	[OPERAND_COLTI_I16] = IMPL_CONVERT_KERNELS_FROM(i16),
+	[OPERAND_COLTI_I32] = IMPL_CONVERT_KERNELS_FROM(i32),
+	[OPERAND_COLTI_I64] = IMPL_CONVERT_KERNELS_FROM(i64),
+	[OPERAND_COLTI_FLOAT] = IMPL_CONVERT_KERNELS_FROM(f),
+	[OPERAND_COLTI_DOUBLE] = IMPL_CONVERT_KERNELS_FROM(d),
+};
+
+/// @brief The specialized conversion OpCodes
+static const SpecializedConversion g_specialized_conversions[] =
+{
+	{ OP_CVT_I32_I64, OPERAND_COLTI_I32, OPERAND_COLTI_I64 },
+	{ OP_CVT_I64_I32, OPERAND_COLTI_I64, OPERAND_COLTI_I32 },
+	{ OP_CVT_I32_DOUBLE, OPERAND_COLTI_I32, OPERAND_COLTI_DOUBLE },
+	{ OP_CVT_DOUBLE_I32, OPERAND_COLTI_DOUBLE, OPERAND_COLTI_I32 },
+	{ OP_CVT_I64_DOUBLE, OPERAND_COLTI_I64, OPERAND_COLTI_DOUBLE },
+	{ OP_CVT_DOUBLE_I64, OPERAND_COLTI_DOUBLE, OPERAND_COLTI_I64 },
+	{ OP_CVT_FLOAT_DOUBLE, OPERAND_COLTI_FLOAT, OPERAND_COLTI_DOUBLE },
+	{ OP_CVT_DOUBLE_FLOAT, OPERAND_COLTI_DOUBLE, OPERAND_COLTI_FLOAT },
+};
+
+/// @brief The number of specialized conversion OpCodes
+#define SPECIALIZED_CONVERSION_COUNT (sizeof(g_specialized_conversions) / sizeof(g_specialized_conversions[0]))
+
+ConvertKernel ConvertGetKernel(OperandType from, OperandType to)
+{
+	colti_assert(from < OPERAND_TYPE_COUNT && to < OPERAND_TYPE_COUNT, "Invalid OperandType!");
+	return g_convert_kernels[from][to];
+}
+
+OpCode ConvertGetOpCode(OperandType from, OperandType to)
+{
+	for (size_t i = 0; i < SPECIALIZED_CONVERSION_COUNT; i++)
+	{
+		if (g_specialized_conversions[i].from == from && g_specialized_conversions[i].to == to)
+			return g_specialized_conversions[i].code;
+	}
+	return OP_CONVERT;
+}
+
+bool ConvertGetOpCodeTypes(uint8_t code, OperandType* from, OperandType* to)
+{
+	for (size_t i = 0; i < SPECIALIZED_CONVERSION_COUNT; i++)
+	{
+		if (g_specialized_conversions[i].code == code)
+		{
+			*from = g_specialized_conversions[i].from;
+			*to = g_specialized_conversions[i].to;
+			return true;
+		}
+	}
+	return false;
+}
+
+void ConvertValues(QWORD* values, uint64_t count, OperandType from, OperandType to)
+{
+	uint64_t i = 0;
+#ifdef IMPL_COLTI_SSE2_CONVERSIONS
+	//Each QWORD takes 64 bits of a vector: the 32 bits values are in the lanes 0 and 2
+	if (from == OPERAND_COLTI_I32 && to == OPERAND_COLTI_I64)
+	{
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128i packed = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(values + i)), _MM_SHUFFLE(3, 1, 2, 0));
+			//Interleaves each value with its sign
+			_mm_storeu_si128((__m128i*)(values + i), _mm_unpacklo_epi32(packed, _mm_srai_epi32(packed, 31)));
+		}
+	}
+	else if (from == OPERAND_COLTI_I32 && to == OPERAND_COLTI_DOUBLE)
+	{
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128i packed = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(values + i)), _MM_SHUFFLE(3, 1, 2, 0));
+			_mm_storeu_pd((double*)(values + i), _mm_cvtepi32_pd(packed));
+		}
+	}
+	else if (from == OPERAND_COLTI_FLOAT && to == OPERAND_COLTI_DOUBLE)
+	{
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128 floats = _mm_loadu_ps((const float*)(values + i));
+			_mm_storeu_pd((double*)(values + i), _mm_cvtps_pd(_mm_shuffle_ps(floats, floats, _MM_SHUFFLE(3, 1, 2, 0))));
+		}
+	}
+	else if (from == OPERAND_COLTI_DOUBLE && to == OPERAND_COLTI_FLOAT)
+	{
+		for (; i + 2 <= count; i += 2)
+		{
+			__m128 floats = _mm_cvtpd_ps(_mm_loadu_pd((const double*)(values + i)));
+			//Moves the 2 floats to the lanes 0 and 2 (the upper bits of each QWORD are unspecified)
+			_mm_storeu_ps((float*)(values + i), _mm_unpacklo_ps(floats, floats));
+		}
+	}
+#endif
+	ConvertKernel kernel = ConvertGetKernel(from, to);
+	for (; i < count; i++)
+		values[i] = kernel(values[i]);
+}
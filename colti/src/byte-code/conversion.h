@@ -0,0 +1,78 @@
+/** @file conversion.h
+* Contains the conversions between OperandTypes, performed by OP_CONVERT and the OP_CVT_* OpCodes.
+* Each pair of types (from, to) is converted by a ConvertKernel, and the kernels are stored in a
+* OPERAND_TYPE_COUNT * OPERAND_TYPE_COUNT table, so that a conversion costs a single indirect call
+* rather than a switch on each type.
+* The conversions follow the rules of C, except that:
+* - converting to a BOOL results in true for any non-zero value (including NaN)
+* - converting a FLOAT or DOUBLE to an integer truncates toward zero, saturating values which are out
+*   of the range of the integer (NaN is converted to 0), rather than being undefined behavior.
+* The most common conversions also have a specialized OpCode (OP_CVT_<FROM>_<TO>), which is not
+* followed by any operand: ChunkWriteConvert writes it when possible.
+*/
+
+#ifndef HG_COLTI_CONVERSION
+#define HG_COLTI_CONVERSION
+
+#include "common.h"
+#include "byte_code.h"
+
+/// @brief Converts a QWORD from a type to another
+typedef QWORD(*ConvertKernel)(QWORD value);
+
+/// @brief A specialized conversion OpCode, and the types it converts
+typedef struct
+{
+	/// @brief The OP_CVT_* OpCode
+	uint8_t code;
+	/// @brief The OperandType of the value to convert
+	uint8_t from;
+	/// @brief The OperandType of the result
+	uint8_t to;
+} SpecializedConversion;
+
+/// @brief Returns the kernel converting a value of type 'from' to a value of type 'to'
+/// @param from The type of the value to convert
+/// @param to The type to which to convert
+/// @return The kernel, which is never NULL
+ConvertKernel ConvertGetKernel(OperandType from, OperandType to);
+
+/// @brief Returns the specialized OpCode converting from a type to another, if there is any
+/// @param from The type of the value to convert
+/// @param to The type to which to convert
+/// @return The OP_CVT_* OpCode, or OP_CONVERT if there is no specialized OpCode for these types
+OpCode ConvertGetOpCode(OperandType from, OperandType to);
+
+/// @brief Returns the types converted by a specialized conversion OpCode
+/// @param code The byte representing the OpCode
+/// @param from Pointer to where to write the type of the value to convert
+/// @param to Pointer to where to write the type of the result
+/// @return False if 'code' is not an OP_CVT_* OpCode (in which case 'from' and 'to' are not modified)
+bool ConvertGetOpCodeTypes(uint8_t code, OperandType* from, OperandType* to);
+
+/// @brief Converts, in place, an array of values of type 'from' to values of type 'to'.
+/// On SSE2 targets, the conversions from INT32 to INT64 or DOUBLE, and between FLOAT and DOUBLE
+/// are done 2 values at a time. Any other conversion calls the kernel of the types for each value.
+/// @param values The values to convert (such as a region of the stack of the VM)
+/// @param count The number of values
+/// @param from The type of the values to convert
+/// @param to The type to which to convert
+void ConvertValues(QWORD* values, uint64_t count, OperandType from, OperandType to);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief The kernels of the conversions which have a specialized OpCode, called directly by the VM
+/// @param value The value to convert
+/// @return The converted value
+QWORD impl_convert_i32_i64(QWORD value);
+QWORD impl_convert_i64_i32(QWORD value);
+QWORD impl_convert_i32_d(QWORD value);
+QWORD impl_convert_d_i32(QWORD value);
+QWORD impl_convert_i64_d(QWORD value);
+QWORD impl_convert_d_i64(QWORD value);
+QWORD impl_convert_f_d(QWORD value);
+QWORD impl_convert_d_f(QWORD value);
+
+#endif //HG_COLTI_CONVERSION
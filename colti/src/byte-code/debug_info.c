@@ -0,0 +1,139 @@
+/** @file debug_info.c
+* Contains the definitions of the functions declared in 'debug_info.h'
+*/
+
+#include "debug_info.h"
+#include "compact_encoding.h" //Contains the zigzag encoding
+
+void DebugInfoInit(DebugInfo* info)
+{
+	//The table is only allocated when an entry is added
+	info->size = 0;
+	info->capacity = 0;
+	info->data = NULL;
+	info->last.offset = 0;
+	info->last.location.line = 0;
+	info->last.location.column = 0;
+}
+
+void DebugInfoFree(DebugInfo* info)
+{
+	if (info->data != NULL)
+		safe_free(info->data);
+	info->data = NULL;
+}
+
+void DebugInfoAdd(DebugInfo* info, uint64_t offset, SourceLocation location)
+{
+	colti_assert(offset >= info->last.offset, "Entries should be added in increasing order of offsets!");
+	if (info->size != 0 && location.line == info->last.location.line && location.column == info->last.location.column)
+		return;
+
+	impl_debug_info_write_uleb128(info, offset - info->last.offset);
+	impl_debug_info_write_uleb128(info, impl_zigzag_encode((int64_t)location.line - (int64_t)info->last.location.line));
+	impl_debug_info_write_uleb128(info, location.column);
+	info->last.offset = offset;
+	info->last.location = location;
+}
+
+bool DebugInfoFind(const DebugInfo* info, uint64_t offset, SourceLocation* location)
+{
+	DebugInfoIterator iter;
+	DebugInfoIteratorInit(&iter, info);
+	DebugEntry entry;
+	bool is_found = false;
+	//The location of an offset is the one of the last entry preceding it
+	while (DebugInfoNext(&iter, &entry) && entry.offset <= offset)
+	{
+		*location = entry.location;
+		is_found = true;
+	}
+	return is_found;
+}
+
+void DebugInfoIteratorInit(DebugInfoIterator* iter, const DebugInfo* info)
+{
+	iter->info = info;
+	iter->position = 0;
+	iter->current.offset = 0;
+	iter->current.location.line = 0;
+	iter->current.location.column = 0;
+}
+
+bool DebugInfoNext(DebugInfoIterator* iter, DebugEntry* entry)
+{
+	if (iter->position == iter->info->size)
+		return false;
+	uint64_t position = iter->position;
+	uint64_t offset_delta, line_delta, column;
+	if (!impl_debug_info_read_uleb128(iter->info, &position, &offset_delta)
+		|| !impl_debug_info_read_uleb128(iter->info, &position, &line_delta)
+		|| !impl_debug_info_read_uleb128(iter->info, &position, &column) || column > UINT32_MAX)
+		return false;
+
+	iter->position = position;
+	iter->current.offset += offset_delta;
+	iter->current.location.line = (uint32_t)((int64_t)iter->current.location.line + impl_zigzag_decode(line_delta));
+	iter->current.location.column = (uint32_t)column;
+	*entry = iter->current;
+	return true;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+void impl_debug_info_restore_last(DebugInfo* info)
+{
+	DebugInfoIterator iter;
+	DebugInfoIteratorInit(&iter, info);
+	DebugEntry entry;
+	while (DebugInfoNext(&iter, &entry));
+	info->last = iter.current;
+}
+
+void impl_debug_info_write_uleb128(DebugInfo* info, uint64_t value)
+{
+	//A LEB128 takes at most 10 bytes
+	if (info->capacity - info->size < 10)
+	{
+		uint64_t new_capacity = info->capacity == 0 ? 64 : info->capacity * 2;
+		uint8_t* ptr = (uint8_t*)safe_malloc(new_capacity);
+		if (info->data != NULL)
+		{
+			memcpy(ptr, info->data, info->size);
+			safe_free(info->data);
+		}
+		info->data = ptr;
+		info->capacity = new_capacity;
+	}
+	while (value >= 0x80)
+	{
+		info->data[info->size++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	info->data[info->size++] = (uint8_t)value;
+}
+
+bool impl_debug_info_read_uleb128(const DebugInfo* info, uint64_t* position, uint64_t* value)
+{
+	uint64_t result = 0;
+	uint64_t local_position = *position;
+	for (uint32_t shift = 0; shift < 64; shift += 7)
+	{
+		if (local_position == info->size)
+			return false;
+		uint8_t byte = info->data[local_position++];
+		//The 10th byte can only contain the most significant bit
+		if (shift == 63 && byte > 1)
+			return false;
+		result |= (uint64_t)(byte & 0x7F) << shift;
+		if (byte < 0x80)
+		{
+			*position = local_position;
+			*value = result;
+			return true;
+		}
+	}
+	return false;
+}
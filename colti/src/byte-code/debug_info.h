@@ -0,0 +1,114 @@
+/** @file debug_info.h
+* Contains the DebugInfo side table of a Chunk, which maps offsets of the code back to source locations.
+* The table is only read when reporting errors or profiling, and never by the VM while running.
+* It is written by the emitter (see ChunkSetSourceLocation) before the instructions of each
+* source location, and only records the changes of location. Each entry is delta encoded:
+* - the offset, as an unsigned LEB128 delta from the offset of the previous entry
+* - the line, as a zigzag LEB128 delta from the line of the previous entry
+* - the column, as an unsigned LEB128
+* As consecutive instructions mostly share their location, and an entry usually takes 3 bytes,
+* the table costs less than a byte per instruction.
+* Looking up an offset decodes the entries from the beginning, stopping at the first entry past the offset.
+*/
+
+#ifndef HG_COLTI_DEBUG_INFO
+#define HG_COLTI_DEBUG_INFO
+
+#include "common.h"
+
+/// @brief A location in the source code
+typedef struct
+{
+	/// @brief The line (starting at 1)
+	uint32_t line;
+	/// @brief The column (starting at 1)
+	uint32_t column;
+} SourceLocation;
+
+/// @brief A decoded entry of a DebugInfo
+typedef struct
+{
+	/// @brief The offset of the first instruction emitted for 'location'
+	uint64_t offset;
+	/// @brief The source location of the instructions starting at 'offset'
+	SourceLocation location;
+} DebugEntry;
+
+/// @brief A delta encoded table mapping offsets of code to source locations
+typedef struct
+{
+	/// @brief The number of bytes of the table
+	uint64_t size;
+	/// @brief The capacity of the table
+	uint64_t capacity;
+	/// @brief The encoded entries, NULL if empty
+	uint8_t* data;
+	/// @brief The last entry added, from which the next entry is delta encoded
+	DebugEntry last;
+} DebugInfo;
+
+/// @brief An iterator over the entries of a DebugInfo, in increasing order of offsets
+typedef struct
+{
+	/// @brief The table being iterated
+	const DebugInfo* info;
+	/// @brief The position of the next entry in the table
+	uint64_t position;
+	/// @brief The last entry decoded
+	DebugEntry current;
+} DebugInfoIterator;
+
+/// @brief Initializes an empty DebugInfo
+/// @param info The table to initialize
+void DebugInfoInit(DebugInfo* info);
+
+/// @brief Frees the resources used by a DebugInfo
+/// @param info The table to free
+void DebugInfoFree(DebugInfo* info);
+
+/// @brief Records that the code starting at 'offset' was emitted for 'location'.
+/// Nothing is recorded if the location did not change.
+/// @param info The table to modify
+/// @param offset The offset of the code (greater or equal to the offset of the last entry)
+/// @param location The source location of the code
+void DebugInfoAdd(DebugInfo* info, uint64_t offset, SourceLocation location);
+
+/// @brief Finds the source location of the instruction at 'offset'
+/// @param info The table in which to search
+/// @param offset The offset of the instruction
+/// @param location Pointer to where to write the location
+/// @return False if no location was recorded for the offset (or if the table is corrupted)
+bool DebugInfoFind(const DebugInfo* info, uint64_t offset, SourceLocation* location);
+
+/// @brief Initializes an iterator over the entries of a DebugInfo
+/// @param iter The iterator to initialize
+/// @param info The table to iterate over
+void DebugInfoIteratorInit(DebugInfoIterator* iter, const DebugInfo* info);
+
+/// @brief Decodes the next entry of a DebugInfo
+/// @param iter The iterator to advance
+/// @param entry Pointer to where to write the entry
+/// @return False if there are no more entries (or if the table is corrupted)
+bool DebugInfoNext(DebugInfoIterator* iter, DebugEntry* entry);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Restores the last entry of a DebugInfo whose data was loaded from a file, so that entries can be appended
+/// @param info The table to modify
+void impl_debug_info_restore_last(DebugInfo* info);
+
+/// @brief Appends an unsigned LEB128 to a DebugInfo
+/// @param info The table to modify
+/// @param value The value to append
+void impl_debug_info_write_uleb128(DebugInfo* info, uint64_t value);
+
+/// @brief Reads an unsigned LEB128 from a DebugInfo, checking that it is complete
+/// @param info The table from which to read
+/// @param position Pointer to the position of the value, which is advanced past the value
+/// @param value Pointer to where to write the value
+/// @return False if the value is truncated or too big
+bool impl_debug_info_read_uleb128(const DebugInfo* info, uint64_t* position, uint64_t* value);
+
+#endif //HG_COLTI_DEBUG_INFO
@@ -5,6 +5,11 @@
 #include "disassemble.h"
 
 void ChunkDisassemble(const Chunk* chunk, const char* name)
+{
+	ChunkDisassembleSamples(chunk, name, NULL, 0);
+}
+
+void ChunkDisassembleSamples(const Chunk* chunk, const char* name, const uint64_t* samples, uint64_t sample_count)
 {
 	printf("============ %s ============\n", name);
 
@@ -13,12 +18,67 @@ void ChunkDisassemble(const Chunk* chunk, const char* name)
 		printf("!EMPTY CHUNK!");
 		return;
 	}
+	DebugInfoIterator iter;
+	DebugEntry next;
+	DebugInfoIteratorInit(&iter, &chunk->debug_info);
+	if (!DebugInfoNext(&iter, &next))
+		next.offset = UINT64_MAX;
+
+	if (chunk->encoding == CHUNK_ENCODING_COMPACT)
+	{
+		Instruction instr;
+		for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+		{
+			impl_print_samples(samples, sample_count, offset);
+			impl_print_source_location(chunk, &iter, &next, offset);
+			printf("%04"PRIu64" ", offset);
+			if (!CompactDecodeInstruction(chunk, offset, &instr))
+			{
+				printf("INVALID INSTRUCTION: '%d'\n", chunk->code[offset]);
+				return;
+			}
+			impl_print_decoded_instruction(chunk, &instr, offset);
+		}
+		return;
+	}
 	for (uint64_t offset = 0; offset < chunk->count;)
 	{
+		impl_print_samples(samples, sample_count, offset);
+		impl_print_source_location(chunk, &iter, &next, offset);
 		offset = impl_chunk_print_code(chunk, offset);
 	}
 }
 
+void impl_print_samples(const uint64_t* samples, uint64_t sample_count, uint64_t offset)
+{
+	if (samples == NULL)
+		return;
+	if (samples[offset] == 0)
+		printf("%16s | ", "");
+	else
+		printf("%6.2f%% %8"PRIu64" | ", 100.0 * (double)samples[offset] / (double)sample_count, samples[offset]);
+}
+
+void impl_print_source_location(const Chunk* chunk, DebugInfoIterator* iter, DebugEntry* next, uint64_t offset)
+{
+	if (chunk->debug_info.size == 0)
+		return;
+	if (next->offset > offset)
+	{
+		printf("   |      | ");
+		return;
+	}
+	//Print the last entry starting at or before this instruction
+	SourceLocation location = next->location;
+	while (next->offset <= offset)
+	{
+		location = next->location;
+		if (!DebugInfoNext(iter, next))
+			next->offset = UINT64_MAX;
+	}
+	printf("%4"PRIu32":%-4"PRIu32" | ", location.line, location.column);
+}
+
 uint64_t impl_chunk_print_code(const Chunk* chunk, uint64_t offset)
 {
 	printf("%04"PRIu64" ", offset);
@@ -34,25 +94,73 @@ uint64_t impl_chunk_print_code(const Chunk* chunk, uint64_t offset)
 		return offset;
 
 	case OP_IMMEDIATE_WORD:
-		colti_assert(offset + ((uint64_t)(chunk->code + offset) & 1) + sizeof(int16_t) <= chunk->count, "Missing int16 after OP_IMMEDIATE_WORD");
+		colti_assert(offset + 1 + impl_chunk_padding(offset + 1, sizeof(int16_t)) + sizeof(int16_t) <= chunk->count, "Missing int16 after OP_IMMEDIATE_WORD");
 		impl_print_hex_instruction("OP_IMMEDIATE_WORD", ChunkGetWORD(chunk, &offset).ui16);
 		return offset;
 
 	case OP_IMMEDIATE_DWORD:
-		colti_assert(offset + ((uint64_t)(chunk->code + offset) % 4) + sizeof(int32_t) <= chunk->count, "Missing int32 after OP_IMMEDIATE_DWORD");
+		colti_assert(offset + 1 + impl_chunk_padding(offset + 1, sizeof(int32_t)) + sizeof(int32_t) <= chunk->count, "Missing int32 after OP_IMMEDIATE_DWORD");
 		impl_print_hex_instruction("OP_IMMEDIATE_DWORD", ChunkGetDWORD(chunk, &offset).ui32);
 		return offset;
 
 	case OP_IMMEDIATE_QWORD:
-		colti_assert(offset + ((uint64_t)(chunk->code + offset) % 8) + sizeof(int64_t) <= chunk->count, "Missing int64 after OP_IMMEDIATE_QWORD");
+		colti_assert(offset + 1 + impl_chunk_padding(offset + 1, sizeof(int64_t)) + sizeof(int64_t) <= chunk->count, "Missing int64 after OP_IMMEDIATE_QWORD");
 		impl_print_hex_instruction("OP_IMMEDIATE_QWORD", ChunkGetQWORD(chunk, &offset).ui64);
 		return offset;
 
 		/******************************************************/
 
+	case OP_LOAD_CONST_BYTE:
+		colti_assert(offset + 1 < chunk->count, "Missing index after OP_LOAD_CONST_BYTE!");
+		return impl_print_constant_instruction("OP_LOAD_CONST_BYTE", chunk, offset);
+	case OP_LOAD_CONST_WORD:
+		colti_assert(offset + 1 + impl_chunk_padding(offset + 1, sizeof(int16_t)) + sizeof(int16_t) <= chunk->count, "Missing index after OP_LOAD_CONST_WORD");
+		return impl_print_constant_instruction("OP_LOAD_CONST_WORD", chunk, offset);
+
+		/******************************************************/
+
+	case OP_LOAD_LOCAL_BYTE:
+	case OP_LOAD_LOCAL_WORD:
+	case OP_STORE_LOCAL_BYTE:
+	case OP_STORE_LOCAL_WORD:
+	case OP_INC_LOCAL_BYTE:
+	case OP_INC_LOCAL_WORD:
+		return impl_print_aligned_instruction(chunk, offset);
+
+		/******************************************************/
+
+	case OP_LOAD_GLOBAL:
+	case OP_STORE_GLOBAL:
+		return impl_print_aligned_instruction(chunk, offset);
+
+		/******************************************************/
+
+	case OP_BOX:
+	case OP_UNBOX:
+		return impl_print_operand_instruction(OpCodeToString(instruction), chunk->code[offset + 1], offset);
+	case OP_ADD_DYNAMIC:
+	case OP_ADD_DYNAMIC_I64:
+	case OP_ADD_DYNAMIC_DOUBLE:
+	case OP_ADD_DYNAMIC_POLY:
+		return impl_print_aligned_instruction(chunk, offset);
+
+		/******************************************************/
+
 	case OP_NEGATE:
 		return impl_print_operand_instruction("OP_NEGATE", chunk->code[offset + 1], offset);
 
+	case OP_CONVERT:
+		return impl_print_conversion_instruction("OP_CONVERT", chunk->code[offset + 1], chunk->code[offset + 2], offset);
+	case OP_CVT_I32_I64:
+	case OP_CVT_I64_I32:
+	case OP_CVT_I32_DOUBLE:
+	case OP_CVT_DOUBLE_I32:
+	case OP_CVT_I64_DOUBLE:
+	case OP_CVT_DOUBLE_I64:
+	case OP_CVT_FLOAT_DOUBLE:
+	case OP_CVT_DOUBLE_FLOAT:
+		return impl_print_simple_instruction(OpCodeToString(instruction), offset);
+
 	case OP_ADD:
 		return impl_print_operand_instruction("OP_ADD", chunk->code[offset + 1], offset);
 	case OP_SUBTRACT:
@@ -61,6 +169,61 @@ uint64_t impl_chunk_print_code(const Chunk* chunk, uint64_t offset)
 		return impl_print_operand_instruction("OP_MULTIPLY", chunk->code[offset + 1], offset);
 	case OP_DIVIDE:
 		return impl_print_operand_instruction("OP_DIVIDE", chunk->code[offset + 1], offset);
+	case OP_MODULO:
+		return impl_print_operand_instruction("OP_MODULO", chunk->code[offset + 1], offset);
+	case OP_ADD_CHECKED:
+	case OP_SUBTRACT_CHECKED:
+	case OP_MULTIPLY_CHECKED:
+	case OP_DIVIDE_CHECKED:
+	case OP_MODULO_CHECKED:
+	case OP_ADD_WRAPPING:
+	case OP_SUBTRACT_WRAPPING:
+	case OP_MULTIPLY_WRAPPING:
+		//The padding of a quickened OpCode is the OperandType it implies
+	case OP_ADD_I64:
+	case OP_ADD_DOUBLE:
+	case OP_SUBTRACT_I64:
+	case OP_SUBTRACT_DOUBLE:
+	case OP_MULTIPLY_I64:
+	case OP_MULTIPLY_DOUBLE:
+		return impl_print_operand_instruction(OpCodeToString(instruction), chunk->code[offset + 1], offset);
+	case OP_DIVIDE_CONST:
+	case OP_MODULO_CONST:
+		return impl_print_aligned_instruction(chunk, offset);
+
+		/******************************************************/
+
+	case OP_ARRAY_NEW:
+	case OP_ARRAY_LENGTH:
+	case OP_ARRAY_GET:
+	case OP_ARRAY_SET:
+	case OP_ARRAY_ADD:
+	case OP_ARRAY_SUBTRACT:
+	case OP_ARRAY_MULTIPLY:
+	case OP_ARRAY_DIVIDE:
+	case OP_ARRAY_NEGATE:
+	case OP_ARRAY_SUM:
+	case OP_ARRAY_MIN:
+	case OP_ARRAY_MAX:
+	case OP_ARRAY_DOT:
+		return impl_print_operand_instruction(OpCodeToString(instruction), chunk->code[offset + 1], offset);
+	case OP_ARRAY_CONVERT:
+		return impl_print_conversion_instruction("OP_ARRAY_CONVERT", chunk->code[offset + 1], chunk->code[offset + 2], offset);
+
+		/******************************************************/
+
+	case OP_ENTER:
+	case OP_CALL:
+	case OP_TAIL_CALL:
+	case OP_JUMP:
+	case OP_JUMP_IF_FALSE:
+	case OP_JUMP_IF_LESS:
+	case OP_JUMP_IF_LESS_EQUAL:
+	case OP_JUMP_IF_EQUAL:
+	case OP_JUMP_IF_NOT_EQUAL:
+	case OP_JUMP_TABLE:
+	case OP_LOOP:
+		return impl_print_aligned_instruction(chunk, offset);
 
 		/******************************************************/
 
@@ -78,6 +241,108 @@ uint64_t impl_chunk_print_code(const Chunk* chunk, uint64_t offset)
 	}
 }
 
+uint64_t impl_print_aligned_instruction(const Chunk* chunk, uint64_t offset)
+{
+	Instruction instr;
+	if (!ChunkDecodeInstruction(chunk, offset, &instr))
+	{
+		printf("TRUNCATED INSTRUCTION: '%s'\n", OpCodeToString(chunk->code[offset]));
+		return chunk->count;
+	}
+	impl_print_decoded_instruction(chunk, &instr, offset);
+	return offset + instr.size;
+}
+
+void impl_print_decoded_instruction(const Chunk* chunk, const Instruction* instr, uint64_t offset)
+{
+	const char* name = OpCodeToString(instr->code);
+	switch (OpCodeGetLayout(instr->code))
+	{
+	break; case LAYOUT_TYPE:
+	case LAYOUT_QUICKENED:
+		printf("%s '%s'\n", name, OperandTypeToString(instr->types[0]));
+	break; case LAYOUT_TWO_TYPES:
+		printf("%s '%s' -> '%s'\n", name, OperandTypeToString(instr->types[0]), OperandTypeToString(instr->types[1]));
+	break; case LAYOUT_BYTE: case LAYOUT_WORD: case LAYOUT_DWORD: case LAYOUT_QWORD:
+		if (instr->code == OP_LOAD_CONST_BYTE || instr->code == OP_LOAD_CONST_WORD)
+		{
+			if (instr->immediate.ui64 < chunk->constant_count)
+				printf("%s #%"PRIu64" '0x%"PRIX64"'\n", name, instr->immediate.ui64, chunk->constants[instr->immediate.ui64].ui64);
+			else
+				printf("%s #%"PRIu64" 'INVALID CONSTANT'\n", name, instr->immediate.ui64);
+		}
+		else if (instr->code >= OP_LOAD_LOCAL_BYTE && instr->code <= OP_STORE_LOCAL_WORD)
+			printf("%s $%"PRIu64"\n", name, instr->immediate.ui64);
+		else if (instr->code == OP_LOAD_GLOBAL || instr->code == OP_STORE_GLOBAL)
+		{
+			if (instr->immediate.ui64 < chunk->global_count)
+				printf("%s @%"PRIu64" '%s'\n", name, instr->immediate.ui64, chunk->globals[instr->immediate.ui64]->name);
+			else
+				printf("%s @%"PRIu64" 'INVALID GLOBAL'\n", name, instr->immediate.ui64);
+		}
+		else if (InlineCacheIsDynamicOpCode(instr->code))
+		{
+			//The caches are only allocated once the chunk is verified
+			printf("%s cache #%"PRIu64, name, instr->immediate.ui64);
+			if (chunk->inline_caches != NULL && instr->immediate.ui64 < chunk->cache_count)
+				impl_print_inline_cache(chunk->inline_caches + instr->immediate.ui64);
+			printf("\n");
+		}
+		else
+			impl_print_hex_instruction(name, instr->immediate.ui64);
+	break; case LAYOUT_TYPE_BYTE:
+		printf("%s '%s' $%"PRIu64"\n", name, OperandTypeToString(instr->types[0]), instr->immediate.ui64);
+	break; case LAYOUT_TYPE_WORD:
+		if (instr->code == OP_INC_LOCAL_WORD)
+			printf("%s '%s' $%"PRIu64"\n", name, OperandTypeToString(instr->types[0]), instr->immediate.ui64);
+		else if (instr->immediate.ui64 < chunk->constant_count)
+			printf("%s '%s' #%"PRIu64" '0x%"PRIX64"'\n", name, OperandTypeToString(instr->types[0]),
+				instr->immediate.ui64, chunk->constants[instr->immediate.ui64].ui64);
+		else
+			printf("%s '%s' #%"PRIu64" 'INVALID CONSTANT'\n", name, OperandTypeToString(instr->types[0]), instr->immediate.ui64);
+	break; case LAYOUT_TWO_BYTES:
+		printf("%s '%"PRIu64"' args '%"PRIu64"' locals\n", name, (uint64_t)instr->immediate.ui8, instr->immediate.ui64 >> 8);
+	break; case LAYOUT_TARGET:
+		printf("%s @%04"PRIu64"\n", name, instr->immediate.ui64);
+	break; case LAYOUT_JUMP:
+		printf("%s %+"PRId64" @%04"PRIu64"\n", name, instr->immediate.i64, offset + instr->immediate.i64);
+	break; case LAYOUT_TYPE_JUMP:
+		printf("%s '%s' %+"PRId64" @%04"PRIu64"\n", name, OperandTypeToString(instr->types[0]),
+			instr->immediate.i64, offset + instr->immediate.i64);
+	break; case LAYOUT_LOOP:
+		//The counters are only allocated once the chunk is verified
+		printf("%s %+"PRId64" @%04"PRIu64" counter #%"PRIu32, name, instr->immediate.i64, offset + instr->immediate.i64, instr->index);
+		if (chunk->loop_counters != NULL && instr->index < chunk->loop_count)
+			printf(" '%"PRIu64"' iterations", chunk->loop_counters[instr->index]);
+		printf("\n");
+	break; case LAYOUT_JUMP_TABLE:
+		printf("%s '%"PRIu32"' cases\n", name, instr->index);
+		for (uint32_t i = 0; i <= instr->index; i++)
+		{
+			int64_t relative = impl_chunk_jump_table_offset(instr->table, i);
+			if (i == instr->index)
+				printf("%14s %+"PRId64" @%04"PRIu64"\n", "default", relative, offset + relative);
+			else
+				printf("%9s %4"PRIu32" %+"PRId64" @%04"PRIu64"\n", "case", i, relative, offset + relative);
+		}
+	break; default:
+		printf("%s\n", name);
+	}
+}
+
+void impl_print_inline_cache(const InlineCache* cache)
+{
+	if (cache->count == INLINE_CACHE_MEGAMORPHIC)
+		printf(" 'MEGAMORPHIC'");
+	else
+	{
+		for (uint8_t i = 0; i < cache->count; i++)
+			printf(" '%s'", OperandTypeToString(cache->types[i]));
+	}
+	if (cache->deopt_count != 0)
+		printf(" '%"PRIu32"' deopts", cache->deopt_count);
+}
+
 uint64_t impl_print_simple_instruction(const char* name, uint64_t offset)
 {
 	printf("%s\n", name);
@@ -92,26 +357,27 @@ uint64_t impl_print_byte_instruction(const char* name, uint8_t byte, uint64_t of
 
 uint64_t impl_print_operand_instruction(const char* name, uint8_t byte, uint64_t offset)
 {
-	const char* operand;
-	switch (byte)
-	{
-	break; case OPERAND_COLTI_BOOL:		operand = "BOOL";
-	break; case OPERAND_COLTI_DOUBLE:	operand = "DOUBLE";
-	break; case OPERAND_COLTI_FLOAT:	operand = "FLOAT";
-	break; case OPERAND_COLTI_I8:		operand = "INT8";
-	break; case OPERAND_COLTI_I16:		operand = "INT16";
-	break; case OPERAND_COLTI_I32:		operand = "INT32";
-	break; case OPERAND_COLTI_I64:		operand = "INT64";
-	break; case OPERAND_COLTI_UI8:		operand = "UINT8";
-	break; case OPERAND_COLTI_UI16:		operand = "UINT16";
-	break; case OPERAND_COLTI_UI32:		operand = "UINT32";
-	break; case OPERAND_COLTI_UI64:		operand = "UINT64";
-	break; default:						operand = "UNKOWN";
-	}
+	const char* operand = OperandTypeToString(byte);
 	printf("%s '%s'\n", name, operand);
 	return offset + 2;
 }
 
+uint64_t impl_print_conversion_instruction(const char* name, uint8_t from, uint8_t to, uint64_t offset)
+{
+	printf("%s '%s' -> '%s'\n", name, OperandTypeToString(from), OperandTypeToString(to));
+	return offset + 3;
+}
+
+uint64_t impl_print_constant_instruction(const char* name, const Chunk* chunk, uint64_t offset)
+{
+	uint16_t index = ChunkGetConstantIndex(chunk, &offset);
+	if (index < chunk->constant_count)
+		printf("%s #%"PRIu16" '0x%"PRIX64"'\n", name, index, chunk->constants[index].ui64);
+	else
+		printf("%s #%"PRIu16" 'INVALID CONSTANT'\n", name, index);
+	return offset;
+}
+
 void impl_print_int_instruction(const char* name, int64_t value)
 {
 	printf("%s '%"PRId64"'", name, value);
@@ -6,22 +6,61 @@
 #define HG_COLTI_DISASSEMBLE
 
 #include "chunk.h"
+#include "compact_encoding.h"
 
 /// @brief Prints a human readable description of the code contained in a chunk
 /// @param chunk The chunk whose content to print
 /// @param name The chunk name
 void ChunkDisassemble(const Chunk* chunk, const char* name);
 
+/// @brief Prints a human readable description of the code contained in a chunk,
+/// prefixing each instruction with the number (and percentage) of samples recorded at its offset
+/// @param chunk The chunk whose content to print
+/// @param name The chunk name
+/// @param samples The number of samples recorded at each offset of the code (of size 'chunk->count'), or NULL
+/// @param sample_count The total number of samples
+void ChunkDisassembleSamples(const Chunk* chunk, const char* name, const uint64_t* samples, uint64_t sample_count);
+
 /**********************************
 IMPLEMENTATION HELPERS
 **********************************/
 
+/// @brief Prints the number of samples recorded at an offset, and their percentage of the total
+/// @param samples The number of samples recorded at each offset, or NULL (in which case nothing is printed)
+/// @param sample_count The total number of samples
+/// @param offset The offset of the instruction
+void impl_print_samples(const uint64_t* samples, uint64_t sample_count, uint64_t offset);
+
+/// @brief Prints the source location of an instruction if it starts a new location, or '|' if it shares the location
+/// of the previous instruction. Nothing is printed if the chunk does not contain any source location.
+/// @param chunk The chunk containing the instruction
+/// @param iter The iterator over the DebugInfo of the chunk
+/// @param next Pointer to the next entry (whose offset is UINT64_MAX if there are none), which is advanced
+/// @param offset The offset of the instruction
+void impl_print_source_location(const Chunk* chunk, DebugInfoIterator* iter, DebugEntry* next, uint64_t offset);
+
 /// @brief Dispatches a code to the correct printing function
 /// @param chunk The chunk from which to extract the code
 /// @param offset The offset to the code
 /// @return Modified offset
 uint64_t impl_chunk_print_code(const Chunk* chunk, uint64_t offset);
 
+/// @brief Prints a decoded instruction (used for chunks using the compact encoding)
+/// @param chunk The chunk containing the instruction and the constant pool
+/// @param instr The instruction to print
+/// @param offset The offset of the instruction, to which the jump offsets are relative
+void impl_print_decoded_instruction(const Chunk* chunk, const Instruction* instr, uint64_t offset);
+
+/// @brief Decodes then prints an instruction of a chunk using the aligned encoding, or prints that it is truncated
+/// @param chunk The chunk containing the instruction
+/// @param offset The offset of the instruction
+/// @return The offset of the next instruction, or the size of the code if the instruction is truncated (which stops the disassembly)
+uint64_t impl_print_aligned_instruction(const Chunk* chunk, uint64_t offset);
+
+/// @brief Prints the types recorded by the InlineCache of a dynamically typed instruction, and its deoptimizations
+/// @param cache The cache to print
+void impl_print_inline_cache(const InlineCache* cache);
+
 /// @brief Prints a one byte instruction
 /// @param name The name of the instruction
 /// @param offset The current byte offset
@@ -42,6 +81,21 @@ uint64_t impl_print_byte_instruction(const char* name, uint8_t byte, uint64_t of
 /// @return The current byte offset + 2
 uint64_t impl_print_operand_instruction(const char* name, uint8_t byte, uint64_t offset);
 
+/// @brief Prints a one byte instruction followed by the 2 operands following it
+/// @param name The name of the instruction
+/// @param from The first operand (the type from which to convert)
+/// @param to The second operand (the type to which to convert)
+/// @param offset The current byte offset
+/// @return The current byte offset + 3
+uint64_t impl_print_conversion_instruction(const char* name, uint8_t from, uint8_t to, uint64_t offset);
+
+/// @brief Prints a constant loading instruction, followed by its index and the constant it resolves to
+/// @param name The name of the instruction
+/// @param chunk The chunk containing the instruction and the constant pool
+/// @param offset The current byte offset (pointing to the OP_LOAD_CONST_(BYTE|WORD))
+/// @return The byte offset of the next instruction
+uint64_t impl_print_constant_instruction(const char* name, const Chunk* chunk, uint64_t offset);
+
 /// @brief Prints a one byte instruction followed by the int following it.
 /// There is no offset to pass to this function, but rather, the 'value' argument
 /// should be ChunkGetInt[16|32|64](..., &offset).
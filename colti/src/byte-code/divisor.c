@@ -0,0 +1,136 @@
+/** @file divisor.c
+* Contains the definitions of the functions declared in 'divisor.h'
+*/
+
+#include "divisor.h"
+
+void DivisorInit(Divisor* divisor, QWORD value)
+{
+	colti_assert(value.ui64 != 0, "Division by zero!");
+	divisor->value = value;
+
+	//Unsigned division
+	uint64_t d = value.ui64;
+	uint8_t log2 = (uint8_t)(63 - impl_count_leading_zeros(d));
+	if ((d & (d - 1)) == 0)
+	{
+		divisor->unsigned_magic = 0;
+		divisor->unsigned_more = log2;
+	}
+	else
+	{
+		uint64_t remainder;
+		uint64_t magic = impl_divisor_divide_128(1ULL << log2, d, &remainder);
+		if (d - remainder < (1ULL << log2))
+			divisor->unsigned_more = log2;
+		else
+		{
+			//The magic number needs 65 bits
+			uint64_t twice_remainder = remainder + remainder;
+			magic += magic;
+			if (twice_remainder >= d || twice_remainder < remainder)
+				magic++;
+			divisor->unsigned_more = log2 | DIVISOR_ADD_MARKER;
+		}
+		divisor->unsigned_magic = magic + 1;
+	}
+
+	//Signed division
+	uint64_t abs_d = value.i64 < 0 ? 0 - value.ui64 : value.ui64;
+	uint8_t negative = value.i64 < 0 ? DIVISOR_NEGATIVE : 0;
+	log2 = (uint8_t)(63 - impl_count_leading_zeros(abs_d));
+	if ((abs_d & (abs_d - 1)) == 0)
+	{
+		divisor->signed_magic = 0;
+		divisor->signed_more = log2 | negative;
+	}
+	else
+	{
+		uint64_t remainder;
+		uint64_t magic = impl_divisor_divide_128(1ULL << (log2 - 1), abs_d, &remainder);
+		if (abs_d - remainder < (1ULL << log2))
+			divisor->signed_more = (log2 - 1) | negative;
+		else
+		{
+			uint64_t twice_remainder = remainder + remainder;
+			magic += magic;
+			if (twice_remainder >= abs_d || twice_remainder < remainder)
+				magic++;
+			divisor->signed_more = log2 | DIVISOR_ADD_MARKER | negative;
+		}
+		magic++;
+		divisor->signed_magic = (int64_t)(negative ? 0 - magic : magic);
+	}
+}
+
+uint64_t DivisorDivideUnsigned(const Divisor* divisor, uint64_t value)
+{
+	uint8_t more = divisor->unsigned_more;
+	if (divisor->unsigned_magic == 0)
+		return value >> more;
+
+	uint64_t quotient = impl_multiply_128(divisor->unsigned_magic, value).high;
+	if (more & DIVISOR_ADD_MARKER)
+		return (((value - quotient) >> 1) + quotient) >> (more & DIVISOR_SHIFT_MASK);
+	return quotient >> more;
+}
+
+int64_t DivisorDivideSigned(const Divisor* divisor, int64_t value)
+{
+	uint8_t more = divisor->signed_more;
+	uint8_t shift = more & DIVISOR_SHIFT_MASK;
+	//All ones if the divisor is negative
+	uint64_t sign = (more & DIVISOR_NEGATIVE) ? UINT64_MAX : 0;
+	uint64_t quotient;
+	if (divisor->signed_magic == 0)
+	{
+		//Round toward zero by adding (2^shift - 1) to negative dividends
+		uint64_t mask = (1ULL << shift) - 1;
+		uint64_t biased = (uint64_t)value + (value < 0 ? mask : 0);
+		quotient = (uint64_t)((int64_t)biased >> shift);
+		//Negates the quotient if the divisor is negative (wrapping for INT64_MIN / -1)
+		return (int64_t)((quotient ^ sign) - sign);
+	}
+
+	//The high half of the signed product, from the unsigned one
+	uint64_t magic = (uint64_t)divisor->signed_magic;
+	quotient = impl_multiply_128(magic, (uint64_t)value).high;
+	quotient -= (divisor->signed_magic < 0 ? (uint64_t)value : 0) + (value < 0 ? magic : 0);
+	if (more & DIVISOR_ADD_MARKER)
+		quotient += ((uint64_t)value ^ sign) - sign;
+	quotient = (uint64_t)((int64_t)quotient >> shift);
+	//Round toward zero
+	quotient += quotient >> 63;
+	return (int64_t)quotient;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+uint64_t impl_divisor_divide_128(uint64_t high, uint64_t divisor, uint64_t* remainder)
+{
+	colti_assert(high < divisor, "Quotient does not fit in 64 bits!");
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 dividend = (unsigned __int128)high << 64;
+	*remainder = (uint64_t)(dividend % divisor);
+	return (uint64_t)(dividend / divisor);
+#else
+	//Long division, shifting in the 64 zero bits of the low half
+	uint64_t rem = high;
+	uint64_t quotient = 0;
+	for (int i = 0; i < 64; i++)
+	{
+		uint64_t carry = rem >> 63;
+		rem <<= 1;
+		quotient <<= 1;
+		if (carry || rem >= divisor)
+		{
+			rem -= divisor;
+			quotient |= 1;
+		}
+	}
+	*remainder = rem;
+	return quotient;
+#endif
+}
@@ -0,0 +1,69 @@
+/** @file divisor.h
+* Contains the Divisor, the precomputed reciprocal of a constant divisor.
+* Dividing by a Divisor costs a multiplication (keeping the high half of the product) and shifts,
+* rather than a hardware division. The magic numbers are computed as in libdivide: for a divisor 'd'
+* whose floor(log2(|d|)) is 'L', the magic number is ceil(2^(64 + L) / d), which may need 65 bits
+* (in which case the 65th bit is added back using DIVISOR_ADD_MARKER).
+* A Divisor is computed once for each constant of a Chunk (see ChunkVerify), for both signed
+* and unsigned divisions, as the OperandType of the instructions using it is not known in advance.
+* Narrower integers are divided as 64-bit integers (which gives the same quotient once truncated).
+*/
+
+#ifndef HG_COLTI_DIVISOR
+#define HG_COLTI_DIVISOR
+
+#include "common.h"
+#include "number_conversion.h"
+
+/// @brief The mask of the shift of a Divisor, in 'unsigned_more' and 'signed_more'
+#define DIVISOR_SHIFT_MASK 0x3F
+/// @brief Set if the magic number needs 65 bits (its 65th bit being added back after the multiplication)
+#define DIVISOR_ADD_MARKER 0x40
+/// @brief Set in 'signed_more' if the divisor is negative
+#define DIVISOR_NEGATIVE 0x80
+
+/// @brief The precomputed reciprocal of a divisor
+typedef struct
+{
+	/// @brief The divisor
+	QWORD value;
+	/// @brief The magic number of the unsigned division, 0 if the divisor is a power of 2
+	uint64_t unsigned_magic;
+	/// @brief The magic number of the signed division, 0 if the absolute value of the divisor is a power of 2
+	int64_t signed_magic;
+	/// @brief The shift and flags of the unsigned division
+	uint8_t unsigned_more;
+	/// @brief The shift and flags of the signed division
+	uint8_t signed_more;
+} Divisor;
+
+/// @brief Computes the reciprocal of a divisor
+/// @param divisor The Divisor to initialize
+/// @param value The divisor, as a 64-bit integer (sign-extended for signed divisions), which must not be 0
+void DivisorInit(Divisor* divisor, QWORD value);
+
+/// @brief Divides an unsigned integer by a Divisor (interpreted as an unsigned 64-bit integer)
+/// @param divisor The divisor
+/// @param value The dividend
+/// @return The quotient, rounded toward zero
+uint64_t DivisorDivideUnsigned(const Divisor* divisor, uint64_t value);
+
+/// @brief Divides a signed integer by a Divisor (interpreted as a signed 64-bit integer).
+/// INT64_MIN divided by -1 wraps to INT64_MIN.
+/// @param divisor The divisor
+/// @param value The dividend
+/// @return The quotient, rounded toward zero
+int64_t DivisorDivideSigned(const Divisor* divisor, int64_t value);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Divides the 128-bit integer (high * 2^64) by a 64-bit integer greater than 'high'
+/// @param high The high half of the dividend (whose low half is 0)
+/// @param divisor The divisor
+/// @param remainder Pointer to where to write the remainder
+/// @return The quotient, which fits in 64 bits as 'high' < 'divisor'
+uint64_t impl_divisor_divide_128(uint64_t high, uint64_t divisor, uint64_t* remainder);
+
+#endif //HG_COLTI_DIVISOR
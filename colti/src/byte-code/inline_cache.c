@@ -0,0 +1,56 @@
+/** @file inline_cache.c
+* Contains the definitions of the functions declared in 'inline_cache.h'
+*/
+
+#include "inline_cache.h"
+#include "thread.h"
+
+OpCode InlineCacheRecord(InlineCache* cache, OperandType type)
+{
+	//The threads running a shared Chunk may record types concurrently: a type is written to the first free slot,
+	//which is then published by incrementing 'count'. If another thread published that slot first, the
+	//type is recorded again in the next one (a type written over a published slot is still a type observed).
+	uint8_t count = atomicLoadByte(&cache->count);
+	while (!InlineCacheContains(cache, type))
+	{
+		if (count == INLINE_CACHE_MEGAMORPHIC)
+			return OP_ADD_DYNAMIC;
+		if (count == INLINE_CACHE_SIZE)
+		{
+			if (atomicCompareExchangeByte(&cache->count, count, INLINE_CACHE_MEGAMORPHIC))
+				return OP_ADD_DYNAMIC;
+		}
+		else
+		{
+			atomicStoreByte(&cache->types[count], (uint8_t)type);
+			if (atomicCompareExchangeByte(&cache->count, count, count + 1))
+				break;
+		}
+		count = atomicLoadByte(&cache->count);
+	}
+	count = atomicLoadByte(&cache->count);
+	//Only the most common types have a monomorphic form
+	if (count == 1 && type == COLTI_INT64)
+		return OP_ADD_DYNAMIC_I64;
+	if (count == 1 && type == COLTI_DOUBLE)
+		return OP_ADD_DYNAMIC_DOUBLE;
+	return count == INLINE_CACHE_MEGAMORPHIC ? OP_ADD_DYNAMIC : OP_ADD_DYNAMIC_POLY;
+}
+
+bool InlineCacheContains(const InlineCache* cache, uint64_t type)
+{
+	//A megamorphic cache is not searched, as its instruction is never specialized
+	uint8_t count = atomicLoadByte(&cache->count);
+	count = count <= INLINE_CACHE_SIZE ? count : 0;
+	for (uint8_t i = 0; i < count; i++)
+	{
+		if (atomicLoadByte(&cache->types[i]) == type)
+			return true;
+	}
+	return false;
+}
+
+bool InlineCacheIsDynamicOpCode(uint8_t code)
+{
+	return code >= OP_ADD_DYNAMIC && code <= OP_ADD_DYNAMIC_POLY;
+}
@@ -0,0 +1,60 @@
+/** @file inline_cache.h
+* Contains the InlineCache, which records the types observed by a dynamically typed instruction.
+* Code compiled without full type information operates on dynamic values: a value followed (on the stack) by
+* a QWORD tag holding its OperandType. OP_BOX tags a value of a known type, and OP_UNBOX checks and drops the tag.
+* OP_ADD_DYNAMIC dispatches on the tags of its operands, which must be the same type (as for the typed OpCodes,
+* there are no implicit conversions): each such instruction has an InlineCache, in a side array of its Chunk
+* (see Chunk.inline_caches) indexed by the DWORD following the OpCode.
+* After running, the instruction rewrites itself (in place) to the form specialized for the types in its cache
+* (see InlineCacheRecord): monomorphic forms add the values directly (OP_ADD_DYNAMIC_I64, OP_ADD_DYNAMIC_DOUBLE),
+* and the polymorphic form (OP_ADD_DYNAMIC_POLY) dispatches on the few types of the cache.
+* Each form guards its assumption by comparing the tags: a guard that fails deoptimizes the instruction back to
+* OP_ADD_DYNAMIC, which records the new type and specializes it again. Once it observed more than INLINE_CACHE_SIZE
+* types, the instruction is megamorphic and stays OP_ADD_DYNAMIC.
+* All the forms compute the same result, the cache only choosing the fastest path: the rewrites of code shared by
+* multiple threads are single atomic byte stores (see atomicStoreByte), and a stale form only costs a deoptimization.
+* The caches of a shared Chunk are updated atomically too (see InlineCacheRecord), so that 'count' never exceeds
+* INLINE_CACHE_SIZE, a type lost to a concurrent update being recorded again on its next deoptimization.
+* The code of a read-only Chunk (see Chunk.is_read_only) is never rewritten, its caches still recording the types.
+*/
+
+#ifndef HG_COLTI_INLINE_CACHE
+#define HG_COLTI_INLINE_CACHE
+
+#include "common.h"
+#include "byte_code.h"
+
+/// @brief The number of types an InlineCache can record before becoming megamorphic
+#define INLINE_CACHE_SIZE 4
+/// @brief The value of 'InlineCache.count' once more than INLINE_CACHE_SIZE types were observed
+#define INLINE_CACHE_MEGAMORPHIC 0xFF
+
+/// @brief The types observed by a dynamically typed instruction
+typedef struct
+{
+	/// @brief The number of types in 'types', or INLINE_CACHE_MEGAMORPHIC
+	uint8_t count;
+	/// @brief The OperandType observed, in the order in which they were first observed
+	uint8_t types[INLINE_CACHE_SIZE];
+	/// @brief The number of times a guard of the instruction failed
+	uint32_t deopt_count;
+} InlineCache;
+
+/// @brief Records the OperandType of the operands of a dynamically typed instruction
+/// @param cache The cache of the instruction
+/// @param type The type of the operands
+/// @return The form of the instruction specialized for the types of the cache
+OpCode InlineCacheRecord(InlineCache* cache, OperandType type);
+
+/// @brief Check if an InlineCache recorded an OperandType
+/// @param cache The cache of the instruction
+/// @param type The type to search for
+/// @return True if 'type' is one of the types of the cache
+bool InlineCacheContains(const InlineCache* cache, uint64_t type);
+
+/// @brief Check if an OpCode is a (generic or specialized) dynamically typed OpCode, whose operand is the index of an InlineCache
+/// @param code The byte representing the OpCode
+/// @return True if 'code' is OP_ADD_DYNAMIC or one of its specialized forms
+bool InlineCacheIsDynamicOpCode(uint8_t code);
+
+#endif //HG_COLTI_INLINE_CACHE
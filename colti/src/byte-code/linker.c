@@ -0,0 +1,541 @@
+/** @file linker.c
+* Contains the definitions of the functions declared in 'linker.h'
+*/
+
+#include "linker.h"
+
+void LinkerInit(Linker* linker)
+{
+	linker->unit_count = 0;
+	linker->unit_capacity = 0;
+	linker->units = NULL;
+}
+
+void LinkerFree(Linker* linker)
+{
+	for (uint64_t i = 0; i < linker->unit_count; i++)
+	{
+		if (linker->units[i].dependencies != NULL)
+			safe_free(linker->units[i].dependencies);
+	}
+	if (linker->units != NULL)
+		safe_free(linker->units);
+	linker->unit_count = 0;
+	linker->unit_capacity = 0;
+	linker->units = NULL;
+}
+
+uint64_t LinkerAddUnit(Linker* linker, const char* name, const Chunk* chunk, bool is_root)
+{
+	if (linker->unit_count == linker->unit_capacity) //Grow if needed
+	{
+		uint64_t new_capacity = linker->unit_capacity == 0 ? 8 : linker->unit_capacity * 2;
+		LinkerUnit* ptr = (LinkerUnit*)safe_malloc(new_capacity * sizeof(LinkerUnit));
+		if (linker->units != NULL)
+		{
+			memcpy(ptr, linker->units, linker->unit_count * sizeof(LinkerUnit));
+			safe_free(linker->units);
+		}
+		linker->units = ptr;
+		linker->unit_capacity = new_capacity;
+	}
+	LinkerUnit unit = { name, chunk, 0, is_root, 0, 0, NULL };
+	linker->units[linker->unit_count] = unit;
+	return linker->unit_count++;
+}
+
+void LinkerAddDependency(Linker* linker, uint64_t unit, uint64_t dependency)
+{
+	colti_assert(unit < linker->unit_count && dependency < linker->unit_count, "Invalid unit index!");
+	LinkerUnit* dependent = linker->units + unit;
+	if (dependent->dependency_count == dependent->dependency_capacity) //Grow if needed
+	{
+		uint64_t new_capacity = dependent->dependency_capacity == 0 ? 4 : dependent->dependency_capacity * 2;
+		uint64_t* ptr = (uint64_t*)safe_malloc(new_capacity * sizeof(uint64_t));
+		if (dependent->dependencies != NULL)
+		{
+			memcpy(ptr, dependent->dependencies, dependent->dependency_count * sizeof(uint64_t));
+			safe_free(dependent->dependencies);
+		}
+		dependent->dependencies = ptr;
+		dependent->dependency_capacity = new_capacity;
+	}
+	dependent->dependencies[dependent->dependency_count++] = dependency;
+}
+
+void LinkerSetSamples(Linker* linker, uint64_t unit, uint64_t samples)
+{
+	colti_assert(unit < linker->unit_count, "Invalid unit index!");
+	linker->units[unit].samples = samples;
+}
+
+bool LinkerLink(const Linker* linker, ChunkImage* image)
+{
+	uint64_t unit_count = linker->unit_count;
+	if (unit_count == 0)
+	{
+		print_error_string("There are no units to link!");
+		return false;
+	}
+
+	//Dead units are not part of the image
+	bool* is_live = (bool*)safe_malloc(unit_count * sizeof(bool));
+	impl_linker_mark_live(linker, is_live);
+	const LinkerUnit** layout = (const LinkerUnit**)safe_malloc(unit_count * sizeof(LinkerUnit*));
+	const LinkerUnit** by_name = (const LinkerUnit**)safe_malloc(unit_count * sizeof(LinkerUnit*));
+	uint64_t live_count = 0;
+	for (uint64_t i = 0; i < unit_count; i++)
+	{
+		if (is_live[i])
+			layout[live_count++] = linker->units + i;
+	}
+	safe_free(is_live);
+	memcpy(by_name, layout, live_count * sizeof(LinkerUnit*));
+	qsort(layout, live_count, sizeof(LinkerUnit*), impl_linker_compare_layout);
+	qsort(by_name, live_count, sizeof(LinkerUnit*), impl_linker_compare_names);
+
+	//The code of each unit, indexed by the index of the unit
+	uint64_t* code_offsets = (uint64_t*)safe_malloc(unit_count * sizeof(uint64_t));
+	uint64_t* code_sizes = (uint64_t*)safe_malloc(unit_count * sizeof(uint64_t));
+	Chunk code;
+	ChunkInit(&code);
+	bool is_success = true;
+	for (uint64_t i = 0; i < live_count && is_success; i++)
+	{
+		//Pad using unreachable OP_RETURN, so that the code of the image stays valid
+		while (code.count % IMAGE_ENTRY_ALIGNMENT != 0)
+			ChunkWriteOpCode(&code, OP_RETURN);
+		uint64_t index = layout[i] - linker->units;
+		code_offsets[index] = code.count;
+		is_success = impl_linker_append_unit(&code, layout[i]);
+		code_sizes[index] = code.count - code_offsets[index];
+	}
+	for (uint64_t i = 1; i < live_count && is_success; i++)
+	{
+		if (strcmp(by_name[i - 1]->name, by_name[i]->name) == 0)
+		{
+			print_error_format("Two units are named '%s'!", by_name[i]->name);
+			is_success = false;
+		}
+	}
+
+	if (is_success)
+	{
+		image->chunk = code;
+		//The views of the entries share the Divisor table, the loop counters and the inline caches of the image
+		if (code.constant_count != 0)
+			impl_chunk_build_divisors(&image->chunk);
+		if (code.loop_count != 0)
+			impl_chunk_build_loop_counters(&image->chunk);
+		if (code.cache_count != 0)
+			impl_chunk_build_inline_caches(&image->chunk);
+		image->entry_count = live_count;
+		image->entries = (ImageEntry*)safe_malloc(live_count * sizeof(ImageEntry));
+		image->names_size = 0;
+		for (uint64_t i = 0; i < live_count; i++)
+			image->names_size += strlen(by_name[i]->name) + 1;
+		image->names = (char*)safe_malloc(image->names_size);
+
+		//The entries are sorted by name
+		uint64_t name_offset = 0;
+		for (uint64_t i = 0; i < live_count; i++)
+		{
+			uint64_t index = by_name[i] - linker->units;
+			uint64_t name_size = strlen(by_name[i]->name);
+			memcpy(image->names + name_offset, by_name[i]->name, name_size + 1);
+			ImageEntry entry = { name_offset, name_size, code_offsets[index], code_sizes[index] };
+			image->entries[i] = entry;
+			name_offset += name_size + 1;
+		}
+	}
+	else
+		ChunkFree(&code);
+
+	safe_free(code_offsets);
+	safe_free(code_sizes);
+	safe_free(layout);
+	safe_free(by_name);
+	return is_success;
+}
+
+void ChunkImageFree(ChunkImage* image)
+{
+	//The entries and names of a mapped image are part of the mapping
+	if (image->chunk.mapping.ptr == NULL)
+	{
+		safe_free(image->entries);
+		safe_free(image->names);
+	}
+	ChunkFree(&image->chunk);
+	image->entry_count = 0;
+	image->entries = NULL;
+	image->names = NULL;
+	image->names_size = 0;
+}
+
+void ChunkImageGetEntry(const ChunkImage* image, uint64_t index, Chunk* view)
+{
+	colti_assert(index < image->entry_count, "Invalid entry index!");
+	const ImageEntry* entry = image->entries + index;
+	view->code = image->chunk.code + entry->code_offset;
+	view->count = entry->code_size;
+	view->capacity = entry->code_size;
+	view->encoding = image->chunk.encoding;
+	//Each entry is verified on its own, as the code of the image only ends with an OP_RETURN
+	view->is_verified = false;
+	view->max_stack_depth = 0;
+	view->local_count = 0;
+	view->operand_type = CHUNK_POLYMORPHIC;
+	view->constant_count = image->chunk.constant_count;
+	view->constant_capacity = image->chunk.constant_count;
+	view->constants = image->chunk.constants;
+	view->constant_table = NULL;
+	//The Divisor table, the loop counters and the inline caches are borrowed from the image, as its constant pool
+	view->divisors = image->chunk.divisors;
+	view->loop_count = image->chunk.loop_count;
+	view->loop_counters = image->chunk.loop_counters;
+	view->cache_count = image->chunk.cache_count;
+	view->inline_caches = image->chunk.inline_caches;
+	//The global slots of the image are shared by all its entries
+	view->global_count = image->chunk.global_count;
+	view->global_capacity = image->chunk.global_count;
+	view->globals = image->chunk.globals;
+	HashMapInit(&view->global_table);
+	//The offsets of the debug info of the image are not relative to the entry
+	DebugInfoInit(&view->debug_info);
+	view->mapping.ptr = NULL;
+	view->mapping.size = 0;
+	//The code of a mapped image is shared with the mapping
+	view->is_read_only = image->chunk.is_read_only;
+	view->is_quickening = image->chunk.is_quickening;
+}
+
+bool ChunkImageFindEntry(const ChunkImage* image, const char* name, uint64_t* index)
+{
+	uint64_t low = 0;
+	uint64_t high = image->entry_count;
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+		int comparison = strcmp(name, image->names + image->entries[middle].name_offset);
+		if (comparison == 0)
+		{
+			*index = middle;
+			return true;
+		}
+		if (comparison < 0)
+			high = middle;
+		else
+			low = middle + 1;
+	}
+	return false;
+}
+
+void ChunkImageSerialize(const ChunkImage* image, const char* path)
+{
+	FILE* file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		print_error_format("Could not create the file at path '%s'!", path);
+		exit(EXIT_OS_RESOURCE_FAILURE);
+	}
+	const Chunk* chunk = &image->chunk;
+	ImageFileHeader header = { IMAGE_FILE_MAGIC, IMAGE_FILE_VERSION, (uint16_t)chunk->encoding,
+		chunk->count, chunk->constant_count, chunk->debug_info.size, image->entry_count, image->names_size, chunk->loop_count,
+		impl_chunk_globals_size(chunk) };
+	bool is_written = fwrite(&header, sizeof(ImageFileHeader), 1, file) == 1;
+	//The constants, entries and code stay aligned, as their sizes are multiples of 8
+	if (chunk->constant_count != 0)
+		is_written &= fwrite(chunk->constants, sizeof(QWORD), chunk->constant_count, file) == chunk->constant_count;
+	is_written &= fwrite(image->entries, sizeof(ImageEntry), image->entry_count, file) == image->entry_count;
+	is_written &= fwrite(chunk->code, sizeof(char), chunk->count, file) == chunk->count;
+	if (chunk->debug_info.size != 0)
+		is_written &= fwrite(chunk->debug_info.data, sizeof(uint8_t), chunk->debug_info.size, file) == chunk->debug_info.size;
+	is_written &= fwrite(image->names, sizeof(char), image->names_size, file) == image->names_size;
+	for (uint64_t i = 0; i < chunk->global_count; i++)
+		is_written &= fwrite(chunk->globals[i]->name, sizeof(char), chunk->globals[i]->size + 1, file) == chunk->globals[i]->size + 1;
+	if (fclose(file) != 0 || !is_written)
+	{
+		print_error_format("Could not write the file at path '%s'!", path);
+		exit(EXIT_OS_RESOURCE_FAILURE);
+	}
+}
+
+bool ChunkImageMap(ChunkImage* image, const char* path)
+{
+	Chunk* chunk = &image->chunk;
+	if (!FileMappingOpen(&chunk->mapping, path))
+	{
+		print_error_format("Could not map the file '%s'!", path);
+		return false;
+	}
+	const ImageFileHeader* header = (const ImageFileHeader*)chunk->mapping.ptr;
+	if (!impl_image_check(header, chunk->mapping.size, path))
+	{
+		FileMappingClose(&chunk->mapping);
+		return false;
+	}
+
+	//The mapping is page aligned, and the header's size is CHUNK_CONSTANT_POOL_ALIGNMENT
+	QWORD* constants = (QWORD*)(chunk->mapping.ptr + sizeof(ImageFileHeader));
+	chunk->constant_count = header->constant_count;
+	chunk->constant_capacity = header->constant_count;
+	chunk->constants = header->constant_count == 0 ? NULL : constants;
+	chunk->constant_table = NULL;
+	//The views of the entries share the Divisor table, the loop counters and the inline caches of the image
+	chunk->divisors = NULL;
+	if (header->constant_count != 0)
+		impl_chunk_build_divisors(chunk);
+	chunk->loop_count = header->loop_count;
+	chunk->loop_counters = NULL;
+	if (header->loop_count != 0)
+		impl_chunk_build_loop_counters(chunk);
+	image->entry_count = header->entry_count;
+	image->entries = (ImageEntry*)(constants + header->constant_count);
+	chunk->code = (uint8_t*)(image->entries + header->entry_count);
+	chunk->count = header->code_size;
+	chunk->capacity = header->code_size;
+	chunk->encoding = (ChunkEncoding)header->encoding;
+	chunk->is_verified = false;
+	chunk->max_stack_depth = 0;
+	chunk->local_count = 0;
+	chunk->operand_type = CHUNK_POLYMORPHIC;
+	chunk->is_read_only = true;
+	chunk->is_quickening = false;
+	//The header has no room for the number of caches, which are counted from the code
+	chunk->cache_count = impl_chunk_count_inline_caches(chunk);
+	chunk->inline_caches = NULL;
+	if (chunk->cache_count != 0)
+		impl_chunk_build_inline_caches(chunk);
+	DebugInfoInit(&chunk->debug_info);
+	if (header->debug_info_size != 0)
+	{
+		chunk->debug_info.data = chunk->code + header->code_size;
+		chunk->debug_info.size = header->debug_info_size;
+		chunk->debug_info.capacity = header->debug_info_size;
+	}
+	image->names = (char*)(chunk->code + header->code_size + header->debug_info_size);
+	image->names_size = header->names_size;
+	//The names of the globals were checked by impl_image_check
+	chunk->global_count = 0;
+	chunk->global_capacity = 0;
+	chunk->globals = NULL;
+	HashMapInit(&chunk->global_table);
+	impl_chunk_intern_globals(chunk, image->names + image->names_size, header->globals_size);
+	return true;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+void impl_linker_mark_live(const Linker* linker, bool* is_live)
+{
+	//Each unit is pushed at most once, when it is first marked
+	uint64_t* worklist = (uint64_t*)safe_malloc(linker->unit_count * sizeof(uint64_t));
+	uint64_t worklist_size = 0;
+	for (uint64_t i = 0; i < linker->unit_count; i++)
+	{
+		is_live[i] = linker->units[i].is_root;
+		if (is_live[i])
+			worklist[worklist_size++] = i;
+	}
+	while (worklist_size != 0)
+	{
+		const LinkerUnit* unit = linker->units + worklist[--worklist_size];
+		for (uint64_t i = 0; i < unit->dependency_count; i++)
+		{
+			uint64_t dependency = unit->dependencies[i];
+			if (!is_live[dependency])
+			{
+				is_live[dependency] = true;
+				worklist[worklist_size++] = dependency;
+			}
+		}
+	}
+	safe_free(worklist);
+}
+
+int impl_linker_compare_layout(const void* lhs, const void* rhs)
+{
+	const LinkerUnit* left = *(const LinkerUnit**)lhs;
+	const LinkerUnit* right = *(const LinkerUnit**)rhs;
+	if (left->samples != right->samples)
+		return left->samples > right->samples ? -1 : 1;
+	//qsort is not stable: cold units keep the order in which they were added
+	return left < right ? -1 : (left > right);
+}
+
+int impl_linker_compare_names(const void* lhs, const void* rhs)
+{
+	return strcmp((*(const LinkerUnit**)lhs)->name, (*(const LinkerUnit**)rhs)->name);
+}
+
+bool impl_linker_append_unit(Chunk* to, const LinkerUnit* unit)
+{
+	//The constant indices are rewritten on the aligned encoding
+	const Chunk* chunk = unit->chunk;
+	Chunk aligned;
+	if (chunk->encoding == CHUNK_ENCODING_COMPACT)
+	{
+		if (!ChunkToAligned(chunk, &aligned))
+		{
+			print_error_format("The unit '%s' contains invalid byte-code!", unit->name);
+			return false;
+		}
+		chunk = &aligned;
+	}
+
+	DebugInfoIterator iter;
+	DebugEntry next;
+	DebugInfoIteratorInit(&iter, &chunk->debug_info);
+	if (!DebugInfoNext(&iter, &next))
+		next.offset = UINT64_MAX;
+
+	//The instructions may be wider in the image, and the targets of the calls are relative to the unit
+	uint64_t start = to->count;
+	uint64_t loop_base = to->loop_count;
+	uint64_t loop_count = chunk->loop_count;
+	uint64_t cache_base = to->cache_count;
+	uint64_t cache_count = chunk->cache_count;
+	uint64_t* relocations = impl_compact_new_relocations(chunk->count);
+	bool is_valid = true;
+	Instruction instr;
+	for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+	{
+		bool is_load = false;
+		bool is_divide = false;
+		if ((is_valid = ChunkDecodeInstruction(chunk, offset, &instr)))
+		{
+			is_load = instr.code == OP_LOAD_CONST_BYTE || instr.code == OP_LOAD_CONST_WORD;
+			is_divide = instr.code == OP_DIVIDE_CONST || instr.code == OP_MODULO_CONST;
+			is_valid = !(is_load || is_divide) || instr.immediate.ui64 < chunk->constant_count;
+			if (instr.code == OP_LOAD_GLOBAL || instr.code == OP_STORE_GLOBAL)
+				is_valid = instr.immediate.ui64 < chunk->global_count;
+		}
+		if (!is_valid)
+		{
+			print_error_format("The unit '%s' contains invalid byte-code at offset %"PRIu64"!", unit->name, offset);
+			break;
+		}
+		if (is_load || is_divide)
+		{
+			uint16_t index;
+			if (!ChunkAddConstant(to, chunk->constants[instr.immediate.ui64], &index))
+			{
+				print_error_format("The constant pool of the image is full (while linking '%s')!", unit->name);
+				is_valid = false;
+				break;
+			}
+			//The index of the constant may need a wider encoding
+			if (is_load)
+				instr.code = index <= UINT8_MAX ? OP_LOAD_CONST_BYTE : OP_LOAD_CONST_WORD;
+			instr.immediate.ui64 = index;
+		}
+		//The globals of the same name share a slot
+		if (instr.code == OP_LOAD_GLOBAL || instr.code == OP_STORE_GLOBAL)
+		{
+			uint16_t index;
+			if (!ChunkAddGlobal(to, chunk->globals[instr.immediate.ui64], &index))
+			{
+				print_error_format("The image contains too many globals (while linking '%s')!", unit->name);
+				is_valid = false;
+				break;
+			}
+			instr.immediate.ui64 = index;
+		}
+		if (instr.code == OP_LOOP)
+		{
+			if (instr.index >= UINT32_MAX - loop_base)
+			{
+				print_error_format("The image contains too many loops (while linking '%s')!", unit->name);
+				is_valid = false;
+				break;
+			}
+			if (instr.index >= loop_count)
+				loop_count = instr.index + 1;
+			instr.index += (uint32_t)loop_base;
+		}
+		//The inline caches of each unit are offset as its loop counters
+		if (InlineCacheIsDynamicOpCode(instr.code))
+		{
+			if (instr.immediate.ui64 >= UINT32_MAX - cache_base)
+			{
+				print_error_format("The image contains too many dynamically typed instructions (while linking '%s')!", unit->name);
+				is_valid = false;
+				break;
+			}
+			if (instr.immediate.ui64 >= cache_count)
+				cache_count = instr.immediate.ui64 + 1;
+			instr.immediate.ui64 += cache_base;
+		}
+		relocations[offset] = to->count - start;
+		impl_chunk_copy_source_locations(to, &iter, &next, offset);
+		ChunkWriteInstruction(to, &instr);
+	}
+	if (is_valid && !(is_valid = impl_chunk_relocate_targets(to, start, chunk, relocations)))
+		print_error_format("The unit '%s' calls or jumps to an offset which is not an instruction!", unit->name);
+	to->loop_count = loop_base + loop_count;
+	to->cache_count = cache_base + cache_count;
+	if (relocations != NULL)
+		safe_free(relocations);
+	if (chunk == &aligned)
+		ChunkFree(&aligned);
+	return is_valid;
+}
+
+bool impl_image_check(const ImageFileHeader* header, uint64_t file_size, const char* path)
+{
+	if (file_size < sizeof(ImageFileHeader) || header->magic != IMAGE_FILE_MAGIC)
+	{
+		print_error_format("The file '%s' is not a linked image!", path);
+		return false;
+	}
+	if (header->version != IMAGE_FILE_VERSION)
+	{
+		print_error_format("The file '%s' was linked using an unsupported version (%"PRIu16")!", path, header->version);
+		return false;
+	}
+	//Each size is checked before being summed so that the sum cannot overflow
+	if (header->encoding != CHUNK_ENCODING_ALIGNED || header->code_size == 0 || header->code_size > file_size
+		|| header->constant_count > CHUNK_CONSTANT_POOL_MAX_SIZE || header->entry_count > file_size
+		|| header->debug_info_size > file_size || header->names_size > file_size || header->loop_count > header->code_size
+		|| header->globals_size > file_size
+		|| file_size != sizeof(ImageFileHeader) + header->constant_count * sizeof(QWORD) + header->entry_count * sizeof(ImageEntry)
+			+ header->code_size + header->debug_info_size + header->names_size + header->globals_size)
+	{
+		print_error_format("The file '%s' is corrupted!", path);
+		return false;
+	}
+
+	//The entries should point into the image, and be sorted by (NUL terminated) names
+	const ImageEntry* entries = (const ImageEntry*)((const uint8_t*)header + sizeof(ImageFileHeader)
+		+ header->constant_count * sizeof(QWORD));
+	const char* names = (const char*)entries + header->entry_count * sizeof(ImageEntry)
+		+ header->code_size + header->debug_info_size;
+	for (uint64_t i = 0; i < header->entry_count; i++)
+	{
+		const ImageEntry* entry = entries + i;
+		if (entry->code_offset % IMAGE_ENTRY_ALIGNMENT != 0 || entry->code_offset > header->code_size
+			|| entry->code_size > header->code_size - entry->code_offset
+			|| entry->name_offset >= header->names_size || entry->name_size >= header->names_size - entry->name_offset
+			|| names[entry->name_offset + entry->name_size] != '\0'
+			|| (i != 0 && strcmp(names + entries[i - 1].name_offset, names + entry->name_offset) >= 0))
+		{
+			print_error_format("The file '%s' is corrupted!", path);
+			return false;
+		}
+	}
+
+	//The names of the globals are NUL terminated, and each is a global slot
+	const char* globals = names + header->names_size;
+	uint64_t global_count = 0;
+	for (uint64_t i = 0; i < header->globals_size; i++)
+		global_count += globals[i] == '\0';
+	if (header->globals_size != 0 && (globals[header->globals_size - 1] != '\0' || global_count > CHUNK_MAX_GLOBALS))
+	{
+		print_error_format("The file '%s' is corrupted!", path);
+		return false;
+	}
+	return true;
+}
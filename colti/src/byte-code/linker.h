@@ -0,0 +1,223 @@
+/** @file linker.h
+* Contains the Linker, which merges multiple compiled units (Chunks) into a single ChunkImage.
+* The code of the units is concatenated in a single Chunk, whose constant pool is the
+* deduplicated union of the constant pools of the units (the constant indices of the code
+* are rewritten accordingly). Each unit starts on an IMAGE_ENTRY_ALIGNMENT boundary, and is
+* described by an ImageEntry (sorted by name) of the entry table of the image.
+* Units that are not reachable from a root (through the dependencies added to the Linker) are
+* not part of the image. The live units are laid out from the hottest (using the number of
+* samples recorded by a VMProfiler) to the coldest, so that the hot code is contiguous.
+* A ChunkImage is serialized as a single file, which is loaded using a single mapping (ChunkImageMap).
+* An entry of the image is run using a Chunk borrowing the code and constant pool of the image (ChunkImageGetEntry).
+* The views of the entries are quickened if the image is: ChunkEnableQuickening should be called on 'ChunkImage.chunk'.
+* The counter indices of the loops of each unit are offset so that they are unique in the image, whose loop counters
+* are shared by the views of its entries. The indices of the inline caches of the dynamically typed instructions are offset
+* in the same way, the caches of a mapped image being counted from its code.
+* The globals of the units are merged by name: the units using a global of the same name share its slot in the image
+* (the global indices of the code being rewritten), and the names of the slots are interned when mapping the image.
+*/
+
+#ifndef HG_COLTI_LINKER
+#define HG_COLTI_LINKER
+
+#include "common.h"
+#include "chunk.h"
+#include "compact_encoding.h"
+
+/// @brief The magic number at the beginning of serialized images ('CIMG' in little endian)
+#define IMAGE_FILE_MAGIC 0x474D4943
+/// @brief The version of the serialized image format, which should be incremented on any breaking change
+#define IMAGE_FILE_VERSION 4
+/// @brief The alignment of the code of each entry of an image (the alignment of the widest immediate)
+#define IMAGE_ENTRY_ALIGNMENT 8
+
+/// @brief A compiled unit to link
+typedef struct
+{
+	/// @brief The name of the unit (NUL terminated), which is borrowed
+	const char* name;
+	/// @brief The code of the unit, which is borrowed
+	const Chunk* chunk;
+	/// @brief The number of samples recorded in the unit by a VMProfiler (0 if the unit is cold)
+	uint64_t samples;
+	/// @brief True if the unit is an entry point of the program, which is always linked
+	bool is_root;
+	/// @brief The number of units this unit depends on
+	uint64_t dependency_count;
+	/// @brief The capacity of 'dependencies'
+	uint64_t dependency_capacity;
+	/// @brief The indices of the units this unit depends on, NULL if there are none
+	uint64_t* dependencies;
+} LinkerUnit;
+
+/// @brief Merges units into a ChunkImage
+typedef struct
+{
+	/// @brief The number of units added to the Linker
+	uint64_t unit_count;
+	/// @brief The capacity of 'units'
+	uint64_t unit_capacity;
+	/// @brief The units to link, NULL if there are none
+	LinkerUnit* units;
+} Linker;
+
+/// @brief An entry of the entry table of an image
+typedef struct
+{
+	/// @brief The offset of the name of the entry in the names of the image
+	uint64_t name_offset;
+	/// @brief The size of the name of the entry (not including the NUL terminator)
+	uint64_t name_size;
+	/// @brief The offset of the code of the entry in the code of the image
+	uint64_t code_offset;
+	/// @brief The number of bytes of code of the entry
+	uint64_t code_size;
+} ImageEntry;
+
+/// @brief A linked program: the code of all its units, and its entry table
+typedef struct
+{
+	/// @brief The code, constant pool and source locations of all the entries.
+	/// The image is mapped if 'chunk.mapping.ptr' is not NULL.
+	Chunk chunk;
+	/// @brief The number of entries
+	uint64_t entry_count;
+	/// @brief The entries, sorted by name (part of the mapping if the image is mapped)
+	ImageEntry* entries;
+	/// @brief The NUL terminated names of the entries (part of the mapping if the image is mapped)
+	char* names;
+	/// @brief The number of bytes of 'names'
+	uint64_t names_size;
+} ChunkImage;
+
+/// @brief The header of a serialized image, followed by the constants, the entry table, the code,
+/// the debug info, the names of the entries, then the names of the globals.
+/// The header takes CHUNK_CONSTANT_POOL_ALIGNMENT bytes, so that the constant pool of a mapped image stays aligned.
+typedef struct
+{
+	/// @brief Should be IMAGE_FILE_MAGIC
+	uint32_t magic;
+	/// @brief Should be IMAGE_FILE_VERSION
+	uint16_t version;
+	/// @brief The ChunkEncoding of the code (always CHUNK_ENCODING_ALIGNED for now)
+	uint16_t encoding;
+	/// @brief The number of bytes of code
+	uint64_t code_size;
+	/// @brief The number of QWORDs in the constant pool
+	uint64_t constant_count;
+	/// @brief The number of bytes of the DebugInfo table
+	uint64_t debug_info_size;
+	/// @brief The number of entries
+	uint64_t entry_count;
+	/// @brief The number of bytes of the names
+	uint64_t names_size;
+	/// @brief The number of hotness counters of the loops of the image (see Chunk.loop_counters)
+	uint64_t loop_count;
+	/// @brief The number of bytes of the names of the global slots (each name being NUL terminated)
+	uint64_t globals_size;
+} ImageFileHeader;
+
+/// @brief Initializes an empty Linker
+/// @param linker The linker to initialize
+void LinkerInit(Linker* linker);
+
+/// @brief Frees the memory used by a Linker (but not the units it borrows)
+/// @param linker The linker to free
+void LinkerFree(Linker* linker);
+
+/// @brief Adds a unit to link
+/// @param linker The linker to which to add the unit
+/// @param name The unique name of the unit, which must outlive the linker
+/// @param chunk The code of the unit, which must outlive the linker
+/// @param is_root True if the unit is an entry point of the program (which is never eliminated)
+/// @return The index of the unit
+uint64_t LinkerAddUnit(Linker* linker, const char* name, const Chunk* chunk, bool is_root);
+
+/// @brief Records that a unit depends on another, which is then linked if the unit is
+/// @param linker The linker containing the units
+/// @param unit The index of the dependent unit
+/// @param dependency The index of the unit it depends on
+void LinkerAddDependency(Linker* linker, uint64_t unit, uint64_t dependency);
+
+/// @brief Sets the number of samples recorded in a unit (see VMProfiler), which drives the layout of the image
+/// @param linker The linker containing the unit
+/// @param unit The index of the unit
+/// @param samples The number of samples
+void LinkerSetSamples(Linker* linker, uint64_t unit, uint64_t samples);
+
+/// @brief Links the units reachable from the roots into an image
+/// @param linker The linker containing the units
+/// @param image The image to initialize, which should be freed using ChunkImageFree
+/// @return False (printing an error) if a unit is invalid, two units have the same name, or the constant pool is full
+bool LinkerLink(const Linker* linker, ChunkImage* image);
+
+/// @brief Frees the memory used by an image (unmapping it if it is mapped)
+/// @param image The image to free
+void ChunkImageFree(ChunkImage* image);
+
+/// @brief Initializes a Chunk to run an entry of an image.
+/// The Chunk borrows the code, constant pool, Divisor table, loop counters and globals of the image: it must not be written to nor freed,
+/// and is only valid as long as the image is.
+/// @param image The image containing the entry
+/// @param index The index of the entry
+/// @param view The Chunk to initialize
+void ChunkImageGetEntry(const ChunkImage* image, uint64_t index, Chunk* view);
+
+/// @brief Finds an entry of an image by name, in O(log(entries))
+/// @param image The image containing the entry
+/// @param name The name of the entry
+/// @param index Pointer to where to write the index of the entry
+/// @return False if the image does not contain any entry named 'name'
+bool ChunkImageFindEntry(const ChunkImage* image, const char* name, uint64_t* index);
+
+/// @brief Serializes an image to a file
+/// @param image The image to serialize
+/// @param path The path to the file to which to serialize
+void ChunkImageSerialize(const ChunkImage* image, const char* path);
+
+/// @brief Maps an image serialized by ChunkImageSerialize in memory.
+/// The code, constant pool, entries and names of the image all point into the read-only mapping of the file,
+/// while the names of its globals are interned.
+/// @param image The image to initialize, which should be freed using ChunkImageFree
+/// @param path The path to the file to map
+/// @return False (printing an error) if the file could not be mapped or is not a valid serialized image
+bool ChunkImageMap(ChunkImage* image, const char* path);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Marks the units reachable from the roots of a linker
+/// @param linker The linker containing the units
+/// @param is_live Array (of size 'linker->unit_count') set to true for each reachable unit
+void impl_linker_mark_live(const Linker* linker, bool* is_live);
+
+/// @brief Compares two units (through pointers to them) by decreasing number of samples,
+/// then by increasing address (which is the order in which they were added)
+/// @param lhs Pointer to a pointer to the left hand side LinkerUnit
+/// @param rhs Pointer to a pointer to the right hand side LinkerUnit
+/// @return Negative if 'lhs' should be laid out before 'rhs'
+int impl_linker_compare_layout(const void* lhs, const void* rhs);
+
+/// @brief Compares two units (through pointers to them) by name
+/// @param lhs Pointer to a pointer to the left hand side LinkerUnit
+/// @param rhs Pointer to a pointer to the right hand side LinkerUnit
+/// @return The result of strcmp on their names
+int impl_linker_compare_names(const void* lhs, const void* rhs);
+
+/// @brief Appends the code of a unit to the code of an image, merging its constants in the constant pool of the image
+/// and its globals in the global slots of the image, and offsetting the counter indices of its loops by the number of
+/// counters of the image (which is updated)
+/// @param to The (aligned) chunk of the image
+/// @param unit The unit to append (whose code is converted to the aligned encoding if needed)
+/// @return False (printing an error) if the code of the unit is invalid, or the constant pool, global slots or loop counters of the image are full
+bool impl_linker_append_unit(Chunk* to, const LinkerUnit* unit);
+
+/// @brief Checks the header and the entry table of a mapped image, printing an error if they are invalid
+/// @param header The header of the image
+/// @param file_size The size of the file containing the image
+/// @param path The path to the file containing the image
+/// @return False if the image is invalid
+bool impl_image_check(const ImageFileHeader* header, uint64_t file_size, const char* path);
+
+#endif //HG_COLTI_LINKER
@@ -0,0 +1,70 @@
+/** @file quickening.c
+* Contains the definitions of the functions declared in 'quickening.h'
+*/
+
+#include "quickening.h"
+
+/// @brief A quickened OpCode, the OpCode it quickens and the OperandType it implies
+typedef struct
+{
+	/// @brief The quickened OpCode
+	uint8_t code;
+	/// @brief The OpCode it quickens
+	uint8_t generic;
+	/// @brief The OperandType it implies
+	uint8_t type;
+} QuickenedOpCode;
+
+/// @brief The quickened OpCodes (only the most common types have one)
+static const QuickenedOpCode g_quickened_opcodes[] =
+{
+	{ OP_ADD_I64, OP_ADD, OPERAND_COLTI_I64 },
+	{ OP_ADD_DOUBLE, OP_ADD, OPERAND_COLTI_DOUBLE },
+	{ OP_SUBTRACT_I64, OP_SUBTRACT, OPERAND_COLTI_I64 },
+	{ OP_SUBTRACT_DOUBLE, OP_SUBTRACT, OPERAND_COLTI_DOUBLE },
+	{ OP_MULTIPLY_I64, OP_MULTIPLY, OPERAND_COLTI_I64 },
+	{ OP_MULTIPLY_DOUBLE, OP_MULTIPLY, OPERAND_COLTI_DOUBLE },
+};
+
+/// @brief The number of quickened OpCodes
+#define QUICKENED_OPCODE_COUNT (sizeof(g_quickened_opcodes) / sizeof(g_quickened_opcodes[0]))
+
+bool ChunkEnableQuickening(Chunk* chunk)
+{
+	if (chunk->is_read_only)
+	{
+		//The mapping of a view is owned by its image
+		if (chunk->mapping.ptr == NULL)
+		{
+			print_error_string("The code of a view of a mapped image cannot be quickened!");
+			return false;
+		}
+		if (!FileMappingMakeCopyOnWrite(&chunk->mapping))
+		{
+			print_error_string("Could not make the mapping of the chunk copy-on-write!");
+			return false;
+		}
+		chunk->is_read_only = false;
+	}
+	chunk->is_quickening = true;
+	return true;
+}
+
+uint8_t QuickenOpCode(uint8_t code, uint8_t type)
+{
+	for (size_t i = 0; i < QUICKENED_OPCODE_COUNT; i++)
+	{
+		if (g_quickened_opcodes[i].generic == code && g_quickened_opcodes[i].type == type)
+			return g_quickened_opcodes[i].code;
+	}
+	return code;
+}
+
+OpCode QuickenedGetOpCode(uint8_t code, OperandType* type)
+{
+	colti_assert(OpCodeGetLayout(code) == LAYOUT_QUICKENED, "OpCode should be a quickened OpCode!");
+	//The quickened OpCodes are contiguous
+	const QuickenedOpCode* quickened = g_quickened_opcodes + (code - OP_ADD_I64);
+	*type = quickened->type;
+	return quickened->generic;
+}
@@ -0,0 +1,41 @@
+/** @file quickening.h
+* Contains the quickening of the typed instructions of a Chunk.
+* A typed instruction such as 'OP_ADD INT64' reads its OperandType each time it runs, and dispatches on it.
+* Once quickening is enabled for a Chunk (ChunkEnableQuickening), the VM rewrites such an instruction (in place) the
+* first time it runs, to the OpCode implied by its type (OP_ADD_I64), which does not dispatch on any OperandType.
+* A quickened OpCode takes as many bytes as the instruction it replaces (see LAYOUT_QUICKENED): its OperandType
+* stays as padding in the aligned encoding, and a fused OpCode (see compact_encoding.h) is a single byte in the compact
+* encoding. The offsets of the instructions (targets, jumps, source locations) are thus never modified.
+* Only the polymorphic loops quicken: a monomorphic chunk is already run by a loop specialized for its type.
+* The rewrite of an instruction is a single atomic byte store (see atomicStoreByte), and both forms compute the same
+* result: the threads running a shared Chunk read either form, and may quicken the same instruction concurrently.
+* The code of a mapped chunk is made copy-on-write, so that the pages that are quickened are private to the process
+* (see FileMappingMakeCopyOnWrite), the file and the other processes mapping it never seeing the rewrites.
+*/
+
+#ifndef HG_COLTI_QUICKENING
+#define HG_COLTI_QUICKENING
+
+#include "common.h"
+#include "chunk.h"
+
+/// @brief Enables the quickening of the code of a Chunk (see Chunk.is_quickening), which is run by the VM.
+/// The code of a mapped chunk is made copy-on-write. This should be done before sharing the chunk between threads.
+/// @param chunk The chunk whose code to quicken
+/// @return False (printing an error) if the code cannot be modified: a view of a mapped image (see ChunkImageGetEntry),
+/// whose image should be quickened instead, or a mapping whose pages could not be made copy-on-write
+bool ChunkEnableQuickening(Chunk* chunk);
+
+/// @brief Returns the quickened form of a typed OpCode operating on a type
+/// @param code The OpCode (following the OperandType in the aligned encoding)
+/// @param type The OperandType of the instruction
+/// @return The quickened OpCode, or 'code' if it has no quickened form for 'type'
+uint8_t QuickenOpCode(uint8_t code, uint8_t type);
+
+/// @brief Returns the OpCode quickened by a LAYOUT_QUICKENED OpCode, and the OperandType it implies
+/// @param code The quickened OpCode
+/// @param type Pointer to where to write the OperandType implied by 'code'
+/// @return The OpCode that 'code' quickens
+OpCode QuickenedGetOpCode(uint8_t code, OperandType* type);
+
+#endif //HG_COLTI_QUICKENING
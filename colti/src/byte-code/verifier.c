@@ -0,0 +1,811 @@
+/** @file verifier.c
+* Contains the definitions of the functions declared in 'verifier.h'
+*/
+
+#include "verifier.h"
+#include "thread.h"
+
+VerifyResult ChunkVerify(Chunk* chunk, uint64_t* error_offset)
+{
+	return ChunkVerifyDepths(chunk, error_offset, NULL);
+}
+
+VerifyResult ChunkVerifyDepths(Chunk* chunk, uint64_t* error_offset, uint64_t* depths)
+{
+	if (depths != NULL)
+		memset(depths, 0xFF, chunk->count * sizeof(uint64_t));
+	uint64_t offset = 0;
+	bool uses_divisors = false;
+	uint64_t local_count = 0;
+	uint64_t local_offset = 0;
+	//The VERIFY_FLAG_* of each offset
+	uint8_t* flags = (uint8_t*)safe_malloc(chunk->count + 1);
+	memset(flags, 0, chunk->count + 1);
+	VerifyResult result = impl_verify_structure(chunk, flags, &offset, &uses_divisors, &local_count, &local_offset);
+	if (result != VERIFY_OK)
+	{
+		safe_free(flags);
+		if (error_offset != NULL)
+			*error_offset = offset;
+		return result;
+	}
+
+	//The offsets of the basic blocks, sorted
+	uint64_t leader_count = 0;
+	uint64_t leader_capacity = 0;
+	uint64_t* leaders = NULL;
+	for (uint64_t i = 0; i < chunk->count; i++)
+	{
+		if (flags[i] & VERIFY_FLAG_LEADER)
+			impl_verify_append(&leaders, &leader_count, &leader_capacity, i);
+	}
+	VerifyState* states = (VerifyState*)safe_malloc(leader_count * sizeof(VerifyState) + 1);
+	for (uint64_t i = 0; i < leader_count; i++)
+	{
+		//The code of the chunk and the functions start with an empty stack, and untyped (zero-initialized or argument) locals
+		states[i].is_reached = i == 0 || (flags[leaders[i]] & VERIFY_FLAG_FUNCTION);
+		states[i].is_pending = states[i].is_reached;
+		states[i].is_in_function = (flags[leaders[i]] & VERIFY_FLAG_FUNCTION) != 0;
+		states[i].depth = 0;
+		memset(states[i].locals, VERIFY_ANY_TYPE, sizeof(states[i].locals));
+	}
+
+	uint64_t max_depth = 0;
+	//The type of the typed instructions, VERIFY_ANY_TYPE until one is found
+	uint8_t operand_type = VERIFY_ANY_TYPE;
+	bool is_monomorphic = true;
+	//The blocks are interpreted (in the order of their offsets) until none of their states changes.
+	//Unreachable blocks are never interpreted, but their instructions were checked by impl_verify_structure.
+	VerifyState state;
+	Instruction instr;
+	uint64_t block = 0;
+	while (block < leader_count && result == VERIFY_OK)
+	{
+		if (!states[block].is_pending)
+		{
+			block++;
+			continue;
+		}
+		states[block].is_pending = false;
+		state = states[block];
+		//The lowest block whose state changed, to which to go back once this block is interpreted
+		uint64_t next_block = block + 1;
+		uint64_t end = next_block < leader_count ? leaders[next_block] : chunk->count;
+		for (offset = leaders[block]; result == VERIFY_OK; offset += instr.size)
+		{
+			impl_verify_decode(chunk, offset, &instr);
+			if (depths != NULL)
+				depths[offset] = state.depth;
+			if ((result = impl_verify_instruction(chunk, &instr, &state, &max_depth, &operand_type, &is_monomorphic)) != VERIFY_OK)
+				break;
+
+			//Merge the state into the blocks targeted by the instruction
+			bool is_terminator = false;
+			switch (OpCodeGetLayout(instr.code))
+			{
+			break; case LAYOUT_JUMP:
+			case LAYOUT_TYPE_JUMP:
+			case LAYOUT_LOOP:
+			{
+				uint64_t target = impl_verify_block_index(leaders, leader_count, offset + instr.immediate.i64);
+				result = impl_verify_merge(&states[target], &state);
+				if (states[target].is_pending && target < next_block)
+					next_block = target;
+				is_terminator = instr.code == OP_JUMP || instr.code == OP_LOOP;
+			}
+			break; case LAYOUT_JUMP_TABLE:
+				for (uint64_t i = 0; i <= instr.index && result == VERIFY_OK; i++)
+				{
+					uint64_t target = impl_verify_block_index(leaders, leader_count, offset + impl_chunk_jump_table_offset(instr.table, i));
+					result = impl_verify_merge(&states[target], &state);
+					if (states[target].is_pending && target < next_block)
+						next_block = target;
+				}
+				is_terminator = true;
+			break; default:
+				is_terminator = instr.code == OP_RETURN || instr.code == OP_TAIL_CALL;
+			}
+			if (result != VERIFY_OK || is_terminator)
+				break;
+			if (offset + instr.size == end)
+			{
+				//The last instruction of the code is a terminator
+				uint64_t target = block + 1;
+				if (flags[end] & VERIFY_FLAG_FUNCTION)
+					result = VERIFY_MISSING_RETURN;
+				else if ((result = impl_verify_merge(&states[target], &state)) == VERIFY_OK && states[target].is_pending && target < next_block)
+					next_block = target;
+				break;
+			}
+		}
+		block = next_block;
+	}
+	safe_free(flags);
+	safe_free(states);
+	if (leaders != NULL)
+		safe_free(leaders);
+
+	//The frame is reserved on the stack, below the values
+	if (result == VERIFY_OK && local_count + max_depth > CHUNK_MAX_STACK_DEPTH)
+	{
+		result = VERIFY_STACK_OVERFLOW;
+		offset = local_offset;
+	}
+	if (result != VERIFY_OK)
+	{
+		if (error_offset != NULL)
+			*error_offset = offset;
+		return result;
+	}
+	//The reciprocals of the constants are computed once, when the chunk is first verified
+	if (uses_divisors && chunk->divisors == NULL)
+		impl_chunk_build_divisors(chunk);
+	if (chunk->loop_count != 0 && chunk->loop_counters == NULL)
+		impl_chunk_build_loop_counters(chunk);
+	if (chunk->cache_count != 0 && chunk->inline_caches == NULL)
+		impl_chunk_build_inline_caches(chunk);
+	chunk->max_stack_depth = max_depth;
+	chunk->local_count = local_count;
+	chunk->operand_type = is_monomorphic && operand_type != VERIFY_ANY_TYPE ? operand_type : CHUNK_POLYMORPHIC;
+	//Stored last, so that a thread reading it also reads the state it guards (see StackVMRunFor)
+	atomicStoreFlag(&chunk->is_verified, true);
+	return VERIFY_OK;
+}
+
+const char* VerifyResultToString(VerifyResult result)
+{
+	switch (result)
+	{
+	case VERIFY_OK:						return "Valid byte-code";
+	case VERIFY_INVALID_OPCODE:			return "Invalid OpCode";
+	case VERIFY_UNSUPPORTED_OPCODE:		return "OpCode not supported by the VM";
+	case VERIFY_TRUNCATED_INSTRUCTION:	return "Truncated instruction";
+	case VERIFY_INVALID_OPERAND:		return "Invalid OperandType";
+	case VERIFY_INVALID_CONSTANT:		return "Constant index out of the constant pool";
+	case VERIFY_STACK_UNDERFLOW:		return "Stack underflow";
+	case VERIFY_STACK_OVERFLOW:			return "Stack overflow";
+	case VERIFY_TYPE_MISMATCH:			return "Type mismatch";
+	case VERIFY_MISSING_RETURN:			return "Missing OP_RETURN at the end of the code";
+	case VERIFY_ZERO_DIVISOR:			return "Division by a constant zero";
+	case VERIFY_INVALID_LOCAL:			return "Local slot index out of the frame";
+	case VERIFY_INVALID_TARGET:			return "Call target is not the beginning of a function";
+	case VERIFY_INVALID_JUMP:			return "Jump target is not an instruction of the function";
+	case VERIFY_INCONSISTENT_STACK:		return "Stack depth differs between the paths reaching an instruction";
+	case VERIFY_INVALID_COUNTER:		return "Loop counter index out of the loop counters";
+	case VERIFY_INVALID_GLOBAL:			return "Global slot index out of the global slots";
+	case VERIFY_INVALID_CACHE:			return "Inline cache index out of the inline caches";
+	default:							return "UNKNOWN";
+	}
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+VerifyResult impl_verify_structure(Chunk* chunk, uint8_t* flags, uint64_t* error_offset, bool* uses_divisors,
+	uint64_t* local_count, uint64_t* local_offset)
+{
+	//The number of local slots of the function being decoded, whose frame is declared by its OP_ENTER
+	bool is_in_function = false;
+	uint64_t function_local_count = 0;
+	bool ends_with_terminator = false;
+	//The number of loop counters used by the OP_LOOP, and of InlineCache used by the dynamically typed instructions
+	uint64_t loop_count = 0;
+	uint64_t cache_count = 0;
+	//The offsets of the functions, and the calls and jumps whose targets are checked once every instruction is decoded
+	uint64_t function_count = 0;
+	uint64_t function_capacity = 0;
+	uint64_t* functions = NULL;
+	uint64_t call_count = 0;
+	uint64_t call_capacity = 0;
+	uint64_t* calls = NULL;
+	uint64_t jump_count = 0;
+	uint64_t jump_capacity = 0;
+	uint64_t* jumps = NULL;
+
+	Instruction instr;
+	VerifyResult result = VERIFY_OK;
+	uint64_t offset = 0;
+	for (; offset < chunk->count; offset += instr.size)
+	{
+		if ((result = impl_verify_decode(chunk, offset, &instr)) != VERIFY_OK)
+			break;
+		flags[offset] |= VERIFY_FLAG_INSTRUCTION;
+
+		//Check the operands
+		switch (OpCodeGetLayout(instr.code))
+		{
+		break; case LAYOUT_TYPE:
+		case LAYOUT_TYPE_JUMP:
+			if (!impl_verify_is_valid_operand(instr.code, instr.types[0]))
+				result = VERIFY_INVALID_OPERAND;
+		break; case LAYOUT_TWO_TYPES:
+			if (instr.types[0] >= OPERAND_TYPE_COUNT || instr.types[1] >= OPERAND_TYPE_COUNT)
+				result = VERIFY_INVALID_OPERAND;
+		break; case LAYOUT_QUICKENED:
+		{
+			//The padding of the aligned encoding is the OperandType implied, so that the OpCode quickens a valid instruction
+			OperandType type;
+			QuickenedGetOpCode(instr.code, &type);
+			if (instr.types[0] != type)
+				result = VERIFY_INVALID_OPERAND;
+		}
+		break; case LAYOUT_TYPE_WORD:
+		case LAYOUT_TYPE_BYTE:
+			if (!impl_verify_is_valid_operand(instr.code, instr.types[0]))
+				result = VERIFY_INVALID_OPERAND;
+			//The WORD of OP_INC_LOCAL_WORD is a local slot index
+			else if (instr.code == OP_DIVIDE_CONST || instr.code == OP_MODULO_CONST)
+			{
+				if (instr.immediate.ui64 >= chunk->constant_count)
+					result = VERIFY_INVALID_CONSTANT;
+				else if (chunk->constants[instr.immediate.ui64].ui64 == 0)
+					result = VERIFY_ZERO_DIVISOR;
+				else
+					*uses_divisors = true;
+			}
+		break; default:
+			if ((instr.code == OP_LOAD_CONST_BYTE || instr.code == OP_LOAD_CONST_WORD)
+				&& instr.immediate.ui64 >= chunk->constant_count)
+				result = VERIFY_INVALID_CONSTANT;
+			else if ((instr.code == OP_LOAD_GLOBAL || instr.code == OP_STORE_GLOBAL)
+				&& instr.immediate.ui64 >= chunk->global_count)
+				result = VERIFY_INVALID_GLOBAL;
+			else if (InlineCacheIsDynamicOpCode(instr.code))
+			{
+				//The caches are allocated from the index, which is bounded as the counter index of an OP_LOOP
+				if (instr.immediate.ui64 >= (chunk->inline_caches != NULL ? chunk->cache_count : chunk->count))
+					result = VERIFY_INVALID_CACHE;
+				else if (instr.immediate.ui64 >= cache_count)
+					cache_count = instr.immediate.ui64 + 1;
+			}
+		}
+		//Every slot used is part of the frame, even by unreachable code
+		if (result == VERIFY_OK && instr.code >= OP_LOAD_LOCAL_BYTE && instr.code <= OP_INC_LOCAL_WORD)
+		{
+			if (instr.immediate.ui64 >= (is_in_function ? function_local_count : CHUNK_MAX_STACK_DEPTH))
+				result = VERIFY_INVALID_LOCAL;
+			else if (!is_in_function && instr.immediate.ui64 >= *local_count)
+			{
+				*local_count = instr.immediate.ui64 + 1;
+				*local_offset = offset;
+			}
+		}
+		//A function starts with an empty stack and a new frame, whose first slots are its (untyped) arguments
+		if (result == VERIFY_OK && instr.code == OP_ENTER)
+		{
+			//The code of the chunk cannot be empty
+			if (offset == 0)
+				result = VERIFY_MISSING_RETURN;
+			else if (instr.immediate.ui8 > (instr.immediate.ui64 >> 8))
+				result = VERIFY_INVALID_LOCAL;
+			else
+			{
+				is_in_function = true;
+				function_local_count = instr.immediate.ui64 >> 8;
+				flags[offset] |= VERIFY_FLAG_FUNCTION | VERIFY_FLAG_LEADER;
+				impl_verify_append(&functions, &function_count, &function_capacity, offset);
+			}
+		}
+		//Only OP_LOOP jumps backward, which gives a single place where to count the iterations of the loops
+		switch (OpCodeGetLayout(instr.code))
+		{
+		break; case LAYOUT_JUMP:
+		case LAYOUT_TYPE_JUMP:
+			if (instr.immediate.i64 <= 0 || offset + instr.immediate.i64 >= chunk->count)
+				result = VERIFY_INVALID_JUMP;
+			else
+			{
+				impl_verify_append(&jumps, &jump_count, &jump_capacity, offset);
+				impl_verify_append(&jumps, &jump_count, &jump_capacity, offset + instr.immediate.i64);
+			}
+		break; case LAYOUT_LOOP:
+			//The target cannot be before the start of the code (the relative offset is negated as unsigned, which cannot overflow)
+			if (instr.immediate.i64 > 0 || (uint64_t)0 - instr.immediate.ui64 > offset)
+				result = VERIFY_INVALID_JUMP;
+			//The counters are allocated from the index: an OP_LOOP takes more than a byte, so that an index
+			//which is not less than the size of the code cannot be the index of one
+			else if (instr.index >= (chunk->loop_counters != NULL ? chunk->loop_count : chunk->count))
+				result = VERIFY_INVALID_COUNTER;
+			else
+			{
+				loop_count = instr.index >= loop_count ? (uint64_t)instr.index + 1 : loop_count;
+				impl_verify_append(&jumps, &jump_count, &jump_capacity, offset);
+				impl_verify_append(&jumps, &jump_count, &jump_capacity, offset + instr.immediate.i64);
+			}
+		break; case LAYOUT_JUMP_TABLE:
+			for (uint64_t i = 0; i <= instr.index && result == VERIFY_OK; i++)
+			{
+				int64_t relative = impl_chunk_jump_table_offset(instr.table, i);
+				if (relative <= 0 || offset + relative >= chunk->count)
+					result = VERIFY_INVALID_JUMP;
+				else
+				{
+					impl_verify_append(&jumps, &jump_count, &jump_capacity, offset);
+					impl_verify_append(&jumps, &jump_count, &jump_capacity, offset + relative);
+				}
+			}
+		break; default:
+			break;
+		}
+		//The target of a call should be an OP_ENTER
+		if (result == VERIFY_OK && (instr.code == OP_CALL || instr.code == OP_TAIL_CALL))
+		{
+			Instruction enter;
+			if (instr.immediate.ui64 >= chunk->count || impl_verify_decode(chunk, instr.immediate.ui64, &enter) != VERIFY_OK
+				|| enter.code != OP_ENTER)
+				result = VERIFY_INVALID_TARGET;
+			else
+			{
+				impl_verify_append(&calls, &call_count, &call_capacity, offset);
+				impl_verify_append(&calls, &call_count, &call_capacity, instr.immediate.ui64);
+			}
+		}
+		if (result != VERIFY_OK)
+			break;
+		//A basic block starts after each jump, and after each instruction which never continues to the next one
+		ends_with_terminator = instr.code == OP_RETURN || instr.code == OP_TAIL_CALL
+			|| instr.code == OP_JUMP || instr.code == OP_LOOP || instr.code == OP_JUMP_TABLE;
+		OpCodeLayout layout = OpCodeGetLayout(instr.code);
+		if (layout == LAYOUT_JUMP || layout == LAYOUT_TYPE_JUMP || layout == LAYOUT_LOOP || layout == LAYOUT_JUMP_TABLE
+			|| ends_with_terminator)
+			flags[offset + instr.size] |= VERIFY_FLAG_LEADER;
+	}
+
+	if (result == VERIFY_OK && !ends_with_terminator)
+		result = VERIFY_MISSING_RETURN;
+	if (result == VERIFY_OK && chunk->count != 0)
+		flags[0] |= VERIFY_FLAG_LEADER;
+	//The target of each call should be an OP_ENTER, and not bytes of another instruction ('calls' contains pairs of offset and target)
+	for (uint64_t i = 0; i < call_count && result == VERIFY_OK; i += 2)
+	{
+		if (!impl_verify_contains(functions, function_count, calls[i + 1]))
+		{
+			result = VERIFY_INVALID_TARGET;
+			offset = calls[i];
+		}
+	}
+	//The target of each jump should be an instruction of the same function, other than its OP_ENTER
+	for (uint64_t i = 0; i < jump_count && result == VERIFY_OK; i += 2)
+	{
+		uint64_t target = jumps[i + 1];
+		if (!(flags[target] & VERIFY_FLAG_INSTRUCTION) || (flags[target] & VERIFY_FLAG_FUNCTION)
+			|| impl_verify_function_of(functions, function_count, target) != impl_verify_function_of(functions, function_count, jumps[i]))
+		{
+			result = VERIFY_INVALID_JUMP;
+			offset = jumps[i];
+		}
+		else
+			flags[target] |= VERIFY_FLAG_LEADER;
+	}
+	if (functions != NULL)
+		safe_free(functions);
+	if (calls != NULL)
+		safe_free(calls);
+	if (jumps != NULL)
+		safe_free(jumps);
+	//The counters of a chunk that was built without them (or deserialized) are allocated once it is verified
+	if (result == VERIFY_OK && chunk->loop_counters == NULL && loop_count > chunk->loop_count)
+		chunk->loop_count = loop_count;
+	if (result == VERIFY_OK && chunk->inline_caches == NULL && cache_count > chunk->cache_count)
+		chunk->cache_count = cache_count;
+	*error_offset = offset;
+	return result;
+}
+
+VerifyResult impl_verify_instruction(const Chunk* chunk, const Instruction* instr, VerifyState* state,
+	uint64_t* max_depth, uint8_t* operand_type, bool* is_monomorphic)
+{
+	OpCodeLayout layout = OpCodeGetLayout(instr->code);
+	if (layout == LAYOUT_TYPE || layout == LAYOUT_TYPE_WORD || layout == LAYOUT_TYPE_BYTE || layout == LAYOUT_TYPE_JUMP
+		|| layout == LAYOUT_QUICKENED)
+	{
+		*is_monomorphic &= *operand_type == VERIFY_ANY_TYPE || *operand_type == instr->types[0];
+		*operand_type = instr->types[0];
+	}
+
+	uint8_t* stack = state->stack;
+	uint8_t* locals = state->locals;
+	uint64_t* depth = &state->depth;
+	VerifyResult result = VERIFY_OK;
+	//Interpret the effect of the instruction on the stack
+	switch (instr->code)
+	{
+	break; case OP_IMMEDIATE_BYTE:
+	case OP_IMMEDIATE_WORD:
+	case OP_IMMEDIATE_DWORD:
+	case OP_IMMEDIATE_QWORD:
+	case OP_LOAD_CONST_BYTE:
+	case OP_LOAD_CONST_WORD:
+		result = impl_verify_push(stack, depth, max_depth, VERIFY_ANY_TYPE);
+	break; case OP_NEGATE:
+	case OP_DIVIDE_CONST:
+	case OP_MODULO_CONST:
+		if ((result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, instr->types[0]);
+
+	break; case OP_CONVERT:
+	case OP_CVT_I32_I64:
+	case OP_CVT_I64_I32:
+	case OP_CVT_I32_DOUBLE:
+	case OP_CVT_DOUBLE_I32:
+	case OP_CVT_I64_DOUBLE:
+	case OP_CVT_DOUBLE_I64:
+	case OP_CVT_FLOAT_DOUBLE:
+	case OP_CVT_DOUBLE_FLOAT:
+	{
+		OperandType from = instr->types[0];
+		OperandType to = instr->types[1];
+		ConvertGetOpCodeTypes(instr->code, &from, &to);
+		//The values on the stack do not all have the same type anymore
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, from)) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, to);
+	}
+
+	break; case OP_ADD:
+	case OP_SUBTRACT:
+	case OP_MULTIPLY:
+	case OP_DIVIDE:
+	case OP_MODULO:
+	case OP_ADD_I64:
+	case OP_ADD_DOUBLE:
+	case OP_SUBTRACT_I64:
+	case OP_SUBTRACT_DOUBLE:
+	case OP_MULTIPLY_I64:
+	case OP_MULTIPLY_DOUBLE:
+	case OP_ADD_CHECKED:
+	case OP_SUBTRACT_CHECKED:
+	case OP_MULTIPLY_CHECKED:
+	case OP_DIVIDE_CHECKED:
+	case OP_MODULO_CHECKED:
+	case OP_ADD_WRAPPING:
+	case OP_SUBTRACT_WRAPPING:
+	case OP_MULTIPLY_WRAPPING:
+		if ((result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK
+			&& (result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, instr->types[0]);
+
+	break; case OP_PRINT:
+		//The value is not popped, but its type is now known
+		if ((result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, instr->types[0]);
+
+	break; case OP_ARRAY_NEW:
+		//The array OpCodes are run by the polymorphic loops
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK
+			&& (result = impl_verify_pop(stack, depth, OPERAND_COLTI_UI64)) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, VERIFY_ARRAY_TYPE(instr->types[0]));
+	break; case OP_ARRAY_LENGTH:
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK
+			&& (result = impl_verify_push(stack, depth, max_depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, OPERAND_COLTI_UI64);
+	break; case OP_ARRAY_GET:
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, OPERAND_COLTI_UI64)) == VERIFY_OK
+			&& (result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK
+			&& (result = impl_verify_push(stack, depth, max_depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, instr->types[0]);
+	break; case OP_ARRAY_SET:
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK
+			&& (result = impl_verify_pop(stack, depth, OPERAND_COLTI_UI64)) == VERIFY_OK
+			&& (result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, VERIFY_ARRAY_TYPE(instr->types[0]));
+	break; case OP_ARRAY_ADD:
+	case OP_ARRAY_SUBTRACT:
+	case OP_ARRAY_MULTIPLY:
+	case OP_ARRAY_DIVIDE:
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK
+			&& (result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, VERIFY_ARRAY_TYPE(instr->types[0]));
+	break; case OP_ARRAY_NEGATE:
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, VERIFY_ARRAY_TYPE(instr->types[0]));
+	break; case OP_ARRAY_CONVERT:
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, VERIFY_ARRAY_TYPE(instr->types[1]));
+	break; case OP_ARRAY_SUM:
+	case OP_ARRAY_MIN:
+	case OP_ARRAY_MAX:
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, instr->types[0]);
+	break; case OP_ARRAY_DOT:
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK
+			&& (result = impl_verify_pop(stack, depth, VERIFY_ARRAY_TYPE(instr->types[0]))) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, instr->types[0]);
+
+	break; case OP_LOAD_LOCAL_BYTE:
+	case OP_LOAD_LOCAL_WORD:
+		result = impl_verify_push(stack, depth, max_depth, locals[instr->immediate.ui64]);
+	break; case OP_STORE_LOCAL_BYTE:
+	case OP_STORE_LOCAL_WORD:
+		//The local takes the type of the value, which may be an array
+		if (*depth == 0)
+			result = VERIFY_STACK_UNDERFLOW;
+		else
+			locals[instr->immediate.ui64] = stack[--(*depth)];
+	break; case OP_INC_LOCAL_BYTE:
+	case OP_INC_LOCAL_WORD:
+		if ((result = impl_verify_pop(stack, depth, instr->types[0])) != VERIFY_OK)
+			break;
+		if (locals[instr->immediate.ui64] != instr->types[0] && locals[instr->immediate.ui64] != VERIFY_ANY_TYPE)
+			result = VERIFY_TYPE_MISMATCH;
+		else
+			locals[instr->immediate.ui64] = instr->types[0];
+
+	break; case OP_LOAD_GLOBAL:
+		//Globals are untyped, as they can be stored by any function
+		result = impl_verify_push(stack, depth, max_depth, VERIFY_ANY_TYPE);
+	break; case OP_STORE_GLOBAL:
+		if (*depth == 0)
+			result = VERIFY_STACK_UNDERFLOW;
+		else
+			--(*depth);
+
+	break; case OP_BOX:
+		//The dynamic values are run by the polymorphic loops, and their tags are untyped
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK
+			&& (result = impl_verify_push(stack, depth, max_depth, instr->types[0])) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, VERIFY_ANY_TYPE);
+	break; case OP_UNBOX:
+		//The tag is checked when running
+		*is_monomorphic = false;
+		if ((result = impl_verify_pop_scalar(stack, depth)) == VERIFY_OK
+			&& (result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, instr->types[0]);
+	break; case OP_ADD_DYNAMIC:
+	case OP_ADD_DYNAMIC_I64:
+	case OP_ADD_DYNAMIC_DOUBLE:
+	case OP_ADD_DYNAMIC_POLY:
+		//The tags and values of the operands are checked when running
+		*is_monomorphic = false;
+		for (int i = 0; i < 4 && result == VERIFY_OK; i++)
+			result = impl_verify_pop_scalar(stack, depth);
+		if (result == VERIFY_OK && (result = impl_verify_push(stack, depth, max_depth, VERIFY_ANY_TYPE)) == VERIFY_OK)
+			result = impl_verify_push(stack, depth, max_depth, VERIFY_ANY_TYPE);
+
+	break; case OP_ENTER: //The frame was reserved when decoding it
+	break; case OP_CALL:
+	case OP_TAIL_CALL:
+	{
+		//The arguments and the result of a function are untyped, so an array passed to a function cannot be used as an array by it.
+		//The target was checked by impl_verify_structure.
+		Instruction enter;
+		impl_verify_decode(chunk, instr->immediate.ui64, &enter);
+		if (*depth < enter.immediate.ui8)
+			result = VERIFY_STACK_UNDERFLOW;
+		else
+		{
+			*depth -= enter.immediate.ui8;
+			//The function called by a tail call returns to the caller
+			if (instr->code == OP_CALL)
+				result = impl_verify_push(stack, depth, max_depth, VERIFY_ANY_TYPE);
+		}
+	}
+
+	break; case OP_RETURN:
+		//A function returns the top of its stack
+		if (state->is_in_function && *depth == 0)
+			result = VERIFY_STACK_UNDERFLOW;
+
+	break; case OP_JUMP:
+	case OP_LOOP:
+	break; case OP_JUMP_IF_FALSE:
+		result = impl_verify_pop(stack, depth, OPERAND_COLTI_BOOL);
+	break; case OP_JUMP_IF_LESS:
+	case OP_JUMP_IF_LESS_EQUAL:
+	case OP_JUMP_IF_EQUAL:
+	case OP_JUMP_IF_NOT_EQUAL:
+		if ((result = impl_verify_pop(stack, depth, instr->types[0])) == VERIFY_OK)
+			result = impl_verify_pop(stack, depth, instr->types[0]);
+	break; case OP_JUMP_TABLE:
+		result = impl_verify_pop(stack, depth, OPERAND_COLTI_UI64);
+
+	break; default:
+		result = VERIFY_UNSUPPORTED_OPCODE;
+	}
+	return result;
+}
+
+VerifyResult impl_verify_merge(VerifyState* into, const VerifyState* from)
+{
+	if (!into->is_reached)
+	{
+		*into = *from;
+		into->is_reached = true;
+		into->is_pending = true;
+		return VERIFY_OK;
+	}
+	if (into->depth != from->depth)
+		return VERIFY_INCONSISTENT_STACK;
+	//A value whose type depends on the path is untyped, unless it is an array (whose address must never be forged)
+	bool is_changed = false;
+	for (uint64_t i = 0; i < into->depth; i++)
+	{
+		if (into->stack[i] == from->stack[i] || (into->stack[i] == VERIFY_ANY_TYPE && !VERIFY_IS_ARRAY_TYPE(from->stack[i])))
+			continue;
+		if (VERIFY_IS_ARRAY_TYPE(into->stack[i]) || VERIFY_IS_ARRAY_TYPE(from->stack[i]))
+			return VERIFY_TYPE_MISMATCH;
+		into->stack[i] = VERIFY_ANY_TYPE;
+		is_changed = true;
+	}
+	for (uint64_t i = 0; i < CHUNK_MAX_STACK_DEPTH; i++)
+	{
+		if (into->locals[i] == from->locals[i] || (into->locals[i] == VERIFY_ANY_TYPE && !VERIFY_IS_ARRAY_TYPE(from->locals[i])))
+			continue;
+		if (VERIFY_IS_ARRAY_TYPE(into->locals[i]) || VERIFY_IS_ARRAY_TYPE(from->locals[i]))
+			return VERIFY_TYPE_MISMATCH;
+		into->locals[i] = VERIFY_ANY_TYPE;
+		is_changed = true;
+	}
+	into->is_pending |= is_changed;
+	return VERIFY_OK;
+}
+
+uint64_t impl_verify_block_index(const uint64_t* leaders, uint64_t count, uint64_t offset)
+{
+	//Binary search, the offset being the beginning of a block
+	uint64_t low = 0;
+	uint64_t high = count;
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+		if (leaders[middle] < offset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	colti_assert(low < count && leaders[low] == offset, "Expected the offset of a basic block!");
+	return low;
+}
+
+uint64_t impl_verify_function_of(const uint64_t* functions, uint64_t count, uint64_t offset)
+{
+	//Binary search of the number of functions starting at or before 'offset'
+	uint64_t low = 0;
+	uint64_t high = count;
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+		if (functions[middle] <= offset)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+
+VerifyResult impl_verify_decode(const Chunk* chunk, uint64_t offset, Instruction* instr)
+{
+	bool is_valid = chunk->encoding == CHUNK_ENCODING_COMPACT
+		? CompactDecodeInstruction(chunk, offset, instr)
+		: ChunkDecodeInstruction(chunk, offset, instr);
+	if (is_valid)
+		return VERIFY_OK;
+
+	//Fused bytes of the compact encoding are never truncated
+	uint8_t byte = chunk->code[offset];
+	if (OpCodeGetLayout(byte) == LAYOUT_INVALID || (chunk->encoding == CHUNK_ENCODING_COMPACT && byte >= COMPACT_FUSED_BASE))
+		return VERIFY_INVALID_OPCODE;
+	return VERIFY_TRUNCATED_INSTRUCTION;
+}
+
+bool impl_verify_is_valid_operand(OpCode code, uint8_t type)
+{
+	if (type >= OPERAND_TYPE_COUNT)
+		return false;
+	switch (code)
+	{
+	case OP_INC_LOCAL_BYTE:
+	case OP_INC_LOCAL_WORD:
+		return type != OPERAND_COLTI_BOOL;
+	case OP_NEGATE: //Only signed types can be negated
+	case OP_ARRAY_NEGATE:
+		return type == OPERAND_COLTI_I8 || type == OPERAND_COLTI_I16 || type == OPERAND_COLTI_I32
+			|| type == OPERAND_COLTI_I64 || type == OPERAND_COLTI_FLOAT || type == OPERAND_COLTI_DOUBLE;
+	case OP_ADD:
+	case OP_SUBTRACT:
+	case OP_MULTIPLY:
+	case OP_DIVIDE:
+	case OP_MODULO:
+	case OP_ARRAY_ADD:
+	case OP_ARRAY_SUBTRACT:
+	case OP_ARRAY_MULTIPLY:
+	case OP_ARRAY_DIVIDE:
+	case OP_ARRAY_SUM:
+	case OP_ARRAY_MIN:
+	case OP_ARRAY_MAX:
+	case OP_ARRAY_DOT:
+		return type != OPERAND_COLTI_BOOL;
+	case OP_ADD_CHECKED: //Only integers can overflow
+	case OP_SUBTRACT_CHECKED:
+	case OP_MULTIPLY_CHECKED:
+	case OP_DIVIDE_CHECKED:
+	case OP_MODULO_CHECKED:
+	case OP_ADD_WRAPPING:
+	case OP_SUBTRACT_WRAPPING:
+	case OP_MULTIPLY_WRAPPING:
+	case OP_DIVIDE_CONST: //Divisors are integers
+	case OP_MODULO_CONST:
+		return type != OPERAND_COLTI_BOOL && type != OPERAND_COLTI_FLOAT && type != OPERAND_COLTI_DOUBLE;
+	default:
+		return true;
+	}
+}
+
+VerifyResult impl_verify_pop(const uint8_t* stack, uint64_t* depth, uint8_t type)
+{
+	if (*depth == 0)
+		return VERIFY_STACK_UNDERFLOW;
+	uint8_t top = stack[--(*depth)];
+	//An untyped value is never an array
+	if (top != type && (top != VERIFY_ANY_TYPE || VERIFY_IS_ARRAY_TYPE(type)))
+		return VERIFY_TYPE_MISMATCH;
+	return VERIFY_OK;
+}
+
+VerifyResult impl_verify_pop_scalar(const uint8_t* stack, uint64_t* depth)
+{
+	if (*depth == 0)
+		return VERIFY_STACK_UNDERFLOW;
+	//VERIFY_IS_ARRAY_TYPE reads its argument twice
+	uint8_t top = stack[--(*depth)];
+	if (VERIFY_IS_ARRAY_TYPE(top))
+		return VERIFY_TYPE_MISMATCH;
+	return VERIFY_OK;
+}
+
+VerifyResult impl_verify_push(uint8_t* stack, uint64_t* depth, uint64_t* max_depth, uint8_t type)
+{
+	if (*depth == CHUNK_MAX_STACK_DEPTH)
+		return VERIFY_STACK_OVERFLOW;
+	stack[(*depth)++] = type;
+	if (*depth > *max_depth)
+		*max_depth = *depth;
+	return VERIFY_OK;
+}
+
+void impl_verify_append(uint64_t** array, uint64_t* count, uint64_t* capacity, uint64_t value)
+{
+	if (*count == *capacity)
+	{
+		uint64_t new_capacity = *capacity == 0 ? 8 : *capacity * 2;
+		uint64_t* ptr = (uint64_t*)safe_malloc(new_capacity * sizeof(uint64_t));
+		if (*array != NULL)
+		{
+			memcpy(ptr, *array, *count * sizeof(uint64_t));
+			safe_free(*array);
+		}
+		*array = ptr;
+		*capacity = new_capacity;
+	}
+	(*array)[(*count)++] = value;
+}
+
+bool impl_verify_contains(const uint64_t* array, uint64_t count, uint64_t value)
+{
+	//Binary search
+	uint64_t low = 0;
+	uint64_t high = count;
+	while (low < high)
+	{
+		uint64_t middle = low + (high - low) / 2;
+		if (array[middle] == value)
+			return true;
+		if (array[middle] < value)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return false;
+}
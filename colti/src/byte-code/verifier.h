@@ -0,0 +1,234 @@
+/** @file verifier.h
+* Contains the byte-code verifier, which checks a Chunk before it is run.
+* The verifier decodes every instruction, checking that:
+* - every OpCode is valid and supported by the VM, and every instruction is complete
+* - every OperandType is valid for the instruction using it (the padding of a quickened OpCode being the OperandType it implies)
+* - every constant index is in the constant pool, and no constant divisor is zero
+* - the stack never underflows, nor exceeds CHUNK_MAX_STACK_DEPTH (including the local slots of the frame)
+* - the types of the values on the stack match the types of the instructions consuming them
+* - the code ends with an OP_RETURN (or another instruction which never continues to the next one, such as OP_JUMP)
+* - every call targets the OP_ENTER of a function, which the code preceding it never runs into
+* - every jump targets an instruction of its own function, forward (except OP_LOOP, which jumps backward),
+*   and every OP_LOOP uses a hotness counter of the chunk
+* To do so, the verifier interprets the code abstractly: rather than values,
+* it keeps track of the types of the values on the stack.
+* The code is split in basic blocks (starting at the targets of the jumps, and after the jumps), which are interpreted
+* until the state (the abstract stack and local slots) at the beginning of each block is stable: every path reaching
+* an instruction must reach it with the same stack depth, and a value (or local) whose type differs between two paths is
+* untyped after them (unless it is an array, which is a type mismatch).
+* Immediates and constants are untyped, and match any type except arrays: an array (see array.h) has the
+* abstract type VERIFY_ARRAY_TYPE(type), which only an array OpCode can produce, so that the address
+* of an array can never be forged.
+* Each local slot has the abstract type of the last value stored to it (untyped before any store, as the slots
+* are zero-initialized): the greatest slot index used gives the size of the frame.
+* Each function is verified from its OP_ENTER with an empty stack, and its own frame (declared by the OP_ENTER),
+* whose arguments are untyped. A call pops the arguments of the function called, and pushes its untyped result.
+* This also infers whether all the typed instructions operate on the same type (and none converts), in which case
+* every value on the stack has that type: the VM then runs the chunk using a loop specialized
+* for that type, which does not decode the OperandType of the instructions.
+* The Divisor table of a chunk dividing by constants is built when it is first verified.
+* A verified Chunk can be run without any runtime check, which is why StackVMRun
+* verifies any Chunk that was not verified yet before running it.
+* The values are not known when verifying: an integer OP_DIVIDE or OP_MODULO by zero (or of the minimum value of a
+* signed type by -1) traps (SIGFPE) even in verified code. Code whose divisors are not known to be valid should use
+* OP_DIVIDE_CHECKED and OP_MODULO_CHECKED, which stop the VM with a runtime error instead.
+*/
+
+#ifndef HG_COLTI_VERIFIER
+#define HG_COLTI_VERIFIER
+
+#include "common.h"
+#include "chunk.h"
+#include "compact_encoding.h"
+#include "conversion.h"
+#include "quickening.h"
+
+/// @brief The abstract type of untyped values (immediates and constants)
+#define VERIFY_ANY_TYPE 0xFF
+/// @brief The abstract type of arrays whose values are of OperandType 'type'
+#define VERIFY_ARRAY_TYPE(type) (0x80 | (type))
+/// @brief Check if an abstract type is the type of an array
+#define VERIFY_IS_ARRAY_TYPE(type) ((type) != VERIFY_ANY_TYPE && ((type) & 0x80) != 0)
+
+/// @brief The result of the verification of a Chunk
+typedef enum
+{
+	/// @brief The chunk is valid
+	VERIFY_OK,
+	/// @brief A byte is not a valid OpCode
+	VERIFY_INVALID_OPCODE,
+	/// @brief An OpCode is not supported by the VM yet
+	VERIFY_UNSUPPORTED_OPCODE,
+	/// @brief An instruction is missing some of its operands
+	VERIFY_TRUNCATED_INSTRUCTION,
+	/// @brief An OperandType is not valid for its instruction
+	VERIFY_INVALID_OPERAND,
+	/// @brief A constant index is not in the constant pool
+	VERIFY_INVALID_CONSTANT,
+	/// @brief An instruction pops more values than the stack contains
+	VERIFY_STACK_UNDERFLOW,
+	/// @brief The stack depth exceeds CHUNK_MAX_STACK_DEPTH
+	VERIFY_STACK_OVERFLOW,
+	/// @brief A value is used as a type different from the type it was produced with
+	VERIFY_TYPE_MISMATCH,
+	/// @brief The code does not end with an OP_RETURN
+	VERIFY_MISSING_RETURN,
+	/// @brief The constant divisor of an OP_DIVIDE_CONST or OP_MODULO_CONST is zero
+	VERIFY_ZERO_DIVISOR,
+	/// @brief A local slot index is not less than CHUNK_MAX_STACK_DEPTH (or than the number of local slots of its function)
+	VERIFY_INVALID_LOCAL,
+	/// @brief The target of an OP_CALL or OP_TAIL_CALL is not the offset of an OP_ENTER
+	VERIFY_INVALID_TARGET,
+	/// @brief A jump does not target an instruction of its function, or jumps backward without being an OP_LOOP
+	VERIFY_INVALID_JUMP,
+	/// @brief Two paths reach an instruction with different stack depths
+	VERIFY_INCONSISTENT_STACK,
+	/// @brief The counter index of an OP_LOOP is not less than the number of loop counters of the chunk
+	VERIFY_INVALID_COUNTER,
+	/// @brief A global slot index is not less than the number of global slots of the chunk
+	VERIFY_INVALID_GLOBAL,
+	/// @brief The InlineCache index of a dynamically typed instruction is not less than the number of caches of the chunk
+	VERIFY_INVALID_CACHE,
+} VerifyResult;
+
+/// @brief The abstract state at the beginning of a basic block
+typedef struct
+{
+	/// @brief True if a path reaching the block was found
+	bool is_reached;
+	/// @brief True if the state changed since the block was last interpreted
+	bool is_pending;
+	/// @brief True if the block is part of a function (rather than of the code of the chunk itself)
+	bool is_in_function;
+	/// @brief The depth of the abstract stack
+	uint64_t depth;
+	/// @brief The abstract stack, containing the types of the values
+	uint8_t stack[CHUNK_MAX_STACK_DEPTH];
+	/// @brief The abstract types of the local slots
+	uint8_t locals[CHUNK_MAX_STACK_DEPTH];
+} VerifyState;
+
+/// @brief Verifies a Chunk, setting its 'is_verified', 'max_stack_depth', 'local_count' and 'operand_type' on success
+/// (building its 'divisors', 'loop_counters' and 'inline_caches' if needed)
+/// @param chunk The chunk to verify
+/// @param error_offset Pointer to where to write the offset of the invalid instruction, can be NULL
+/// @return VERIFY_OK if the chunk is valid
+VerifyResult ChunkVerify(Chunk* chunk, uint64_t* error_offset);
+
+/// @brief Verifies a Chunk as ChunkVerify, also writing the depth of the stack before each reachable instruction
+/// @param chunk The chunk to verify
+/// @param error_offset Pointer to where to write the offset of the invalid instruction, can be NULL
+/// @param depths Array (of size 'chunk->count') to which to write the depth of the stack before the instruction
+/// at each offset, UINT64_MAX for unreachable instructions and offsets that are not instructions
+/// @return VERIFY_OK if the chunk is valid
+VerifyResult ChunkVerifyDepths(Chunk* chunk, uint64_t* error_offset, uint64_t* depths);
+
+/// @brief Returns a human readable description of a VerifyResult
+/// @param result The result to describe
+/// @return The description
+const char* VerifyResultToString(VerifyResult result);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Flag of the offsets at which an instruction starts
+#define VERIFY_FLAG_INSTRUCTION 1
+/// @brief Flag of the offsets at which a basic block starts
+#define VERIFY_FLAG_LEADER 2
+/// @brief Flag of the offsets at which a function (an OP_ENTER) starts
+#define VERIFY_FLAG_FUNCTION 4
+
+/// @brief Checks the structure of the code of a chunk: decodes every instruction, checking its operands, its local slots,
+/// its calls and its jumps, and flags the offsets of the instructions and of the basic blocks
+/// @param chunk The chunk to verify
+/// @param flags Array (of size 'chunk->count', zero-initialized) to which to write the VERIFY_FLAG_* of each offset
+/// @param error_offset Pointer to where to write the offset of the invalid instruction
+/// @param uses_divisors Pointer to where to write true if the code divides by constants
+/// @param local_count Pointer to where to write the number of local slots of the frame of the chunk (initialized to 0)
+/// @param local_offset Pointer to where to write the offset of the instruction using the greatest slot index
+/// @return VERIFY_OK if the structure of the code is valid
+VerifyResult impl_verify_structure(Chunk* chunk, uint8_t* flags, uint64_t* error_offset, bool* uses_divisors,
+	uint64_t* local_count, uint64_t* local_offset);
+
+/// @brief Interprets the effect of an instruction on an abstract state
+/// @param chunk The chunk containing the instruction
+/// @param instr The instruction, whose structure was checked
+/// @param state The state before the instruction, which is updated
+/// @param max_depth Pointer to the max depth reached, which is updated
+/// @param operand_type Pointer to the type of the typed instructions (VERIFY_ANY_TYPE until one is found), which is updated
+/// @param is_monomorphic Pointer to false if the typed instructions do not all operate on the same type, which is updated
+/// @return VERIFY_OK if the instruction is valid in that state
+VerifyResult impl_verify_instruction(const Chunk* chunk, const Instruction* instr, VerifyState* state,
+	uint64_t* max_depth, uint8_t* operand_type, bool* is_monomorphic);
+
+/// @brief Merges the state of a path into the state at the beginning of a basic block, marking the block
+/// as pending if its state changed
+/// @param into The state at the beginning of the block
+/// @param from The state of the path reaching the block
+/// @return VERIFY_OK, VERIFY_INCONSISTENT_STACK or VERIFY_TYPE_MISMATCH
+VerifyResult impl_verify_merge(VerifyState* into, const VerifyState* from);
+
+/// @brief Returns the index of the basic block starting at an offset, in O(log(count))
+/// @param leaders The sorted offsets of the basic blocks
+/// @param count The number of basic blocks
+/// @param offset The offset of the beginning of the block
+/// @return The index of the block
+uint64_t impl_verify_block_index(const uint64_t* leaders, uint64_t count, uint64_t offset);
+
+/// @brief Returns the index + 1 of the function containing an offset, 0 for the code of the chunk itself, in O(log(count))
+/// @param functions The sorted offsets of the functions
+/// @param count The number of functions
+/// @param offset The offset
+/// @return The index + 1 of the last function starting at or before 'offset', or 0 if there are none
+uint64_t impl_verify_function_of(const uint64_t* functions, uint64_t count, uint64_t offset);
+
+/// @brief Decodes an instruction of a chunk using any encoding
+/// @param chunk The chunk containing the instruction
+/// @param offset The offset of the instruction
+/// @param instr Pointer to where to write the decoded instruction
+/// @return VERIFY_OK, VERIFY_INVALID_OPCODE or VERIFY_TRUNCATED_INSTRUCTION
+VerifyResult impl_verify_decode(const Chunk* chunk, uint64_t offset, Instruction* instr);
+
+/// @brief Check if an OperandType is valid for an instruction
+/// @param code The OpCode of the instruction
+/// @param type The OperandType
+/// @return True if the OpCode can operate on the type
+bool impl_verify_is_valid_operand(OpCode code, uint8_t type);
+
+/// @brief Pops the abstract type of a value, checking that it matches 'type' (untyped values matching any type but arrays)
+/// @param stack The abstract stack
+/// @param depth Pointer to the depth of the stack, which is decremented
+/// @param type The type which the value should have
+/// @return VERIFY_OK, VERIFY_STACK_UNDERFLOW or VERIFY_TYPE_MISMATCH
+VerifyResult impl_verify_pop(const uint8_t* stack, uint64_t* depth, uint8_t type);
+
+/// @brief Pops the abstract type of a value of any type which is not an array (a part of a dynamic value)
+/// @param stack The abstract stack
+/// @param depth Pointer to the depth of the stack, which is decremented
+/// @return VERIFY_OK, VERIFY_STACK_UNDERFLOW or VERIFY_TYPE_MISMATCH
+VerifyResult impl_verify_pop_scalar(const uint8_t* stack, uint64_t* depth);
+
+/// @brief Pushes the abstract type of a value
+/// @param stack The abstract stack
+/// @param depth Pointer to the depth of the stack, which is incremented
+/// @param max_depth Pointer to the max depth reached, which is updated
+/// @param type The type to push
+/// @return VERIFY_OK or VERIFY_STACK_OVERFLOW
+VerifyResult impl_verify_push(uint8_t* stack, uint64_t* depth, uint64_t* max_depth, uint8_t type);
+
+/// @brief Appends an offset to a growable array
+/// @param array Pointer to the array (NULL if empty), which is reallocated when full
+/// @param count Pointer to the number of offsets of the array, which is incremented
+/// @param capacity Pointer to the capacity of the array
+/// @param value The offset to append
+void impl_verify_append(uint64_t** array, uint64_t* count, uint64_t* capacity, uint64_t value);
+
+/// @brief Check if a sorted array contains an offset, in O(log(count))
+/// @param array The sorted array
+/// @param count The number of offsets of the array
+/// @param value The offset to search for
+/// @return True if the array contains 'value'
+bool impl_verify_contains(const uint64_t* array, uint64_t count, uint64_t value);
+
+#endif //HG_COLTI_VERIFIER
@@ -4,6 +4,12 @@
 
 #include "scanner.h"
 
+#if (defined(COLTI_GNU) || defined(COLTI_CLANG)) && defined(__SSE2__)
+	#include <emmintrin.h>
+	/// @brief Defined if newlines can be searched for 16 bytes at a time
+	#define IMPL_COLTI_SSE2_NEWLINES
+#endif
+
 void ScannerInit(Scanner* scan, StringView to_scan)
 {
 	colti_assert(scan != NULL, "Pointer was NULL!");
@@ -16,6 +22,42 @@ void ScannerInit(Scanner* scan, StringView to_scan)
 void ScannerFree(Scanner* scan)
 {
 	StringFree(&scan->parsed_identifier);
+	if (scan->line_starts != NULL)
+		safe_free(scan->line_starts);
+	for (uint64_t i = 0; i < scan->diagnostic_count; i++)
+		safe_free(scan->diagnostics[i].message);
+	if (scan->diagnostics != NULL)
+		safe_free(scan->diagnostics);
+}
+
+SourceLocation ScannerGetSourceLocation(Scanner* scan, uint64_t offset)
+{
+	if (scan->line_starts == NULL)
+		impl_scanner_build_line_index(scan);
+	uint64_t line = impl_scanner_find_line(scan, offset);
+	SourceLocation location = { (uint32_t)(line + 1), (uint32_t)(offset - scan->line_starts[line] + 1) };
+	return location;
+}
+
+void ScannerSetDiagnosticBatching(Scanner* scan, bool is_batching)
+{
+	scan->is_batching_diagnostics = is_batching;
+}
+
+uint64_t ScannerFlushDiagnostics(Scanner* scan)
+{
+	uint64_t count = scan->diagnostic_count;
+	if (count == 0)
+		return 0;
+	qsort(scan->diagnostics, count, sizeof(ScannerDiagnostic), impl_scanner_compare_diagnostics);
+	for (uint64_t i = 0; i < count; i++)
+	{
+		ScannerDiagnostic* diagnostic = scan->diagnostics + i;
+		impl_scanner_print_diagnostic_format(scan, diagnostic->begin, diagnostic->end, "%s", diagnostic->message);
+		safe_free(diagnostic->message);
+	}
+	scan->diagnostic_count = 0;
+	return count;
 }
 
 StringView ScannerGetIdentifier(const Scanner* scan)
@@ -23,6 +65,11 @@ StringView ScannerGetIdentifier(const Scanner* scan)
 	return StringToStringView(&scan->parsed_identifier);
 }
 
+const Symbol* ScannerInternIdentifier(const Scanner* scan)
+{
+	return SymbolInternView(StringToStringView(&scan->parsed_identifier));
+}
+
 double ScannerGetDouble(const Scanner* scan)
 {
 	return scan->parsed_double;
@@ -95,59 +142,147 @@ Token ScannerGetNextToken(Scanner* scan)
 IMPLEMENTATION HELPERS
 **********************************/
 
-void impl_scanner_print_error(const Scanner* scan, const char* error, ...)
+void impl_scanner_print_error(Scanner* scan, const char* error, ...)
 {
-	fprintf(stderr, CONSOLE_FOREGROUND_BRIGHT_RED"Error: "CONSOLE_COLOR_RESET"On line %"PRIu64": ", scan->current_line);
-	
-	//prints the error
+	//The character following the lexeme was consumed, unless the lexeme ends the string
+	uint64_t end = scan->offset - (impl_peek_next_char(scan, 0) == EOF ? 0 : 1);
+	if (end < scan->lexeme_begin)
+		end = scan->lexeme_begin;
+
 	va_list args;
 	va_start(args, error);
-	vfprintf(stderr, error, args);
-	va_end(args);
-	fputc('\n', stderr);
-
-	size_t line_begin = 0;
-	//set the searching pointer to before the lexeme, and start searching backwards
-	//for the first '\n', which would be the beginning of the newline.
-	const char* newline = scan->view.start + scan->lexeme_begin;
-	while (newline != scan->view.start)
+	if (!scan->is_batching_diagnostics)
 	{
-		if (*newline == '\n')
-		{
-			line_begin = newline - scan->view.start;
-			break;
-		}
-		newline--;
+		impl_scanner_print_diagnostic(scan, scan->lexeme_begin, end, error, args);
+		va_end(args);
+		return;
 	}
 
-	//starts with the size of the string from the beginning of the line till the end of the whole string.
-	size_t line_end = scan->view.end - newline;
-	//reset the newline pointer to after the lexeme, and start looking for a '\n'
-	newline = scan->view.start + scan->offset;
-	while (newline != scan->view.end)
+	//Format the error, which is printed by ScannerFlushDiagnostics
+	va_list args_copy;
+	va_copy(args_copy, args);
+	int size = vsnprintf(NULL, 0, error, args_copy);
+	va_end(args_copy);
+	char* message = (char*)safe_malloc((size_t)size + 1);
+	vsnprintf(message, (size_t)size + 1, error, args);
+	va_end(args);
+
+	if (scan->diagnostic_count == scan->diagnostic_capacity) //Grow if needed
 	{
-		if (*newline == '\n')
+		uint64_t new_capacity = scan->diagnostic_capacity == 0 ? 16 : scan->diagnostic_capacity * 2;
+		ScannerDiagnostic* ptr = (ScannerDiagnostic*)safe_malloc(new_capacity * sizeof(ScannerDiagnostic));
+		if (scan->diagnostics != NULL)
 		{
-			line_end = newline - scan->view.start;
-			break;
+			memcpy(ptr, scan->diagnostics, scan->diagnostic_count * sizeof(ScannerDiagnostic));
+			safe_free(scan->diagnostics);
 		}
-		newline++;
+		scan->diagnostics = ptr;
+		scan->diagnostic_capacity = new_capacity;
 	}
+	ScannerDiagnostic diagnostic = { scan->lexeme_begin, end, message };
+	scan->diagnostics[scan->diagnostic_count++] = diagnostic;
+}
 
-	//This offset variable allows to fix highlighting issues:
-	//When the lexeme is not the last one, we need to remove 1 from the size of the lexeme.
-	//But if it's the last one, doing this results in a character getting chopped off.
-	int offset = (impl_peek_next_char(scan, 0) == EOF ? 0 : 1);
+void impl_scanner_print_diagnostic(Scanner* scan, uint64_t begin, uint64_t end, const char* error, va_list args)
+{
+	SourceLocation location = ScannerGetSourceLocation(scan, begin);
+	fprintf(stderr, CONSOLE_FOREGROUND_BRIGHT_RED"Error: "CONSOLE_COLOR_RESET"On line %"PRIu32", column %"PRIu32": ",
+		location.line, location.column);
+	vfprintf(stderr, error, args);
+	fputc('\n', stderr);
+
+	//The line ends before its '\n' (or at the end of the string)
+	uint64_t line = location.line - 1;
+	uint64_t line_begin = scan->line_starts[line];
+	uint64_t line_end = line + 1 < scan->line_count
+		? scan->line_starts[line + 1] - 1 : (uint64_t)(scan->view.end - scan->view.start);
+	if (end > line_end)
+		end = line_end;
 
-	//To highlight the error lexeme, we need to break down the line in 3 parts:
-	//
+	//To highlight the error lexeme, we need to break down the line in 3 parts
 	fprintf(stderr, "%.*s"CONSOLE_BACKGROUND_BRIGHT_RED"%.*s"CONSOLE_COLOR_RESET"%.*s\n",
-		(uint32_t)(scan->lexeme_begin - line_begin), scan->view.start + line_begin,
-		(uint32_t)(scan->offset - scan->lexeme_begin - offset), scan->view.start + scan->lexeme_begin,
-		(uint32_t)(line_end - scan->offset), scan->view.end - (line_end - scan->offset) - offset
+		(uint32_t)(begin - line_begin), scan->view.start + line_begin,
+		(uint32_t)(end - begin), scan->view.start + begin,
+		(uint32_t)(line_end - end), scan->view.start + end
 	);
 }
 
+void impl_scanner_print_diagnostic_format(Scanner* scan, uint64_t begin, uint64_t end, const char* error, ...)
+{
+	va_list args;
+	va_start(args, error);
+	impl_scanner_print_diagnostic(scan, begin, end, error, args);
+	va_end(args);
+}
+
+int impl_scanner_compare_diagnostics(const void* lhs, const void* rhs)
+{
+	const ScannerDiagnostic* left = (const ScannerDiagnostic*)lhs;
+	const ScannerDiagnostic* right = (const ScannerDiagnostic*)rhs;
+	if (left->begin != right->begin)
+		return left->begin < right->begin ? -1 : 1;
+	if (left->end != right->end)
+		return left->end < right->end ? -1 : 1;
+	//qsort is not stable: keep the order deterministic
+	return strcmp(left->message, right->message);
+}
+
+void impl_scanner_build_line_index(Scanner* scan)
+{
+	//The first line starts at offset 0, and every newline starts a new line
+	uint64_t newline_count = impl_find_newlines(scan->view.start, scan->view.end, NULL);
+	scan->line_starts = (uint64_t*)safe_malloc((newline_count + 1) * sizeof(uint64_t));
+	scan->line_starts[0] = 0;
+	impl_find_newlines(scan->view.start, scan->view.end, scan->line_starts + 1);
+	scan->line_count = newline_count + 1;
+}
+
+uint64_t impl_scanner_find_line(const Scanner* scan, uint64_t offset)
+{
+	//Finds the last line starting before or at 'offset'
+	uint64_t low = 0;
+	uint64_t high = scan->line_count;
+	while (high - low > 1)
+	{
+		uint64_t middle = low + (high - low) / 2;
+		if (scan->line_starts[middle] <= offset)
+			low = middle;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+uint64_t impl_find_newlines(const char* begin, const char* end, uint64_t* offsets)
+{
+	uint64_t count = 0;
+	const char* ptr = begin;
+#ifdef IMPL_COLTI_SSE2_NEWLINES
+	const __m128i newline = _mm_set1_epi8('\n');
+	for (; end - ptr >= 16; ptr += 16)
+	{
+		//A bit is set for each byte equal to '\n'
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)ptr), newline));
+		if (offsets == NULL)
+			count += (uint64_t)__builtin_popcount(mask);
+		else
+		{
+			for (; mask != 0; mask &= mask - 1)
+				offsets[count++] = (uint64_t)(ptr - begin) + (uint64_t)__builtin_ctz(mask) + 1;
+		}
+	}
+#endif
+	for (; ptr != end; ptr++)
+	{
+		if (*ptr != '\n')
+			continue;
+		if (offsets != NULL)
+			offsets[count] = (uint64_t)(ptr - begin) + 1;
+		count++;
+	}
+	return count;
+}
+
 char impl_get_next_char(Scanner* scan)
 {
 	if (scan->offset < (uint64_t)(scan->view.end - scan->view.start))
@@ -182,12 +317,6 @@ Token impl_scanner_handle_identifier(Scanner* scan, char current_char)
 
 Token impl_scanner_handle_digit(Scanner* scan, char current_char)
 {
-	//Clear the string
-	scan->parsed_identifier.size = 1;
-	scan->parsed_identifier.ptr[0] = '\0';
-
-	StringAppendChar(&scan->parsed_identifier, current_char);
-
 	if (current_char == '0') //Could be 0x, 0b, 0o
 	{
 		char after_0 = (char)tolower(impl_peek_next_char(scan, 0));
@@ -195,77 +324,82 @@ Token impl_scanner_handle_digit(Scanner* scan, char current_char)
 		switch (after_0)
 		{
 		break; case 'x': //HEXADECIMAL
-			base = 16;			
+			base = 16;
 		break; case 'b': //BINARY
 			base = 2;
-		break; case 'o': //OCTAL	
+		break; case 'o': //OCTAL
 			base = 8;
-		break; default:
-			if (!isdigit(after_0))
-			{
-				scan->parsed_uinteger = 0;
-				return TKN_INTEGER;
-			}
-			else //We recurse now that we have popped the leading 0
-				return impl_scanner_handle_digit(scan, impl_get_next_char(scan));
 		}
-		//Handle the different bases: 0x, 0b, 0o
-		after_0 = (char)tolower(impl_get_next_char(scan)); //consume the x|b|o
-		impl_parse_alnum(scan);
-		if (scan->parsed_identifier.size == 2) //Contains only the '0'
+		if (base != 10)
 		{
-			const char* range_str;
-			switch (after_0)
+			//Handle the different bases: 0x, 0b, 0o
+			(void)impl_get_next_char(scan); //consume the x|b|o
+			const char* digits_begin = scan->view.start + scan->offset;
+			StringView literal = { digits_begin, impl_scanner_literal_end(scan, impl_skip_alnum(scan)) };
+			if (literal.start == literal.end) //No digits after the prefix
 			{
-			break; case 'x':
-				range_str = "[0-9a-f]";
-			break; case 'b':
-				range_str = "[0-1]";
-			break; case 'o':
-				range_str = "[0-7]";
-			break; default: //should never happen
-				colti_assert(false, "after_0 was an unexpected value!");
-				range_str = "ERROR";
+				const char* range_str;
+				switch (after_0)
+				{
+				break; case 'x':
+					range_str = "[0-9a-f]";
+				break; case 'b':
+					range_str = "[0-1]";
+				break; case 'o':
+					range_str = "[0-7]";
+				break; default: //should never happen
+					colti_assert(false, "after_0 was an unexpected value!");
+					range_str = "ERROR";
+				}
+				impl_scanner_print_error(scan, "'0%c' should be followed by characters in range %s!", after_0, range_str);
+				return TKN_ERROR;
 			}
-			impl_scanner_print_error(scan, "'0%c' should be followed by characters in range %s!", after_0, range_str);
-			return TKN_ERROR;
+			return impl_token_str_to_uinteger(scan, literal, base);
 		}
-		return impl_token_str_to_uinteger(scan, base);
+		//Leading zeros of decimal literals are parsed as any other digit
 	}
 
-	//Parse as many digits as possible
-	char next_char = impl_parse_digits(scan);	
+	//Parse the integer part directly, which also skips its digits
+	const char* literal_begin = scan->view.start + scan->lexeme_begin;
+	StringView remaining = { literal_begin, scan->view.end };
+	const char* digits_end;
+	uint64_t value;
+	ConversionResult result = charsToUInt(remaining, 10, &value, &digits_end);
+	scan->offset = digits_end - scan->view.start;
+	char next_char = impl_get_next_char(scan);
 
 	bool isfloat = false;
 	// [0-9]+ followed by a .[0-9] is a float
 	if (next_char == '.' && isdigit(impl_peek_next_char(scan, 0)))
 	{
 		isfloat = true;
-		StringAppendChar(&scan->parsed_identifier, next_char);
-
-		//Parse as many digits as possible
-		next_char = impl_parse_digits(scan);
+		//Skip as many digits as possible
+		next_char = impl_skip_digits(scan);
 	}
 	char after_e = impl_peek_next_char(scan, 0);
 	// [0-9]+(.[0-9]+)?e[+-][0-9]+ is a float
 	if (next_char == 'e' && (after_e == '+' || after_e == '-' || isdigit(after_e)))
 	{
 		isfloat = true;
-		StringAppendChar(&scan->parsed_identifier, next_char);
-		next_char = impl_get_next_char(scan);
-		if (next_char == '+') //skip the + after the exponent
-			next_char = impl_get_next_char(scan);
+		(void)impl_get_next_char(scan); //consume the sign or first digit of the exponent
 
-		StringAppendChar(&scan->parsed_identifier, next_char);		
-		
-		//Parse as many digits as possible
-		(void)impl_parse_digits(scan);
+		//Skip as many digits as possible
+		next_char = impl_skip_digits(scan);
 	}
 
 	if (isfloat)
-		return impl_token_str_to_double(scan);
-	else
-		return impl_token_str_to_uinteger(scan, 10);
+	{
+		//The literal is parsed directly from the scanned string
+		StringView literal = { literal_begin, impl_scanner_literal_end(scan, next_char) };
+		return impl_token_str_to_double(scan, literal);
+	}
+	if (result == CONVERSION_OUT_OF_RANGE)
+	{
+		impl_scanner_print_error(scan, "Integer literal is not representable.");
+		return TKN_ERROR;
+	}
+	scan->parsed_uinteger = value;
+	return TKN_INTEGER;
 }
 
 Token impl_scanner_handle_plus(Scanner* scan)
@@ -443,18 +577,18 @@ Token impl_token_identifier_or_keyword(const String* string)
 	return TKN_IDENTIFIER;
 }
 
-Token impl_token_str_to_double(Scanner* scan)
+Token impl_token_str_to_double(Scanner* scan, StringView literal)
 {
-	char* end;
-	double value = strtod(scan->parsed_identifier.ptr, &end);
-	if (end != scan->parsed_identifier.ptr + scan->parsed_identifier.size - 1)
+	const char* end;
+	double value;
+	ConversionResult result = charsToDouble(literal, &value, &end);
+	if (end != literal.end)
 	{
 		impl_scanner_print_error(scan, "Unexpected character '%c' while parsing floating point literal.", *end);
 		return TKN_ERROR;
 	}
-	else if (value == HUGE_VAL && errno == ERANGE)
+	else if (result == CONVERSION_OUT_OF_RANGE)
 	{
-		errno = 0;
 		impl_scanner_print_error(scan, "Floating point literal is not representable.");
 		return TKN_ERROR;
 	}
@@ -462,19 +596,19 @@ Token impl_token_str_to_double(Scanner* scan)
 	return TKN_DOUBLE;
 }
 
-Token impl_token_str_to_uinteger(Scanner* scan, int base)
+Token impl_token_str_to_uinteger(Scanner* scan, StringView literal, int base)
 {
-	char* end;
-	uint64_t value = strtoull(scan->parsed_identifier.ptr, &end, base);
+	const char* end;
+	uint64_t value;
+	ConversionResult result = charsToUInt(literal, (uint32_t)base, &value, &end);
 	
-	if (end != scan->parsed_identifier.ptr + scan->parsed_identifier.size - 1)
+	if (end != literal.end)
 	{
 		impl_scanner_print_error(scan, "Unexpected character '%c' while parsing integer literal.", *end);
 		return TKN_ERROR;
 	}
-	else if (value == ULLONG_MAX && errno == ERANGE)
+	else if (result == CONVERSION_OUT_OF_RANGE)
 	{
-		errno = 0;
 		impl_scanner_print_error(scan, "Integer literal is not representable.");
 		return TKN_ERROR;
 	}
@@ -482,24 +616,24 @@ Token impl_token_str_to_uinteger(Scanner* scan, int base)
 	return TKN_INTEGER;
 }
 
-char impl_parse_alnum(Scanner* scan)
+char impl_skip_alnum(Scanner* scan)
 {
 	char next_char = impl_get_next_char(scan);
 	while (isalnum(next_char))
-	{
-		StringAppendChar(&scan->parsed_identifier, next_char);
 		next_char = impl_get_next_char(scan);
-	}
 	return next_char;
 }
 
-char impl_parse_digits(Scanner* scan)
+char impl_skip_digits(Scanner* scan)
 {
 	char next_char = impl_get_next_char(scan);
 	while (isdigit(next_char))
-	{
-		StringAppendChar(&scan->parsed_identifier, next_char);
 		next_char = impl_get_next_char(scan);
-	}
 	return next_char;
 }
+
+const char* impl_scanner_literal_end(const Scanner* scan, char last_char)
+{
+	//impl_get_next_char does not advance the offset when returning EOF
+	return scan->view.start + scan->offset - (last_char == EOF ? 0 : 1);
+}
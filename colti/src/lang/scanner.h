@@ -3,6 +3,11 @@
 * As the Scanner does not need to modify the input string, it takes in
 * a StringView.
 * The Scanner also handles error printing through `impl_scanner_print_error`.
+* To print the line containing an error, the Scanner builds an index of the beginning
+* of each line the first time an error is found (which is never done for valid code),
+* after which any offset is converted to a line and column in O(log(lines)).
+* Errors can also be batched (ScannerSetDiagnosticBatching), in which case they are
+* only printed, sorted by offset, by ScannerFlushDiagnostics.
 * The Scanner's string to integer can handles binary integers `0b`, decimal integers `0x`, octal integers `0o`.
 */
 
@@ -11,7 +16,21 @@
 
 #include "common.h"
 #include "structs/struct_string.h"
+#include "structs/struct_symbol.h"
 #include "token.h"
+#include "util/number_conversion.h"
+#include "byte-code/debug_info.h" //Contains SourceLocation
+
+/// @brief An error found by a Scanner which batches its diagnostics
+typedef struct
+{
+	/// @brief The offset of the beginning of the highlighted lexeme
+	uint64_t begin;
+	/// @brief The offset past the end of the highlighted lexeme
+	uint64_t end;
+	/// @brief The formatted error (NUL terminated)
+	char* message;
+} ScannerDiagnostic;
 
 /// @brief Struct responsible of breaking a string into lexemes
 typedef struct
@@ -33,6 +52,20 @@ typedef struct
 	uint64_t parsed_uinteger;
 	/// @brief The last parsed signed integer literal
 	int64_t parsed_integer;
+
+	/// @brief The offsets of the beginning of each line, NULL until an error is printed
+	uint64_t* line_starts;
+	/// @brief The number of lines in 'line_starts'
+	uint64_t line_count;
+
+	/// @brief True if errors are stored in 'diagnostics' rather than printed
+	bool is_batching_diagnostics;
+	/// @brief The number of batched diagnostics
+	uint64_t diagnostic_count;
+	/// @brief The capacity of 'diagnostics'
+	uint64_t diagnostic_capacity;
+	/// @brief The batched diagnostics, NULL if empty
+	ScannerDiagnostic* diagnostics;
 } Scanner;
 
 /// @brief Initializes a Scanner
@@ -48,6 +81,11 @@ void ScannerFree(Scanner* scan);
 /// @return A StringView of the 
 StringView ScannerGetIdentifier(const Scanner* scan);
 
+/// @brief Returns the Symbol of the parsed identifier, interning it (see struct_symbol.h)
+/// @param scan The scanner from which to get the value
+/// @return The Symbol of the identifier, which is the same for every occurrence of the identifier
+const Symbol* ScannerInternIdentifier(const Scanner* scan);
+
 /// @brief Returns the parsed double/float
 /// @param scan The scanner from which to get the value
 /// @return The value stored in parsed_double
@@ -58,6 +96,23 @@ double ScannerGetDouble(const Scanner* scan);
 /// @return The value stored in parsed_uinteger
 uint64_t ScannerGetInt(const Scanner* scan);
 
+/// @brief Converts an offset of the scanned string to a line and column (both starting at 1).
+/// The index of the lines is built on the first call.
+/// @param scan The scanner containing the string
+/// @param offset The offset to convert
+/// @return The location of the offset
+SourceLocation ScannerGetSourceLocation(Scanner* scan, uint64_t offset);
+
+/// @brief Enables or disables batching errors, rather than printing them when found
+/// @param scan The scanner to modify
+/// @param is_batching True to batch the errors until ScannerFlushDiagnostics is called
+void ScannerSetDiagnosticBatching(Scanner* scan, bool is_batching);
+
+/// @brief Prints the batched errors sorted by their offsets, and clears them
+/// @param scan The scanner whose errors to print
+/// @return The number of errors printed
+uint64_t ScannerFlushDiagnostics(Scanner* scan);
+
 /// @brief Get the next token from a scanner.
 /// @param scan The scanner from which to get the value
 /// @return A Token representing the parsed lexeme, or TKN_EOF if there are no more lexemes
@@ -69,12 +124,50 @@ IMPLEMENTATION HELPERS
 
 /// @brief Prints formatted 'error' and highlights the current lexeme.
 /// Prints the line number, the line, highlights the lexeme.
-/// This function is as optimized as it can be, but it should still only
-/// be called for when error are found to avoid slowdown.
+/// If the scanner batches its diagnostics, the error is stored rather than printed.
 /// @param scan The scanner from which to get the lexeme and line
 /// @param error The error, which is a `printf` style-format string
 /// @param  Variadic number of arguments to format to 'error'
-void impl_scanner_print_error(const Scanner* scan, const char* error, ...);
+void impl_scanner_print_error(Scanner* scan, const char* error, ...);
+
+/// @brief Prints an error, followed by the line containing it in which [begin, end) is highlighted
+/// @param scan The scanner containing the string
+/// @param begin The offset of the beginning of the highlighted lexeme
+/// @param end The offset past the end of the highlighted lexeme
+/// @param error The error, which is a `printf` style-format string
+/// @param args The arguments to format to 'error'
+void impl_scanner_print_diagnostic(Scanner* scan, uint64_t begin, uint64_t end, const char* error, va_list args);
+
+/// @brief Prints an error, highlighting its lexeme, using a `printf` style-format string
+/// @param scan The scanner containing the string
+/// @param begin The offset of the beginning of the highlighted lexeme
+/// @param end The offset past the end of the highlighted lexeme
+/// @param error The error, which is a `printf` style-format string
+/// @param  Variadic number of arguments to format to 'error'
+void impl_scanner_print_diagnostic_format(Scanner* scan, uint64_t begin, uint64_t end, const char* error, ...);
+
+/// @brief Compares 2 ScannerDiagnostic by their offsets (for qsort)
+/// @param lhs Pointer to the first diagnostic
+/// @param rhs Pointer to the second diagnostic
+/// @return Negative if 'lhs' should be printed before 'rhs', positive if after, else 0
+int impl_scanner_compare_diagnostics(const void* lhs, const void* rhs);
+
+/// @brief Builds the index of the beginning of the lines of the scanned string
+/// @param scan The scanner whose index to build
+void impl_scanner_build_line_index(Scanner* scan);
+
+/// @brief Returns the index of the line containing an offset, using a binary search
+/// @param scan The scanner whose index was built
+/// @param offset The offset whose line to find
+/// @return The index of the line (starting at 0)
+uint64_t impl_scanner_find_line(const Scanner* scan, uint64_t offset);
+
+/// @brief Finds the newlines of a string, 16 bytes at a time on SSE2 targets
+/// @param begin Pointer to the beginning of the string
+/// @param end Pointer past the end of the string
+/// @param offsets Pointer to where to write the offset following each newline, or NULL to only count them
+/// @return The number of newlines
+uint64_t impl_find_newlines(const char* begin, const char* end, uint64_t* offsets);
 
 /// @brief Returns the next character in the stream, and updates the offset
 /// @param scan The scanner from which to get the character
@@ -119,27 +212,39 @@ Token impl_scanner_handle_greater(Scanner* scan);
 /// @return A Token representing a keyword, or TKN_IDENTIFIER
 Token impl_token_identifier_or_keyword(const String* string);
 
-/// @brief Converts a scanner's identifier string to a double.
+/// @brief Converts a literal to a double.
 /// This function also stores the result in the scanner's 'parsed_double',
 /// and handles any error.
 /// @param scan The scanner to modify
+/// @param literal The view over the literal, which points into the scanned string
 /// @return TKN_DOUBLE or TKN_ERROR if an error is encountered
-Token impl_token_str_to_double(Scanner* scan);
+Token impl_token_str_to_double(Scanner* scan, StringView literal);
 
-/// @brief Converts a scanner's identifier string to an int of base 'base'.
+/// @brief Converts a literal to an int of base 'base'.
 /// This function also stores the result of the conversion in the scanner's
 /// 'parsed_uinteger' and handles any error.
 /// @param scan The scanner to modify
+/// @param literal The view over the literal (without any base prefix)
 /// @param base The base of the int to parse
 /// @return TKN_INTEGER or TKN_ERROR if an error is encountered
-Token impl_token_str_to_uinteger(Scanner* scan, int base);
+Token impl_token_str_to_uinteger(Scanner* scan, StringView literal, int base);
 
-/// @brief Adds characters to the scanner's identifier string while they are alpha or digits
+/// @brief Consumes characters while they are alpha or digits.
+/// The character following them is also consumed.
 /// @param scan The scanner to modify
-char impl_parse_alnum(Scanner* scan);
+/// @return The character following the alpha or digits
+char impl_skip_alnum(Scanner* scan);
 
-/// @brief Adds characters to the scanner's identifier string while they are digits
+/// @brief Consumes characters while they are digits.
+/// The character following them is also consumed.
 /// @param scan The scanner to modify
-char impl_parse_digits(Scanner* scan);
+/// @return The character following the digits
+char impl_skip_digits(Scanner* scan);
+
+/// @brief Returns the end of a literal whose following character was consumed
+/// @param scan The scanner from which to get the end
+/// @param last_char The last character consumed (which is not part of the literal)
+/// @return Pointer past the last character of the literal
+const char* impl_scanner_literal_end(const Scanner* scan, char last_char);
 
 #endif //HG_COLTI_SCANNER
\ No newline at end of file
@@ -42,5 +42,7 @@ int main(int argc, const char** argv)
 		debug_scan(StringToStringView(&file_content));
 		StringFree(&file_content);
 	}
+	//The Symbols interned while loading the code are freed last
+	SymbolTableFree();
 	DUMP_MEMORY_LEAKS();
 }
\ No newline at end of file
@@ -0,0 +1,205 @@
+/** @file struct_hash_map.c
+* Contains the definitions of the functions declared in 'struct_hash_map.h'
+*/
+
+#include "struct_hash_map.h"
+
+#if (defined(COLTI_GNU) || defined(COLTI_CLANG)) && defined(__SSE2__)
+	#include <emmintrin.h>
+	/// @brief Defined if the control bytes of a group can be compared at once
+	#define IMPL_COLTI_SSE2_CONTROL
+#endif
+
+void HashMapInit(HashMap* map)
+{
+	map->control = NULL;
+	map->slots = NULL;
+	map->capacity = 0;
+	map->count = 0;
+	map->growth_left = 0;
+}
+
+void HashMapFree(HashMap* map)
+{
+	if (map->control != NULL)
+		safe_free(map->control);
+	if (map->slots != NULL)
+		safe_free(map->slots);
+	HashMapInit(map);
+}
+
+bool HashMapFind(const HashMap* map, uint64_t key, uint64_t hash, uint64_t* value)
+{
+	const HashMapSlot* slot = HashMapFindWith(map, hash, impl_hash_map_key_equal, &key);
+	if (slot == NULL)
+		return false;
+	if (value != NULL)
+		*value = slot->value;
+	return true;
+}
+
+HashMapSlot* HashMapFindWith(const HashMap* map, uint64_t hash, HashMapKeyEqual equal, const void* context)
+{
+	if (map->capacity == 0)
+		return NULL;
+	//The low 7 bits are stored in the control bytes, the other bits choose the first group
+	uint64_t mask = map->capacity - 1;
+	uint64_t position = (hash >> 7) & mask;
+	uint8_t control = (uint8_t)(hash & 0x7F);
+	//Triangular probing, which visits every group as the capacity is a power of 2
+	for (uint64_t stride = HASH_MAP_GROUP_SIZE;; stride += HASH_MAP_GROUP_SIZE)
+	{
+		const uint8_t* group = map->control + position;
+		for (uint32_t match = impl_hash_map_match(group, control); match != 0; match &= match - 1)
+		{
+			HashMapSlot* slot = map->slots + ((position + impl_hash_map_lowest_bit(match)) & mask);
+			if (slot->hash == hash && equal(slot->key, context))
+				return slot;
+		}
+		//The key would have been inserted in that EMPTY slot
+		if (impl_hash_map_match(group, HASH_MAP_EMPTY) != 0)
+			return NULL;
+		position = (position + stride) & mask;
+	}
+}
+
+bool HashMapInsert(HashMap* map, uint64_t key, uint64_t hash, uint64_t value)
+{
+	HashMapSlot* slot = HashMapFindWith(map, hash, impl_hash_map_key_equal, &key);
+	if (slot != NULL)
+	{
+		slot->value = value;
+		return false;
+	}
+	HashMapInsertNew(map, key, hash, value);
+	return true;
+}
+
+void HashMapInsertNew(HashMap* map, uint64_t key, uint64_t hash, uint64_t value)
+{
+	if (map->growth_left == 0)
+	{
+		//Rehashing in place is enough if most of the used slots are DELETED
+		if (map->capacity == 0)
+			impl_hash_map_rehash(map, HASH_MAP_GROUP_SIZE);
+		else
+			impl_hash_map_rehash(map, map->count >= map->capacity * 7 / 16 ? map->capacity * 2 : map->capacity);
+	}
+	uint64_t index = impl_hash_map_find_free(map, hash);
+	if (map->control[index] == HASH_MAP_EMPTY)
+		--map->growth_left;
+	impl_hash_map_set_control(map, index, (uint8_t)(hash & 0x7F));
+	HashMapSlot slot = { key, hash, value };
+	map->slots[index] = slot;
+	++map->count;
+}
+
+bool HashMapRemove(HashMap* map, uint64_t key, uint64_t hash)
+{
+	HashMapSlot* slot = HashMapFindWith(map, hash, impl_hash_map_key_equal, &key);
+	if (slot == NULL)
+		return false;
+	//The slot may be in the middle of the probe sequence of other keys
+	impl_hash_map_set_control(map, (uint64_t)(slot - map->slots), HASH_MAP_DELETED);
+	--map->count;
+	return true;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+uint32_t impl_hash_map_match(const uint8_t* group, uint8_t byte)
+{
+#ifdef IMPL_COLTI_SSE2_CONTROL
+	__m128i bytes = _mm_loadu_si128((const __m128i*)group);
+	return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)byte)));
+#else
+	uint32_t mask = 0;
+	for (uint32_t i = 0; i < HASH_MAP_GROUP_SIZE; i++)
+		mask |= (uint32_t)(group[i] == byte) << i;
+	return mask;
+#endif
+}
+
+uint32_t impl_hash_map_match_free(const uint8_t* group)
+{
+	//EMPTY and DELETED are the only control bytes whose high bit is set
+#ifdef IMPL_COLTI_SSE2_CONTROL
+	return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+#else
+	uint32_t mask = 0;
+	for (uint32_t i = 0; i < HASH_MAP_GROUP_SIZE; i++)
+		mask |= (uint32_t)(group[i] >> 7) << i;
+	return mask;
+#endif
+}
+
+uint32_t impl_hash_map_lowest_bit(uint32_t mask)
+{
+	colti_assert(mask != 0, "Cannot find the lowest bit of 0!");
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	return (uint32_t)__builtin_ctz(mask);
+#else
+	uint32_t index = 0;
+	while (!(mask & 1))
+	{
+		mask >>= 1;
+		++index;
+	}
+	return index;
+#endif
+}
+
+bool impl_hash_map_key_equal(uint64_t key, const void* context)
+{
+	return key == *(const uint64_t*)context;
+}
+
+void impl_hash_map_set_control(HashMap* map, uint64_t index, uint8_t control)
+{
+	map->control[index] = control;
+	if (index < HASH_MAP_GROUP_SIZE)
+		map->control[map->capacity + index] = control;
+}
+
+uint64_t impl_hash_map_find_free(const HashMap* map, uint64_t hash)
+{
+	uint64_t mask = map->capacity - 1;
+	uint64_t position = (hash >> 7) & mask;
+	for (uint64_t stride = HASH_MAP_GROUP_SIZE;; stride += HASH_MAP_GROUP_SIZE)
+	{
+		uint32_t match = impl_hash_map_match_free(map->control + position);
+		if (match != 0)
+			return (position + impl_hash_map_lowest_bit(match)) & mask;
+		position = (position + stride) & mask;
+	}
+}
+
+void impl_hash_map_rehash(HashMap* map, uint64_t capacity)
+{
+	colti_assert((capacity & (capacity - 1)) == 0 && capacity >= HASH_MAP_GROUP_SIZE, "Invalid HashMap capacity!");
+	uint8_t* old_control = map->control;
+	HashMapSlot* old_slots = map->slots;
+	uint64_t old_capacity = map->capacity;
+
+	map->control = (uint8_t*)safe_malloc(capacity + HASH_MAP_GROUP_SIZE);
+	memset(map->control, HASH_MAP_EMPTY, capacity + HASH_MAP_GROUP_SIZE);
+	map->slots = (HashMapSlot*)safe_malloc(capacity * sizeof(HashMapSlot));
+	map->capacity = capacity;
+	//The table is kept at most 7/8 full, so that the probing always ends on an EMPTY slot
+	map->growth_left = capacity - capacity / 8 - map->count;
+	for (uint64_t i = 0; i < old_capacity; i++)
+	{
+		if (old_control[i] & HASH_MAP_EMPTY) //EMPTY or DELETED
+			continue;
+		uint64_t index = impl_hash_map_find_free(map, old_slots[i].hash);
+		impl_hash_map_set_control(map, index, old_control[i]);
+		map->slots[index] = old_slots[i];
+	}
+	if (old_control != NULL)
+	{
+		safe_free(old_control);
+		safe_free(old_slots);
+	}
+}
@@ -0,0 +1,149 @@
+/** @file struct_hash_map.h
+* An open addressing hash table mapping 64-bit keys to 64-bit values, following the Swiss table design.
+* Each slot has a control byte, stored in a separate array: EMPTY, DELETED, or the 7 low bits
+* of the hash of its key (the remaining bits choosing where the probing starts).
+* A lookup compares the control bytes of a group of HASH_MAP_GROUP_SIZE slots at once
+* (using SSE2 where it is available), and only compares the keys of the slots whose 7 bits match:
+* most lookups touch a single group, and compare a single key.
+* The keys are not hashed by the table: the caller passes the hash of each key (which is stored in its slot),
+* which lets a key be a pointer to data whose hash is precomputed (see struct_symbol.h).
+* Such keys can be looked up by content using HashMapFindWith, which compares the keys using a callback.
+* The table grows (doubling its capacity) once it is 7/8 full. An empty HashMap does not allocate.
+*/
+
+#ifndef HG_COLTI_STRUCT_HASH_MAP
+#define HG_COLTI_STRUCT_HASH_MAP
+
+#include "common.h"
+
+/// @brief The number of control bytes compared at once when probing
+#define HASH_MAP_GROUP_SIZE 16
+/// @brief The control byte of a slot that was never used (which ends the probing)
+#define HASH_MAP_EMPTY 0x80
+/// @brief The control byte of a slot whose key was removed (which does not end the probing)
+#define HASH_MAP_DELETED 0xFE
+
+/// @brief A key, its hash and its value
+typedef struct
+{
+	/// @brief The key
+	uint64_t key;
+	/// @brief The hash of the key, kept so that growing does not need to hash the keys again
+	uint64_t hash;
+	/// @brief The value mapped to the key
+	uint64_t value;
+} HashMapSlot;
+
+/// @brief Compares a key of a HashMap to the content searched for by HashMapFindWith
+/// @param key The key of a slot whose hash matches
+/// @param context The content searched for
+/// @return True if the key is the one searched for
+typedef bool (*HashMapKeyEqual)(uint64_t key, const void* context);
+
+/// @brief An open addressing hash table, whose slots are probed by groups of control bytes
+typedef struct
+{
+	/// @brief The control byte of each slot, followed by a copy of the first HASH_MAP_GROUP_SIZE
+	/// control bytes (so that a group can start at any slot), NULL if the capacity is 0
+	uint8_t* control;
+	/// @brief The slots, NULL if the capacity is 0
+	HashMapSlot* slots;
+	/// @brief The number of slots (0, or a power of 2 not less than HASH_MAP_GROUP_SIZE)
+	uint64_t capacity;
+	/// @brief The number of keys in the table
+	uint64_t count;
+	/// @brief The number of EMPTY slots that can be filled before growing
+	uint64_t growth_left;
+} HashMap;
+
+/// @brief Initializes an empty HashMap, which does not allocate until a key is inserted
+/// @param map The map to initialize
+void HashMapInit(HashMap* map);
+
+/// @brief Frees the resources used by a HashMap (the keys are not freed)
+/// @param map The map to free
+void HashMapFree(HashMap* map);
+
+/// @brief Finds the value mapped to a key
+/// @param map The map in which to search
+/// @param key The key to search for
+/// @param hash The hash of 'key' (which must be the hash with which it was inserted)
+/// @param value Pointer to where to write the value, or NULL
+/// @return False if the map does not contain the key (in which case 'value' is not modified)
+bool HashMapFind(const HashMap* map, uint64_t key, uint64_t hash, uint64_t* value);
+
+/// @brief Finds the slot of a key by comparing the keys whose hash matches using a callback.
+/// This allows finding a key that points to some content, knowing only the content.
+/// @param map The map in which to search
+/// @param hash The hash of the content searched for
+/// @param equal The function comparing a key to 'context'
+/// @param context The content searched for
+/// @return The slot of the key (whose value can be modified), or NULL if no key is equal to 'context'
+HashMapSlot* HashMapFindWith(const HashMap* map, uint64_t hash, HashMapKeyEqual equal, const void* context);
+
+/// @brief Maps a key to a value, replacing its value if the map already contains the key
+/// @param map The map to modify
+/// @param key The key
+/// @param hash The hash of 'key'
+/// @param value The value to map to 'key'
+/// @return True if the key was inserted, false if its value was replaced
+bool HashMapInsert(HashMap* map, uint64_t key, uint64_t hash, uint64_t value);
+
+/// @brief Inserts a key that the map does not contain, without searching for it first
+/// @param map The map to modify
+/// @param key The key, which must not be in the map
+/// @param hash The hash of 'key'
+/// @param value The value to map to 'key'
+void HashMapInsertNew(HashMap* map, uint64_t key, uint64_t hash, uint64_t value);
+
+/// @brief Removes a key from a HashMap
+/// @param map The map to modify
+/// @param key The key to remove
+/// @param hash The hash of 'key'
+/// @return False if the map does not contain the key
+bool HashMapRemove(HashMap* map, uint64_t key, uint64_t hash);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Returns a bit mask of the control bytes of a group that are equal to a byte
+/// @param group The first control byte of the group (which does not need to be aligned)
+/// @param byte The byte to compare to
+/// @return The mask whose bit N is set if the Nth byte of the group is equal to 'byte'
+uint32_t impl_hash_map_match(const uint8_t* group, uint8_t byte);
+
+/// @brief Returns a bit mask of the control bytes of a group that are EMPTY or DELETED
+/// @param group The first control byte of the group (which does not need to be aligned)
+/// @return The mask whose bit N is set if the Nth slot of the group is free
+uint32_t impl_hash_map_match_free(const uint8_t* group);
+
+/// @brief Returns the index of the lowest set bit of a mask
+/// @param mask The mask, which must not be 0
+/// @return The index of the bit
+uint32_t impl_hash_map_lowest_bit(uint32_t mask);
+
+/// @brief Compares a key to the key pointed to by 'context' (used by HashMapFind)
+/// @param key The key of a slot
+/// @param context Pointer to the key searched for
+/// @return True if the keys are equal
+bool impl_hash_map_key_equal(uint64_t key, const void* context);
+
+/// @brief Writes the control byte of a slot, and its copy if the slot is in the first group
+/// @param map The map to modify
+/// @param index The index of the slot
+/// @param control The control byte
+void impl_hash_map_set_control(HashMap* map, uint64_t index, uint8_t control);
+
+/// @brief Returns the index of the first free slot of the probe sequence of a hash
+/// @param map The map in which to search, which contains at least an EMPTY slot
+/// @param hash The hash of the key to insert
+/// @return The index of the slot
+uint64_t impl_hash_map_find_free(const HashMap* map, uint64_t hash);
+
+/// @brief Reallocates the slots of a HashMap, reinserting its keys (and dropping the DELETED slots)
+/// @param map The map to modify
+/// @param capacity The new capacity (a power of 2 not less than HASH_MAP_GROUP_SIZE), which can hold all the keys
+void impl_hash_map_rehash(HashMap* map, uint64_t capacity);
+
+#endif //HG_COLTI_STRUCT_HASH_MAP
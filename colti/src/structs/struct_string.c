@@ -3,6 +3,7 @@
 */
 
 #include "struct_string.h"
+#include "hash.h"
 
 void StringInit(String* str)
 {
@@ -195,6 +196,12 @@ bool StringEqual(const String* lhs, const String* rhs)
 	return memcmp(lhs->ptr, rhs->ptr, lhs->size - 1) == 0;	
 }
 
+uint64_t StringHash(const String* str)
+{
+	colti_assert(str->ptr != NULL, "Huge bug: a string's buffer was NULL!");
+	return hashBytes(str->ptr, str->size - 1, 0);
+}
+
 void StringFill(String* str, char character)
 {
 	colti_assert(str->ptr != NULL, "Huge bug: a string's buffer was NULL!");
@@ -269,6 +276,11 @@ bool StringViewEqual(StringView lhs, StringView rhs)
 	return memcmp(lhs.start, rhs.start, lhs.end - lhs.start) == 0;
 }
 
+uint64_t StringViewHash(StringView strv)
+{
+	return hashBytes(strv.start, (uint64_t)(strv.end - strv.start), 0);
+}
+
 /*****************************************
 IMPLEMENTATION HELPERS
 *****************************************/
@@ -104,6 +104,11 @@ void StringAppendString(String* str, const char* what);
 /// @return True if the strings are equal
 bool StringEqual(const String* lhs, const String* rhs);
 
+/// @brief Hashes the content of a string (without its NUL terminator), see hash.h
+/// @param str The string to hash
+/// @return The hash of the string, which is the hash of StringToStringView(str)
+uint64_t StringHash(const String* str);
+
 /// @brief Fills a string with the specified character
 /// @param str The string to modify
 /// @param character The character with which to fill the string
@@ -153,6 +158,11 @@ void StringViewPrint(const StringView strv);
 /// @return True if the content pointed by the views is the same
 bool StringViewEqual(StringView lhs, StringView rhs);
 
+/// @brief Hashes the characters pointed by a string view, see hash.h
+/// @param strv The view to hash
+/// @return The hash of the characters
+uint64_t StringViewHash(StringView strv);
+
 /*****************************************
 IMPLEMENTATION HELPERS
 *****************************************/
@@ -0,0 +1,71 @@
+/** @file struct_symbol.c
+* Contains the definitions of the functions declared in 'struct_symbol.h'
+*/
+
+#include "struct_symbol.h"
+#include "thread.h"
+
+/// @brief The intern table, whose keys are the Symbol* (hashed using their precomputed hash)
+static HashMap g_symbol_table = { NULL, NULL, 0, 0, 0 };
+/// @brief The mutex protecting the intern table
+static ColtiMutex g_symbol_mutex = COLTI_MUTEX_INITIALIZER;
+
+const Symbol* SymbolIntern(const char* name, uint64_t size)
+{
+	StringView strv = { name, name + size };
+	//The hash is computed outside of the lock
+	uint64_t hash = StringViewHash(strv);
+
+	ColtiMutexLock(&g_symbol_mutex);
+	HashMapSlot* slot = HashMapFindWith(&g_symbol_table, hash, impl_symbol_equal, &strv);
+	Symbol* symbol;
+	if (slot != NULL)
+		symbol = (Symbol*)slot->key;
+	else
+	{
+		symbol = (Symbol*)safe_malloc(sizeof(Symbol) + size + 1);
+		symbol->hash = hash;
+		symbol->size = size;
+		memcpy(symbol->name, name, size);
+		symbol->name[size] = '\0';
+		HashMapInsertNew(&g_symbol_table, (uint64_t)symbol, hash, 0);
+	}
+	ColtiMutexUnlock(&g_symbol_mutex);
+	return symbol;
+}
+
+const Symbol* SymbolInternView(StringView strv)
+{
+	return SymbolIntern(strv.start, (uint64_t)(strv.end - strv.start));
+}
+
+uint64_t SymbolTableCount()
+{
+	ColtiMutexLock(&g_symbol_mutex);
+	uint64_t count = g_symbol_table.count;
+	ColtiMutexUnlock(&g_symbol_mutex);
+	return count;
+}
+
+void SymbolTableFree()
+{
+	ColtiMutexLock(&g_symbol_mutex);
+	for (uint64_t i = 0; i < g_symbol_table.capacity; i++)
+	{
+		if (!(g_symbol_table.control[i] & HASH_MAP_EMPTY)) //Neither EMPTY nor DELETED
+			safe_free((void*)g_symbol_table.slots[i].key);
+	}
+	HashMapFree(&g_symbol_table);
+	ColtiMutexUnlock(&g_symbol_mutex);
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+bool impl_symbol_equal(uint64_t key, const void* context)
+{
+	const Symbol* symbol = (const Symbol*)key;
+	const StringView* strv = (const StringView*)context;
+	return symbol->size == (uint64_t)(strv->end - strv->start) && memcmp(symbol->name, strv->start, symbol->size) == 0;
+}
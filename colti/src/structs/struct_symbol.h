@@ -0,0 +1,60 @@
+/** @file struct_symbol.h
+* Interned symbols, which are the unique copies of names (identifiers, names of globals...).
+* Interning a name returns the Symbol of that name, which is created the first time the name is
+* interned: 2 names are equal if and only if their Symbols are the same pointer, so comparing
+* Symbols never compares characters.
+* The hash of the name is computed once, when interning it, and stored in the Symbol: Symbols
+* can be used as the keys of a HashMap (see struct_hash_map.h) without ever hashing them again.
+* All the Symbols are owned by a single global intern table, which is protected by a mutex:
+* names can be interned from any thread, and Symbols (which are immutable) can be read without locking.
+* Symbols live until SymbolTableFree is called, at the end of the program.
+*/
+
+#ifndef HG_COLTI_STRUCT_SYMBOL
+#define HG_COLTI_STRUCT_SYMBOL
+
+#include "common.h"
+#include "struct_string.h"
+#include "struct_hash_map.h"
+
+/// @brief The unique copy of a name, created by SymbolIntern
+typedef struct
+{
+	/// @brief The hash of the name (which is StringViewHash of the name)
+	uint64_t hash;
+	/// @brief The number of characters of the name, without its NUL terminator
+	uint64_t size;
+	/// @brief The characters of the name, followed by a NUL terminator
+	char name[];
+} Symbol;
+
+/// @brief Returns the Symbol of a name, creating it if the name was never interned
+/// @param name The characters of the name (which do not need to be NUL terminated)
+/// @param size The number of characters of the name
+/// @return The Symbol of the name, which is the same for every call with the same name
+const Symbol* SymbolIntern(const char* name, uint64_t size);
+
+/// @brief Returns the Symbol of the characters pointed by a string view (see SymbolIntern)
+/// @param strv The view over the name
+/// @return The Symbol of the name
+const Symbol* SymbolInternView(StringView strv);
+
+/// @brief Returns the number of Symbols in the intern table
+/// @return The number of distinct names that were interned
+uint64_t SymbolTableCount();
+
+/// @brief Frees all the Symbols of the intern table, after which no Symbol may be used.
+/// This should only be called at the end of the program, when no other thread is running.
+void SymbolTableFree();
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Compares the name of a Symbol to the characters pointed by a StringView (used to find a name in the intern table)
+/// @param key The Symbol* stored in the intern table
+/// @param context Pointer to the StringView of the name searched for
+/// @return True if the name of the Symbol is the one searched for
+bool impl_symbol_equal(uint64_t key, const void* context);
+
+#endif //HG_COLTI_STRUCT_SYMBOL
@@ -0,0 +1,45 @@
+#ifndef COLTI_CONFIG
+#define COLTI_CONFIG
+
+//Major version of Colti
+#define COLTI_VERSION_MAJOR 		0
+//Minor version of Colti
+#define COLTI_VERSION_MINOR 		0
+//Patch version of Colti
+#define COLTI_VERSION_PATCH 		5
+//Tweak version of Colti
+#define COLTI_VERSION_TWEAK 		6
+//The project version as a string
+#define COLTI_VERSION_STRING 		"0.0.5.6"
+
+#define COLTI_OS_STRING				"Linux"
+
+#ifdef COLTI_DEBUG_BUILD
+	#define COLTI_CONFIG_STRING		"Debug"
+#else
+	#define COLTI_CONFIG_STRING		"Release"
+#endif
+
+//Determine the current operating system
+#if 0 == 1
+	#define COLTI_WINDOWS
+#elif 0 == 1
+	#define COLTI_APPLE
+#elif 1 == 1
+	#define COLTI_LINUX
+#else
+	#error "Unsupported platform!"
+#endif
+
+//Determine the current compiler
+#if 0 == 1
+	#define COLTI_CLANG
+#elif 1 == 1
+	#define COLTI_GNU
+#elif 0 == 1
+	#define COLTI_INTEL
+#elif 0 == 1
+	#define COLTI_MSVC
+#endif
+
+#endif //COLTI_CONFIG
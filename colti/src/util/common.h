@@ -32,7 +32,8 @@ typedef enum
 {
 	INTERPRET_OK, ///< Interpreting was successful
 	INTERPRET_COMPILE_ERROR, ///< There was a compilation error
-	INTERPRET_RUNTIME_ERROR ///< There was a runtime error
+	INTERPRET_RUNTIME_ERROR, ///< There was a runtime error
+	INTERPRET_YIELD ///< The instruction budget was exhausted, and the interpretation can be resumed
 } InterpretResult;
 
 /// @brief Common exit codes to use in place of ints
@@ -142,6 +143,9 @@ MACRO HELPERS FOR ASSERTION AND ALLOCATIONS
 	/// @brief Ensures no NULL pointer is returned from a heap allocation
 	#define safe_malloc(size)		checked_malloc(size)
 	#define safe_free(ptr)			checked_free(ptr)
+	/// @brief Ensures no NULL pointer is returned from an aligned heap allocation
+	#define safe_aligned_malloc(size, alignment)	checked_aligned_malloc(size, alignment)
+	#define safe_aligned_free(ptr)					checked_aligned_free(ptr)
 	
 	/// @brief Does 'what' only on Debug configuration
 	#define DO_IF_DEBUG_BUILD(what) do { what; } while(0)
@@ -153,11 +157,29 @@ MACRO HELPERS FOR ASSERTION AND ALLOCATIONS
 	#define safe_malloc(size)		checked_malloc(size)
 	/// @brief Ensures no NULL pointer is passed for deallocation
 	#define safe_free(ptr)			checked_free(ptr)
+	/// @brief Ensures no NULL pointer is returned from an aligned heap allocation
+	#define safe_aligned_malloc(size, alignment)	checked_aligned_malloc(size, alignment)
+	/// @brief Ensures no NULL pointer is passed for aligned deallocation
+	#define safe_aligned_free(ptr)					checked_aligned_free(ptr)
 
 	/// @brief Does 'what' only on Debug configuration
 	#define DO_IF_DEBUG_BUILD(what) do {} while(0)
 #endif
 
+#ifdef COLTI_DEBUG_BUILD
+	/// @brief Marks code that should never be reached, which is asserted on Debug configuration
+	#define colti_unreachable() colti_assert(false, "Unreachable code was reached!")
+#elif defined(COLTI_GNU) || defined(COLTI_CLANG)
+	/// @brief Marks code that should never be reached, which lets the compiler optimize it away
+	#define colti_unreachable() __builtin_unreachable()
+#elif defined(COLTI_MSVC)
+	/// @brief Marks code that should never be reached, which lets the compiler optimize it away
+	#define colti_unreachable() __assume(0)
+#else
+	/// @brief Marks code that should never be reached
+	#define colti_unreachable() do {} while(0)
+#endif
+
 /// @brief Prints an error and appends a newline.
 /// 'format' should be a compile-time known string.
 /// Due to how the preprocessor works, always format at least an argument.
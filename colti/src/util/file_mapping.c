@@ -0,0 +1,97 @@
+/** @file file_mapping.c
+* Contains the definitions of the functions declared in 'file_mapping.h'
+*/
+
+#include "file_mapping.h"
+
+#ifdef COLTI_WINDOWS
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+bool FileMappingOpen(FileMapping* mapping, const char* path)
+{
+	mapping->ptr = NULL;
+	mapping->size = 0;
+#ifdef COLTI_WINDOWS
+	mapping->mapping_handle = NULL;
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return false;
+	}
+	//The mapping object keeps the file open
+	HANDLE mapping_handle = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (mapping_handle == NULL)
+		return false;
+	//A copy-on-write view, so that FileMappingMakeCopyOnWrite only has to change its protection
+	uint8_t* ptr = MapViewOfFile(mapping_handle, FILE_MAP_COPY, 0, 0, 0);
+	if (ptr == NULL)
+	{
+		CloseHandle(mapping_handle);
+		return false;
+	}
+	DWORD old_protection;
+	if (!VirtualProtect(ptr, (SIZE_T)size.QuadPart, PAGE_READONLY, &old_protection))
+	{
+		UnmapViewOfFile(ptr);
+		CloseHandle(mapping_handle);
+		return false;
+	}
+	mapping->mapping_handle = mapping_handle;
+	mapping->ptr = ptr;
+	mapping->size = (uint64_t)size.QuadPart;
+#else
+	int file = open(path, O_RDONLY);
+	if (file == -1)
+		return false;
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+	//The mapping stays valid after closing the file, and is private so that FileMappingMakeCopyOnWrite only has to change its protection
+	void* ptr = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (ptr == MAP_FAILED)
+		return false;
+	mapping->ptr = ptr;
+	mapping->size = (uint64_t)info.st_size;
+#endif
+	return true;
+}
+
+bool FileMappingMakeCopyOnWrite(FileMapping* mapping)
+{
+	colti_assert(mapping->ptr != NULL, "The mapping was not open!");
+#ifdef COLTI_WINDOWS
+	DWORD old_protection;
+	return VirtualProtect((void*)mapping->ptr, (SIZE_T)mapping->size, PAGE_WRITECOPY, &old_protection) != 0;
+#else
+	return mprotect((void*)mapping->ptr, (size_t)mapping->size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+void FileMappingClose(FileMapping* mapping)
+{
+	colti_assert(mapping->ptr != NULL, "The mapping was not open!");
+#ifdef COLTI_WINDOWS
+	UnmapViewOfFile(mapping->ptr);
+	CloseHandle(mapping->mapping_handle);
+#else
+	munmap((void*)mapping->ptr, (size_t)mapping->size);
+#endif
+	mapping->ptr = NULL;
+	mapping->size = 0;
+}
@@ -0,0 +1,44 @@
+/** @file file_mapping.h
+* Contains a read-only memory mapping of a file, which abstracts over the OS APIs.
+* Mapping a file rather than reading it avoids copying its content: the pages of the
+* mapping are shared with the OS file cache (and with any other process mapping the same file),
+* and are only loaded when accessed.
+* A mapping can be made copy-on-write (FileMappingMakeCopyOnWrite): the pages written to are then privately
+* copied for the process, the file and the other mappings never seeing the writes.
+*/
+
+#ifndef HG_COLTI_FILE_MAPPING
+#define HG_COLTI_FILE_MAPPING
+
+#include "common.h"
+
+/// @brief A read-only memory mapping of a whole file
+typedef struct
+{
+	/// @brief Pointer to the beginning of the mapping (page aligned), NULL if the mapping is not open
+	const uint8_t* ptr;
+	/// @brief The size of the mapped file
+	uint64_t size;
+#ifdef COLTI_WINDOWS
+	/// @brief The handle of the file mapping object
+	void* mapping_handle;
+#endif
+} FileMapping;
+
+/// @brief Maps a whole file in memory, in read-only mode
+/// @param mapping The mapping to initialize
+/// @param path The path to the file to map
+/// @return False if the file could not be mapped (or is empty), in which case 'mapping->ptr' is NULL
+bool FileMappingOpen(FileMapping* mapping, const char* path);
+
+/// @brief Makes the pages of a mapping writable, copy-on-write: a page is privately copied the first time it is written to,
+/// and the other pages stay shared with the file cache. The writes are never written back to the file.
+/// @param mapping The mapping to modify
+/// @return False if the protection of the pages could not be changed
+bool FileMappingMakeCopyOnWrite(FileMapping* mapping);
+
+/// @brief Unmaps a file mapped by FileMappingOpen
+/// @param mapping The mapping to close
+void FileMappingClose(FileMapping* mapping);
+
+#endif //HG_COLTI_FILE_MAPPING
@@ -0,0 +1,96 @@
+/** @file hash.c
+* Contains the definitions of the functions declared in 'hash.h'
+*/
+
+#include "hash.h"
+
+/// @brief The primes used by xxHash64
+#define HASH_PRIME_1 0x9E3779B185EBCA87ULL
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4FULL
+#define HASH_PRIME_3 0x165667B19E3779F9ULL
+#define HASH_PRIME_4 0x85EBCA77C2B2AE63ULL
+#define HASH_PRIME_5 0x27D4EB2F165667C5ULL
+
+uint64_t hashBytes(const void* data, uint64_t size, uint64_t seed)
+{
+	const uint8_t* ptr = (const uint8_t*)data;
+	const uint8_t* end = ptr + size;
+	uint64_t hash;
+	if (size >= 32)
+	{
+		//The 4 accumulators do not depend on each other
+		uint64_t acc1 = seed + HASH_PRIME_1 + HASH_PRIME_2;
+		uint64_t acc2 = seed + HASH_PRIME_2;
+		uint64_t acc3 = seed;
+		uint64_t acc4 = seed - HASH_PRIME_1;
+		for (; end - ptr >= 32; ptr += 32)
+		{
+			acc1 = impl_hash_round(acc1, impl_hash_read64(ptr));
+			acc2 = impl_hash_round(acc2, impl_hash_read64(ptr + 8));
+			acc3 = impl_hash_round(acc3, impl_hash_read64(ptr + 16));
+			acc4 = impl_hash_round(acc4, impl_hash_read64(ptr + 24));
+		}
+		hash = impl_hash_rotate(acc1, 1) + impl_hash_rotate(acc2, 7)
+			+ impl_hash_rotate(acc3, 12) + impl_hash_rotate(acc4, 18);
+		hash = impl_hash_merge_round(hash, acc1);
+		hash = impl_hash_merge_round(hash, acc2);
+		hash = impl_hash_merge_round(hash, acc3);
+		hash = impl_hash_merge_round(hash, acc4);
+	}
+	else
+		hash = seed + HASH_PRIME_5;
+	hash += size;
+
+	//Mix the remaining bytes
+	for (; end - ptr >= 8; ptr += 8)
+		hash = impl_hash_rotate(hash ^ impl_hash_round(0, impl_hash_read64(ptr)), 27) * HASH_PRIME_1 + HASH_PRIME_4;
+	if (end - ptr >= 4)
+	{
+		hash = impl_hash_rotate(hash ^ (impl_hash_read32(ptr) * HASH_PRIME_1), 23) * HASH_PRIME_2 + HASH_PRIME_3;
+		ptr += 4;
+	}
+	for (; ptr != end; ptr++)
+		hash = impl_hash_rotate(hash ^ (*ptr * HASH_PRIME_5), 11) * HASH_PRIME_1;
+
+	//Avalanche
+	hash ^= hash >> 33;
+	hash *= HASH_PRIME_2;
+	hash ^= hash >> 29;
+	hash *= HASH_PRIME_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+uint64_t impl_hash_read64(const uint8_t* ptr)
+{
+	//Assembled byte by byte, which compilers turn into a single load on little endian targets
+	return (uint64_t)ptr[0] | ((uint64_t)ptr[1] << 8) | ((uint64_t)ptr[2] << 16) | ((uint64_t)ptr[3] << 24)
+		| ((uint64_t)ptr[4] << 32) | ((uint64_t)ptr[5] << 40) | ((uint64_t)ptr[6] << 48) | ((uint64_t)ptr[7] << 56);
+}
+
+uint32_t impl_hash_read32(const uint8_t* ptr)
+{
+	return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) | ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+uint64_t impl_hash_rotate(uint64_t value, uint32_t count)
+{
+	return (value << count) | (value >> (64 - count));
+}
+
+uint64_t impl_hash_round(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * HASH_PRIME_2;
+	accumulator = impl_hash_rotate(accumulator, 31);
+	return accumulator * HASH_PRIME_1;
+}
+
+uint64_t impl_hash_merge_round(uint64_t hash, uint64_t accumulator)
+{
+	hash ^= impl_hash_round(0, accumulator);
+	return hash * HASH_PRIME_1 + HASH_PRIME_4;
+}
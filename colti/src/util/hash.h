@@ -0,0 +1,53 @@
+/** @file hash.h
+* Contains a fast non-cryptographic hash of arrays of bytes, following the xxHash64 algorithm.
+* The input is consumed 32 bytes at a time by 4 independent accumulators (which keeps
+* the multipliers of the CPU busy), then the remaining bytes are mixed in, and the
+* result is avalanched so that every bit of the input affects every bit of the hash.
+* The hash is the same on every platform (the input is read as little endian).
+*/
+
+#ifndef HG_COLTI_HASH
+#define HG_COLTI_HASH
+
+#include "common.h"
+
+/// @brief Hashes an array of bytes
+/// @param data The bytes to hash (which do not need to be aligned)
+/// @param size The number of bytes to hash
+/// @param seed The seed of the hash, which should be changed to obtain unrelated hashes of the same bytes
+/// @return The 64-bit hash
+uint64_t hashBytes(const void* data, uint64_t size, uint64_t seed);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Reads a (possibly unaligned) little endian uint64_t
+/// @param ptr Pointer to the bytes to read
+/// @return The value read
+uint64_t impl_hash_read64(const uint8_t* ptr);
+
+/// @brief Reads a (possibly unaligned) little endian uint32_t
+/// @param ptr Pointer to the bytes to read
+/// @return The value read
+uint32_t impl_hash_read32(const uint8_t* ptr);
+
+/// @brief Rotates the bits of a value to the left
+/// @param value The value to rotate
+/// @param count The number of bits by which to rotate (in range [1, 63])
+/// @return The rotated value
+uint64_t impl_hash_rotate(uint64_t value, uint32_t count);
+
+/// @brief Mixes 8 bytes of input into an accumulator
+/// @param accumulator The accumulator
+/// @param input The input to mix
+/// @return The new value of the accumulator
+uint64_t impl_hash_round(uint64_t accumulator, uint64_t input);
+
+/// @brief Merges one of the 4 accumulators into the hash
+/// @param hash The hash
+/// @param accumulator The accumulator to merge
+/// @return The new value of the hash
+uint64_t impl_hash_merge_round(uint64_t hash, uint64_t accumulator);
+
+#endif //HG_COLTI_HASH
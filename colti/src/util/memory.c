@@ -23,4 +23,34 @@ void checked_free(void* ptr)
 	printf(CONSOLE_FOREGROUND_BRIGHT_RED "Error: "CONSOLE_COLOR_RESET"Pointer passed 'checked_free' was NULL!\n");
 	(void)getc(stdin);
 	exit(EXIT_OS_RESOURCE_FAILURE);
+}
+
+void* checked_aligned_malloc(size_t size, size_t alignment)
+{
+#ifdef COLTI_WINDOWS
+	void* ptr = _aligned_malloc(size, alignment);
+	if (ptr) return ptr;
+#else
+	void* ptr;
+	if (posix_memalign(&ptr, alignment, size) == 0) return ptr;
+#endif
+
+	printf(CONSOLE_FOREGROUND_BRIGHT_RED "Error: "CONSOLE_COLOR_RESET"Could not allocate memory!\n");
+	(void)getc(stdin);
+	exit(EXIT_OS_RESOURCE_FAILURE);
+}
+
+void checked_aligned_free(void* ptr)
+{
+	if (ptr)
+	{
+#ifdef COLTI_WINDOWS
+		_aligned_free(ptr); return;
+#else
+		free(ptr); return;
+#endif
+	}
+	printf(CONSOLE_FOREGROUND_BRIGHT_RED "Error: "CONSOLE_COLOR_RESET"Pointer passed 'checked_aligned_free' was NULL!\n");
+	(void)getc(stdin);
+	exit(EXIT_OS_RESOURCE_FAILURE);
 }
\ No newline at end of file
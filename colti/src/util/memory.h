@@ -19,4 +19,15 @@ void* checked_malloc(size_t size);
 /// @param ptr The pointer to free
 void checked_free(void* ptr);
 
+/// @brief Allocates a block of size 'size' aligned on 'alignment' from the heap, but terminates if the pointer is NULL.
+/// The block must be freed using checked_aligned_free.
+/// @param size The size of the block to allocate
+/// @param alignment The alignment of the block (a power of 2, multiple of sizeof(void*))
+/// @return a non-NULL pointer aligned on 'alignment'
+void* checked_aligned_malloc(size_t size, size_t alignment);
+
+/// @brief Frees a pointer obtained by checked_aligned_malloc if it isn't NULL, else terminates.
+/// @param ptr The pointer to free
+void checked_aligned_free(void* ptr);
+
 #endif //HG_COLTI_MEMORY
\ No newline at end of file
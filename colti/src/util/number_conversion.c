@@ -0,0 +1,679 @@
+/** @file number_conversion.c
+* Contains the definitions of the functions declared in 'number_conversion.h'
+*/
+
+#include "number_conversion.h"
+#include "power_of_five_table.h"
+
+#ifdef COLTI_MSVC
+	#include <intrin.h>
+#endif
+
+/// @brief Properties of a double (IEEE 754 binary64)
+static const FloatFormat g_double_format = { 52, 1023, 0x7FF, -342, 308, -4, 23 };
+/// @brief Properties of a float (IEEE 754 binary32)
+static const FloatFormat g_float_format = { 23, 127, 0xFF, -65, 38, -17, 10 };
+
+/// @brief The powers of ten that are exactly representable by a double
+static const double g_exact_powers_of_ten[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/// @brief The powers of ten that are exactly representable by a float
+static const float g_exact_powers_of_ten_f[] =
+{
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+/// @brief The powers of ten that are representable by a uint64_t
+static const uint64_t g_powers_of_ten_64[] =
+{
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+	100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+	10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+	100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+uint64_t doubleToChars(double value, char* buffer)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(double));
+	uint64_t significand = bits & (((uint64_t)1 << 52) - 1);
+	int32_t biased_exponent = (int32_t)((bits >> 52) & 0x7FF);
+
+	char* ptr = buffer;
+	if (biased_exponent == 0x7FF && significand != 0)
+	{
+		//'%g' also prints the sign of NaNs
+		if (bits >> 63)
+			*(ptr++) = '-';
+		memcpy(ptr, "nan", 3);
+		return ptr + 3 - buffer;
+	}
+	if (bits >> 63)
+		*(ptr++) = '-';
+	if (biased_exponent == 0x7FF)
+	{
+		memcpy(ptr, "inf", 3);
+		return ptr + 3 - buffer;
+	}
+	if (biased_exponent == 0 && significand == 0)
+	{
+		*(ptr++) = '0';
+		return ptr - buffer;
+	}
+
+	char digits[24];
+	int32_t K;
+	int32_t length;
+	if (biased_exponent == 0) //subnormal
+		length = impl_grisu2(significand, 1 - 1075, false, digits, &K);
+	else
+		length = impl_grisu2(significand | ((uint64_t)1 << 52), biased_exponent - 1075,
+			significand == 0 && biased_exponent > 1, digits, &K);
+	return impl_write_shortest(digits, length, K, ptr) - buffer;
+}
+
+uint64_t floatToChars(float value, char* buffer)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(float));
+	uint32_t significand = bits & (((uint32_t)1 << 23) - 1);
+	int32_t biased_exponent = (int32_t)((bits >> 23) & 0xFF);
+
+	char* ptr = buffer;
+	if (biased_exponent == 0xFF && significand != 0)
+	{
+		if (bits >> 31)
+			*(ptr++) = '-';
+		memcpy(ptr, "nan", 3);
+		return ptr + 3 - buffer;
+	}
+	if (bits >> 31)
+		*(ptr++) = '-';
+	if (biased_exponent == 0xFF)
+	{
+		memcpy(ptr, "inf", 3);
+		return ptr + 3 - buffer;
+	}
+	if (biased_exponent == 0 && significand == 0)
+	{
+		*(ptr++) = '0';
+		return ptr - buffer;
+	}
+
+	char digits[24];
+	int32_t K;
+	int32_t length;
+	if (biased_exponent == 0) //subnormal
+		length = impl_grisu2(significand, 1 - 150, false, digits, &K);
+	else
+		length = impl_grisu2(significand | ((uint32_t)1 << 23), biased_exponent - 150,
+			significand == 0 && biased_exponent > 1, digits, &K);
+	return impl_write_shortest(digits, length, K, ptr) - buffer;
+}
+
+ConversionResult charsToDouble(StringView view, double* result, const char** end)
+{
+	DecimalNumber number;
+	const char* number_end = impl_parse_decimal(view.start, view.end, &number);
+	if (end != NULL)
+		*end = number_end;
+	if (number_end == view.start)
+		return CONVERSION_INVALID_INPUT;
+
+	double value;
+	uint64_t bits;
+	if (!number.is_truncated && number.mantissa <= ((uint64_t)1 << 53)
+		&& number.exponent >= -22 && number.exponent <= 22)
+	{
+		//Clinger's fast path: both the mantissa and the power of ten are exact doubles,
+		//so a single (correctly rounded) operation gives the correct result
+		value = (double)number.mantissa;
+		if (number.exponent < 0)
+			value /= g_exact_powers_of_ten[-number.exponent];
+		else
+			value *= g_exact_powers_of_ten[number.exponent];
+		value = number.is_negative ? -value : value;
+	}
+	else if (impl_decimal_to_bits(&number, &g_double_format, &bits))
+	{
+		bits |= (uint64_t)number.is_negative << 63;
+		memcpy(&value, &bits, sizeof(double));
+	}
+	else //the fallback also parses the sign
+		value = impl_strtod_fallback(view.start, number_end);
+
+	*result = value;
+	return isinf(value) ? CONVERSION_OUT_OF_RANGE : CONVERSION_SUCCESS;
+}
+
+ConversionResult charsToFloat(StringView view, float* result, const char** end)
+{
+	DecimalNumber number;
+	const char* number_end = impl_parse_decimal(view.start, view.end, &number);
+	if (end != NULL)
+		*end = number_end;
+	if (number_end == view.start)
+		return CONVERSION_INVALID_INPUT;
+
+	float value;
+	uint64_t bits;
+	if (!number.is_truncated && number.mantissa <= ((uint64_t)1 << 24)
+		&& number.exponent >= -10 && number.exponent <= 10)
+	{
+		value = (float)number.mantissa;
+		if (number.exponent < 0)
+			value /= g_exact_powers_of_ten_f[-number.exponent];
+		else
+			value *= g_exact_powers_of_ten_f[number.exponent];
+		value = number.is_negative ? -value : value;
+	}
+	else if (impl_decimal_to_bits(&number, &g_float_format, &bits))
+	{
+		uint32_t bits32 = (uint32_t)bits | ((uint32_t)number.is_negative << 31);
+		memcpy(&value, &bits32, sizeof(float));
+	}
+	else
+		value = impl_strtof_fallback(view.start, number_end);
+
+	*result = value;
+	return isinf(value) ? CONVERSION_OUT_OF_RANGE : CONVERSION_SUCCESS;
+}
+
+ConversionResult charsToUInt(StringView view, uint32_t base, uint64_t* result, const char** end)
+{
+	colti_assert(base == 2 || base == 8 || base == 10 || base == 16, "Invalid base!");
+	const char* ptr = view.start;
+	uint64_t value = 0;
+
+	if (base == 10)
+	{
+		//As long as the value is less than 10^11, 8 more digits cannot overflow
+		while (view.end - ptr >= 8 && value < 100000000000ULL)
+		{
+			uint64_t chars = impl_load_eight_chars(ptr);
+			if (!impl_is_eight_digits(chars))
+				break;
+			value = value * 100000000 + impl_parse_eight_digits(chars);
+			ptr += 8;
+		}
+	}
+
+	//Remaining digits are added one by one, checking for overflow
+	bool is_overflow = false;
+	uint32_t digit;
+	while (ptr != view.end && (digit = impl_digit_value(*ptr)) < base)
+	{
+		if (!is_overflow)
+			is_overflow = impl_mul_add_overflow(value, base, digit, &value);
+		ptr++;
+	}
+
+	if (end != NULL)
+		*end = ptr;
+	if (ptr == view.start)
+	{
+		*result = 0;
+		return CONVERSION_INVALID_INPUT;
+	}
+	*result = is_overflow ? UINT64_MAX : value;
+	return is_overflow ? CONVERSION_OUT_OF_RANGE : CONVERSION_SUCCESS;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+bool impl_is_digit(char chr)
+{
+	return (unsigned char)(chr - '0') < 10;
+}
+
+uint32_t impl_digit_value(char chr)
+{
+	if ((unsigned char)(chr - '0') < 10)
+		return (uint32_t)(chr - '0');
+	//Setting the 0x20 bit converts upper case letters to lower case
+	if ((unsigned char)((chr | 0x20) - 'a') < 26)
+		return (uint32_t)((chr | 0x20) - 'a') + 10;
+	return UINT32_MAX;
+}
+
+uint64_t impl_load_eight_chars(const char* ptr)
+{
+	//Assembled byte by byte to be independent of the endianness,
+	//which compilers optimize to a single load on little endian targets
+	const unsigned char* bytes = (const unsigned char*)ptr;
+	return (uint64_t)bytes[0] | ((uint64_t)bytes[1] << 8)
+		| ((uint64_t)bytes[2] << 16) | ((uint64_t)bytes[3] << 24)
+		| ((uint64_t)bytes[4] << 32) | ((uint64_t)bytes[5] << 40)
+		| ((uint64_t)bytes[6] << 48) | ((uint64_t)bytes[7] << 56);
+}
+
+bool impl_is_eight_digits(uint64_t chars)
+{
+	//Each byte must be in [0x30, 0x39]: the high nibble must be 3 for both
+	//the byte and the byte + 6 (which carries into the high nibble for bytes above 0x39)
+	return (((chars & 0xF0F0F0F0F0F0F0F0) | (((chars + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+		== 0x3333333333333333);
+}
+
+uint32_t impl_parse_eight_digits(uint64_t chars)
+{
+	//The first digit is in the least significant byte
+	chars -= 0x3030303030303030;
+	//Combine pairs of digits: each 16-bit lane now contains a value in [0, 99]
+	chars = (chars * 10) + (chars >> 8);
+	//Combine the pairs: 4 digits in the low half and 4 digits in the high half
+	chars = (((chars & 0x000000FF000000FF) * (100 + (1000000ULL << 32)))
+		+ (((chars >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+	return (uint32_t)chars;
+}
+
+bool impl_mul_add_overflow(uint64_t value, uint64_t multiplier, uint64_t addend, uint64_t* result)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	bool is_overflow = __builtin_mul_overflow(value, multiplier, result);
+	return __builtin_add_overflow(*result, addend, result) || is_overflow;
+#else
+	if (multiplier != 0 && value > UINT64_MAX / multiplier)
+	{
+		*result = value * multiplier + addend;
+		return true;
+	}
+	*result = value * multiplier;
+	bool is_overflow = *result > UINT64_MAX - addend;
+	*result += addend;
+	return is_overflow;
+#endif
+}
+
+double impl_strtod_fallback(const char* begin, const char* end)
+{
+	//This path is only taken for more than 19 significant digits, so copying is fine
+	char* copy = safe_malloc(end - begin + 1);
+	memcpy(copy, begin, end - begin);
+	copy[end - begin] = '\0';
+	double value = strtod(copy, NULL);
+	safe_free(copy);
+	return value;
+}
+
+float impl_strtof_fallback(const char* begin, const char* end)
+{
+	char* copy = safe_malloc(end - begin + 1);
+	memcpy(copy, begin, end - begin);
+	copy[end - begin] = '\0';
+	float value = strtof(copy, NULL);
+	safe_free(copy);
+	return value;
+}
+
+UInt128 impl_multiply_128(uint64_t a, uint64_t b)
+{
+	UInt128 result;
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 product = (unsigned __int128)a * b;
+	result.low = (uint64_t)product;
+	result.high = (uint64_t)(product >> 64);
+#elif defined(COLTI_MSVC) && defined(_M_X64)
+	result.low = _umul128(a, b, &result.high);
+#else
+	//Multiply the 32-bit halves
+	uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+	uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+	uint64_t lo_lo = a_lo * b_lo;
+	uint64_t hi_lo = a_hi * b_lo;
+	uint64_t lo_hi = a_lo * b_hi;
+	uint64_t hi_hi = a_hi * b_hi;
+	uint64_t cross = (lo_lo >> 32) + (uint32_t)hi_lo + lo_hi;
+	result.high = hi_hi + (hi_lo >> 32) + (cross >> 32);
+	result.low = (cross << 32) | (uint32_t)lo_lo;
+#endif
+	return result;
+}
+
+int32_t impl_count_leading_zeros(uint64_t value)
+{
+	colti_assert(value != 0, "Cannot count the leading zeros of 0!");
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	return __builtin_clzll(value);
+#elif defined(COLTI_MSVC) && defined(_M_X64)
+	unsigned long index;
+	_BitScanReverse64(&index, value);
+	return 63 - (int32_t)index;
+#else
+	int32_t count = 0;
+	while (!(value & ((uint64_t)1 << 63)))
+	{
+		value <<= 1;
+		count++;
+	}
+	return count;
+#endif
+}
+
+const char* impl_parse_decimal(const char* begin, const char* end, DecimalNumber* number)
+{
+	const char* ptr = begin;
+	number->is_negative = false;
+	number->is_truncated = false;
+	if (ptr != end && (*ptr == '-' || *ptr == '+'))
+		number->is_negative = (*(ptr++) == '-');
+
+	//The mantissa can overflow, which is handled below by recomputing it
+	uint64_t mantissa = 0;
+	const char* integer_begin = ptr;
+	while (end - ptr >= 8 && impl_is_eight_digits(impl_load_eight_chars(ptr)))
+	{
+		mantissa = mantissa * 100000000 + impl_parse_eight_digits(impl_load_eight_chars(ptr));
+		ptr += 8;
+	}
+	while (ptr != end && impl_is_digit(*ptr))
+		mantissa = mantissa * 10 + (uint64_t)(*(ptr++) - '0');
+	const char* integer_end = ptr;
+	int64_t digit_count = integer_end - integer_begin;
+
+	int64_t exponent = 0;
+	const char* fraction_begin = ptr;
+	if (ptr != end && *ptr == '.')
+	{
+		fraction_begin = ++ptr;
+		while (end - ptr >= 8 && impl_is_eight_digits(impl_load_eight_chars(ptr)))
+		{
+			mantissa = mantissa * 100000000 + impl_parse_eight_digits(impl_load_eight_chars(ptr));
+			ptr += 8;
+		}
+		while (ptr != end && impl_is_digit(*ptr))
+			mantissa = mantissa * 10 + (uint64_t)(*(ptr++) - '0');
+		exponent = fraction_begin - ptr;
+		digit_count += ptr - fraction_begin;
+	}
+	const char* fraction_end = ptr;
+	if (digit_count == 0)
+		return begin;
+
+	int64_t explicit_exponent = 0;
+	if (ptr != end && (*ptr == 'e' || *ptr == 'E'))
+	{
+		const char* exponent_ptr = ptr + 1;
+		bool is_exponent_negative = false;
+		if (exponent_ptr != end && (*exponent_ptr == '-' || *exponent_ptr == '+'))
+			is_exponent_negative = (*(exponent_ptr++) == '-');
+		//An 'e' which is not followed by digits is not part of the number
+		if (exponent_ptr != end && impl_is_digit(*exponent_ptr))
+		{
+			while (exponent_ptr != end && impl_is_digit(*exponent_ptr))
+			{
+				//Bigger exponents would round to 0 or infinity anyway
+				if (explicit_exponent < 0x10000000)
+					explicit_exponent = explicit_exponent * 10 + (*exponent_ptr - '0');
+				exponent_ptr++;
+			}
+			if (is_exponent_negative)
+				explicit_exponent = -explicit_exponent;
+			ptr = exponent_ptr;
+		}
+	}
+	exponent += explicit_exponent;
+
+	if (digit_count > 19)
+	{
+		//Leading zeros are not significant
+		const char* start = integer_begin;
+		while (start != fraction_end && (*start == '0' || *start == '.'))
+		{
+			if (*start == '0')
+				digit_count--;
+			start++;
+		}
+		if (digit_count > 19)
+		{
+			//Only keep the 19 first significant digits
+			number->is_truncated = true;
+			mantissa = 0;
+			const char* digit = integer_begin;
+			while (mantissa < 1000000000000000000ULL && digit != integer_end)
+				mantissa = mantissa * 10 + (uint64_t)(*(digit++) - '0');
+			if (mantissa >= 1000000000000000000ULL) //the integer part is big enough
+				exponent = (integer_end - digit) + explicit_exponent;
+			else
+			{
+				digit = fraction_begin;
+				while (mantissa < 1000000000000000000ULL && digit != fraction_end)
+					mantissa = mantissa * 10 + (uint64_t)(*(digit++) - '0');
+				exponent = (fraction_begin - digit) + explicit_exponent;
+			}
+		}
+	}
+	number->mantissa = mantissa;
+	number->exponent = exponent;
+	return ptr;
+}
+
+uint64_t impl_eisel_lemire(uint64_t mantissa, int64_t exponent, const FloatFormat* format)
+{
+	if (mantissa == 0 || exponent < format->smallest_power_of_ten)
+		return 0;
+	if (exponent > format->largest_power_of_ten)
+		return (uint64_t)format->infinite_power << format->mantissa_bits;
+
+	int32_t q = (int32_t)exponent;
+	int32_t leading_zeros = impl_count_leading_zeros(mantissa);
+	mantissa <<= leading_zeros;
+
+	//Approximate mantissa * 5^q, only computing the lower half if the upper one is not precise enough
+	const uint64_t* power = g_power_of_five_128 + 2 * (q - POWER_OF_FIVE_TABLE_MIN);
+	const uint64_t precision_mask = UINT64_MAX >> (format->mantissa_bits + 3);
+	UInt128 product = impl_multiply_128(mantissa, power[0]);
+	if ((product.high & precision_mask) == precision_mask)
+	{
+		UInt128 second_product = impl_multiply_128(mantissa, power[1]);
+		product.low += second_product.high;
+		if (second_product.high > product.low)
+			product.high++;
+	}
+
+	int32_t upper_bit = (int32_t)(product.high >> 63);
+	int32_t shift = upper_bit + 64 - format->mantissa_bits - 3;
+	uint64_t result_mantissa = product.high >> shift;
+	//floor(log2(10^q)) + 63 is approximated by ((217706 * q) >> 16) + 63
+	int32_t power2 = (((217706 * q) >> 16) + 63) + upper_bit - leading_zeros + format->exponent_bias;
+
+	if (power2 <= 0) //subnormal
+	{
+		if (-power2 + 1 >= 64)
+			return 0;
+		result_mantissa >>= -power2 + 1;
+		//Round up, the round-to-even case cannot happen for subnormals
+		result_mantissa += result_mantissa & 1;
+		result_mantissa >>= 1;
+		//Rounding up can make the value normal
+		power2 = result_mantissa < ((uint64_t)1 << format->mantissa_bits) ? 0 : 1;
+		return (result_mantissa & (((uint64_t)1 << format->mantissa_bits) - 1))
+			| ((uint64_t)power2 << format->mantissa_bits);
+	}
+
+	//If exactly between two values, round to even (only possible if 5^q fits in 64 bits)
+	if (product.low <= 1 && q >= format->min_exponent_round_to_even && q <= format->max_exponent_round_to_even
+		&& (result_mantissa & 3) == 1 && (result_mantissa << shift) == product.high)
+		result_mantissa &= ~(uint64_t)1;
+
+	result_mantissa += result_mantissa & 1;
+	result_mantissa >>= 1;
+	if (result_mantissa >= ((uint64_t)2 << format->mantissa_bits))
+	{
+		result_mantissa = (uint64_t)1 << format->mantissa_bits;
+		power2++;
+	}
+	result_mantissa &= ~((uint64_t)1 << format->mantissa_bits);
+	if (power2 >= format->infinite_power)
+		return (uint64_t)format->infinite_power << format->mantissa_bits;
+	return result_mantissa | ((uint64_t)power2 << format->mantissa_bits);
+}
+
+bool impl_decimal_to_bits(const DecimalNumber* number, const FloatFormat* format, uint64_t* result)
+{
+	*result = impl_eisel_lemire(number->mantissa, number->exponent, format);
+	//As digits were dropped, the real value lies between mantissa and mantissa + 1:
+	//if both round to the same value, the result is correct.
+	if (number->is_truncated
+		&& *result != impl_eisel_lemire(number->mantissa + 1, number->exponent, format))
+		return false;
+	return true;
+}
+
+DiyFp impl_diyfp_normalize(DiyFp value)
+{
+	int32_t shift = impl_count_leading_zeros(value.f);
+	DiyFp result = { value.f << shift, value.e - shift };
+	return result;
+}
+
+DiyFp impl_diyfp_multiply(DiyFp lhs, DiyFp rhs)
+{
+	UInt128 product = impl_multiply_128(lhs.f, rhs.f);
+	DiyFp result = { product.high + (product.low >> 63), lhs.e + rhs.e + 64 };
+	return result;
+}
+
+DiyFp impl_cached_power(int32_t e, int32_t* k)
+{
+	//ceil((-61 - e) * log10(2)) == -floor((61 + e) * log10(2)), and 78913 / 2^18 approximates
+	//log10(2) closely enough for the result to be exact for any exponent of a double
+	*k = -(((61 + e) * 78913) >> 18);
+	colti_assert(*k >= POWER_OF_FIVE_TABLE_MIN && *k <= POWER_OF_FIVE_TABLE_MAX, "Power of ten out of range!");
+	//10^k = 5^k * 2^k, and the table contains the normalized 5^k
+	const uint64_t* power = g_power_of_five_128 + 2 * (*k - POWER_OF_FIVE_TABLE_MIN);
+	DiyFp result = { power[0] + (power[1] >> 63), ((217706 * *k) >> 16) - 63 };
+	return result;
+}
+
+void impl_grisu_round(char* buffer, int32_t length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+	while (rest < wp_w && delta - rest >= ten_kappa
+		&& (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+	{
+		buffer[length - 1]--;
+		rest += ten_kappa;
+	}
+}
+
+int32_t impl_grisu2(uint64_t f, int32_t e, bool is_lower_closer, char* buffer, int32_t* K)
+{
+	//The boundaries are the middles between the value and its neighbors
+	DiyFp plus = { (f << 1) + 1, e - 1 };
+	plus = impl_diyfp_normalize(plus);
+	DiyFp minus = { is_lower_closer ? (f << 2) - 1 : (f << 1) - 1, is_lower_closer ? e - 2 : e - 1 };
+	minus.f <<= minus.e - plus.e;
+	minus.e = plus.e;
+	DiyFp value = { f, e };
+	value = impl_diyfp_normalize(value);
+
+	int32_t k;
+	DiyFp ten_k = impl_cached_power(plus.e, &k);
+	*K = -k;
+	DiyFp W = impl_diyfp_multiply(value, ten_k);
+	DiyFp Wp = impl_diyfp_multiply(plus, ten_k);
+	DiyFp Wm = impl_diyfp_multiply(minus, ten_k);
+	//Account for the imprecision of the multiplications
+	Wm.f++;
+	Wp.f--;
+
+	uint64_t delta = Wp.f - Wm.f;
+	const int32_t one_e = -Wp.e;
+	const uint64_t one_f = (uint64_t)1 << one_e;
+	const uint64_t wp_w = Wp.f - W.f;
+	uint32_t p1 = (uint32_t)(Wp.f >> one_e);
+	uint64_t p2 = Wp.f & (one_f - 1);
+
+	//As the exponent is in [-60, -57], the integral part 'p1' is less than 128
+	int32_t kappa = p1 >= 100 ? 3 : (p1 >= 10 ? 2 : (p1 >= 1 ? 1 : 0));
+	int32_t length = 0;
+	while (kappa > 0)
+	{
+		uint32_t divisor = (uint32_t)g_powers_of_ten_64[kappa - 1];
+		uint32_t digit = p1 / divisor;
+		p1 %= divisor;
+		if (digit != 0 || length != 0)
+			buffer[length++] = (char)('0' + digit);
+		kappa--;
+		uint64_t rest = ((uint64_t)p1 << one_e) + p2;
+		if (rest <= delta)
+		{
+			*K += kappa;
+			impl_grisu_round(buffer, length, delta, rest, g_powers_of_ten_64[kappa] << one_e, wp_w);
+			return length;
+		}
+	}
+	for (;;)
+	{
+		p2 *= 10;
+		delta *= 10;
+		char digit = (char)(p2 >> one_e);
+		if (digit != 0 || length != 0)
+			buffer[length++] = (char)('0' + digit);
+		p2 &= one_f - 1;
+		kappa--;
+		if (p2 < delta)
+		{
+			*K += kappa;
+			impl_grisu_round(buffer, length, delta, p2, one_f, -kappa < 20 ? wp_w * g_powers_of_ten_64[-kappa] : 0);
+			return length;
+		}
+	}
+}
+
+char* impl_write_shortest(const char* digits, int32_t length, int32_t K, char* buffer)
+{
+	//The exponent of the first digit
+	int32_t exponent = length + K - 1;
+	if (exponent >= -4 && exponent < 17)
+	{
+		if (K >= 0) //integer: 1234e2 -> 123400
+		{
+			memcpy(buffer, digits, length);
+			memset(buffer + length, '0', K);
+			return buffer + length + K;
+		}
+		if (exponent >= 0) //1234e-2 -> 12.34
+		{
+			memcpy(buffer, digits, exponent + 1);
+			buffer[exponent + 1] = '.';
+			memcpy(buffer + exponent + 2, digits + exponent + 1, length - exponent - 1);
+			return buffer + length + 1;
+		}
+		//1234e-6 -> 0.001234
+		buffer[0] = '0';
+		buffer[1] = '.';
+		memset(buffer + 2, '0', -exponent - 1);
+		memcpy(buffer + 1 - exponent, digits, length);
+		return buffer + 1 - exponent + length;
+	}
+
+	//Scientific notation: 1234e30 -> 1.234e+33
+	char* ptr = buffer;
+	*(ptr++) = digits[0];
+	if (length > 1)
+	{
+		*(ptr++) = '.';
+		memcpy(ptr, digits + 1, length - 1);
+		ptr += length - 1;
+	}
+	*(ptr++) = 'e';
+	*(ptr++) = exponent < 0 ? '-' : '+';
+	if (exponent < 0)
+		exponent = -exponent;
+	//Like '%g', the exponent contains at least 2 digits
+	if (exponent >= 100)
+	{
+		*(ptr++) = (char)('0' + exponent / 100);
+		exponent %= 100;
+	}
+	*(ptr++) = (char)('0' + exponent / 10);
+	*(ptr++) = (char)('0' + exponent % 10);
+	return ptr;
+}
@@ -0,0 +1,257 @@
+/** @file number_conversion.h
+* Contains locale-independent conversions from numbers to strings, and from strings to numbers.
+* The floating point formatter (`doubleToChars`, `floatToChars`) uses the Grisu2 algorithm,
+* which produces the shortest (in virtually all cases) representation of the value
+* that parses back to the exact same value.
+* The floating point parser (`charsToDouble`, `charsToFloat`) uses the Eisel-Lemire algorithm,
+* which works directly on a StringView (no NUL terminator is needed), and only
+* falls back to `strtod` for literals with more than 19 significant digits whose
+* rounding cannot be determined from their first 19 digits.
+* The integer parser (`charsToUInt`) also works on a StringView, and parses
+* decimal digits 8 at a time using SWAR (SIMD within a register).
+*/
+
+#ifndef HG_COLTI_NUMBER_CONVERSION
+#define HG_COLTI_NUMBER_CONVERSION
+
+#include "common.h"
+#include "structs/struct_string.h"
+
+/// @brief The maximum number of characters written by doubleToChars and floatToChars
+#define FLOAT_TO_CHARS_MAX_SIZE 32
+
+/// @brief The result of parsing a number from a string
+typedef enum
+{
+	/// @brief The conversion was successful
+	CONVERSION_SUCCESS,
+	/// @brief The string does not start with a number
+	CONVERSION_INVALID_INPUT,
+	/// @brief The number is too big to be represented
+	CONVERSION_OUT_OF_RANGE,
+} ConversionResult;
+
+/// @brief Writes the shortest representation of a double that round-trips.
+/// The representation uses the fixed notation for exponents in [-4, 17[, and
+/// the scientific notation (`1.5e+20`) for any other exponent.
+/// NaN and infinities are written as `nan` and `inf`.
+/// @param value The value to write
+/// @param buffer The buffer to write to, of at least FLOAT_TO_CHARS_MAX_SIZE characters
+/// @return The number of characters written (no NUL terminator is written)
+uint64_t doubleToChars(double value, char* buffer);
+
+/// @brief Writes the shortest representation of a float that round-trips.
+/// Uses the same notations as doubleToChars.
+/// @param value The value to write
+/// @param buffer The buffer to write to, of at least FLOAT_TO_CHARS_MAX_SIZE characters
+/// @return The number of characters written (no NUL terminator is written)
+uint64_t floatToChars(float value, char* buffer);
+
+/// @brief Parses a double from the beginning of a view.
+/// Expects `[+-]?[0-9]*(.[0-9]*)?([eE][+-]?[0-9]+)?` with at least one digit.
+/// On CONVERSION_OUT_OF_RANGE, 'result' is set to an infinity.
+/// @param view The view from which to parse
+/// @param result Pointer to where to write the parsed value
+/// @param end Pointer to where to write the pointer past the last parsed character, can be NULL
+/// @return CONVERSION_SUCCESS if a double could be parsed
+ConversionResult charsToDouble(StringView view, double* result, const char** end);
+
+/// @brief Parses a float from the beginning of a view.
+/// Expects the same format as charsToDouble.
+/// The conversion is exact: the literal is not parsed as a double before being rounded to a float.
+/// @param view The view from which to parse
+/// @param result Pointer to where to write the parsed value
+/// @param end Pointer to where to write the pointer past the last parsed character, can be NULL
+/// @return CONVERSION_SUCCESS if a float could be parsed
+ConversionResult charsToFloat(StringView view, float* result, const char** end);
+
+/// @brief Parses an unsigned integer of base 2, 8, 10 or 16 from the beginning of a view.
+/// Expects at least one digit of 'base' (no prefix or sign), letters can be upper or lower case.
+/// On CONVERSION_OUT_OF_RANGE, 'result' is set to UINT64_MAX, and 'end' points past all the digits.
+/// @param view The view from which to parse
+/// @param base The base of the integer (2, 8, 10 or 16)
+/// @param result Pointer to where to write the parsed value
+/// @param end Pointer to where to write the pointer past the last parsed character, can be NULL
+/// @return CONVERSION_SUCCESS if an integer could be parsed
+ConversionResult charsToUInt(StringView view, uint32_t base, uint64_t* result, const char** end);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Result of a 64-bit by 64-bit multiplication
+typedef struct
+{
+	/// @brief The least significant 64 bits
+	uint64_t low;
+	/// @brief The most significant 64 bits
+	uint64_t high;
+} UInt128;
+
+/// @brief Floating point value with a 64-bit significand, used by Grisu2
+typedef struct
+{
+	/// @brief The significand
+	uint64_t f;
+	/// @brief The binary exponent
+	int32_t e;
+} DiyFp;
+
+/// @brief Describes the properties of a floating point format (float or double)
+typedef struct
+{
+	/// @brief The number of explicit bits of the significand (23 or 52)
+	int32_t mantissa_bits;
+	/// @brief The exponent bias (127 or 1023)
+	int32_t exponent_bias;
+	/// @brief The biased exponent representing infinities (0xFF or 0x7FF)
+	int32_t infinite_power;
+	/// @brief The smallest power of ten which does not always round to 0
+	int32_t smallest_power_of_ten;
+	/// @brief The greatest power of ten which does not always round to infinity
+	int32_t largest_power_of_ten;
+	/// @brief The smallest power of ten for which round-to-even ties can happen
+	int32_t min_exponent_round_to_even;
+	/// @brief The greatest power of ten for which round-to-even ties can happen
+	int32_t max_exponent_round_to_even;
+} FloatFormat;
+
+/// @brief A decimal number extracted from a string
+typedef struct
+{
+	/// @brief The (first 19) significant digits
+	uint64_t mantissa;
+	/// @brief The decimal exponent
+	int64_t exponent;
+	/// @brief True if the number had more than 19 significant digits
+	bool is_truncated;
+	/// @brief True if the number is negative
+	bool is_negative;
+} DecimalNumber;
+
+/// @brief Check if a character is in [0-9], without depending on the locale
+/// @param chr The character to check
+/// @return True if 'chr' is a decimal digit
+bool impl_is_digit(char chr);
+
+/// @brief Returns the value of a digit of base up to 36, without depending on the locale
+/// @param chr The character whose value to return ([0-9a-zA-Z])
+/// @return The value of the digit, or UINT32_MAX if 'chr' is not a digit
+uint32_t impl_digit_value(char chr);
+
+/// @brief Loads 8 characters in a uint64_t, the first character being the least significant byte
+/// @param ptr Pointer to the characters (of at least 8 characters)
+/// @return The loaded characters
+uint64_t impl_load_eight_chars(const char* ptr);
+
+/// @brief Check if 8 characters loaded by impl_load_eight_chars are all decimal digits
+/// @param chars The characters to check
+/// @return True if all the characters are in [0-9]
+bool impl_is_eight_digits(uint64_t chars);
+
+/// @brief Converts 8 decimal digits loaded by impl_load_eight_chars to their value.
+/// Uses 3 multiplications instead of 8 by combining digits in pairs in each step.
+/// @param chars The characters to convert (which must all be digits)
+/// @return The value of the 8 digits
+uint32_t impl_parse_eight_digits(uint64_t chars);
+
+/// @brief Computes 'value' * 'multiplier' + 'addend', checking for overflow
+/// @param value The value to multiply
+/// @param multiplier The multiplier
+/// @param addend The value to add to the product
+/// @param result Pointer to where to write the (wrapped) result
+/// @return True if the operation overflowed
+bool impl_mul_add_overflow(uint64_t value, uint64_t multiplier, uint64_t addend, uint64_t* result);
+
+/// @brief Parses a number using `strtod`, used when the Eisel-Lemire algorithm cannot decide.
+/// As this only happens for more than 19 significant digits, the number is copied to add a NUL terminator.
+/// @param begin The beginning of the number
+/// @param end The end of the number
+/// @return The parsed double
+double impl_strtod_fallback(const char* begin, const char* end);
+
+/// @brief Parses a number using `strtof`, used when the Eisel-Lemire algorithm cannot decide
+/// @param begin The beginning of the number
+/// @param end The end of the number
+/// @return The parsed float
+float impl_strtof_fallback(const char* begin, const char* end);
+
+/// @brief Multiplies 2 uint64_t, returning the full 128-bit result
+/// @param a The left hand side
+/// @param b The right hand side
+/// @return The product
+UInt128 impl_multiply_128(uint64_t a, uint64_t b);
+
+/// @brief Counts the leading zeros of a non-zero uint64_t
+/// @param value The value (not 0)
+/// @return The number of leading zeros
+int32_t impl_count_leading_zeros(uint64_t value);
+
+/// @brief Extracts a decimal number from a string
+/// @param begin The beginning of the string
+/// @param end The end of the string
+/// @param number Pointer to where to write the extracted number
+/// @return Pointer past the last character of the number, or 'begin' if no number was found
+const char* impl_parse_decimal(const char* begin, const char* end, DecimalNumber* number);
+
+/// @brief Converts a decimal number to the bits of a floating point value using the Eisel-Lemire algorithm.
+/// @param mantissa The decimal significand
+/// @param exponent The decimal exponent
+/// @param format The format of the floating point value
+/// @return The bits of the float (without the sign)
+uint64_t impl_eisel_lemire(uint64_t mantissa, int64_t exponent, const FloatFormat* format);
+
+/// @brief Converts a decimal number to the bits of a floating point value, without the sign.
+/// Returns false if the result cannot be determined from the decimal number (which
+/// happens when the number was truncated), in which case a slower fallback is needed.
+/// @param number The decimal number to convert
+/// @param format The format of the floating point value
+/// @param result Pointer to where to write the bits of the value
+/// @return True if the conversion was successful
+bool impl_decimal_to_bits(const DecimalNumber* number, const FloatFormat* format, uint64_t* result);
+
+/// @brief Normalizes a DiyFp so that the most significant bit of its significand is set
+/// @param value The value to normalize (whose significand is not 0)
+/// @return The normalized value
+DiyFp impl_diyfp_normalize(DiyFp value);
+
+/// @brief Multiplies 2 DiyFp, rounding the result to 64 bits
+/// @param lhs The left hand side
+/// @param rhs The right hand side
+/// @return The rounded product
+DiyFp impl_diyfp_multiply(DiyFp lhs, DiyFp rhs);
+
+/// @brief Returns the normalized 10^k, with k chosen so that the product of a value
+/// of binary exponent 'e' and 10^k has a binary exponent in [-60, -57]
+/// @param e The binary exponent of the value
+/// @param k Pointer to where to write the chosen power of ten
+/// @return 10^k
+DiyFp impl_cached_power(int32_t e, int32_t* k);
+
+/// @brief Moves the last digit generated by Grisu2 closer to the exact value, if possible
+/// @param buffer The generated digits
+/// @param length The number of digits
+/// @param delta The width of the rounding interval
+/// @param rest The distance from the digits to the upper boundary
+/// @param ten_kappa The weight of the last digit
+/// @param wp_w The distance from the exact value to the upper boundary
+void impl_grisu_round(char* buffer, int32_t length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w);
+
+/// @brief Generates the shortest digits of a floating point value (f * 2^e) using Grisu2.
+/// @param f The significand of the value (not 0)
+/// @param e The binary exponent of the value
+/// @param is_lower_closer True if the lower boundary of the value is closer than the upper one
+/// @param buffer The buffer to which to write the digits (at least 18 characters)
+/// @param K Pointer to where to write the decimal exponent of the last digit
+/// @return The number of digits written
+int32_t impl_grisu2(uint64_t f, int32_t e, bool is_lower_closer, char* buffer, int32_t* K);
+
+/// @brief Writes the digits generated by impl_grisu2 using fixed or scientific notation
+/// @param digits The digits to write
+/// @param length The number of digits
+/// @param K The decimal exponent of the last digit
+/// @param buffer The buffer to write to
+/// @return Pointer past the last character written
+char* impl_write_shortest(const char* digits, int32_t length, int32_t K, char* buffer);
+
+#endif //HG_COLTI_NUMBER_CONVERSION
@@ -27,6 +27,16 @@ ParseResult ParseArguments(int argc, const char** argv)
 				impl_disassemble(argc, argv);
 			break; case ARG_TEST_COLOR_CONSOLE:
 				impl_test_color(argc, argv);
+			break; case ARG_BATCH:
+				impl_batch(argc, argv);
+			break; case ARG_PROFILE:
+				impl_profile(argc, argv);
+			break; case ARG_LINK:
+				impl_link(argc, argv);
+			break; case ARG_RUN_IMAGE:
+				impl_run_image(argc, argv);
+			break; case ARG_EMIT_C:
+				impl_emit_c(argc, argv);
 			break; case ARG_EXEC_OUTPUT:
 				//As the function will read 1 argument more, we need to update i
 				result.file_path_out = impl_exec_out(argc, argv, ++i);
@@ -92,6 +102,8 @@ CommandLineArgument impl_string_to_arg(const char* str)
 			return ARG_EXEC_OUTPUT;
 		case 'b':
 			return ARG_BYTE_CODE_OUTPUT;
+		case 'p':
+			return ARG_PROFILE;
 		default:
 			return ARG_INVALID;
 		}
@@ -108,6 +120,8 @@ CommandLineArgument impl_string_to_arg(const char* str)
 		case 'e':
 			if (strcmp(str + 3, "num") == 0)
 				return ARG_ENUM;
+			if (strcmp(str + 3, "mit-c") == 0)
+				return ARG_EMIT_C;
 			return ARG_INVALID;
 		case 'v':
 			if (strcmp(str + 3, "ersion") == 0) //we already checked for --v
@@ -128,6 +142,20 @@ CommandLineArgument impl_string_to_arg(const char* str)
 		case 'b':
 			if (strcmp(str + 3, "yte-out") == 0)
 				return ARG_BYTE_CODE_OUTPUT;
+			if (strcmp(str + 3, "atch") == 0)
+				return ARG_BATCH;
+			return ARG_INVALID;
+		case 'p':
+			if (strcmp(str + 3, "rofile") == 0)
+				return ARG_PROFILE;
+			return ARG_INVALID;
+		case 'l':
+			if (strcmp(str + 3, "ink") == 0)
+				return ARG_LINK;
+			return ARG_INVALID;
+		case 'r':
+			if (strcmp(str + 3, "un-image") == 0)
+				return ARG_RUN_IMAGE;
 			return ARG_INVALID;
 		default:
 			return ARG_INVALID;
@@ -208,6 +236,16 @@ void impl_help(int argc, const char** argv)
 			impl_help_test_color();
 		break; case ARG_BYTE_CODE_OUTPUT:
 			impl_help_byte_out();
+		break; case ARG_BATCH:
+			impl_help_batch();
+		break; case ARG_PROFILE:
+			impl_help_profile();
+		break; case ARG_LINK:
+			impl_help_link();
+		break; case ARG_RUN_IMAGE:
+			impl_help_run_image();
+		break; case ARG_EMIT_C:
+			impl_help_emit_c();
 		break; default:
 			impl_print_invalid_combination(argc, argv);
 			exit(EXIT_USER_INVALID_INPUT);
@@ -233,6 +271,11 @@ void impl_enum(int argc, const char** argv)
 			"\n\t-o, --out"
 			"\n\t-b, --byte-code"
 			"\n\t--test-color"
+			"\n\t--batch"
+			"\n\t-p, --profile"
+			"\n\t--link"
+			"\n\t--run-image"
+			"\n\t--emit-c"
 			"\n"CONSOLE_COLOR_RESET
 		);
 		exit(EXIT_NO_FAILURE);
@@ -276,6 +319,186 @@ const char* impl_byte_out(int argc, const char** argv, size_t current_argc)
 	}
 }
 
+void impl_batch(int argc, const char** argv)
+{
+	if (argc == 2)
+	{
+		impl_help_batch();
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	//All the arguments following --batch are paths
+	uint64_t job_count = (uint64_t)argc - 2;
+	BatchJob* jobs = (BatchJob*)safe_malloc(job_count * sizeof(BatchJob));
+	for (uint64_t i = 0; i < job_count; i++)
+		BatchJobInit(jobs + i, argv[i + 2]);
+	BatchRun(jobs, job_count, hardwareThreadCount());
+
+	//The outputs are written in the order of the batch
+	bool is_success = true;
+	for (uint64_t i = 0; i < job_count; i++)
+	{
+		if (jobs[i].output != NULL)
+			fwrite(jobs[i].output, sizeof(char), jobs[i].output_size, stdout);
+		if (jobs[i].result != INTERPRET_OK)
+		{
+			is_success = false;
+			fflush(stdout);
+			print_error_format("Could not run '%s'!", jobs[i].path);
+		}
+		BatchJobFree(jobs + i);
+	}
+	safe_free(jobs);
+	exit(is_success ? EXIT_NO_FAILURE : EXIT_USER_INVALID_INPUT);
+}
+
+void impl_profile(int argc, const char** argv)
+{
+	if (argc == 2)
+	{
+		impl_help_profile();
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	if (argc > 4)
+	{
+		impl_print_invalid_combination(argc, argv);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	if (!checkIfValidFile(argv[2]))
+	{
+		print_error_format("'%s' is not a valid path!", argv[2]);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	//By default, every instruction is counted
+	uint64_t interval = 1;
+	if (argc == 4)
+	{
+		StringView view = { argv[3], argv[3] + strlen(argv[3]) };
+		const char* end;
+		if (charsToUInt(view, 10, &interval, &end) != CONVERSION_SUCCESS || end != view.end || interval == 0)
+		{
+			print_error_format("Expected a non-zero sampling interval, not '%s'!", argv[3]);
+			exit(EXIT_USER_INVALID_INPUT);
+		}
+	}
+
+	Chunk chunk = ChunkDeserialize(argv[2]);
+	VMProfiler profiler;
+	VMProfilerInit(&profiler, &chunk, interval);
+	StackVM vm;
+	StackVMInit(&vm);
+	InterpretResult result = VMProfilerRun(&profiler, &vm, &chunk);
+	//Flush the output of the chunk before the report
+	StackVMFree(&vm);
+	if (result == INTERPRET_OK)
+		VMProfilerReport(&profiler, &chunk, argv[2]);
+	VMProfilerFree(&profiler);
+	ChunkFree(&chunk);
+	exit(result == INTERPRET_OK ? EXIT_NO_FAILURE : EXIT_USER_INVALID_INPUT);
+}
+
+void impl_link(int argc, const char** argv)
+{
+	if (argc < 4)
+	{
+		impl_help_link();
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	//All the arguments following the output are paths, which are the names of the entries
+	uint64_t unit_count = (uint64_t)argc - 3;
+	Chunk* chunks = (Chunk*)safe_malloc(unit_count * sizeof(Chunk));
+	Linker linker;
+	LinkerInit(&linker);
+	for (uint64_t i = 0; i < unit_count; i++)
+	{
+		if (!checkIfValidFile(argv[i + 3]))
+		{
+			print_error_format("'%s' is not a valid path!", argv[i + 3]);
+			exit(EXIT_USER_INVALID_INPUT);
+		}
+		chunks[i] = ChunkDeserialize(argv[i + 3]);
+		LinkerAddUnit(&linker, argv[i + 3], chunks + i, true);
+	}
+
+	ChunkImage image;
+	bool is_success = LinkerLink(&linker, &image);
+	if (is_success)
+	{
+		ChunkImageSerialize(&image, argv[2]);
+		ChunkImageFree(&image);
+	}
+	LinkerFree(&linker);
+	for (uint64_t i = 0; i < unit_count; i++)
+		ChunkFree(chunks + i);
+	safe_free(chunks);
+	exit(is_success ? EXIT_NO_FAILURE : EXIT_USER_INVALID_INPUT);
+}
+
+void impl_run_image(int argc, const char** argv)
+{
+	if (argc == 2)
+	{
+		impl_help_run_image();
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	if (argc != 4)
+	{
+		impl_print_invalid_combination(argc, argv);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	ChunkImage image;
+	if (!ChunkImageMap(&image, argv[2]))
+		exit(EXIT_USER_INVALID_INPUT);
+	uint64_t index;
+	if (!ChunkImageFindEntry(&image, argv[3], &index))
+	{
+		print_error_format("The image '%s' does not contain an entry named '%s'!", argv[2], argv[3]);
+		ChunkImageFree(&image);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+
+	Chunk entry;
+	ChunkImageGetEntry(&image, index, &entry);
+	StackVM vm;
+	StackVMInit(&vm);
+	InterpretResult result = StackVMRun(&vm, &entry);
+	StackVMFree(&vm);
+	//The entry borrows the image, and is not freed
+	ChunkImageFree(&image);
+	exit(result == INTERPRET_OK ? EXIT_NO_FAILURE : EXIT_USER_INVALID_INPUT);
+}
+
+void impl_emit_c(int argc, const char** argv)
+{
+	if (argc == 2)
+	{
+		impl_help_emit_c();
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	if (argc > 4)
+	{
+		impl_print_invalid_combination(argc, argv);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	if (!checkIfValidFile(argv[2]))
+	{
+		print_error_format("'%s' is not a valid path!", argv[2]);
+		exit(EXIT_USER_INVALID_INPUT);
+	}
+	//The C code is written to stdout if no output path is specified
+	FILE* file = stdout;
+	if (argc == 4 && (file = fopen(argv[3], "w")) == NULL)
+	{
+		print_error_format("Could not create the file at path '%s'!", argv[3]);
+		exit(EXIT_OS_RESOURCE_FAILURE);
+	}
+	Chunk chunk = ChunkDeserialize(argv[2]);
+	bool is_success = ChunkEmitC(&chunk, argv[2], file);
+	ChunkFree(&chunk);
+	if (file != stdout)
+		fclose(file);
+	exit(is_success ? EXIT_NO_FAILURE : EXIT_USER_INVALID_INPUT);
+}
+
 void impl_test_color(int argc, const char** argv)
 {
 	if (argc > 2)
@@ -343,6 +566,31 @@ void impl_help_byte_out()
 	printf(CONSOLE_FOREGROUND_BRIGHT_CYAN"-b, --byte-out"CONSOLE_COLOR_RESET": Specifies the byte-code output path.\nUse: "CONSOLE_FOREGROUND_BRIGHT_CYAN"--byte-out"CONSOLE_FOREGROUND_BRIGHT_MAGENTA" <PATH>\n"CONSOLE_COLOR_RESET);
 }
 
+void impl_help_batch()
+{
+	printf(CONSOLE_FOREGROUND_BRIGHT_CYAN"--batch"CONSOLE_COLOR_RESET": Runs serialized chunks of code on all the hardware threads, printing their outputs in order.\nUse: "CONSOLE_FOREGROUND_BRIGHT_CYAN"--batch"CONSOLE_FOREGROUND_BRIGHT_MAGENTA" <PATHS...>\n"CONSOLE_COLOR_RESET);
+}
+
+void impl_help_profile()
+{
+	printf(CONSOLE_FOREGROUND_BRIGHT_CYAN"-p, --profile"CONSOLE_COLOR_RESET": Runs a serialized chunk of code, sampling the instruction run every <INTERVAL> instructions on average (1 by default, which counts every instruction), then prints its disassembly annotated with the samples.\nUse: "CONSOLE_FOREGROUND_BRIGHT_CYAN"--profile"CONSOLE_FOREGROUND_BRIGHT_MAGENTA" <PATH>"CONSOLE_FOREGROUND_BRIGHT_GREEN" [<INTERVAL>]\n"CONSOLE_COLOR_RESET);
+}
+
+void impl_help_link()
+{
+	printf(CONSOLE_FOREGROUND_BRIGHT_CYAN"--link"CONSOLE_COLOR_RESET": Links serialized chunks of code into a single image, in which each chunk is an entry named by its path.\nUse: "CONSOLE_FOREGROUND_BRIGHT_CYAN"--link"CONSOLE_FOREGROUND_BRIGHT_MAGENTA" <OUT_PATH> <PATHS...>\n"CONSOLE_COLOR_RESET);
+}
+
+void impl_help_run_image()
+{
+	printf(CONSOLE_FOREGROUND_BRIGHT_CYAN"--run-image"CONSOLE_COLOR_RESET": Maps an image linked using '--link', then runs one of its entries.\nUse: "CONSOLE_FOREGROUND_BRIGHT_CYAN"--run-image"CONSOLE_FOREGROUND_BRIGHT_MAGENTA" <PATH> <ENTRY>\n"CONSOLE_COLOR_RESET);
+}
+
+void impl_help_emit_c()
+{
+	printf(CONSOLE_FOREGROUND_BRIGHT_CYAN"--emit-c"CONSOLE_COLOR_RESET": Translates a serialized chunk of code into C, which is written to <OUT_PATH> (stdout by default). The C code is compiled from 'colti/src' using: cc "C_EMITTER_RUNTIME_FLAGS" <OUT_PATH> "C_EMITTER_RUNTIME_SOURCES" -lm.\nUse: "CONSOLE_FOREGROUND_BRIGHT_CYAN"--emit-c"CONSOLE_FOREGROUND_BRIGHT_MAGENTA" <PATH>"CONSOLE_FOREGROUND_BRIGHT_GREEN" [<OUT_PATH>]\n"CONSOLE_COLOR_RESET);
+}
+
 void impl_help_test_color()
 {
 	printf(CONSOLE_FOREGROUND_BRIGHT_CYAN"--test-color"CONSOLE_COLOR_RESET": Prints colored output (as a test) to the terminal.\nUse: "CONSOLE_FOREGROUND_BRIGHT_CYAN"--test-color\n"CONSOLE_COLOR_RESET);
@@ -21,6 +21,10 @@
 #include "common.h"
 #include "chunk.h"
 #include "disassemble.h"
+#include "vm/batch_runner.h"
+#include "vm/vm_profiler.h"
+#include "linker.h"
+#include "c_emitter.h"
 
 /// @brief The result of parsing command line arguments.
 /// This struct is one of the only that will never hold any heap-allocated value.
@@ -51,6 +55,16 @@ typedef enum
 	ARG_BYTE_CODE_OUTPUT,
 	/// @brief --test-color
 	ARG_TEST_COLOR_CONSOLE,
+	/// @brief --batch
+	ARG_BATCH,
+	/// @brief -p, or --profile
+	ARG_PROFILE,
+	/// @brief --link
+	ARG_LINK,
+	/// @brief --run-image
+	ARG_RUN_IMAGE,
+	/// @brief --emit-c
+	ARG_EMIT_C,
 	/// @brief Any invalid argument
 	ARG_INVALID
 } CommandLineArgument;
@@ -109,6 +123,31 @@ const char* impl_exec_out(int argc, const char** argv, size_t current_argc);
 /// @return A valid path to which to write the byte-code
 const char* impl_byte_out(int argc, const char** argv, size_t current_argc);
 
+/// @brief Handles the --batch logic, and exits
+/// @param argc The argument count
+/// @param argv The argument values
+void impl_batch(int argc, const char** argv);
+
+/// @brief Handles the -p or --profile logic, and exits
+/// @param argc The argument count
+/// @param argv The argument values
+void impl_profile(int argc, const char** argv);
+
+/// @brief Handles the --link logic, and exits
+/// @param argc The argument count
+/// @param argv The argument values
+void impl_link(int argc, const char** argv);
+
+/// @brief Handles the --run-image logic, and exits
+/// @param argc The argument count
+/// @param argv The argument values
+void impl_run_image(int argc, const char** argv);
+
+/// @brief Handles the --emit-c logic, and exits
+/// @param argc The argument count
+/// @param argv The argument values
+void impl_emit_c(int argc, const char** argv);
+
 /// @brief Handles the --test-color and exits
 /// @param argc The argument count
 /// @param argv The argument values
@@ -141,4 +180,19 @@ void impl_help_byte_out();
 /// @brief Prints the help of '--test-color'
 void impl_help_test_color();
 
+/// @brief Prints the help of '--batch'
+void impl_help_batch();
+
+/// @brief Prints the help of '-p' or '--profile'
+void impl_help_profile();
+
+/// @brief Prints the help of '--link'
+void impl_help_link();
+
+/// @brief Prints the help of '--run-image'
+void impl_help_run_image();
+
+/// @brief Prints the help of '--emit-c'
+void impl_help_emit_c();
+
 #endif //HG_COLTI_PARSE_ARGS
\ No newline at end of file
@@ -10,6 +10,9 @@
 #include "byte_code.h"
 #include "disassemble.h"
 #include "chunk.h"
+#include "compact_encoding.h"
+#include "verifier.h"
+#include "chunk_cache.h"
 
 #include "lang/scanner.h"
 
@@ -0,0 +1,168 @@
+/** @file thread.c
+* Contains the definitions of the functions declared in 'thread.h'
+*/
+
+#include "thread.h"
+
+#ifdef COLTI_WINDOWS
+	#define WIN32_LEAN_AND_MEAN
+	#include <Windows.h>
+#else
+	#include <unistd.h>
+#endif
+
+bool ColtiThreadCreate(ColtiThread* thread, ThreadRoutine routine, void* arg)
+{
+	thread->routine = routine;
+	thread->arg = arg;
+#ifdef COLTI_WINDOWS
+	thread->handle = CreateThread(NULL, 0, impl_thread_entry, thread, 0, NULL);
+	return thread->handle != NULL;
+#else
+	return pthread_create(&thread->handle, NULL, impl_thread_entry, thread) == 0;
+#endif
+}
+
+void ColtiThreadJoin(ColtiThread* thread)
+{
+#ifdef COLTI_WINDOWS
+	WaitForSingleObject(thread->handle, INFINITE);
+	CloseHandle(thread->handle);
+#else
+	pthread_join(thread->handle, NULL);
+#endif
+}
+
+uint32_t hardwareThreadCount()
+{
+#ifdef COLTI_WINDOWS
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors == 0 ? 1 : (uint32_t)info.dwNumberOfProcessors;
+#else
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count < 1 ? 1 : (uint32_t)count;
+#endif
+}
+
+uint64_t atomicFetchAdd(volatile uint64_t* ptr, uint64_t value)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	return __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+#elif defined(COLTI_WINDOWS)
+	return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)ptr, (LONG64)value);
+#else
+	#error "Atomic operations are not supported for this compiler!"
+#endif
+}
+
+uint32_t atomicFetchAdd32(volatile uint32_t* ptr, uint32_t value)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	return __atomic_fetch_add(ptr, value, __ATOMIC_RELAXED);
+#elif defined(COLTI_WINDOWS)
+	return (uint32_t)InterlockedExchangeAdd((volatile LONG*)ptr, (LONG)value);
+#else
+	#error "Atomic operations are not supported for this compiler!"
+#endif
+}
+
+void atomicStoreByte(volatile uint8_t* ptr, uint8_t value)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	__atomic_store_n(ptr, value, __ATOMIC_RELAXED);
+#elif defined(COLTI_WINDOWS)
+	InterlockedExchange8((volatile char*)ptr, (char)value);
+#else
+	#error "Atomic operations are not supported for this compiler!"
+#endif
+}
+
+bool atomicCompareExchangeByte(volatile uint8_t* ptr, uint8_t expected, uint8_t desired)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	return __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+#elif defined(COLTI_WINDOWS)
+	return (uint8_t)_InterlockedCompareExchange8((volatile char*)ptr, (char)desired, (char)expected) == expected;
+#else
+	#error "Atomic operations are not supported for this compiler!"
+#endif
+}
+
+bool atomicLoadFlag(volatile const bool* ptr)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	return __atomic_load_n(ptr, __ATOMIC_ACQUIRE);
+#elif defined(COLTI_WINDOWS)
+	//The interlocked operations are full barriers
+	return InterlockedOr8((volatile char*)ptr, 0) != 0;
+#else
+	#error "Atomic operations are not supported for this compiler!"
+#endif
+}
+
+void atomicStoreFlag(volatile bool* ptr, bool value)
+{
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	__atomic_store_n(ptr, value, __ATOMIC_RELEASE);
+#elif defined(COLTI_WINDOWS)
+	InterlockedExchange8((volatile char*)ptr, (char)value);
+#else
+	#error "Atomic operations are not supported for this compiler!"
+#endif
+}
+
+void ColtiMutexInit(ColtiMutex* mutex)
+{
+#ifdef COLTI_WINDOWS
+	InitializeSRWLock((PSRWLOCK)&mutex->lock);
+#else
+	pthread_mutex_init(&mutex->lock, NULL);
+#endif
+}
+
+void ColtiMutexDestroy(ColtiMutex* mutex)
+{
+	//An SRWLOCK does not own any resource
+#ifndef COLTI_WINDOWS
+	pthread_mutex_destroy(&mutex->lock);
+#endif
+}
+
+void ColtiMutexLock(ColtiMutex* mutex)
+{
+#ifdef COLTI_WINDOWS
+	AcquireSRWLockExclusive((PSRWLOCK)&mutex->lock);
+#else
+	pthread_mutex_lock(&mutex->lock);
+#endif
+}
+
+void ColtiMutexUnlock(ColtiMutex* mutex)
+{
+#ifdef COLTI_WINDOWS
+	ReleaseSRWLockExclusive((PSRWLOCK)&mutex->lock);
+#else
+	pthread_mutex_unlock(&mutex->lock);
+#endif
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+#ifdef COLTI_WINDOWS
+unsigned long __stdcall impl_thread_entry(void* thread)
+{
+	ColtiThread* colti_thread = (ColtiThread*)thread;
+	colti_thread->routine(colti_thread->arg);
+	return 0;
+}
+#else
+void* impl_thread_entry(void* thread)
+{
+	ColtiThread* colti_thread = (ColtiThread*)thread;
+	colti_thread->routine(colti_thread->arg);
+	return NULL;
+}
+#endif
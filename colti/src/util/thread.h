@@ -0,0 +1,154 @@
+/** @file thread.h
+* Contains a thin abstraction over the threads and atomic operations of the OS.
+* Only what is needed by the VMs is abstracted: starting and joining threads,
+* querying the number of hardware threads, atomic counters, atomic byte operations, and a mutex.
+*/
+
+#ifndef HG_COLTI_THREAD
+#define HG_COLTI_THREAD
+
+#include "common.h"
+
+#ifndef COLTI_WINDOWS
+	#include <pthread.h>
+#endif
+
+/// @brief The function run by a thread
+typedef void (*ThreadRoutine)(void* arg);
+
+/// @brief A thread of the OS
+typedef struct
+{
+#ifdef COLTI_WINDOWS
+	/// @brief The handle of the thread
+	void* handle;
+#else
+	/// @brief The handle of the thread
+	pthread_t handle;
+#endif
+	/// @brief The function run by the thread
+	ThreadRoutine routine;
+	/// @brief The argument passed to 'routine'
+	void* arg;
+} ColtiThread;
+
+/// @brief A mutual exclusion lock, which is not recursive
+typedef struct
+{
+#ifdef COLTI_WINDOWS
+	/// @brief The SRWLOCK of the mutex (which is a single pointer)
+	void* lock;
+#else
+	/// @brief The mutex of the thread library
+	pthread_mutex_t lock;
+#endif
+} ColtiMutex;
+
+#ifdef COLTI_WINDOWS
+	/// @brief Initializes a ColtiMutex statically (SRWLOCK_INIT), which does not need to be destroyed
+	#define COLTI_MUTEX_INITIALIZER { NULL }
+#else
+	/// @brief Initializes a ColtiMutex statically, which does not need to be destroyed
+	#define COLTI_MUTEX_INITIALIZER { PTHREAD_MUTEX_INITIALIZER }
+#endif
+
+/// @brief Starts a thread running 'routine(arg)'.
+/// The ColtiThread must not be moved until it is joined.
+/// @param thread The thread to initialize
+/// @param routine The function to run
+/// @param arg The argument to pass to 'routine'
+/// @return False if the thread could not be created
+bool ColtiThreadCreate(ColtiThread* thread, ThreadRoutine routine, void* arg);
+
+/// @brief Waits for a thread started by ColtiThreadCreate to end, and frees its resources
+/// @param thread The thread to join
+void ColtiThreadJoin(ColtiThread* thread);
+
+/// @brief Returns the number of threads that the hardware can run concurrently
+/// @return The number of logical processors (at least 1)
+uint32_t hardwareThreadCount();
+
+/// @brief Atomically adds 'value' to the integer pointed by 'ptr'
+/// @param ptr Pointer to the integer to modify
+/// @param value The value to add
+/// @return The value of the integer before the addition
+uint64_t atomicFetchAdd(volatile uint64_t* ptr, uint64_t value);
+
+/// @brief Atomically adds 'value' to the 32-bit integer pointed by 'ptr'
+/// @param ptr Pointer to the integer to modify
+/// @param value The value to add
+/// @return The value of the integer before the addition
+uint32_t atomicFetchAdd32(volatile uint32_t* ptr, uint32_t value);
+
+/// @brief Atomically writes a byte, so that the threads reading it concurrently read either its previous or its new value.
+/// The write is not ordered with respect to the other memory accesses.
+/// @param ptr Pointer to the byte to write
+/// @param value The value to write
+void atomicStoreByte(volatile uint8_t* ptr, uint8_t value);
+
+/// @brief Atomically reads a byte written concurrently by atomicStoreByte or atomicCompareExchangeByte.
+/// The read is not ordered with respect to the other memory accesses.
+/// This is a macro (compiled to a plain load), as the VMs read each OpCode using it (see quickening.h).
+/// @param ptr Pointer to the byte to read
+/// @return The value of the byte
+#if defined(COLTI_GNU) || defined(COLTI_CLANG)
+	#define atomicLoadByte(ptr) __atomic_load_n((volatile const uint8_t*)(ptr), __ATOMIC_RELAXED)
+#elif defined(COLTI_WINDOWS)
+	//Aligned reads of a byte are atomic, the volatile read not being optimized away
+	#define atomicLoadByte(ptr) (*(volatile const uint8_t*)(ptr))
+#else
+	#error "Atomic operations are not supported for this compiler!"
+#endif
+
+/// @brief Atomically replaces a byte by 'desired' if its value is 'expected'.
+/// The operation is not ordered with respect to the other memory accesses.
+/// @param ptr Pointer to the byte to modify
+/// @param expected The value that the byte should have
+/// @param desired The value to write
+/// @return True if the byte was 'expected' (and is now 'desired'), false if it was not modified
+bool atomicCompareExchangeByte(volatile uint8_t* ptr, uint8_t expected, uint8_t desired);
+
+/// @brief Atomically reads a flag written by atomicStoreFlag.
+/// The writes that preceded the store of the value read are visible to the memory accesses that follow the read.
+/// @param ptr Pointer to the flag to read
+/// @return The value of the flag
+bool atomicLoadFlag(volatile const bool* ptr);
+
+/// @brief Atomically writes a flag, publishing the writes that precede it to the threads reading it using atomicLoadFlag
+/// @param ptr Pointer to the flag to write
+/// @param value The value to write
+void atomicStoreFlag(volatile bool* ptr, bool value);
+
+/// @brief Initializes a mutex, which should be destroyed using ColtiMutexDestroy
+/// @param mutex The mutex to initialize
+void ColtiMutexInit(ColtiMutex* mutex);
+
+/// @brief Frees the resources of a mutex initialized by ColtiMutexInit, which must not be locked
+/// @param mutex The mutex to destroy
+void ColtiMutexDestroy(ColtiMutex* mutex);
+
+/// @brief Locks a mutex, waiting for the thread holding it to unlock it
+/// @param mutex The mutex to lock, which must not be held by the calling thread
+void ColtiMutexLock(ColtiMutex* mutex);
+
+/// @brief Unlocks a mutex held by the calling thread
+/// @param mutex The mutex to unlock
+void ColtiMutexUnlock(ColtiMutex* mutex);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+#ifdef COLTI_WINDOWS
+/// @brief The entry point of the threads, which calls the routine of the ColtiThread
+/// @param thread The ColtiThread being run
+/// @return 0
+unsigned long __stdcall impl_thread_entry(void* thread);
+#else
+/// @brief The entry point of the threads, which calls the routine of the ColtiThread
+/// @param thread The ColtiThread being run
+/// @return NULL
+void* impl_thread_entry(void* thread);
+#endif
+
+#endif //HG_COLTI_THREAD
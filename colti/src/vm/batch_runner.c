@@ -0,0 +1,83 @@
+/** @file batch_runner.c
+* Contains the definitions of the functions declared in 'batch_runner.h'
+*/
+
+#include "batch_runner.h"
+
+void BatchJobInit(BatchJob* job, const char* path)
+{
+	job->path = path;
+	job->result = INTERPRET_OK;
+	job->output = NULL;
+	job->output_size = 0;
+}
+
+void BatchJobFree(BatchJob* job)
+{
+	if (job->output != NULL)
+		safe_free(job->output);
+	job->output = NULL;
+	job->output_size = 0;
+}
+
+void BatchRun(BatchJob* jobs, uint64_t job_count, uint32_t thread_count)
+{
+	if (job_count == 0)
+		return;
+	if (thread_count > job_count)
+		thread_count = (uint32_t)job_count;
+	if (thread_count == 0)
+		thread_count = 1;
+
+	BatchQueue queue = { jobs, job_count, 0 };
+	//The calling thread is also a worker
+	uint32_t started_count = 0;
+	ColtiThread* threads = thread_count == 1 ? NULL
+		: (ColtiThread*)safe_malloc((thread_count - 1) * sizeof(ColtiThread));
+	for (; started_count < thread_count - 1; started_count++)
+	{
+		//If a thread cannot be created, the started workers handle its jobs
+		if (!ColtiThreadCreate(threads + started_count, impl_batch_worker, &queue))
+			break;
+	}
+	impl_batch_worker(&queue);
+
+	for (uint32_t i = 0; i < started_count; i++)
+		ColtiThreadJoin(threads + i);
+	if (threads != NULL)
+		safe_free(threads);
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+void impl_batch_worker(void* queue)
+{
+	BatchQueue* batch = (BatchQueue*)queue;
+	//The VM is reused for all the jobs of the worker
+	StackVM vm;
+	StackVMInitWithStream(&vm, NULL);
+	for (;;)
+	{
+		uint64_t index = atomicFetchAdd(&batch->next_job, 1);
+		if (index >= batch->job_count)
+			break;
+		impl_batch_run_job(&vm, batch->jobs + index);
+	}
+	StackVMFree(&vm);
+}
+
+void impl_batch_run_job(StackVM* vm, BatchJob* job)
+{
+	Chunk chunk;
+	if (!ChunkMap(&chunk, job->path))
+	{
+		job->result = INTERPRET_COMPILE_ERROR;
+		return;
+	}
+	StackVMReset(vm);
+	job->result = StackVMRun(vm, &chunk);
+	job->output = VMOutputTakeCapture(&vm->output, &job->output_size);
+	ChunkFree(&chunk);
+}
@@ -0,0 +1,73 @@
+/** @file batch_runner.h
+* Contains the batch runner, which runs a batch of serialized chunks on a pool of threads.
+* Each worker thread owns a single StackVM, which is reused for every chunk it runs,
+* and pulls the next job to run from a shared atomic counter (so that the work is
+* balanced even if the chunks take different times to run).
+* The chunks are memory-mapped (see ChunkMap) rather than copied, so that their pages
+* are shared read-only by all the workers, and are verified by the worker running them.
+* As the workers run concurrently, the output of each chunk is captured in its own
+* buffer, which is returned in its BatchJob: the outputs can then be written
+* in the order of the batch, independently of the order in which the chunks were run.
+*/
+
+#ifndef HG_COLTI_BATCH_RUNNER
+#define HG_COLTI_BATCH_RUNNER
+
+#include "common.h"
+#include "util/thread.h"
+#include "stack_based_vm.h"
+
+/// @brief A serialized chunk to run, and the result of running it
+typedef struct
+{
+	/// @brief The path to the serialized chunk
+	const char* path;
+	/// @brief The result of running the chunk (INTERPRET_COMPILE_ERROR if it could not be loaded)
+	InterpretResult result;
+	/// @brief The output printed by the chunk (not NUL terminated), NULL if nothing was printed
+	char* output;
+	/// @brief The size of 'output'
+	uint64_t output_size;
+} BatchJob;
+
+/// @brief The state shared by the workers of a batch
+typedef struct
+{
+	/// @brief The jobs of the batch
+	BatchJob* jobs;
+	/// @brief The number of jobs
+	uint64_t job_count;
+	/// @brief The index of the next job to run, incremented atomically by the workers
+	volatile uint64_t next_job;
+} BatchQueue;
+
+/// @brief Initializes a job running the chunk serialized at 'path'
+/// @param job The job to initialize
+/// @param path The path to the serialized chunk (which must outlive the job)
+void BatchJobInit(BatchJob* job, const char* path);
+
+/// @brief Frees the output captured by a job
+/// @param job The job to free
+void BatchJobFree(BatchJob* job);
+
+/// @brief Runs a batch of jobs on 'thread_count' threads (including the calling thread),
+/// and returns when all the jobs were run.
+/// @param jobs The jobs to run, whose results are written by this function
+/// @param job_count The number of jobs
+/// @param thread_count The number of threads to use (see hardwareThreadCount), clamped to 'job_count'
+void BatchRun(BatchJob* jobs, uint64_t job_count, uint32_t thread_count);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief The routine of the workers, which run jobs until the queue is empty
+/// @param queue The BatchQueue from which to pull the jobs
+void impl_batch_worker(void* queue);
+
+/// @brief Runs a single job using the VM of a worker
+/// @param vm The (capturing) virtual machine of the worker
+/// @param job The job to run
+void impl_batch_run_job(StackVM* vm, BatchJob* job);
+
+#endif //HG_COLTI_BATCH_RUNNER
@@ -4,15 +4,52 @@
 
 #include "stack_based_vm.h"
 
+/// @brief The mutex serializing the verification of the chunks run by StackVMRunFor (which may be shared by threads)
+static ColtiMutex g_verify_mutex = COLTI_MUTEX_INITIALIZER;
+
 void StackVMInit(StackVM* vm)
+{
+	StackVMInitWithStream(vm, stdout);
+}
+
+void StackVMInitWithStream(StackVM* vm, FILE* stream)
 {
 	//Point to index 0 of the stack (which means empty)
 	vm->stack_top = vm->stack;
+	vm->locals = vm->stack;
+	vm->frame_count = 0;
+	vm->ip = NULL;
+	vm->chunk = NULL;
+	vm->arrays = NULL;
+	vm->globals = NULL;
+	vm->global_capacity = 0;
+	VMOutputInit(&vm->output, stream);
+}
+
+void StackVMReset(StackVM* vm)
+{
+	vm->stack_top = vm->stack;
+	vm->locals = vm->stack;
+	vm->frame_count = 0;
+	vm->ip = NULL;
+	vm->chunk = NULL;
+	//The stack does not reference any array anymore
+	ArrayFreeAll(&vm->arrays);
+}
+
+bool StackVMIsSuspended(const StackVM* vm)
+{
+	return vm->ip != NULL;
 }
 
 void StackVMFree(StackVM* vm)
 {
-	//Nothing to free
+	VMOutputFree(&vm->output);
+	ArrayFreeAll(&vm->arrays);
+	if (vm->globals != NULL)
+		safe_free(vm->globals);
+	vm->globals = NULL;
+	vm->global_capacity = 0;
 }
 
 void StackVMPush(StackVM* vm, QWORD value)
@@ -44,27 +81,195 @@ uint64_t StackVMSize(const StackVM* vm)
 
 InterpretResult StackVMRun(StackVM* vm, Chunk* chunk)
 {
-	uint8_t* ip = chunk->code;
-	for (;;)
+	//The budget cannot be exhausted before the chunk returns
+	return StackVMRunFor(vm, chunk, UINT64_MAX);
+}
+
+InterpretResult StackVMRunFor(StackVM* vm, Chunk* chunk, uint64_t budget)
+{
+	uint8_t* ip = vm->ip;
+	if (ip != NULL) //Resume the suspended chunk
+	{
+		colti_assert(vm->chunk == chunk, "Another Chunk is suspended in the VM!");
+		colti_assert(chunk->is_verified, "The suspended Chunk was modified!");
+	}
+	else
 	{
-		switch (*(ip++)) //Dereferences then advances the pointer
+		//The threads running a shared chunk verify it once: the others wait for it, then read the state it built
+		if (!atomicLoadFlag(&chunk->is_verified))
+		{
+			uint64_t error_offset;
+			VerifyResult result = VERIFY_OK;
+			ColtiMutexLock(&g_verify_mutex);
+			if (!chunk->is_verified)
+				result = ChunkVerify(chunk, &error_offset);
+			ColtiMutexUnlock(&g_verify_mutex);
+			if (result != VERIFY_OK)
+			{
+				SourceLocation location;
+				if (ChunkGetSourceLocation(chunk, error_offset, &location))
+					print_error_format("Invalid byte-code at offset %"PRIu64" (line %"PRIu32", column %"PRIu32"): %s!",
+						error_offset, location.line, location.column, VerifyResultToString(result));
+				else
+					print_error_format("Invalid byte-code at offset %"PRIu64": %s!", error_offset, VerifyResultToString(result));
+				return INTERPRET_COMPILE_ERROR;
+			}
+		}
+		//Values left on the stack by previous runs reduce the depth available
+		if (StackVMSize(vm) + chunk->local_count + chunk->max_stack_depth > STACK_VM_STACK_SIZE)
+		{
+			print_error_string("The stack of the VM is too small to run the byte-code!");
+			return INTERPRET_RUNTIME_ERROR;
+		}
+		//The frame of the chunk precedes its values (a previous run may have failed in a function)
+		vm->frame_count = 0;
+		vm->locals = vm->stack_top;
+		memset(vm->locals, 0, chunk->local_count * sizeof(QWORD));
+		vm->stack_top += chunk->local_count;
+		//The global slots are zero-initialized too, and only reallocated if the chunk has more globals
+		if (chunk->global_count > vm->global_capacity)
+		{
+			if (vm->globals != NULL)
+				safe_free(vm->globals);
+			vm->globals = (QWORD*)safe_malloc(chunk->global_count * sizeof(QWORD));
+			vm->global_capacity = chunk->global_count;
+		}
+		if (chunk->global_count != 0)
+			memset(vm->globals, 0, chunk->global_count * sizeof(QWORD));
+		ip = chunk->code;
+	}
+
+	InterpretResult result;
+	if (chunk->encoding == CHUNK_ENCODING_COMPACT)
+		result = impl_stack_vm_run_compact(vm, chunk, ip, budget);
+	else if (chunk->operand_type != CHUNK_POLYMORPHIC)
+		result = impl_stack_vm_run_monomorphic(vm, chunk, ip, budget);
+	else
+		result = impl_stack_vm_run_aligned(vm, chunk, ip, budget);
+	//The instruction pointer is saved by the run functions when yielding
+	vm->chunk = result == INTERPRET_YIELD ? chunk : NULL;
+	if (result != INTERPRET_YIELD)
+		vm->ip = NULL;
+	return result;
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+InterpretResult impl_stack_vm_runtime_error(StackVM* vm, const Chunk* chunk, uint64_t offset, const char* message)
+{
+	//The output printed before the error should precede it
+	VMOutputFlush(&vm->output);
+	SourceLocation location;
+	if (ChunkGetSourceLocation(chunk, offset, &location))
+		print_error_format("%s at offset %"PRIu64" (line %"PRIu32", column %"PRIu32")!",
+			message, offset, location.line, location.column);
+	else
+		print_error_format("%s at offset %"PRIu64"!", message, offset);
+	return INTERPRET_RUNTIME_ERROR;
+}
+
+ArrayError impl_stack_vm_run_array(StackVM* vm, uint8_t code, OperandType type, OperandType to)
+{
+	//The verifier checked the types and the number of the values on the stack
+	QWORD* top = vm->stack_top;
+	ArrayError error = ARRAY_OK;
+	switch (code)
+	{
+	break; case OP_ARRAY_NEW:
+		error = OpCode_ArrayNew(top[-2], top[-1], type, &vm->arrays, &top[-2]);
+		vm->stack_top--;
+	break; case OP_ARRAY_LENGTH:
+		StackVMPush(vm, OpCode_ArrayLength(top[-1]));
+	break; case OP_ARRAY_GET:
+		error = OpCode_ArrayGet(top[-2], top[-1], &top[-1]);
+	break; case OP_ARRAY_SET:
+		error = OpCode_ArraySet(top[-3], top[-2], top[-1]);
+		vm->stack_top -= 2;
+		//The left operand is the top of the stack, see OpCode_Sum
+	break; case OP_ARRAY_ADD:
+	case OP_ARRAY_SUBTRACT:
+	case OP_ARRAY_MULTIPLY:
+	case OP_ARRAY_DIVIDE:
+		error = OpCode_ArrayBinary(code, top[-1], top[-2], &vm->arrays, &top[-2]);
+		vm->stack_top--;
+	break; case OP_ARRAY_NEGATE:
+		top[-1] = OpCode_ArrayNegate(top[-1], &vm->arrays);
+	break; case OP_ARRAY_CONVERT:
+		top[-1] = OpCode_ArrayConvert(top[-1], to, &vm->arrays);
+	break; case OP_ARRAY_SUM:
+	case OP_ARRAY_MIN:
+	case OP_ARRAY_MAX:
+		error = OpCode_ArrayReduce(code, top[-1], &top[-1]);
+	break; case OP_ARRAY_DOT:
+		error = OpCode_ArrayDot(top[-1], top[-2], &top[-2]);
+		vm->stack_top--;
+	break; default:
+		colti_unreachable();
+	}
+	return error;
+}
+
+bool impl_stack_vm_add_dynamic(StackVM* vm, Chunk* chunk, uint8_t* instr, uint64_t cache)
+{
+	//The left operand (its tag being the top of the stack) is above the right one, whose tag becomes the tag of the result
+	QWORD* top = vm->stack_top;
+	if (!OpCode_SumDynamic(top[-2], top[-1], top[-4], top[-3], &top[-4]))
+		return false;
+	vm->stack_top -= 2;
+	OperandType type = (OperandType)top[-1].ui64;
+
+	//A specialized form reaches the generic path when its guard fails
+	InlineCache* inline_cache = chunk->inline_caches + cache;
+	if (atomicLoadByte(instr) != OP_ADD_DYNAMIC)
+		atomicFetchAdd32(&inline_cache->deopt_count, 1);
+	OpCode code = InlineCacheRecord(inline_cache, type);
+	if (!chunk->is_read_only && atomicLoadByte(instr) != code)
+		atomicStoreByte(instr, (uint8_t)code);
+	return true;
+}
+
+void impl_stack_vm_quicken(uint8_t* instr, uint8_t code, uint8_t type)
+{
+	uint8_t quickened = QuickenOpCode(code, type);
+	//Concurrent runs of the instruction read either form, and may store the same byte
+	if (quickened != code)
+		atomicStoreByte(instr, quickened);
+}
+
+InterpretResult impl_stack_vm_run_aligned(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget)
+{
+	QWORD* locals = vm->locals;
+	//A single predictable branch per instruction
+	for (;; --budget)
+	{
+		if (budget == 0)
+		{
+			vm->locals = locals;
+			vm->ip = ip;
+			return INTERPRET_YIELD;
+		}
+		//The OpCode may be quickened concurrently by another thread running the chunk
+		switch (atomicLoadByte(ip++)) //Dereferences then advances the pointer
 		{
 
 			/******************************************************/
 
 		break; case OP_IMMEDIATE_BYTE:
 		{
-			QWORD qword = { .byte = unsafe_get_byte(&ip) };
+			//Immediates are zero-extended
+			QWORD qword = { .ui64 = unsafe_get_byte(&ip).ui8 };
 			StackVMPush(vm, qword);
 		}
 		break; case OP_IMMEDIATE_WORD:
 		{
-			QWORD qword = { .word = unsafe_get_word(&ip) };
+			QWORD qword = { .ui64 = unsafe_get_word(&ip).ui16 };
 			StackVMPush(vm, qword);
 		}
 		break; case OP_IMMEDIATE_DWORD:
 		{
-			QWORD qword = { .dword = unsafe_get_dword(&ip) };
+			QWORD qword = { .ui64 = unsafe_get_dword(&ip).ui32 };
 			StackVMPush(vm, qword);
 		}
 		break; case OP_IMMEDIATE_QWORD:
@@ -75,6 +280,112 @@ InterpretResult StackVMRun(StackVM* vm, Chunk* chunk)
 
 		/******************************************************/
 
+		break; case OP_LOAD_CONST_BYTE:
+			colti_assert(*ip < chunk->constant_count, "Invalid constant index!");
+			StackVMPush(vm, chunk->constants[unsafe_get_byte(&ip).ui8]);
+		break; case OP_LOAD_CONST_WORD:
+		{
+			uint16_t index = unsafe_get_word(&ip).ui16;
+			colti_assert(index < chunk->constant_count, "Invalid constant index!");
+			StackVMPush(vm, chunk->constants[index]);
+		}
+
+		/******************************************************/
+
+		break; case OP_LOAD_LOCAL_BYTE:
+			StackVMPush(vm, locals[unsafe_get_byte(&ip).ui8]);
+		break; case OP_LOAD_LOCAL_WORD:
+			StackVMPush(vm, locals[unsafe_get_word(&ip).ui16]);
+		break; case OP_STORE_LOCAL_BYTE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			locals[unsafe_get_byte(&ip).ui8] = StackVMPop(vm);
+		break; case OP_STORE_LOCAL_WORD:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			locals[unsafe_get_word(&ip).ui16] = StackVMPop(vm);
+		break; case OP_INC_LOCAL_BYTE:
+		{
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			OperandType type = *(ip++);
+			QWORD* local = locals + unsafe_get_byte(&ip).ui8;
+			*local = OpCode_Sum(*local, StackVMPop(vm), type);
+		}
+		break; case OP_INC_LOCAL_WORD:
+		{
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			OperandType type = *(ip++);
+			QWORD* local = locals + unsafe_get_word(&ip).ui16;
+			*local = OpCode_Sum(*local, StackVMPop(vm), type);
+		}
+
+		/******************************************************/
+
+		break; case OP_LOAD_GLOBAL:
+			StackVMPush(vm, vm->globals[unsafe_get_word(&ip).ui16]);
+		break; case OP_STORE_GLOBAL:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			vm->globals[unsafe_get_word(&ip).ui16] = StackVMPop(vm);
+
+		/******************************************************/
+
+		break; case OP_BOX:
+		{
+			QWORD tag = { .ui64 = *(ip++) };
+			StackVMPush(vm, tag);
+		}
+		break; case OP_UNBOX:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			if (StackVMPop(vm).ui64 != *(ip++))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, "Dynamic value of an unexpected type");
+		break; case OP_ADD_DYNAMIC:
+		{
+			uint8_t* instr = ip - 1;
+			if (!impl_stack_vm_add_dynamic(vm, chunk, instr, unsafe_get_dword(&ip).ui32))
+				return impl_stack_vm_runtime_error(vm, chunk, instr - chunk->code, "Dynamic operands of different or invalid types");
+		}
+		break; case OP_ADD_DYNAMIC_I64:
+		{
+			//The guard: both tags are still INT64
+			uint8_t* instr = ip - 1;
+			uint32_t cache = unsafe_get_dword(&ip).ui32;
+			QWORD* top = vm->stack_top;
+			if (top[-1].ui64 == OPERAND_COLTI_I64 && top[-3].ui64 == OPERAND_COLTI_I64)
+			{
+				top[-4].i64 = top[-2].i64 + top[-4].i64;
+				vm->stack_top -= 2;
+			}
+			else if (!impl_stack_vm_add_dynamic(vm, chunk, instr, cache))
+				return impl_stack_vm_runtime_error(vm, chunk, instr - chunk->code, "Dynamic operands of different or invalid types");
+		}
+		break; case OP_ADD_DYNAMIC_DOUBLE:
+		{
+			uint8_t* instr = ip - 1;
+			uint32_t cache = unsafe_get_dword(&ip).ui32;
+			QWORD* top = vm->stack_top;
+			if (top[-1].ui64 == OPERAND_COLTI_DOUBLE && top[-3].ui64 == OPERAND_COLTI_DOUBLE)
+			{
+				top[-4].d = top[-2].d + top[-4].d;
+				vm->stack_top -= 2;
+			}
+			else if (!impl_stack_vm_add_dynamic(vm, chunk, instr, cache))
+				return impl_stack_vm_runtime_error(vm, chunk, instr - chunk->code, "Dynamic operands of different or invalid types");
+		}
+		break; case OP_ADD_DYNAMIC_POLY:
+		{
+			//The guard: the tags are the same type, which is one of the types of the cache
+			uint8_t* instr = ip - 1;
+			uint32_t cache = unsafe_get_dword(&ip).ui32;
+			QWORD* top = vm->stack_top;
+			if (top[-1].ui64 == top[-3].ui64 && InlineCacheContains(chunk->inline_caches + cache, top[-1].ui64))
+			{
+				top[-4] = OpCode_Sum(top[-2], top[-4], (OperandType)top[-1].ui64);
+				vm->stack_top -= 2;
+			}
+			else if (!impl_stack_vm_add_dynamic(vm, chunk, instr, cache))
+				return impl_stack_vm_runtime_error(vm, chunk, instr - chunk->code, "Dynamic operands of different or invalid types");
+		}
+
+		/******************************************************/
+
 		break; case OP_NEGATE:
 			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
 			StackVMPush(vm, OpCode_Negate(StackVMPop(vm), *(ip++)));
@@ -87,6 +398,31 @@ InterpretResult StackVMRun(StackVM* vm, Chunk* chunk)
 			StackVMPush(vm, OpCode_Convert(StackVMPop(vm), from, to));
 		}
 
+		break; case OP_CVT_I32_I64:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_i32_i64(StackVMPop(vm)));
+		break; case OP_CVT_I64_I32:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_i64_i32(StackVMPop(vm)));
+		break; case OP_CVT_I32_DOUBLE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_i32_d(StackVMPop(vm)));
+		break; case OP_CVT_DOUBLE_I32:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_d_i32(StackVMPop(vm)));
+		break; case OP_CVT_I64_DOUBLE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_i64_d(StackVMPop(vm)));
+		break; case OP_CVT_DOUBLE_I64:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_d_i64(StackVMPop(vm)));
+		break; case OP_CVT_FLOAT_DOUBLE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_f_d(StackVMPop(vm)));
+		break; case OP_CVT_DOUBLE_FLOAT:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_d_f(StackVMPop(vm)));
+
 		/******************************************************/
 
 		break; case OP_ADD:
@@ -94,6 +430,8 @@ InterpretResult StackVMRun(StackVM* vm, Chunk* chunk)
 			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
 			QWORD val1 = StackVMPop(vm);
 			QWORD val2 = StackVMPop(vm);
+			if (chunk->is_quickening)
+				impl_stack_vm_quicken(ip - 1, OP_ADD, *ip);
 			StackVMPush(vm, OpCode_Sum(val1, val2, *(ip++)));
 		}
 		break; case OP_SUBTRACT:
@@ -101,6 +439,8 @@ InterpretResult StackVMRun(StackVM* vm, Chunk* chunk)
 			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
 			QWORD val1 = StackVMPop(vm);
 			QWORD val2 = StackVMPop(vm);
+			if (chunk->is_quickening)
+				impl_stack_vm_quicken(ip - 1, OP_SUBTRACT, *ip);
 			StackVMPush(vm, OpCode_Difference(val1, val2, *(ip++)));
 		}
 		break; case OP_MULTIPLY:
@@ -108,6 +448,8 @@ InterpretResult StackVMRun(StackVM* vm, Chunk* chunk)
 			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
 			QWORD val1 = StackVMPop(vm);
 			QWORD val2 = StackVMPop(vm);
+			if (chunk->is_quickening)
+				impl_stack_vm_quicken(ip - 1, OP_MULTIPLY, *ip);
 			StackVMPush(vm, OpCode_Multiply(val1, val2, *(ip++)));
 		}
 		break; case OP_DIVIDE:
@@ -117,18 +459,982 @@ InterpretResult StackVMRun(StackVM* vm, Chunk* chunk)
 			QWORD val2 = StackVMPop(vm);
 			StackVMPush(vm, OpCode_Divide(val1, val2, *(ip++)));
 		}
+		break; case OP_MODULO:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_Modulo(val1, val2, *(ip++)));
+		}
+
+		/******************************************************/
+
+			//The quickened OpCodes skip their padding, which is the OperandType they imply
+		break; case OP_ADD_I64:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			ip++;
+			vm->stack_top[-2].i64 = vm->stack_top[-1].i64 + vm->stack_top[-2].i64;
+			vm->stack_top--;
+		break; case OP_ADD_DOUBLE:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			ip++;
+			vm->stack_top[-2].d = vm->stack_top[-1].d + vm->stack_top[-2].d;
+			vm->stack_top--;
+		break; case OP_SUBTRACT_I64:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			ip++;
+			vm->stack_top[-2].i64 = vm->stack_top[-1].i64 - vm->stack_top[-2].i64;
+			vm->stack_top--;
+		break; case OP_SUBTRACT_DOUBLE:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			ip++;
+			vm->stack_top[-2].d = vm->stack_top[-1].d - vm->stack_top[-2].d;
+			vm->stack_top--;
+		break; case OP_MULTIPLY_I64:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			ip++;
+			vm->stack_top[-2].i64 = vm->stack_top[-1].i64 * vm->stack_top[-2].i64;
+			vm->stack_top--;
+		break; case OP_MULTIPLY_DOUBLE:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			ip++;
+			vm->stack_top[-2].d = vm->stack_top[-1].d * vm->stack_top[-2].d;
+			vm->stack_top--;
+
+		/******************************************************/
+
+		break; case OP_ADD_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_SumChecked(val1, val2, *(ip++), &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_ADD_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_SUBTRACT_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_DifferenceChecked(val1, val2, *(ip++), &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_SUBTRACT_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_MULTIPLY_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_MultiplyChecked(val1, val2, *(ip++), &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_MULTIPLY_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_DIVIDE_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_DivideChecked(val1, val2, *(ip++), &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_DIVIDE_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_MODULO_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_ModuloChecked(val1, val2, *(ip++), &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_MODULO_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_ADD_WRAPPING:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_SumWrapping(val1, val2, *(ip++)));
+		}
+		break; case OP_SUBTRACT_WRAPPING:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_DifferenceWrapping(val1, val2, *(ip++)));
+		}
+		break; case OP_MULTIPLY_WRAPPING:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_MultiplyWrapping(val1, val2, *(ip++)));
+		}
+		break; case OP_DIVIDE_CONST:
+		{
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			OperandType type = *(ip++);
+			const Divisor* divisor = chunk->divisors + unsafe_get_word(&ip).ui16;
+			StackVMPush(vm, OpCode_DivideByConstant(StackVMPop(vm), divisor, type));
+		}
+		break; case OP_MODULO_CONST:
+		{
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			OperandType type = *(ip++);
+			const Divisor* divisor = chunk->divisors + unsafe_get_word(&ip).ui16;
+			StackVMPush(vm, OpCode_ModuloByConstant(StackVMPop(vm), divisor, type));
+		}
+
+		/******************************************************/
+
+		break; case OP_ARRAY_NEW:
+		case OP_ARRAY_LENGTH:
+		case OP_ARRAY_GET:
+		case OP_ARRAY_SET:
+		case OP_ARRAY_ADD:
+		case OP_ARRAY_SUBTRACT:
+		case OP_ARRAY_MULTIPLY:
+		case OP_ARRAY_DIVIDE:
+		case OP_ARRAY_NEGATE:
+		case OP_ARRAY_SUM:
+		case OP_ARRAY_MIN:
+		case OP_ARRAY_MAX:
+		case OP_ARRAY_DOT:
+		{
+			//A single dispatch runs the kernel on the whole array
+			OperandType type = *(ip++);
+			ArrayError error = impl_stack_vm_run_array(vm, ip[-2], type, type);
+			if (error != ARRAY_OK)
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, ArrayErrorToString(error));
+		}
+		break; case OP_ARRAY_CONVERT:
+		{
+			OperandType from = *(ip++);
+			OperandType to = *(ip++);
+			impl_stack_vm_run_array(vm, OP_ARRAY_CONVERT, from, to);
+		}
+
+		/******************************************************/
+
+		break; case OP_ENTER:
+		{
+			//The arguments pushed by the caller are the first slots of the frame
+			QWORD* frame = vm->stack_top - ip[0];
+			QWORD* frame_end = frame + ip[1];
+			if (frame_end + chunk->max_stack_depth > vm->stack + STACK_VM_STACK_SIZE)
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 1 - chunk->code, "Stack overflow");
+			memset(vm->stack_top, 0, (frame_end - vm->stack_top) * sizeof(QWORD));
+			vm->stack_top = frame_end;
+			locals = frame;
+			ip += 2;
+		}
+		break; case OP_CALL:
+		{
+			uint64_t offset = ip - 1 - chunk->code;
+			uint8_t* target = chunk->code + unsafe_get_dword(&ip).ui32;
+			if (vm->frame_count == STACK_VM_MAX_FRAMES)
+				return impl_stack_vm_runtime_error(vm, chunk, offset, "Call stack overflow");
+			StackVMFrame* frame = vm->frames + vm->frame_count++;
+			frame->return_ip = ip;
+			frame->locals = locals;
+			ip = target;
+		}
+		break; case OP_TAIL_CALL:
+		{
+			//The arguments replace the frame of the caller (their number follows the OP_ENTER of the function)
+			uint8_t* target = chunk->code + unsafe_get_dword(&ip).ui32;
+			uint8_t arg_count = target[1];
+			memmove(locals, vm->stack_top - arg_count, arg_count * sizeof(QWORD));
+			vm->stack_top = locals + arg_count;
+			ip = target;
+		}
+		/******************************************************/
+
+		break; case OP_JUMP:
+		{
+			//The offsets are relative to the beginning of the jump
+			uint8_t* start = ip - 1;
+			ip = start + unsafe_get_dword(&ip).i32;
+		}
+		break; case OP_JUMP_IF_FALSE:
+		{
+			uint8_t* start = ip - 1;
+			int32_t relative = unsafe_get_dword(&ip).i32;
+			if (!StackVMPop(vm).b)
+				ip = start + relative;
+		}
+		break; case OP_JUMP_IF_LESS:
+		case OP_JUMP_IF_LESS_EQUAL:
+		case OP_JUMP_IF_EQUAL:
+		case OP_JUMP_IF_NOT_EQUAL:
+		{
+			uint8_t* start = ip - 1;
+			OperandType type = *(ip++);
+			int32_t relative = unsafe_get_dword(&ip).i32;
+			QWORD left = StackVMPop(vm);
+			QWORD right = StackVMPop(vm);
+			if (OpCode_Compare(*start, left, right, type))
+				ip = start + relative;
+		}
+		break; case OP_JUMP_TABLE:
+		{
+			uint8_t* start = ip - 1;
+			uint32_t case_count = unsafe_get_dword(&ip).ui32;
+			//Indices out of the cases jump to the default case, which follows them
+			uint64_t index = StackVMPop(vm).ui64;
+			ip = start + ((const int32_t*)ip)[index < case_count ? index : case_count];
+		}
+		break; case OP_LOOP:
+		{
+			uint8_t* start = ip - 1;
+			atomicFetchAdd(&chunk->loop_counters[unsafe_get_dword(&ip).ui32], 1);
+			ip = start + unsafe_get_dword(&ip).i32;
+		}
+
 		/******************************************************/
 
 		break; case OP_PRINT:
 		{
 			colti_assert(!StackVMIsEmpty(vm), "Stack was empty!");
-			OpCode_Print(StackVMTop(vm), *(ip++));
+			OpCode_Print(StackVMTop(vm), *(ip++), &vm->output);
 		}
 		break; case OP_RETURN:
-			return INTERPRET_OK;
+			if (vm->frame_count == 0)
+			{
+				VMOutputFlush(&vm->output);
+				return INTERPRET_OK;
+			}
+			else
+			{
+				//The result replaces the frame of the function
+				const StackVMFrame* frame = vm->frames + --vm->frame_count;
+				locals[0] = StackVMTop(vm);
+				vm->stack_top = locals + 1;
+				locals = frame->locals;
+				ip = frame->return_ip;
+			}
 
-		break; default:
-			break;
+		break; default: //The chunk was verified
+			colti_unreachable();
 		}
 	}
-}
\ No newline at end of file
+}
+
+InterpretResult impl_stack_vm_run_compact(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget)
+{
+	QWORD* locals = vm->locals;
+	OperandType type = COLTI_BOOL;
+	for (;; --budget)
+	{
+		if (budget == 0)
+		{
+			vm->locals = locals;
+			vm->ip = ip;
+			return INTERPRET_YIELD;
+		}
+		//Decodes the OpCode and its OperandType, then advances the pointer
+		switch (unsafe_get_compact_opcode(&ip, &type))
+		{
+
+			/******************************************************/
+
+		break; case OP_IMMEDIATE_BYTE:
+		{
+			QWORD qword = { .ui64 = unsafe_get_byte(&ip).ui8 };
+			StackVMPush(vm, qword);
+		}
+		break; case OP_IMMEDIATE_WORD:
+		case OP_IMMEDIATE_DWORD:
+		{
+			QWORD qword = { .ui64 = unsafe_get_uleb128(&ip) };
+			StackVMPush(vm, qword);
+		}
+		break; case OP_IMMEDIATE_QWORD:
+		{
+			QWORD qword = { .i64 = impl_zigzag_decode(unsafe_get_uleb128(&ip)) };
+			StackVMPush(vm, qword);
+		}
+
+		/******************************************************/
+
+		break; case OP_LOAD_CONST_BYTE:
+			colti_assert(*ip < chunk->constant_count, "Invalid constant index!");
+			StackVMPush(vm, chunk->constants[unsafe_get_byte(&ip).ui8]);
+		break; case OP_LOAD_CONST_WORD:
+		{
+			uint64_t index = unsafe_get_uleb128(&ip);
+			colti_assert(index < chunk->constant_count, "Invalid constant index!");
+			StackVMPush(vm, chunk->constants[index]);
+		}
+
+		/******************************************************/
+
+		break; case OP_LOAD_LOCAL_BYTE:
+			StackVMPush(vm, locals[unsafe_get_byte(&ip).ui8]);
+		break; case OP_LOAD_LOCAL_WORD:
+			StackVMPush(vm, locals[unsafe_get_uleb128(&ip)]);
+		break; case OP_STORE_LOCAL_BYTE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			locals[unsafe_get_byte(&ip).ui8] = StackVMPop(vm);
+		break; case OP_STORE_LOCAL_WORD:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			locals[unsafe_get_uleb128(&ip)] = StackVMPop(vm);
+		break; case OP_INC_LOCAL_BYTE:
+		{
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			QWORD* local = locals + unsafe_get_byte(&ip).ui8;
+			*local = OpCode_Sum(*local, StackVMPop(vm), type);
+		}
+		break; case OP_INC_LOCAL_WORD:
+		{
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			QWORD* local = locals + unsafe_get_uleb128(&ip);
+			*local = OpCode_Sum(*local, StackVMPop(vm), type);
+		}
+
+		/******************************************************/
+
+		break; case OP_LOAD_GLOBAL:
+			StackVMPush(vm, vm->globals[unsafe_get_uleb128(&ip)]);
+		break; case OP_STORE_GLOBAL:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			vm->globals[unsafe_get_uleb128(&ip)] = StackVMPop(vm);
+
+		/******************************************************/
+
+		break; case OP_BOX:
+		{
+			QWORD tag = { .ui64 = type };
+			StackVMPush(vm, tag);
+		}
+		break; case OP_UNBOX:
+			//OP_UNBOX is never fused, so the OpCode precedes the OperandType
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			if (StackVMPop(vm).ui64 != type)
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, "Dynamic value of an unexpected type");
+			//The dynamically typed OpCodes are never fused, so the OpCode is the byte preceding the index of the cache
+		break; case OP_ADD_DYNAMIC:
+		{
+			uint8_t* instr = ip - 1;
+			if (!impl_stack_vm_add_dynamic(vm, chunk, instr, unsafe_get_uleb128(&ip)))
+				return impl_stack_vm_runtime_error(vm, chunk, instr - chunk->code, "Dynamic operands of different or invalid types");
+		}
+		break; case OP_ADD_DYNAMIC_I64:
+		{
+			uint8_t* instr = ip - 1;
+			uint64_t cache = unsafe_get_uleb128(&ip);
+			QWORD* top = vm->stack_top;
+			if (top[-1].ui64 == OPERAND_COLTI_I64 && top[-3].ui64 == OPERAND_COLTI_I64)
+			{
+				top[-4].i64 = top[-2].i64 + top[-4].i64;
+				vm->stack_top -= 2;
+			}
+			else if (!impl_stack_vm_add_dynamic(vm, chunk, instr, cache))
+				return impl_stack_vm_runtime_error(vm, chunk, instr - chunk->code, "Dynamic operands of different or invalid types");
+		}
+		break; case OP_ADD_DYNAMIC_DOUBLE:
+		{
+			uint8_t* instr = ip - 1;
+			uint64_t cache = unsafe_get_uleb128(&ip);
+			QWORD* top = vm->stack_top;
+			if (top[-1].ui64 == OPERAND_COLTI_DOUBLE && top[-3].ui64 == OPERAND_COLTI_DOUBLE)
+			{
+				top[-4].d = top[-2].d + top[-4].d;
+				vm->stack_top -= 2;
+			}
+			else if (!impl_stack_vm_add_dynamic(vm, chunk, instr, cache))
+				return impl_stack_vm_runtime_error(vm, chunk, instr - chunk->code, "Dynamic operands of different or invalid types");
+		}
+		break; case OP_ADD_DYNAMIC_POLY:
+		{
+			uint8_t* instr = ip - 1;
+			uint64_t cache = unsafe_get_uleb128(&ip);
+			QWORD* top = vm->stack_top;
+			if (top[-1].ui64 == top[-3].ui64 && InlineCacheContains(chunk->inline_caches + cache, top[-1].ui64))
+			{
+				top[-4] = OpCode_Sum(top[-2], top[-4], (OperandType)top[-1].ui64);
+				vm->stack_top -= 2;
+			}
+			else if (!impl_stack_vm_add_dynamic(vm, chunk, instr, cache))
+				return impl_stack_vm_runtime_error(vm, chunk, instr - chunk->code, "Dynamic operands of different or invalid types");
+		}
+
+		/******************************************************/
+
+		break; case OP_NEGATE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, OpCode_Negate(StackVMPop(vm), type));
+
+		break; case OP_CONVERT:
+		{
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			//Both types are packed in a byte
+			uint8_t packed = *(ip++);
+			StackVMPush(vm, OpCode_Convert(StackVMPop(vm), packed / OPERAND_TYPE_COUNT, packed % OPERAND_TYPE_COUNT));
+		}
+
+		break; case OP_CVT_I32_I64:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_i32_i64(StackVMPop(vm)));
+		break; case OP_CVT_I64_I32:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_i64_i32(StackVMPop(vm)));
+		break; case OP_CVT_I32_DOUBLE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_i32_d(StackVMPop(vm)));
+		break; case OP_CVT_DOUBLE_I32:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_d_i32(StackVMPop(vm)));
+		break; case OP_CVT_I64_DOUBLE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_i64_d(StackVMPop(vm)));
+		break; case OP_CVT_DOUBLE_I64:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_d_i64(StackVMPop(vm)));
+		break; case OP_CVT_FLOAT_DOUBLE:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_f_d(StackVMPop(vm)));
+		break; case OP_CVT_DOUBLE_FLOAT:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, impl_convert_d_f(StackVMPop(vm)));
+
+		/******************************************************/
+
+		break; case OP_ADD:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			//Only the fused form takes a single byte, as the quickened OpCode
+			if (chunk->is_quickening && ip[-1] >= COMPACT_FUSED_BASE)
+				impl_stack_vm_quicken(ip - 1, OP_ADD, type);
+			StackVMPush(vm, OpCode_Sum(val1, val2, type));
+		}
+		break; case OP_SUBTRACT:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			if (chunk->is_quickening && ip[-1] >= COMPACT_FUSED_BASE)
+				impl_stack_vm_quicken(ip - 1, OP_SUBTRACT, type);
+			StackVMPush(vm, OpCode_Difference(val1, val2, type));
+		}
+		break; case OP_MULTIPLY:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			if (chunk->is_quickening && ip[-1] >= COMPACT_FUSED_BASE)
+				impl_stack_vm_quicken(ip - 1, OP_MULTIPLY, type);
+			StackVMPush(vm, OpCode_Multiply(val1, val2, type));
+		}
+		break; case OP_DIVIDE:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_Divide(val1, val2, type));
+		}
+		break; case OP_MODULO:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_Modulo(val1, val2, type));
+		}
+
+		/******************************************************/
+
+			//The quickened OpCodes are a single byte, as their OperandType is implied
+		break; case OP_ADD_I64:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			vm->stack_top[-2].i64 = vm->stack_top[-1].i64 + vm->stack_top[-2].i64;
+			vm->stack_top--;
+		break; case OP_ADD_DOUBLE:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			vm->stack_top[-2].d = vm->stack_top[-1].d + vm->stack_top[-2].d;
+			vm->stack_top--;
+		break; case OP_SUBTRACT_I64:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			vm->stack_top[-2].i64 = vm->stack_top[-1].i64 - vm->stack_top[-2].i64;
+			vm->stack_top--;
+		break; case OP_SUBTRACT_DOUBLE:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			vm->stack_top[-2].d = vm->stack_top[-1].d - vm->stack_top[-2].d;
+			vm->stack_top--;
+		break; case OP_MULTIPLY_I64:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			vm->stack_top[-2].i64 = vm->stack_top[-1].i64 * vm->stack_top[-2].i64;
+			vm->stack_top--;
+		break; case OP_MULTIPLY_DOUBLE:
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			vm->stack_top[-2].d = vm->stack_top[-1].d * vm->stack_top[-2].d;
+			vm->stack_top--;
+
+		/******************************************************/
+
+		break; case OP_ADD_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_SumChecked(val1, val2, type, &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_ADD_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_SUBTRACT_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_DifferenceChecked(val1, val2, type, &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_SUBTRACT_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_MULTIPLY_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_MultiplyChecked(val1, val2, type, &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_MULTIPLY_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_DIVIDE_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_DivideChecked(val1, val2, type, &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_DIVIDE_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_MODULO_CHECKED:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			QWORD result;
+			if (!OpCode_ModuloChecked(val1, val2, type, &result))
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_MODULO_CHECKED));
+			StackVMPush(vm, result);
+		}
+		break; case OP_ADD_WRAPPING:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_SumWrapping(val1, val2, type));
+		}
+		break; case OP_SUBTRACT_WRAPPING:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_DifferenceWrapping(val1, val2, type));
+		}
+		break; case OP_MULTIPLY_WRAPPING:
+		{
+			colti_assert(StackVMSize(vm) >= 2, "Stack should contain at least 2 items!");
+			QWORD val1 = StackVMPop(vm);
+			QWORD val2 = StackVMPop(vm);
+			StackVMPush(vm, OpCode_MultiplyWrapping(val1, val2, type));
+		}
+		break; case OP_DIVIDE_CONST:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, OpCode_DivideByConstant(StackVMPop(vm), chunk->divisors + unsafe_get_uleb128(&ip), type));
+		break; case OP_MODULO_CONST:
+			colti_assert(!StackVMIsEmpty(vm), "Stack should contain at least 1 items!");
+			StackVMPush(vm, OpCode_ModuloByConstant(StackVMPop(vm), chunk->divisors + unsafe_get_uleb128(&ip), type));
+
+		/******************************************************/
+
+		break; case OP_ARRAY_NEW:
+		case OP_ARRAY_LENGTH:
+		case OP_ARRAY_GET:
+		case OP_ARRAY_SET:
+		case OP_ARRAY_ADD:
+		case OP_ARRAY_SUBTRACT:
+		case OP_ARRAY_MULTIPLY:
+		case OP_ARRAY_DIVIDE:
+		case OP_ARRAY_NEGATE:
+		case OP_ARRAY_SUM:
+		case OP_ARRAY_MIN:
+		case OP_ARRAY_MAX:
+		case OP_ARRAY_DOT:
+		{
+			//The array OpCodes are never fused, so the OpCode precedes the OperandType
+			ArrayError error = impl_stack_vm_run_array(vm, ip[-2], type, type);
+			if (error != ARRAY_OK)
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, ArrayErrorToString(error));
+		}
+		break; case OP_ARRAY_CONVERT:
+		{
+			uint8_t packed = *(ip++);
+			impl_stack_vm_run_array(vm, OP_ARRAY_CONVERT, packed / OPERAND_TYPE_COUNT, packed % OPERAND_TYPE_COUNT);
+		}
+
+		/******************************************************/
+
+		break; case OP_ENTER:
+		{
+			//The arguments pushed by the caller are the first slots of the frame
+			QWORD* frame = vm->stack_top - ip[0];
+			QWORD* frame_end = frame + ip[1];
+			if (frame_end + chunk->max_stack_depth > vm->stack + STACK_VM_STACK_SIZE)
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 1 - chunk->code, "Stack overflow");
+			memset(vm->stack_top, 0, (frame_end - vm->stack_top) * sizeof(QWORD));
+			vm->stack_top = frame_end;
+			locals = frame;
+			ip += 2;
+		}
+		break; case OP_CALL:
+		{
+			uint64_t offset = ip - 1 - chunk->code;
+			uint8_t* target = chunk->code + unsafe_get_compact_target(&ip);
+			if (vm->frame_count == STACK_VM_MAX_FRAMES)
+				return impl_stack_vm_runtime_error(vm, chunk, offset, "Call stack overflow");
+			StackVMFrame* frame = vm->frames + vm->frame_count++;
+			frame->return_ip = ip;
+			frame->locals = locals;
+			ip = target;
+		}
+		break; case OP_TAIL_CALL:
+		{
+			//The arguments replace the frame of the caller (their number follows the OP_ENTER of the function)
+			uint8_t* target = chunk->code + unsafe_get_compact_target(&ip);
+			uint8_t arg_count = target[1];
+			memmove(locals, vm->stack_top - arg_count, arg_count * sizeof(QWORD));
+			vm->stack_top = locals + arg_count;
+			ip = target;
+		}
+		/******************************************************/
+
+		break; case OP_JUMP:
+		{
+			//The offsets are relative to the beginning of the jump
+			uint8_t* start = ip - 1;
+			ip = start + (int32_t)unsafe_get_compact_target(&ip);
+		}
+		break; case OP_JUMP_IF_FALSE:
+		{
+			uint8_t* start = ip - 1;
+			int32_t relative = (int32_t)unsafe_get_compact_target(&ip);
+			if (!StackVMPop(vm).b)
+				ip = start + relative;
+		}
+		break; case OP_JUMP_IF_LESS:
+		case OP_JUMP_IF_LESS_EQUAL:
+		case OP_JUMP_IF_EQUAL:
+		case OP_JUMP_IF_NOT_EQUAL:
+		{
+			//The OperandType was decoded with the OpCode
+			uint8_t* start = ip - 2;
+			int32_t relative = (int32_t)unsafe_get_compact_target(&ip);
+			QWORD left = StackVMPop(vm);
+			QWORD right = StackVMPop(vm);
+			if (OpCode_Compare(*start, left, right, type))
+				ip = start + relative;
+		}
+		break; case OP_JUMP_TABLE:
+		{
+			uint8_t* start = ip - 1;
+			uint64_t case_count = unsafe_get_uleb128(&ip);
+			//Indices out of the cases jump to the default case, which follows them
+			uint64_t index = StackVMPop(vm).ui64;
+			ip = start + impl_chunk_jump_table_offset(ip, index < case_count ? index : case_count);
+		}
+		break; case OP_LOOP:
+		{
+			uint8_t* start = ip - 1;
+			atomicFetchAdd(&chunk->loop_counters[unsafe_get_uleb128(&ip)], 1);
+			ip = start + (int32_t)unsafe_get_compact_target(&ip);
+		}
+
+		/******************************************************/
+
+		break; case OP_PRINT:
+		{
+			colti_assert(!StackVMIsEmpty(vm), "Stack was empty!");
+			OpCode_Print(StackVMTop(vm), type, &vm->output);
+		}
+		break; case OP_RETURN:
+			if (vm->frame_count == 0)
+			{
+				VMOutputFlush(&vm->output);
+				return INTERPRET_OK;
+			}
+			else
+			{
+				//The result replaces the frame of the function
+				const StackVMFrame* frame = vm->frames + --vm->frame_count;
+				locals[0] = StackVMTop(vm);
+				vm->stack_top = locals + 1;
+				locals = frame->locals;
+				ip = frame->return_ip;
+			}
+
+		break; default: //The chunk was verified
+			colti_unreachable();
+		}
+	}
+}
+InterpretResult impl_stack_vm_run_monomorphic(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget)
+{
+	switch (chunk->operand_type)
+	{
+	break; case OPERAND_COLTI_I8:		return impl_stack_vm_run_i8(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_I16:		return impl_stack_vm_run_i16(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_I32:		return impl_stack_vm_run_i32(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_I64:		return impl_stack_vm_run_i64(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_UI8:		return impl_stack_vm_run_ui8(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_UI16:		return impl_stack_vm_run_ui16(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_UI32:		return impl_stack_vm_run_ui32(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_UI64:		return impl_stack_vm_run_ui64(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_FLOAT:	return impl_stack_vm_run_f(vm, chunk, ip, budget);
+	break; case OPERAND_COLTI_DOUBLE:	return impl_stack_vm_run_d(vm, chunk, ip, budget);
+	break; default: //A chunk of bools can only print them, which does not need specializing
+		return impl_stack_vm_run_aligned(vm, chunk, ip, budget);
+	}
+}
+
+/// @brief Defines the run function 'impl_stack_vm_run_##member', specialized for chunks whose typed
+/// instructions all operate on 'type' (whose QWORD member is 'member').
+/// As the chunk was verified, the OperandType following typed instructions is skipped without being read.
+#define IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(member, type) \
+InterpretResult impl_stack_vm_run_##member(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget) \
+{ \
+	/* Points past the top of the stack, written back to the VM when returning */ \
+	QWORD* top = vm->stack_top; \
+	QWORD* locals = vm->locals; \
+	for (;; --budget) \
+	{ \
+		if (budget == 0) \
+		{ \
+			vm->stack_top = top; \
+			vm->locals = locals; \
+			vm->ip = ip; \
+			return INTERPRET_YIELD; \
+		} \
+		switch (*(ip++)) \
+		{ \
+		break; case OP_IMMEDIATE_BYTE:		(top++)->ui64 = unsafe_get_byte(&ip).ui8; \
+		break; case OP_IMMEDIATE_WORD:		(top++)->ui64 = unsafe_get_word(&ip).ui16; \
+		break; case OP_IMMEDIATE_DWORD:		(top++)->ui64 = unsafe_get_dword(&ip).ui32; \
+		break; case OP_IMMEDIATE_QWORD:		*(top++) = unsafe_get_qword(&ip); \
+		break; case OP_LOAD_CONST_BYTE:		*(top++) = chunk->constants[unsafe_get_byte(&ip).ui8]; \
+		break; case OP_LOAD_CONST_WORD:		*(top++) = chunk->constants[unsafe_get_word(&ip).ui16]; \
+		break; case OP_LOAD_LOCAL_BYTE:		*(top++) = locals[unsafe_get_byte(&ip).ui8]; \
+		break; case OP_LOAD_LOCAL_WORD:		*(top++) = locals[unsafe_get_word(&ip).ui16]; \
+		break; case OP_STORE_LOCAL_BYTE:	locals[unsafe_get_byte(&ip).ui8] = *(--top); \
+		break; case OP_STORE_LOCAL_WORD:	locals[unsafe_get_word(&ip).ui16] = *(--top); \
+		break; case OP_INC_LOCAL_BYTE: \
+		{ \
+			ip++; \
+			QWORD* local = locals + unsafe_get_byte(&ip).ui8; \
+			local->member = local->member + (--top)->member; \
+		} \
+		break; case OP_INC_LOCAL_WORD: \
+		{ \
+			ip++; \
+			QWORD* local = locals + unsafe_get_word(&ip).ui16; \
+			local->member = local->member + (--top)->member; \
+		} \
+		break; case OP_LOAD_GLOBAL:			*(top++) = vm->globals[unsafe_get_word(&ip).ui16]; \
+		break; case OP_STORE_GLOBAL:		vm->globals[unsafe_get_word(&ip).ui16] = *(--top); \
+		break; case OP_NEGATE:				ip++; top[-1].member = -top[-1].member; \
+		/* The left operand is the top of the stack, see OpCode_Sum. A quickened OpCode implies the type of the chunk. */ \
+		break; case OP_ADD: case OP_ADD_I64: case OP_ADD_DOUBLE: \
+			ip++; top[-2].member = top[-1].member + top[-2].member; top--; \
+		break; case OP_SUBTRACT: case OP_SUBTRACT_I64: case OP_SUBTRACT_DOUBLE: \
+			ip++; top[-2].member = top[-1].member - top[-2].member; top--; \
+		break; case OP_MULTIPLY: case OP_MULTIPLY_I64: case OP_MULTIPLY_DOUBLE: \
+			ip++; top[-2].member = top[-1].member * top[-2].member; top--; \
+		break; case OP_DIVIDE:				ip++; top[-2].member = top[-1].member / top[-2].member; top--; \
+		break; case OP_MODULO:				ip++; top[-2] = OpCode_Modulo(top[-1], top[-2], type); top--; \
+		break; case OP_ADD_CHECKED: \
+			ip++; \
+			if (!OpCode_SumChecked(top[-1], top[-2], type, &top[-2])) \
+			{ \
+				vm->stack_top = top - 2; \
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_ADD_CHECKED)); \
+			} \
+			top--; \
+		break; case OP_SUBTRACT_CHECKED: \
+			ip++; \
+			if (!OpCode_DifferenceChecked(top[-1], top[-2], type, &top[-2])) \
+			{ \
+				vm->stack_top = top - 2; \
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_SUBTRACT_CHECKED)); \
+			} \
+			top--; \
+		break; case OP_MULTIPLY_CHECKED: \
+			ip++; \
+			if (!OpCode_MultiplyChecked(top[-1], top[-2], type, &top[-2])) \
+			{ \
+				vm->stack_top = top - 2; \
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_MULTIPLY_CHECKED)); \
+			} \
+			top--; \
+		break; case OP_DIVIDE_CHECKED: \
+			ip++; \
+			if (!OpCode_DivideChecked(top[-1], top[-2], type, &top[-2])) \
+			{ \
+				vm->stack_top = top - 2; \
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_DIVIDE_CHECKED)); \
+			} \
+			top--; \
+		break; case OP_MODULO_CHECKED: \
+			ip++; \
+			if (!OpCode_ModuloChecked(top[-1], top[-2], type, &top[-2])) \
+			{ \
+				vm->stack_top = top - 2; \
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 2 - chunk->code, OpCodeCheckedErrorToString(OP_MODULO_CHECKED)); \
+			} \
+			top--; \
+		break; case OP_ADD_WRAPPING:		ip++; top[-2] = OpCode_SumWrapping(top[-1], top[-2], type); top--; \
+		break; case OP_SUBTRACT_WRAPPING:		ip++; top[-2] = OpCode_DifferenceWrapping(top[-1], top[-2], type); top--; \
+		break; case OP_MULTIPLY_WRAPPING:		ip++; top[-2] = OpCode_MultiplyWrapping(top[-1], top[-2], type); top--; \
+		break; case OP_DIVIDE_CONST: \
+			ip++; \
+			top[-1] = OpCode_DivideByConstant(top[-1], chunk->divisors + unsafe_get_word(&ip).ui16, type); \
+		break; case OP_MODULO_CONST: \
+			ip++; \
+			top[-1] = OpCode_ModuloByConstant(top[-1], chunk->divisors + unsafe_get_word(&ip).ui16, type); \
+		break; case OP_PRINT:				ip++; OpCode_Print(top[-1], type, &vm->output); \
+		break; case OP_ENTER: \
+		{ \
+			QWORD* frame = top - ip[0]; \
+			QWORD* frame_end = frame + ip[1]; \
+			if (frame_end + chunk->max_stack_depth > vm->stack + STACK_VM_STACK_SIZE) \
+			{ \
+				vm->stack_top = top; \
+				return impl_stack_vm_runtime_error(vm, chunk, ip - 1 - chunk->code, "Stack overflow"); \
+			} \
+			memset(top, 0, (frame_end - top) * sizeof(QWORD)); \
+			top = frame_end; \
+			locals = frame; \
+			ip += 2; \
+		} \
+		break; case OP_CALL: \
+		{ \
+			uint64_t offset = ip - 1 - chunk->code; \
+			uint8_t* target = chunk->code + unsafe_get_dword(&ip).ui32; \
+			if (vm->frame_count == STACK_VM_MAX_FRAMES) \
+			{ \
+				vm->stack_top = top; \
+				return impl_stack_vm_runtime_error(vm, chunk, offset, "Call stack overflow"); \
+			} \
+			StackVMFrame* frame = vm->frames + vm->frame_count++; \
+			frame->return_ip = ip; \
+			frame->locals = locals; \
+			ip = target; \
+		} \
+		break; case OP_TAIL_CALL: \
+		{ \
+			uint8_t* target = chunk->code + unsafe_get_dword(&ip).ui32; \
+			uint8_t arg_count = target[1]; \
+			memmove(locals, top - arg_count, arg_count * sizeof(QWORD)); \
+			top = locals + arg_count; \
+			ip = target; \
+		} \
+		break; case OP_JUMP: \
+		{ \
+			uint8_t* start = ip - 1; \
+			ip = start + unsafe_get_dword(&ip).i32; \
+		} \
+		break; case OP_JUMP_IF_FALSE: \
+		{ \
+			uint8_t* start = ip - 1; \
+			int32_t relative = unsafe_get_dword(&ip).i32; \
+			if (!(--top)->b) \
+				ip = start + relative; \
+		} \
+		break; case OP_JUMP_IF_LESS: \
+		{ \
+			uint8_t* start = ip - 1; \
+			ip++; \
+			int32_t relative = unsafe_get_dword(&ip).i32; \
+			top -= 2; \
+			if (top[1].member < top[0].member) \
+				ip = start + relative; \
+		} \
+		break; case OP_JUMP_IF_LESS_EQUAL: \
+		{ \
+			uint8_t* start = ip - 1; \
+			ip++; \
+			int32_t relative = unsafe_get_dword(&ip).i32; \
+			top -= 2; \
+			if (top[1].member <= top[0].member) \
+				ip = start + relative; \
+		} \
+		break; case OP_JUMP_IF_EQUAL: \
+		{ \
+			uint8_t* start = ip - 1; \
+			ip++; \
+			int32_t relative = unsafe_get_dword(&ip).i32; \
+			top -= 2; \
+			if (top[1].member == top[0].member) \
+				ip = start + relative; \
+		} \
+		break; case OP_JUMP_IF_NOT_EQUAL: \
+		{ \
+			uint8_t* start = ip - 1; \
+			ip++; \
+			int32_t relative = unsafe_get_dword(&ip).i32; \
+			top -= 2; \
+			if (!(top[1].member == top[0].member)) \
+				ip = start + relative; \
+		} \
+		break; case OP_JUMP_TABLE: \
+		{ \
+			uint8_t* start = ip - 1; \
+			uint32_t case_count = unsafe_get_dword(&ip).ui32; \
+			uint64_t index = (--top)->ui64; \
+			ip = start + ((const int32_t*)ip)[index < case_count ? index : case_count]; \
+		} \
+		break; case OP_LOOP: \
+		{ \
+			uint8_t* start = ip - 1; \
+			atomicFetchAdd(&chunk->loop_counters[unsafe_get_dword(&ip).ui32], 1); \
+			ip = start + unsafe_get_dword(&ip).i32; \
+		} \
+		break; case OP_RETURN: \
+			if (vm->frame_count == 0) \
+			{ \
+				vm->stack_top = top; \
+				VMOutputFlush(&vm->output); \
+				return INTERPRET_OK; \
+			} \
+			else \
+			{ \
+				const StackVMFrame* frame = vm->frames + --vm->frame_count; \
+				locals[0] = top[-1]; \
+				top = locals + 1; \
+				locals = frame->locals; \
+				ip = frame->return_ip; \
+			} \
+		break; default: /* Conversions and arrays are polymorphic */ \
+			colti_unreachable(); \
+		} \
+	} \
+}
+
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(i8, OPERAND_COLTI_I8)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(i16, OPERAND_COLTI_I16)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(i32, OPERAND_COLTI_I32)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(i64, OPERAND_COLTI_I64)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(ui8, OPERAND_COLTI_UI8)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(ui16, OPERAND_COLTI_UI16)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(ui32, OPERAND_COLTI_UI32)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(ui64, OPERAND_COLTI_UI64)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(f, OPERAND_COLTI_FLOAT)
+IMPL_STACK_VM_DEFINE_MONOMORPHIC_RUN(d, OPERAND_COLTI_DOUBLE)
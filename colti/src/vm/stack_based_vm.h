@@ -4,6 +4,24 @@
 * To run code written in a Chunk, use StackVMRun(...) which takes
 * in a StackVM* (which should be initialized using StackVMInit(...)) and a Chunk
 * containing the code.
+* Everything printed by the VM goes through its VMOutput, which is flushed
+* on OP_RETURN and by StackVMFree(...).
+* StackVMRunFor(...) runs at most a budget of instructions, after which it
+* returns INTERPRET_YIELD, saving the instruction pointer in the VM: calling
+* it again with the same Chunk resumes the execution where it stopped.
+* This allows a host to interleave many scripts (each with its own StackVM) on a single thread.
+* The arrays created by the array OpCodes are owned by the VM, and freed by StackVMReset(...) and StackVMFree(...).
+* When a Chunk starts, the VM reserves the local slots of its frame (see Chunk.local_count) on the stack,
+* zero-initialized: the values pushed by the code are above them, and the frame stays on the stack when it returns.
+* Functions called by the code (OP_CALL) use the same stack: the arguments pushed by the caller are the first slots of
+* the frame of the function, and its result replaces them when it returns. The state of each call is saved in a
+* StackVMFrame of a fixed array, so a call never allocates. A tail call (OP_TAIL_CALL) reuses the frame of the caller
+* and does not push any StackVMFrame, so a function calling itself in tail position runs in constant memory.
+* The global slots of the Chunk are allocated by the VM, zero-initialized when the Chunk starts, and freed by StackVMFree(...).
+* The dynamically typed instructions update their InlineCache and rewrite themselves in the code of the Chunk
+* (see inline_cache.h), unless the Chunk is read-only.
+* The typed instructions of a Chunk whose quickening is enabled are rewritten to their quickened form the first time
+* they run (see quickening.h), which the polymorphic loops run without reading their OperandType.
 */
 
 #ifndef HG_COLTI_STACK_BASED_VM
@@ -12,7 +30,28 @@
 #include "common.h"
 
 #include "byte-code/chunk.h"
+#include "byte-code/compact_encoding.h"
+#include "byte-code/verifier.h"
+#include "byte-code/conversion.h"
+#include "byte-code/quickening.h"
+#include "util/thread.h"
+#include "byte-code/array.h"
 #include "values/colti_floating_value.h"
+#include "vm_output.h"
+
+/// @brief The number of QWORDs of the stack of a StackVM, shared by the frames of the Chunk and of the functions it calls
+#define STACK_VM_STACK_SIZE 16384
+/// @brief The maximum number of nested calls (not counting tail calls)
+#define STACK_VM_MAX_FRAMES 1024
+
+/// @brief The state of the caller of a function, saved by OP_CALL and restored by the OP_RETURN of the function
+typedef struct
+{
+	/// @brief The instruction following the OP_CALL
+	uint8_t* return_ip;
+	/// @brief The first local slot of the frame of the caller
+	QWORD* locals;
+} StackVMFrame;
 
 /// @brief VM containing a stack
 typedef struct
@@ -21,14 +60,46 @@ typedef struct
 	/// Points to where the next push should be written.
 	QWORD* stack_top;
 	/// @brief The stack-allocated stack
-	QWORD stack[256];
+	QWORD stack[STACK_VM_STACK_SIZE];
+	/// @brief The first local slot of the frame of the running (or suspended) function or Chunk
+	QWORD* locals;
+	/// @brief The callers of the running (or suspended) function, the last one being its caller
+	StackVMFrame frames[STACK_VM_MAX_FRAMES];
+	/// @brief The number of StackVMFrame in use (0 when running the code of the Chunk itself)
+	uint64_t frame_count;
+	/// @brief The instruction pointer saved when yielding, NULL if no Chunk is suspended
+	uint8_t* ip;
+	/// @brief The suspended Chunk, NULL if no Chunk is suspended
+	const Chunk* chunk;
+	/// @brief The buffered output to which OP_PRINT writes
+	VMOutput output;
+	/// @brief The arrays created by the code run by the VM, NULL if there are none
+	Array* arrays;
+	/// @brief The global slots of the running (or suspended) Chunk (see Chunk.globals), NULL if none were allocated
+	QWORD* globals;
+	/// @brief The number of QWORDs allocated for 'globals'
+	uint64_t global_capacity;
 } StackVM;
 
-/// @brief Initializes a StackVM
+/// @brief Initializes a StackVM, whose output is written to stdout
 /// @param vm The virtual machine to initialize
 void StackVMInit(StackVM* vm);
 
-/// @brief Frees the resources used by a StackVM
+/// @brief Initializes a StackVM, whose output is written to 'stream'
+/// @param vm The virtual machine to initialize
+/// @param stream The stream to which to write, or NULL to capture the output (see VMOutputTakeCapture)
+void StackVMInitWithStream(StackVM* vm, FILE* stream);
+
+/// @brief Empties the stack of a StackVM (freeing its arrays) and drops any suspended Chunk, so that it can be reused to run another Chunk
+/// @param vm The virtual machine to modify
+void StackVMReset(StackVM* vm);
+
+/// @brief Check if a StackVM yielded, and is waiting to be resumed
+/// @param vm The virtual machine for which to check
+/// @return True if StackVMRunFor returned INTERPRET_YIELD, and the Chunk did not return yet
+bool StackVMIsSuspended(const StackVM* vm);
+
+/// @brief Frees the resources used by a StackVM (including its arrays), flushing its output
 /// @param vm The virtual machine to modify
 void StackVMFree(StackVM* vm);
 
@@ -57,10 +128,104 @@ bool StackVMIsEmpty(const StackVM* vm);
 /// @return The count of QWORD pushed
 uint64_t StackVMSize(const StackVM* vm);
 
-/// @brief Runs code contained in a Chunk using an initialized StackVM
+/// @brief Runs code contained in a Chunk using an initialized StackVM.
+/// A chunk that was not verified yet is verified first, and rejected if it is invalid
+/// (INTERPRET_COMPILE_ERROR): the code itself is run without any check.
+/// Chunks using the compact encoding are decoded while running.
+/// If the chunk is suspended in the VM (see StackVMRunFor), it is resumed.
 /// @param vm The virtual machine in which to run
 /// @param chunk The chunk containing the code to run
 /// @return The result of the interpretation
 InterpretResult StackVMRun(StackVM* vm, Chunk* chunk);
 
+/// @brief Runs at most 'budget' instructions of a Chunk, starting from its beginning
+/// or resuming where the previous call yielded.
+/// The Chunk is only verified when starting it, once for all the threads running it concurrently (which wait for that
+/// verification). A suspended Chunk must not be modified nor freed,
+/// and must be resumed (or dropped using StackVMReset) before running another Chunk.
+/// @param vm The virtual machine in which to run
+/// @param chunk The chunk containing the code to run, which must be the suspended chunk if any
+/// @param budget The maximum number of instructions to run
+/// @return INTERPRET_YIELD if the budget was exhausted before OP_RETURN, else the result of the interpretation
+InterpretResult StackVMRunFor(StackVM* vm, Chunk* chunk, uint64_t budget);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Prints an error raised while running an instruction (with its source location if it is known),
+/// after flushing the output of the VM
+/// @param vm The virtual machine running the instruction
+/// @param chunk The chunk containing the instruction
+/// @param offset The offset of the instruction
+/// @param message The description of the error
+/// @return INTERPRET_RUNTIME_ERROR
+InterpretResult impl_stack_vm_runtime_error(StackVM* vm, const Chunk* chunk, uint64_t offset, const char* message);
+
+/// @brief Runs an array OpCode (whose operands were decoded) on the stack of a StackVM
+/// @param vm The virtual machine owning the arrays
+/// @param code The array OpCode
+/// @param type The OperandType of the values of the arrays
+/// @param to The type to which to convert the values, for OP_ARRAY_CONVERT
+/// @return ARRAY_OK, or the runtime error of the instruction
+ArrayError impl_stack_vm_run_array(StackVM* vm, uint8_t code, OperandType type, OperandType to);
+
+/// @brief Runs the generic path of a dynamically typed addition (see inline_cache.h) on the stack of a StackVM:
+/// adds the dynamic values, records their type in the InlineCache of the instruction, and rewrites the instruction
+/// to the form specialized for the types of its cache (counting a deoptimization if it was already specialized)
+/// @param vm The virtual machine whose stack contains the operands
+/// @param chunk The chunk containing the instruction
+/// @param instr Pointer to the OpCode of the instruction
+/// @param cache The index of the InlineCache of the instruction
+/// @return False if the tags of the operands are different, or not a valid type for an addition
+bool impl_stack_vm_add_dynamic(StackVM* vm, Chunk* chunk, uint8_t* instr, uint64_t cache);
+
+/// @brief Rewrites a typed instruction to its quickened form (see quickening.h), if it has one.
+/// The rewrite is atomic, as the code may be run concurrently by other threads.
+/// @param instr Pointer to the OpCode of the instruction (or to the fused OpCode, in the compact encoding)
+/// @param code The OpCode of the instruction
+/// @param type The OperandType of the instruction
+void impl_stack_vm_quicken(uint8_t* instr, uint8_t code, uint8_t type);
+
+/// @brief Runs code contained in a verified Chunk using the aligned encoding
+/// @param vm The virtual machine in which to run
+/// @param chunk The aligned chunk containing the code to run
+/// @param ip The instruction pointer from which to start
+/// @param budget The maximum number of instructions to run
+/// @return The result of the interpretation
+InterpretResult impl_stack_vm_run_aligned(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+
+/// @brief Runs code contained in a verified Chunk using the compact encoding
+/// @param vm The virtual machine in which to run
+/// @param chunk The compact chunk containing the code to run
+/// @param ip The instruction pointer from which to start
+/// @param budget The maximum number of instructions to run
+/// @return The result of the interpretation
+InterpretResult impl_stack_vm_run_compact(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+
+/// @brief Runs code contained in a verified Chunk using the aligned encoding, whose typed instructions
+/// all operate on the same type ('chunk->operand_type' is not CHUNK_POLYMORPHIC).
+/// Dispatches to the run function specialized for that type, or to impl_stack_vm_run_aligned if there are none.
+/// @param vm The virtual machine in which to run
+/// @param chunk The aligned monomorphic chunk containing the code to run
+/// @param ip The instruction pointer from which to start
+/// @param budget The maximum number of instructions to run
+/// @return The result of the interpretation
+InterpretResult impl_stack_vm_run_monomorphic(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+
+/// @brief Run functions specialized for aligned chunks whose typed instructions all operate on a single type.
+/// The values on the stack are operated on through the member of that type, without decoding the OperandType
+/// of each instruction, and the top of the stack is kept in a local until the function returns.
+/// Parameters and return value are the same as impl_stack_vm_run_aligned.
+InterpretResult impl_stack_vm_run_i8(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_i16(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_i32(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_i64(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_ui8(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_ui16(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_ui32(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_ui64(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_f(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+InterpretResult impl_stack_vm_run_d(StackVM* vm, Chunk* chunk, uint8_t* ip, uint64_t budget);
+
 #endif //HG_COLTI_STACK_BASED_VM
\ No newline at end of file
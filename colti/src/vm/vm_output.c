@@ -0,0 +1,180 @@
+/** @file vm_output.c
+* Contains the definitions of the functions declared in 'vm_output.h'
+*/
+
+#include "vm_output.h"
+
+#ifdef COLTI_WINDOWS
+	#include <io.h>
+	/// @brief Check if a stream is an interactive terminal
+	#define impl_is_terminal(stream) _isatty(_fileno(stream))
+#else
+	#include <unistd.h>
+	/// @brief Check if a stream is an interactive terminal
+	#define impl_is_terminal(stream) isatty(fileno(stream))
+#endif
+
+/// @brief Table of all the 2 digits pairs, which allows writing 2 digits at a time
+static const char g_digit_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+void VMOutputInit(VMOutput* out, FILE* stream)
+{
+	out->stream = stream;
+	out->size = 0;
+	out->is_line_buffered = stream != NULL && impl_is_terminal(stream);
+	out->capture_size = 0;
+	out->capture_capacity = 0;
+	out->capture = NULL;
+}
+
+void VMOutputFree(VMOutput* out)
+{
+	VMOutputFlush(out);
+	if (out->capture != NULL)
+		safe_free(out->capture);
+}
+
+void VMOutputFlush(VMOutput* out)
+{
+	if (out->size == 0)
+		return;
+	if (out->stream == NULL)
+	{
+		//Grow the capture geometrically, starting with the size of the buffer
+		if (out->capture_capacity - out->capture_size < out->size)
+		{
+			uint64_t new_capacity = out->capture_capacity == 0 ? VM_OUTPUT_BUFFER_SIZE : out->capture_capacity * 2;
+			char* ptr = (char*)safe_malloc(new_capacity);
+			if (out->capture != NULL)
+			{
+				memcpy(ptr, out->capture, out->capture_size);
+				safe_free(out->capture);
+			}
+			out->capture = ptr;
+			out->capture_capacity = new_capacity;
+		}
+		memcpy(out->capture + out->capture_size, out->buffer, out->size);
+		out->capture_size += out->size;
+	}
+	else
+	{
+		fwrite(out->buffer, sizeof(char), out->size, out->stream);
+		fflush(out->stream);
+	}
+	out->size = 0;
+}
+
+char* VMOutputTakeCapture(VMOutput* out, uint64_t* size)
+{
+	colti_assert(out->stream == NULL, "The output was not captured!");
+	VMOutputFlush(out);
+	char* capture = out->capture;
+	*size = out->capture_size;
+	out->capture = NULL;
+	out->capture_size = 0;
+	out->capture_capacity = 0;
+	return capture;
+}
+
+void VMOutputWriteChar(VMOutput* out, char chr)
+{
+	impl_vm_output_reserve(out, 1);
+	out->buffer[out->size++] = chr;
+}
+
+void VMOutputWriteString(VMOutput* out, const char* str, size_t size)
+{
+	//Strings bigger than the buffer are written in multiple passes
+	while (size > VM_OUTPUT_BUFFER_SIZE - out->size)
+	{
+		size_t available = VM_OUTPUT_BUFFER_SIZE - out->size;
+		memcpy(out->buffer + out->size, str, available);
+		out->size += available;
+		VMOutputFlush(out);
+		str += available;
+		size -= available;
+	}
+	memcpy(out->buffer + out->size, str, size);
+	out->size += size;
+}
+
+void VMOutputWriteUInt(VMOutput* out, uint64_t value)
+{
+	//UINT64_MAX contains 20 digits
+	char digits[20];
+	char* begin = unsafe_write_uint_backward(digits + 20, value);
+	VMOutputWriteString(out, begin, digits + 20 - begin);
+}
+
+void VMOutputWriteInt(VMOutput* out, int64_t value)
+{
+	//INT64_MIN contains 19 digits + its sign
+	char digits[20];
+	//Negate as unsigned, which is well defined for INT64_MIN
+	uint64_t abs_value = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+	char* begin = unsafe_write_uint_backward(digits + 20, abs_value);
+	if (value < 0)
+		*(--begin) = '-';
+	VMOutputWriteString(out, begin, digits + 20 - begin);
+}
+
+void VMOutputWriteFloat(VMOutput* out, float value)
+{
+	impl_vm_output_reserve(out, FLOAT_TO_CHARS_MAX_SIZE);
+	out->size += floatToChars(value, out->buffer + out->size);
+}
+
+void VMOutputWriteDouble(VMOutput* out, double value)
+{
+	impl_vm_output_reserve(out, FLOAT_TO_CHARS_MAX_SIZE);
+	out->size += doubleToChars(value, out->buffer + out->size);
+}
+
+void VMOutputEndLine(VMOutput* out)
+{
+	VMOutputWriteChar(out, '\n');
+	if (out->is_line_buffered)
+		VMOutputFlush(out);
+}
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+void impl_vm_output_reserve(VMOutput* out, size_t size)
+{
+	colti_assert(size <= VM_OUTPUT_BUFFER_SIZE, "Cannot reserve more than the buffer size!");
+	if (VM_OUTPUT_BUFFER_SIZE - out->size < size)
+		VMOutputFlush(out);
+}
+
+char* unsafe_write_uint_backward(char* buffer_end, uint64_t value)
+{
+	//Write 2 digits at a time, from the least significant ones
+	while (value >= 100)
+	{
+		const char* pair = g_digit_pairs + (value % 100) * 2;
+		value /= 100;
+		*(--buffer_end) = pair[1];
+		*(--buffer_end) = pair[0];
+	}
+	if (value >= 10)
+	{
+		const char* pair = g_digit_pairs + value * 2;
+		*(--buffer_end) = pair[1];
+		*(--buffer_end) = pair[0];
+	}
+	else
+		*(--buffer_end) = (char)('0' + value);
+	return buffer_end;
+}
@@ -0,0 +1,114 @@
+/** @file vm_output.h
+* Contains the VMOutput struct, which buffers everything printed by a virtual machine.
+* Calling `printf` for each OP_PRINT means parsing a format string and locking
+* the stream for every value printed.
+* A VMOutput formats the values itself (without any locale or format string),
+* and appends them to a buffer, which is only written to the stream when:
+* - the buffer is full
+* - VMOutputFlush is called (which the VM does on OP_RETURN)
+* - a line ends, if the stream is an interactive terminal (line mode)
+* A VMOutput initialized without a stream captures the output instead: flushing
+* appends the buffer to a heap allocated capture, which is taken using VMOutputTakeCapture.
+*/
+
+#ifndef HG_COLTI_VM_OUTPUT
+#define HG_COLTI_VM_OUTPUT
+
+#include "common.h"
+#include "util/number_conversion.h"
+
+/// @brief The size of the buffer of a VMOutput
+#define VM_OUTPUT_BUFFER_SIZE 4096
+
+/// @brief Buffered output of a virtual machine
+typedef struct
+{
+	/// @brief The stream to which the buffer is flushed, NULL if the output is captured
+	FILE* stream;
+	/// @brief The number of bytes written to the buffer
+	uint64_t size;
+	/// @brief True if the buffer should be flushed at the end of each line
+	bool is_line_buffered;
+	/// @brief The size of the captured output
+	uint64_t capture_size;
+	/// @brief The capacity of the capture
+	uint64_t capture_capacity;
+	/// @brief The output flushed since the last VMOutputTakeCapture, NULL if empty
+	char* capture;
+	/// @brief The buffer containing the output which was not yet flushed
+	char buffer[VM_OUTPUT_BUFFER_SIZE];
+} VMOutput;
+
+/// @brief Initializes a VMOutput writing to 'stream'.
+/// If 'stream' is an interactive terminal, the output is flushed at the end of each line.
+/// @param out The output to initialize
+/// @param stream The stream to which to write, or NULL to capture the output
+void VMOutputInit(VMOutput* out, FILE* stream);
+
+/// @brief Flushes and frees the resources used by a VMOutput
+/// @param out The output to free
+void VMOutputFree(VMOutput* out);
+
+/// @brief Writes the content of the buffer to the stream (or the capture), and empties the buffer
+/// @param out The output to flush
+void VMOutputFlush(VMOutput* out);
+
+/// @brief Flushes a capturing VMOutput, and transfers the ownership of the captured output to the caller.
+/// The capture of the VMOutput is then empty.
+/// @param out The output whose capture to take
+/// @param size Pointer to where to write the size of the captured output
+/// @return The captured output (not NUL terminated) to free using safe_free, NULL if nothing was captured
+char* VMOutputTakeCapture(VMOutput* out, uint64_t* size);
+
+/// @brief Appends a character to the buffer
+/// @param out The output to write to
+/// @param chr The character to write
+void VMOutputWriteChar(VMOutput* out, char chr);
+
+/// @brief Appends 'size' characters to the buffer
+/// @param out The output to write to
+/// @param str The characters to write (does not need to be NUL terminated)
+/// @param size The number of characters to write
+void VMOutputWriteString(VMOutput* out, const char* str, size_t size);
+
+/// @brief Appends the decimal representation of an unsigned integer to the buffer
+/// @param out The output to write to
+/// @param value The value to write
+void VMOutputWriteUInt(VMOutput* out, uint64_t value);
+
+/// @brief Appends the decimal representation of a signed integer to the buffer
+/// @param out The output to write to
+/// @param value The value to write
+void VMOutputWriteInt(VMOutput* out, int64_t value);
+
+/// @brief Appends the shortest representation of a float that round-trips to the buffer
+/// @param out The output to write to
+/// @param value The value to write
+void VMOutputWriteFloat(VMOutput* out, float value);
+
+/// @brief Appends the shortest representation of a double that round-trips to the buffer
+/// @param out The output to write to
+/// @param value The value to write
+void VMOutputWriteDouble(VMOutput* out, double value);
+
+/// @brief Appends a newline to the buffer, flushing it if the output is line buffered
+/// @param out The output to write to
+void VMOutputEndLine(VMOutput* out);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Ensures that at least 'size' bytes are available in the buffer, flushing if needed
+/// @param out The output to modify
+/// @param size The number of bytes needed (less or equal to VM_OUTPUT_BUFFER_SIZE)
+void impl_vm_output_reserve(VMOutput* out, size_t size);
+
+/// @brief Writes the decimal digits of 'value' at the end of a buffer.
+/// The buffer must be able to contain 20 characters.
+/// @param buffer_end Pointer past the end of the buffer in which to write
+/// @param value The value whose digits to write
+/// @return Pointer to the first written digit
+char* unsafe_write_uint_backward(char* buffer_end, uint64_t value);
+
+#endif //HG_COLTI_VM_OUTPUT
@@ -0,0 +1,62 @@
+/** @file vm_profiler.c
+* Contains the definitions of the functions declared in 'vm_profiler.h'
+*/
+
+#include "vm_profiler.h"
+
+void VMProfilerInit(VMProfiler* profiler, const Chunk* chunk, uint64_t interval)
+{
+	colti_assert(interval != 0, "The sampling interval cannot be 0!");
+	profiler->interval = interval;
+	//The seed is fixed, so that profiling the same Chunk twice gives the same samples
+	profiler->random_state = 0x9E3779B97F4A7C15;
+	profiler->sample_count = 0;
+	profiler->code_size = chunk->count;
+	profiler->samples = (uint64_t*)safe_malloc(chunk->count * sizeof(uint64_t));
+	memset(profiler->samples, 0, chunk->count * sizeof(uint64_t));
+}
+
+void VMProfilerFree(VMProfiler* profiler)
+{
+	safe_free(profiler->samples);
+}
+
+InterpretResult VMProfilerRun(VMProfiler* profiler, StackVM* vm, Chunk* chunk)
+{
+	colti_assert(profiler->code_size == chunk->count, "The profiler was initialized for another Chunk!");
+	colti_assert(!StackVMIsSuspended(vm), "A Chunk is suspended in the VM!");
+
+	//Each slice is attributed to its first instruction
+	uint64_t offset = 0;
+	InterpretResult result;
+	do
+	{
+		profiler->samples[offset]++;
+		profiler->sample_count++;
+		result = StackVMRunFor(vm, chunk, impl_profiler_next_slice(profiler));
+		offset = vm->ip - chunk->code; //Only meaningful when yielding
+	} while (result == INTERPRET_YIELD);
+	return result;
+}
+
+void VMProfilerReport(const VMProfiler* profiler, const Chunk* chunk, const char* name)
+{
+	colti_assert(profiler->code_size == chunk->count, "The profiler was initialized for another Chunk!");
+	printf("%"PRIu64" samples (every %"PRIu64" instructions on average)\n", profiler->sample_count, profiler->interval);
+	ChunkDisassembleSamples(chunk, name, profiler->samples, profiler->sample_count);
+}
+
+uint64_t impl_profiler_next_slice(VMProfiler* profiler)
+{
+	if (profiler->interval == 1)
+		return 1;
+	//Xorshift64
+	uint64_t x = profiler->random_state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	profiler->random_state = x;
+	//2 * 'interval' - 1 cannot overflow for any usable interval
+	uint64_t span = profiler->interval <= UINT64_MAX / 2 ? 2 * profiler->interval - 1 : UINT64_MAX;
+	return 1 + x % span;
+}
@@ -0,0 +1,68 @@
+/** @file vm_profiler.h
+* Contains the VMProfiler, which attributes the execution of a Chunk to the offsets of its instructions.
+* Native profilers (like `perf`) attribute all the samples to the dispatch loop of the VM,
+* as the byte-code is data: they cannot tell which instruction was being interpreted.
+* The VMProfiler samples the byte-code itself: it runs the Chunk using StackVMRunFor,
+* yielding after a slice of instructions, and records the offset of the first instruction of each slice.
+* The length of each slice is random (uniform between 1 and 2 * 'interval' - 1, so 'interval' on average):
+* slices of a fixed length would lock onto the period of any loop, attributing all its samples to a few of its instructions.
+* As sampling is driven by the instruction budget, the dispatch loop is not modified,
+* and runs at full speed between samples.
+* The samples can then be printed next to the disassembly of the Chunk (VMProfilerReport).
+*/
+
+#ifndef HG_COLTI_VM_PROFILER
+#define HG_COLTI_VM_PROFILER
+
+#include "common.h"
+#include "disassemble.h"
+#include "stack_based_vm.h"
+
+/// @brief Samples the offsets of the instructions run by a StackVM
+typedef struct
+{
+	/// @brief The average number of instructions run between 2 samples
+	uint64_t interval;
+	/// @brief The state of the generator of the length of each slice (Xorshift64, not 0)
+	uint64_t random_state;
+	/// @brief The total number of samples recorded
+	uint64_t sample_count;
+	/// @brief The size of the profiled code
+	uint64_t code_size;
+	/// @brief The number of samples recorded at each offset of the code
+	uint64_t* samples;
+} VMProfiler;
+
+/// @brief Initializes a profiler for a Chunk
+/// @param profiler The profiler to initialize
+/// @param chunk The chunk to profile
+/// @param interval The average number of instructions run between 2 samples (1 counts every instruction)
+void VMProfilerInit(VMProfiler* profiler, const Chunk* chunk, uint64_t interval);
+
+/// @brief Frees the resources used by a profiler
+/// @param profiler The profiler to free
+void VMProfilerFree(VMProfiler* profiler);
+
+/// @brief Runs a Chunk to completion in a StackVM, sampling the instructions being run
+/// @param profiler The profiler which records the samples (initialized for 'chunk')
+/// @param vm The virtual machine in which to run, in which no Chunk should be suspended
+/// @param chunk The chunk to run
+/// @return The result of the interpretation (never INTERPRET_YIELD)
+InterpretResult VMProfilerRun(VMProfiler* profiler, StackVM* vm, Chunk* chunk);
+
+/// @brief Prints the disassembly of a Chunk, annotated with the samples recorded at each instruction
+/// @param profiler The profiler containing the samples
+/// @param chunk The profiled chunk
+/// @param name The name of the chunk
+void VMProfilerReport(const VMProfiler* profiler, const Chunk* chunk, const char* name);
+
+/**********************************
+IMPLEMENTATION HELPERS
+**********************************/
+
+/// @brief Returns the number of instructions of the next slice, uniformly distributed between 1 and 2 * 'interval' - 1
+/// @param profiler The profiler whose generator to update
+/// @return The length of the slice (always 1 if 'interval' is 1)
+uint64_t impl_profiler_next_slice(VMProfiler* profiler);
+
+#endif //HG_COLTI_VM_PROFILER
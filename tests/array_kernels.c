@@ -0,0 +1,193 @@
+#include "precomph.h"
+#include "byte-code/array_kernels.h"
+
+/// @brief The greatest number of values for which the kernels are compared (which covers every tail of the widest vectors)
+#define ARRAY_KERNELS_MAX_COUNT 9
+
+/// @brief Xorshift64 random number generator
+/// @param state The state of the generator (not 0)
+/// @return The next random number
+uint64_t next_random(uint64_t* state)
+{
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return x;
+}
+
+/// @brief Returns the mask of the bits of a QWORD that are specified for a type (see array_kernels.h)
+/// @param type The type of the value
+/// @return The mask
+uint64_t specified_bits(OperandType type)
+{
+	switch (type)
+	{
+	case OPERAND_COLTI_UI8:
+	case OPERAND_COLTI_I8:
+		return UINT8_MAX;
+	case OPERAND_COLTI_UI16:
+	case OPERAND_COLTI_I16:
+		return UINT16_MAX;
+	case OPERAND_COLTI_UI32:
+	case OPERAND_COLTI_I32:
+	case OPERAND_COLTI_FLOAT:
+		return UINT32_MAX;
+	default:
+		return UINT64_MAX;
+	}
+}
+
+/// @brief Returns a random value of a type, small enough for the sums and products of FLOAT and DOUBLE to be exact
+/// (so that they do not depend on the order in which they are reduced)
+/// @param state The state of the generator
+/// @param type The type of the value
+/// @param is_divisor True if the value cannot be 0
+/// @return The value, extended to a QWORD as the VM does
+QWORD random_element(uint64_t* state, OperandType type, bool is_divisor)
+{
+	int64_t small = (int64_t)(next_random(state) % 41) - 20;
+	//Unsigned values are not negative
+	if (type >= OPERAND_COLTI_UI8 && type <= OPERAND_COLTI_UI64)
+		small += 20;
+	if (is_divisor && small == 0)
+		small = 3;
+	QWORD value = { .ui64 = 0 };
+	switch (type)
+	{
+	break; case OPERAND_COLTI_UI8:	value.ui64 = (uint8_t)small;
+	break; case OPERAND_COLTI_UI16:	value.ui64 = (uint16_t)small;
+	break; case OPERAND_COLTI_UI32:	value.ui64 = (uint32_t)small;
+	break; case OPERAND_COLTI_UI64:	value.ui64 = (uint64_t)small;
+	break; case OPERAND_COLTI_I8:	value.i64 = (int8_t)small;
+	break; case OPERAND_COLTI_I16:	value.i64 = (int16_t)small;
+	break; case OPERAND_COLTI_I32:	value.i64 = (int32_t)small;
+	break; case OPERAND_COLTI_I64:	value.i64 = small;
+	break; case OPERAND_COLTI_FLOAT:	value.f = (float)small / 2;
+	break; case OPERAND_COLTI_DOUBLE:	value.d = (double)small / 2;
+	break; default:
+		break;
+	}
+	return value;
+}
+
+/// @brief Compares the specified bits of the results of a scalar kernel and of a vector kernel
+/// @param expected The results of the scalar kernel
+/// @param actual The results of the vector kernel
+/// @param count The number of results
+/// @param type The type of the results
+/// @return True if the results are identical
+bool are_same_results(const QWORD* expected, const QWORD* actual, uint64_t count, OperandType type)
+{
+	uint64_t mask = specified_bits(type);
+	for (uint64_t i = 0; i < count; i++)
+	{
+		if (((expected[i].ui64 ^ actual[i].ui64) & mask) != 0)
+			return false;
+	}
+	return true;
+}
+
+/// @brief Compares every kernel of a type using an instruction set to the scalar kernel, on 'count' random values
+/// @param level The instruction set of the kernels to check
+/// @param type The type of the values
+/// @param count The number of values
+/// @param state The state of the random number generator
+/// @return The number of failures
+uint64_t compare_kernels(ArrayKernelLevel level, OperandType type, uint64_t count, uint64_t* state)
+{
+	const ArrayKernels* scalar = ArrayKernelsGet(ARRAY_KERNELS_SCALAR, type);
+	const ArrayKernels* vector = ArrayKernelsGet(level, type);
+	//The buffers have exactly 'count' values, so that reading past the tail is detected by sanitizers
+	size_t size = (count == 0 ? 1 : count) * sizeof(QWORD);
+	QWORD* left = (QWORD*)safe_malloc(size);
+	QWORD* right = (QWORD*)safe_malloc(size);
+	QWORD* expected = (QWORD*)safe_malloc(size);
+	QWORD* actual = (QWORD*)safe_malloc(size);
+	for (uint64_t i = 0; i < count; i++)
+	{
+		left[i] = random_element(state, type, false);
+		right[i] = random_element(state, type, true);
+	}
+
+	uint64_t failures = 0;
+	const ArrayBinaryKernel scalar_binary[] = { scalar->add, scalar->subtract, scalar->multiply, scalar->divide };
+	const ArrayBinaryKernel vector_binary[] = { vector->add, vector->subtract, vector->multiply, vector->divide };
+	const char* binary_names[] = { "add", "subtract", "multiply", "divide" };
+	for (size_t k = 0; k < sizeof(scalar_binary) / sizeof(scalar_binary[0]); k++)
+	{
+		bool is_success = scalar_binary[k](expected, left, right, count);
+		bool is_same = vector_binary[k](actual, left, right, count) == is_success && are_same_results(expected, actual, count, type);
+		//The result can be the left operand
+		if (count != 0)
+			memcpy(actual, left, count * sizeof(QWORD));
+		is_same &= vector_binary[k](actual, actual, right, count) == is_success && are_same_results(expected, actual, count, type);
+		if (!is_same)
+			printf("'%s' differs for %"PRIu64" %s values (level %d)!\n", binary_names[k], count, OperandTypeToString(type), (int)level);
+		failures += !is_same;
+	}
+	//An integer division by zero fails whatever the lane
+	if (count != 0 && type != OPERAND_COLTI_FLOAT && type != OPERAND_COLTI_DOUBLE)
+	{
+		right[count - 1].ui64 = 0;
+		failures += vector->divide(actual, left, right, count);
+	}
+	//The negation of unsigned values is unspecified
+	if ((type >= OPERAND_COLTI_I8 && type <= OPERAND_COLTI_I64) || type == OPERAND_COLTI_FLOAT || type == OPERAND_COLTI_DOUBLE)
+	{
+		scalar->negate(expected, left, count);
+		vector->negate(actual, left, count);
+		failures += !are_same_results(expected, actual, count, type);
+	}
+	QWORD scalar_result = scalar->sum(left, count);
+	QWORD vector_result = vector->sum(left, count);
+	failures += !are_same_results(&scalar_result, &vector_result, 1, type);
+	scalar_result = scalar->dot(left, right, count);
+	vector_result = vector->dot(left, right, count);
+	failures += !are_same_results(&scalar_result, &vector_result, 1, type);
+	if (count != 0)
+	{
+		scalar_result = scalar->min(left, count);
+		vector_result = vector->min(left, count);
+		failures += !are_same_results(&scalar_result, &vector_result, 1, type);
+		scalar_result = scalar->max(left, count);
+		vector_result = vector->max(left, count);
+		failures += !are_same_results(&scalar_result, &vector_result, 1, type);
+	}
+
+	safe_free(left);
+	safe_free(right);
+	safe_free(expected);
+	safe_free(actual);
+	return failures;
+}
+
+int array_kernels()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t state = 0x9E3779B97F4A7C15;
+	uint64_t failures = 0;
+	ArrayKernelLevel widest = ArrayKernelsGetLevel();
+	//Every tail length of the vectors is covered, including no values at all
+	for (int level = ARRAY_KERNELS_SCALAR + 1; level <= (int)widest; level++)
+	{
+		for (uint8_t type = 0; type < OPERAND_TYPE_COUNT; type++)
+		{
+			if (type == OPERAND_COLTI_BOOL)
+				continue;
+			for (uint64_t count = 0; count <= ARRAY_KERNELS_MAX_COUNT; count++)
+				failures += compare_kernels((ArrayKernelLevel)level, (OperandType)type, count, &state);
+		}
+	}
+	if (widest == ARRAY_KERNELS_SCALAR)
+		printf("Only the scalar kernels are available.\n");
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The vector kernels computed the same results as the scalar kernels." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,131 @@
+#include "precomph.h"
+#include "vm/stack_based_vm.h"
+#include <time.h>
+
+/// @brief The number of calls written in the chunk calling a function
+#define CALL_BENCHMARK_CALLS 10000
+/// @brief The number of times the chunk calling a function is run
+#define CALL_BENCHMARK_RUNS 1000
+/// @brief The number of instructions run by the tail recursive function (5 per call, including its OP_ENTER)
+#define CALL_BENCHMARK_BUDGET 40000000
+
+/// @brief Writes a chunk calling 'increment(x) = x + 1' CALL_BENCHMARK_CALLS times, each result being stored in a local slot
+/// @param chunk The chunk to which to write
+void write_calling_chunk(Chunk* chunk)
+{
+	ChunkInit(chunk);
+	uint64_t* targets = (uint64_t*)safe_malloc(CALL_BENCHMARK_CALLS * sizeof(uint64_t));
+	for (uint64_t i = 0; i < CALL_BENCHMARK_CALLS; i++)
+	{
+		QWORD value = { .ui64 = i };
+		ChunkWriteConstant(chunk, value);
+		targets[i] = ChunkWriteCall(chunk, OP_CALL, 0);
+		ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	}
+	ChunkWriteOpCode(chunk, OP_RETURN);
+
+	uint64_t increment = ChunkWriteEnter(chunk, 1, 1);
+	QWORD one = { .ui64 = 1 };
+	ChunkWriteConstant(chunk, one);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_ADD);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+	for (uint64_t i = 0; i < CALL_BENCHMARK_CALLS; i++)
+		ChunkPatchTarget(chunk, targets[i], (uint32_t)increment);
+	safe_free(targets);
+}
+
+/// @brief Writes a chunk calling 'count(n) = count(n + 1)', which never returns
+/// @param chunk The chunk to which to write
+void write_tail_calling_chunk(Chunk* chunk)
+{
+	ChunkInit(chunk);
+	QWORD zero = { .ui64 = 0 };
+	ChunkWriteConstant(chunk, zero);
+	uint64_t target = ChunkWriteCall(chunk, OP_CALL, 0);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+
+	uint64_t count = ChunkWriteEnter(chunk, 1, 1);
+	QWORD one = { .ui64 = 1 };
+	ChunkWriteConstant(chunk, one);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_ADD);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteCall(chunk, OP_TAIL_CALL, (uint32_t)count);
+	ChunkPatchTarget(chunk, target, (uint32_t)count);
+}
+
+/// @brief Returns the seconds elapsed since 'start'
+/// @param start The processor time at which the measure started
+/// @return The elapsed time, in seconds
+double elapsed_seconds(clock_t start)
+{
+	return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+/// @brief Measures the calls per second of OP_CALL, and of OP_TAIL_CALL (whose frames must not grow)
+/// @param chunk The aligned chunk calling a function
+/// @param tail The aligned chunk calling a function recursively in tail position
+/// @param name The name of the encoding
+/// @return True if the tail calls ran in constant frame memory
+bool benchmark_encoding(Chunk* chunk, Chunk* tail, const char* name)
+{
+	//The VM is too big to be allocated on the stack of some platforms
+	StackVM* vm = (StackVM*)safe_malloc(sizeof(StackVM));
+	StackVMInit(vm);
+
+	clock_t start = clock();
+	for (uint64_t i = 0; i < CALL_BENCHMARK_RUNS; i++)
+	{
+		StackVMRun(vm, chunk);
+		StackVMReset(vm);
+	}
+	double seconds = elapsed_seconds(start);
+	printf("%-8s OP_CALL:      %8.1f million calls/s\n", name, (double)CALL_BENCHMARK_CALLS * CALL_BENCHMARK_RUNS / seconds / 1e6);
+
+	start = clock();
+	InterpretResult result = StackVMRunFor(vm, tail, CALL_BENCHMARK_BUDGET);
+	seconds = elapsed_seconds(start);
+	//The argument of the suspended function is the number of tail calls
+	uint64_t calls = vm->locals[0].ui64;
+	bool is_constant = result == INTERPRET_YIELD && vm->frame_count == 1 && StackVMSize(vm) <= 3;
+	printf("%-8s OP_TAIL_CALL: %8.1f million calls/s (%"PRIu64" calls, %"PRIu64" frame)\n",
+		name, (double)calls / seconds / 1e6, calls, vm->frame_count);
+	StackVMReset(vm);
+	StackVMFree(vm);
+	safe_free(vm);
+	return is_constant;
+}
+
+int call_benchmark()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	Chunk chunk;
+	Chunk tail;
+	write_calling_chunk(&chunk);
+	write_tail_calling_chunk(&tail);
+	bool is_constant = benchmark_encoding(&chunk, &tail, "aligned");
+
+	Chunk compact;
+	Chunk compact_tail;
+	if (!ChunkToCompact(&chunk, &compact) || !ChunkToCompact(&tail, &compact_tail))
+	{
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "Could not encode the chunks!" CONSOLE_COLOR_RESET "\n");
+		return EXIT_FAILURE;
+	}
+	is_constant &= benchmark_encoding(&compact, &compact_tail, "compact");
+	ChunkFree(&compact);
+	ChunkFree(&compact_tail);
+	ChunkFree(&chunk);
+	ChunkFree(&tail);
+
+	if (is_constant)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The tail calls ran in constant frame memory." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "The tail calls did not run in constant frame memory!" CONSOLE_COLOR_RESET "\n");
+	return is_constant ? EXIT_SUCCESS : EXIT_FAILURE;
+}
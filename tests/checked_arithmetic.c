@@ -0,0 +1,247 @@
+#include "precomph.h"
+#include "vm/stack_based_vm.h"
+
+/// @brief A checked or wrapping operation, and its expected result
+typedef struct
+{
+	/// @brief The OpCode of the operation
+	OpCode code;
+	/// @brief The left hand side (truncated to the type of the operation)
+	uint64_t left;
+	/// @brief The right hand side (truncated to the type of the operation)
+	uint64_t right;
+	/// @brief True if the operation must stop the VM with INTERPRET_RUNTIME_ERROR
+	bool is_error;
+	/// @brief The result of the operation if it succeeds (truncated to the type of the operation)
+	uint64_t expected;
+} ArithmeticCase;
+
+/// @brief Truncates a value to a type, then extends it to a QWORD as the VM does
+/// @param value The value to truncate
+/// @param type The integer type of the value
+/// @return The extended value
+QWORD truncate_to(uint64_t value, OperandType type)
+{
+	QWORD result = { .ui64 = 0 };
+	switch (type)
+	{
+	break; case OPERAND_COLTI_UI8:	result.ui64 = (uint8_t)value;
+	break; case OPERAND_COLTI_UI16:	result.ui64 = (uint16_t)value;
+	break; case OPERAND_COLTI_UI32:	result.ui64 = (uint32_t)value;
+	break; case OPERAND_COLTI_UI64:	result.ui64 = value;
+	break; case OPERAND_COLTI_I8:	result.i64 = (int8_t)value;
+	break; case OPERAND_COLTI_I16:	result.i64 = (int16_t)value;
+	break; case OPERAND_COLTI_I32:	result.i64 = (int32_t)value;
+	break; case OPERAND_COLTI_I64:	result.ui64 = value;
+	break; default:
+		break;
+	}
+	return result;
+}
+
+/// @brief Returns the limits of an integer type
+/// @param type The integer type
+/// @param min Pointer to where to write the minimum value of the type (0 for unsigned types)
+/// @param max Pointer to where to write the maximum value of the type
+void type_limits(OperandType type, uint64_t* min, uint64_t* max)
+{
+	*min = 0;
+	switch (type)
+	{
+	break; case OPERAND_COLTI_UI8:	*max = UINT8_MAX;
+	break; case OPERAND_COLTI_UI16:	*max = UINT16_MAX;
+	break; case OPERAND_COLTI_UI32:	*max = UINT32_MAX;
+	break; case OPERAND_COLTI_UI64:	*max = UINT64_MAX;
+	break; case OPERAND_COLTI_I8:	*min = (uint64_t)INT8_MIN; *max = INT8_MAX;
+	break; case OPERAND_COLTI_I16:	*min = (uint64_t)INT16_MIN; *max = INT16_MAX;
+	break; case OPERAND_COLTI_I32:	*min = (uint64_t)INT32_MIN; *max = INT32_MAX;
+	break; case OPERAND_COLTI_I64:	*min = (uint64_t)INT64_MIN; *max = INT64_MAX;
+	break; default:
+		*max = 0;
+	}
+}
+
+/// @brief Runs an operation through the VM, checking that it stops with INTERPRET_RUNTIME_ERROR if it must fail,
+/// or that it prints its expected result
+/// @param test The operation to run
+/// @param type The integer type of the operation
+/// @return The number of failures
+uint64_t run_case(const ArithmeticCase* test, OperandType type)
+{
+	//The left hand side is the top of the stack
+	Chunk chunk;
+	ChunkInit(&chunk);
+	ChunkWriteConstant(&chunk, truncate_to(test->right, type));
+	ChunkWriteConstant(&chunk, truncate_to(test->left, type));
+	ChunkWriteOpCode(&chunk, test->code);
+	ChunkWriteOperand(&chunk, type);
+	ChunkWriteOpCode(&chunk, OP_PRINT);
+	ChunkWriteOperand(&chunk, type);
+	ChunkWriteLocal(&chunk, OP_STORE_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+
+	VMOutput expected;
+	VMOutputInit(&expected, NULL);
+	if (!test->is_error)
+		OpCode_Print(truncate_to(test->expected, type), type, &expected);
+	uint64_t expected_size;
+	char* expected_output = VMOutputTakeCapture(&expected, &expected_size);
+	VMOutputFree(&expected);
+
+	StackVM* vm = (StackVM*)safe_malloc(sizeof(StackVM));
+	StackVMInitWithStream(vm, NULL);
+	InterpretResult result = StackVMRun(vm, &chunk);
+	uint64_t size;
+	char* output = VMOutputTakeCapture(&vm->output, &size);
+	StackVMFree(vm);
+	safe_free(vm);
+
+	uint64_t failures = result != (test->is_error ? INTERPRET_RUNTIME_ERROR : INTERPRET_OK);
+	failures += size != expected_size || (size != 0 && memcmp(output, expected_output, size) != 0);
+	if (failures != 0)
+	{
+		printf("Unexpected run of '%s' on %s values %"PRIu64" and %"PRIu64" (output: '%.*s')!\n",
+			OpCodeToString(test->code), OperandTypeToString(type), test->left, test->right, (int)size, output);
+	}
+	if (output != NULL)
+		safe_free(output);
+	if (expected_output != NULL)
+		safe_free(expected_output);
+	ChunkFree(&chunk);
+	return failures;
+}
+
+/// @brief Checks that the range checks used on compilers without overflow builtins agree with the checked OpCodes
+/// (which use the builtins if they are available), and that both write the wrapped result
+/// @param test The operation to check (OP_ADD_CHECKED, OP_SUBTRACT_CHECKED or OP_MULTIPLY_CHECKED)
+/// @param type The integer type of the operation
+/// @return The number of failures
+uint64_t check_portable_case(const ArithmeticCase* test, OperandType type)
+{
+	QWORD left = truncate_to(test->left, type);
+	QWORD right = truncate_to(test->right, type);
+	QWORD result;
+	QWORD portable_result;
+	QWORD wrapped;
+	bool is_success;
+	bool is_portable_success;
+	switch (test->code)
+	{
+	break; case OP_ADD_CHECKED:
+		is_success = OpCode_SumChecked(left, right, type, &result);
+		is_portable_success = impl_sum_checked_portable(left, right, type, &portable_result);
+		wrapped = OpCode_SumWrapping(left, right, type);
+	break; case OP_SUBTRACT_CHECKED:
+		is_success = OpCode_DifferenceChecked(left, right, type, &result);
+		is_portable_success = impl_difference_checked_portable(left, right, type, &portable_result);
+		wrapped = OpCode_DifferenceWrapping(left, right, type);
+	break; case OP_MULTIPLY_CHECKED:
+		is_success = OpCode_MultiplyChecked(left, right, type, &result);
+		is_portable_success = impl_multiply_checked_portable(left, right, type, &portable_result);
+		wrapped = OpCode_MultiplyWrapping(left, right, type);
+	break; default:
+		return 0;
+	}
+	//Only the bits of 'type' are written
+	QWORD expected = truncate_to(test->is_error ? wrapped.ui64 : test->expected, type);
+	uint64_t failures = is_success == test->is_error || is_portable_success == test->is_error;
+	failures += truncate_to(result.ui64, type).ui64 != expected.ui64 || truncate_to(portable_result.ui64, type).ui64 != expected.ui64;
+	if (failures != 0)
+	{
+		printf("The range checks of '%s' differ on %s values %"PRIu64" and %"PRIu64"!\n",
+			OpCodeToString(test->code), OperandTypeToString(type), test->left, test->right);
+	}
+	return failures;
+}
+
+/// @brief Checks the checked OpCodes at the limits of every integer type (MIN/MAX +/- 1, MIN / -1 and division by zero),
+/// and the wrapping OpCodes past these limits
+/// @return The number of failures
+uint64_t test_overflow_boundaries()
+{
+	uint64_t failures = 0;
+	for (uint8_t type = OPERAND_COLTI_UI8; type <= OPERAND_COLTI_I64; type++)
+	{
+		uint64_t min;
+		uint64_t max;
+		type_limits((OperandType)type, &min, &max);
+		const uint64_t minus_one = (uint64_t)-1;
+		const ArithmeticCase common_cases[] = {
+			{ OP_ADD_CHECKED, max, 1, true, 0 },
+			{ OP_ADD_CHECKED, 1, max, true, 0 },
+			{ OP_ADD_CHECKED, max - 1, 1, false, max },
+			{ OP_ADD_CHECKED, min, 0, false, min },
+			{ OP_SUBTRACT_CHECKED, min, 1, true, 0 },
+			{ OP_SUBTRACT_CHECKED, min + 1, 1, false, min },
+			{ OP_SUBTRACT_CHECKED, max, max, false, 0 },
+			{ OP_MULTIPLY_CHECKED, max, 2, true, 0 },
+			{ OP_MULTIPLY_CHECKED, max / 2 + 1, 2, true, 0 },
+			{ OP_MULTIPLY_CHECKED, max / 2, 2, false, max - 1 },
+			{ OP_MULTIPLY_CHECKED, max, 1, false, max },
+			{ OP_MULTIPLY_CHECKED, min, 1, false, min },
+			{ OP_MULTIPLY_CHECKED, max, 0, false, 0 },
+			{ OP_DIVIDE_CHECKED, max, 0, true, 0 },
+			{ OP_DIVIDE_CHECKED, 0, 0, true, 0 },
+			{ OP_DIVIDE_CHECKED, min, 1, false, min },
+			{ OP_DIVIDE_CHECKED, max, max, false, 1 },
+			{ OP_MODULO_CHECKED, max, 0, true, 0 },
+			{ OP_MODULO_CHECKED, min, 0, true, 0 },
+			{ OP_MODULO_CHECKED, max, max, false, 0 },
+			{ OP_MODULO_CHECKED, max, 2, false, 1 },
+			//The wrapping OpCodes compute modulo 2^N
+			{ OP_ADD_WRAPPING, max, 1, false, min },
+			{ OP_ADD_WRAPPING, min, minus_one, false, max },
+			{ OP_SUBTRACT_WRAPPING, min, 1, false, max },
+			{ OP_MULTIPLY_WRAPPING, max, 2, false, (uint64_t)-2 },
+			{ OP_MULTIPLY_WRAPPING, min, minus_one, false, min },
+		};
+		const ArithmeticCase signed_cases[] = {
+			{ OP_ADD_CHECKED, min, minus_one, true, 0 },
+			{ OP_ADD_CHECKED, max, minus_one, false, max - 1 },
+			{ OP_ADD_CHECKED, max, min, false, minus_one },
+			{ OP_SUBTRACT_CHECKED, max, minus_one, true, 0 },
+			{ OP_SUBTRACT_CHECKED, 0, min, true, 0 },
+			{ OP_SUBTRACT_CHECKED, minus_one, max, false, min },
+			{ OP_MULTIPLY_CHECKED, min, minus_one, true, 0 },
+			{ OP_MULTIPLY_CHECKED, minus_one, min, true, 0 },
+			{ OP_MULTIPLY_CHECKED, max, minus_one, false, min + 1 },
+			{ OP_MULTIPLY_CHECKED, 2, (uint64_t)((int64_t)min / 2), false, min },
+			{ OP_DIVIDE_CHECKED, min, minus_one, true, 0 },
+			{ OP_DIVIDE_CHECKED, max, minus_one, false, min + 1 },
+			{ OP_MODULO_CHECKED, min, minus_one, true, 0 },
+			{ OP_MODULO_CHECKED, min, max, false, minus_one },
+		};
+		const ArithmeticCase unsigned_cases[] = {
+			{ OP_SUBTRACT_CHECKED, max - 1, max, true, 0 },
+			{ OP_SUBTRACT_CHECKED, max, 1, false, max - 1 },
+			{ OP_DIVIDE_CHECKED, max, 2, false, max / 2 },
+		};
+		for (size_t i = 0; i < sizeof(common_cases) / sizeof(common_cases[0]); i++)
+		{
+			failures += run_case(&common_cases[i], (OperandType)type);
+			failures += check_portable_case(&common_cases[i], (OperandType)type);
+		}
+		const ArithmeticCase* cases = type >= OPERAND_COLTI_I8 ? signed_cases : unsigned_cases;
+		size_t count = type >= OPERAND_COLTI_I8 ? sizeof(signed_cases) / sizeof(signed_cases[0]) : sizeof(unsigned_cases) / sizeof(unsigned_cases[0]);
+		for (size_t i = 0; i < count; i++)
+		{
+			failures += run_case(&cases[i], (OperandType)type);
+			failures += check_portable_case(&cases[i], (OperandType)type);
+		}
+	}
+	return failures;
+}
+
+int checked_arithmetic()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_overflow_boundaries();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The checked and wrapping OpCodes behaved as expected at the limits of every type." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,121 @@
+#include "precomph.h"
+
+#ifdef COLTI_WINDOWS
+	#include <direct.h>
+#else
+	#include <unistd.h>
+#endif
+
+/// @brief The source whose chunk is cached
+#define CHUNK_CACHE_TEST_SOURCE "print(42);"
+
+/// @brief Points the cache to a directory of the temporary directory, so that the cache of the user is not modified
+/// @param base The buffer to which to write the directory containing the cache directory
+/// @param size The size of 'base'
+void use_temporary_cache(char* base, size_t size)
+{
+#ifdef COLTI_WINDOWS
+	const char* temporary = getenv("TEMP");
+	snprintf(base, size, "%s\\colti_chunk_cache_test", temporary != NULL ? temporary : ".");
+	_putenv_s("LOCALAPPDATA", base);
+#else
+	const char* temporary = getenv("TMPDIR");
+	snprintf(base, size, "%s/colti_chunk_cache_test", temporary != NULL && temporary[0] != '\0' ? temporary : "/tmp");
+	setenv("XDG_CACHE_HOME", base, 1);
+#endif
+}
+
+/// @brief Removes an empty directory
+/// @param path The path to the directory
+void remove_directory(const char* path)
+{
+#ifdef COLTI_WINDOWS
+	_rmdir(path);
+#else
+	rmdir(path);
+#endif
+}
+
+/// @brief Writes a chunk printing 42
+/// @param chunk The chunk to which to write
+void write_cached_chunk(Chunk* chunk)
+{
+	ChunkInit(chunk);
+	QWORD value = { .i64 = 42 };
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+}
+
+/// @brief Checks that a chunk is stored then loaded, and that missing or corrupted entries are misses
+/// @return The number of failures
+uint64_t test_chunk_cache()
+{
+	uint64_t failures = 0;
+	char base[512];
+	use_temporary_cache(base, sizeof(base));
+	ChunkCache cache;
+	ChunkCacheInit(&cache);
+	if (cache.directory == NULL)
+	{
+		printf("Could not create the directory of the cache!\n");
+		return 1;
+	}
+	uint64_t key = ChunkCacheKey(CHUNK_CACHE_TEST_SOURCE, sizeof(CHUNK_CACHE_TEST_SOURCE) - 1);
+	failures += key == ChunkCacheKey(CHUNK_CACHE_TEST_SOURCE, sizeof(CHUNK_CACHE_TEST_SOURCE) - 2);
+	char* path = impl_chunk_cache_path(&cache, key, false);
+	remove(path);
+
+	//A missing entry is a miss
+	Chunk loaded;
+	failures += ChunkCacheLoad(&cache, key, &loaded);
+
+	Chunk chunk;
+	write_cached_chunk(&chunk);
+	failures += !ChunkCacheStore(&cache, key, &chunk);
+	if (ChunkCacheLoad(&cache, key, &loaded))
+	{
+		failures += !loaded.is_read_only || loaded.count != chunk.count || memcmp(loaded.code, chunk.code, chunk.count) != 0;
+		ChunkFree(&loaded);
+	}
+	else
+		failures++;
+	ChunkFree(&chunk);
+
+	//A corrupted entry is a miss, and is removed
+	FILE* file = fopen(path, "wb");
+	if (file != NULL)
+	{
+		fputs("corrupted", file);
+		fclose(file);
+	}
+	failures += file == NULL || ChunkCacheLoad(&cache, key, &loaded);
+	file = fopen(path, "rb");
+	failures += file != NULL;
+	if (file != NULL)
+		fclose(file);
+
+	safe_free(path);
+	remove_directory(cache.directory);
+	remove_directory(base);
+	ChunkCacheFree(&cache);
+	//A disabled cache always misses
+	failures += ChunkCacheLoad(&cache, key, &loaded);
+	return failures;
+}
+
+int chunk_cache()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_chunk_cache();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The chunk cache behaved as expected." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -5,7 +5,7 @@ int deserialize()
 {
 	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
 		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
-	printf("Test: "CONSOLE_COLOR_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
 
 	Chunk to_serialize;
 	ChunkInit(&to_serialize);
@@ -33,11 +33,23 @@ int deserialize()
 	ChunkWriteOpCode(&to_serialize, OP_PRINT);
 	ChunkWriteOperand(&to_serialize, COLTI_INT64);
 
+	//Pooled constants, the second one being deduplicated
+	QWORD pooled = { .d = 3.14 };
+	ChunkWriteConstant(&to_serialize, pooled);
+	ChunkWriteOpCode(&to_serialize, OP_PRINT);
+	ChunkWriteOperand(&to_serialize, COLTI_DOUBLE);
+	ChunkWriteConstant(&to_serialize, pooled);
+	ChunkWriteOpCode(&to_serialize, OP_ADD);
+	ChunkWriteOperand(&to_serialize, COLTI_DOUBLE);
+	ChunkWriteOpCode(&to_serialize, OP_PRINT);
+	ChunkWriteOperand(&to_serialize, COLTI_DOUBLE);
+
 	ChunkWriteOpCode(&to_serialize, OP_RETURN);
 	ChunkDisassemble(&to_serialize, "Test1");
 
 	ChunkSerialize(&to_serialize, "chunk.bin");
 	Chunk deserialized = ChunkDeserialize("chunk.bin");
+	ChunkDisassemble(&deserialized, "Deserialized");
 
 	StackVM vm;
 	StackVMInit(&vm);
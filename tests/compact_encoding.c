@@ -0,0 +1,222 @@
+#include "precomph.h"
+#include "vm/stack_based_vm.h"
+
+/// @brief The output of the chunk written by write_encoding_chunk
+#define COMPACT_ENCODING_EXPECTED_OUTPUT "-8\n3\n6\n20\n3\n5\n42\n"
+
+/// @brief Writes a chunk using every kind of operand: negative constants, a constant divisor, a distant local slot,
+/// a jump table, forward jumps, a loop, a dynamically typed instruction and a call
+/// @param chunk The chunk to which to write
+void write_encoding_chunk(Chunk* chunk)
+{
+	ChunkInit(chunk);
+	QWORD value = { .i64 = -8 };
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	//7 / 2
+	value.i64 = 7;
+	ChunkWriteConstant(chunk, value);
+	value.i64 = 2;
+	ChunkWriteDivideConstant(chunk, OP_DIVIDE_CONST, COLTI_INT64, value);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	//A slot far from the first ones (the locals and the stack share CHUNK_MAX_STACK_DEPTH)
+	value.i64 = 5;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 200);
+	value.i64 = 1;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteIncLocal(chunk, COLTI_INT64, 200);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 200);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	//switch (1) { case 0: print(10); case 1: print(20); default: print(30); }
+	value.ui64 = 1;
+	ChunkWriteConstant(chunk, value);
+	uint64_t table = ChunkWriteJumpTable(chunk, 2);
+	uint64_t ends[2];
+	for (uint32_t i = 0; i <= 2; i++)
+	{
+		ChunkPatchJumpTable(chunk, table, i, chunk->count);
+		value.i64 = 10 * (i + 1);
+		ChunkWriteConstant(chunk, value);
+		ChunkWriteOpCode(chunk, OP_PRINT);
+		ChunkWriteOperand(chunk, COLTI_INT64);
+		ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+		if (i != 2)
+			ends[i] = ChunkWriteJump(chunk, OP_JUMP, COLTI_BOOL);
+	}
+	ChunkPatchJump(chunk, ends[0], chunk->count);
+	ChunkPatchJump(chunk, ends[1], chunk->count);
+
+	//while (i != 3) i++
+	value.i64 = 0;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 1);
+	uint64_t header = chunk->count;
+	value.i64 = 3;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 1);
+	uint64_t exit = ChunkWriteJump(chunk, OP_JUMP_IF_EQUAL, COLTI_INT64);
+	value.i64 = 1;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteIncLocal(chunk, COLTI_INT64, 1);
+	ChunkWriteLoop(chunk, header);
+	ChunkPatchJump(chunk, exit, chunk->count);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 1);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	//2 + 3 on dynamic values
+	value.i64 = 2;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteOpCode(chunk, OP_BOX);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	value.i64 = 3;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteOpCode(chunk, OP_BOX);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteAddDynamic(chunk);
+	ChunkWriteOpCode(chunk, OP_UNBOX);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	//increment(41)
+	value.ui64 = 41;
+	ChunkWriteConstant(chunk, value);
+	uint64_t target = ChunkWriteCall(chunk, OP_CALL, 0);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+
+	uint64_t increment = ChunkWriteEnter(chunk, 1, 1);
+	value.ui64 = 1;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_ADD);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+	ChunkPatchTarget(chunk, target, (uint32_t)increment);
+}
+
+/// @brief Runs a chunk, checking its output
+/// @param chunk The chunk to run
+/// @param name The name of the encoding, printed on failure
+/// @return The number of failures
+uint64_t run_encoding(Chunk* chunk, const char* name)
+{
+	StackVM* vm = (StackVM*)safe_malloc(sizeof(StackVM));
+	StackVMInitWithStream(vm, NULL);
+	InterpretResult result = StackVMRun(vm, chunk);
+	uint64_t size;
+	char* output = VMOutputTakeCapture(&vm->output, &size);
+	StackVMFree(vm);
+	safe_free(vm);
+
+	uint64_t failures = result != INTERPRET_OK;
+	failures += size != strlen(COMPACT_ENCODING_EXPECTED_OUTPUT) || memcmp(output, COMPACT_ENCODING_EXPECTED_OUTPUT, size) != 0;
+	if (failures != 0)
+		printf("Unexpected run of the %s chunk (output: '%.*s')!\n", name, (int)size, output);
+	if (output != NULL)
+		safe_free(output);
+	return failures;
+}
+
+/// @brief Checks that converting an aligned chunk to the compact encoding and back gives the same code and constants,
+/// and that both encodings run identically
+/// @return The number of failures
+uint64_t test_round_trip()
+{
+	Chunk aligned;
+	write_encoding_chunk(&aligned);
+	uint64_t failures = run_encoding(&aligned, "aligned");
+
+	Chunk compact;
+	if (!ChunkToCompact(&aligned, &compact))
+	{
+		printf("Could not convert the chunk to the compact encoding!\n");
+		ChunkFree(&aligned);
+		return failures + 1;
+	}
+	failures += compact.encoding != CHUNK_ENCODING_COMPACT || compact.count >= aligned.count;
+	failures += run_encoding(&compact, "compact");
+
+	Chunk converted;
+	if (ChunkToAligned(&compact, &converted))
+	{
+		bool is_same = converted.encoding == CHUNK_ENCODING_ALIGNED && converted.count == aligned.count
+			&& memcmp(converted.code, aligned.code, aligned.count) == 0
+			&& converted.constant_count == aligned.constant_count
+			&& memcmp(converted.constants, aligned.constants, aligned.constant_count * sizeof(QWORD)) == 0;
+		failures += !is_same;
+		if (!is_same)
+			printf("The chunk converted back to the aligned encoding differs from the original!\n");
+		ChunkFree(&converted);
+	}
+	else
+	{
+		printf("Could not convert the chunk back to the aligned encoding!\n");
+		failures++;
+	}
+	ChunkFree(&compact);
+	ChunkFree(&aligned);
+	return failures;
+}
+
+/// @brief Checks that the zigzag encoding and the LEB128 round-trip at the limits of their ranges,
+/// and that a truncated LEB128 is rejected
+/// @return The number of failures
+uint64_t test_variable_integers()
+{
+	uint64_t failures = 0;
+	const int64_t signed_values[] = { 0, -1, 1, -64, 64, INT32_MIN, INT32_MAX, INT64_MIN, INT64_MAX };
+	for (size_t i = 0; i < sizeof(signed_values) / sizeof(signed_values[0]); i++)
+		failures += impl_zigzag_decode(impl_zigzag_encode(signed_values[i])) != signed_values[i];
+	//Small negative values are small
+	failures += impl_zigzag_encode(-1) != 1 || impl_zigzag_encode(1) != 2;
+
+	const uint64_t values[] = { 0, 127, 128, 16383, 16384, UINT32_MAX, UINT64_MAX };
+	Chunk chunk;
+	ChunkInit(&chunk);
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+		impl_chunk_write_uleb128(&chunk, values[i]);
+	uint64_t offset = 0;
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+	{
+		uint64_t value;
+		failures += !impl_chunk_read_uleb128(&chunk, &offset, &value) || value != values[i];
+	}
+	failures += offset != chunk.count;
+	//The last byte of UINT64_MAX is missing
+	chunk.count--;
+	offset -= 10;
+	uint64_t value;
+	failures += impl_chunk_read_uleb128(&chunk, &offset, &value);
+	ChunkFree(&chunk);
+	return failures;
+}
+
+int compact_encoding()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_round_trip() + test_variable_integers();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The compact encoding round-tripped as expected." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,165 @@
+#include "precomph.h"
+#include "vm/stack_based_vm.h"
+
+/// @brief The number of dividends at the limits of the integer types, which are followed by the random ones
+#define DIVISOR_BOUNDARY_DIVIDENDS 22
+/// @brief The number of random dividends added to the boundaries for each divisor
+#define DIVISOR_RANDOM_DIVIDENDS 16
+
+/// @brief Xorshift64 random number generator
+/// @param state The state of the generator (not 0)
+/// @return The next random number
+uint64_t next_random(uint64_t* state)
+{
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return x;
+}
+
+/// @brief Truncates a value to a type, then extends it to a QWORD as the VM does
+/// @param value The value to truncate
+/// @param type The integer type of the value
+/// @return The extended value
+QWORD truncate_to(uint64_t value, OperandType type)
+{
+	QWORD result = { .ui64 = 0 };
+	switch (type)
+	{
+	break; case OPERAND_COLTI_UI8:	result.ui64 = (uint8_t)value;
+	break; case OPERAND_COLTI_UI16:	result.ui64 = (uint16_t)value;
+	break; case OPERAND_COLTI_UI32:	result.ui64 = (uint32_t)value;
+	break; case OPERAND_COLTI_UI64:	result.ui64 = value;
+	break; case OPERAND_COLTI_I8:	result.i64 = (int8_t)value;
+	break; case OPERAND_COLTI_I16:	result.i64 = (int16_t)value;
+	break; case OPERAND_COLTI_I32:	result.i64 = (int32_t)value;
+	break; case OPERAND_COLTI_I64:	result.ui64 = value;
+	break; default:
+		break;
+	}
+	return result;
+}
+
+/// @brief Computes the quotient or the remainder of a division using '/' and '%'.
+/// INT64_MIN divided by -1 wraps to INT64_MIN (its remainder being 0), as documented in divisor.h.
+/// @param dividend The dividend, extended to a QWORD
+/// @param divisor The divisor, extended to a QWORD (not 0)
+/// @param type The integer type of the operands
+/// @param is_modulo True to compute the remainder rather than the quotient
+/// @return The result, truncated to 'type'
+QWORD expected_result(QWORD dividend, QWORD divisor, OperandType type, bool is_modulo)
+{
+	uint64_t result;
+	if (type >= OPERAND_COLTI_I8)
+	{
+		if (divisor.i64 == -1)
+			result = is_modulo ? 0 : 0 - dividend.ui64;
+		else
+			result = (uint64_t)(is_modulo ? dividend.i64 % divisor.i64 : dividend.i64 / divisor.i64);
+	}
+	else
+		result = is_modulo ? dividend.ui64 % divisor.ui64 : dividend.ui64 / divisor.ui64;
+	return truncate_to(result, type);
+}
+
+/// @brief Runs OP_DIVIDE_CONST and OP_MODULO_CONST on every dividend for a divisor, and compares the output of the VM
+/// with the results of '/' and '%' printed the same way
+/// @param type The integer type of the operands
+/// @param divisor The divisor, truncated to 'type' (not 0)
+/// @param dividends The dividends (truncated to 'type')
+/// @param count The number of dividends
+/// @return The number of failures
+uint64_t compare_divisions(OperandType type, QWORD divisor, const uint64_t* dividends, uint64_t count)
+{
+	Chunk chunk;
+	ChunkInit(&chunk);
+	VMOutput expected;
+	VMOutputInit(&expected, NULL);
+	for (uint64_t i = 0; i < count; i++)
+	{
+		QWORD dividend = truncate_to(dividends[i], type);
+		for (int is_modulo = 0; is_modulo <= 1; is_modulo++)
+		{
+			ChunkWriteConstant(&chunk, dividend);
+			ChunkWriteDivideConstant(&chunk, is_modulo ? OP_MODULO_CONST : OP_DIVIDE_CONST, type, divisor);
+			ChunkWriteOpCode(&chunk, OP_PRINT);
+			ChunkWriteOperand(&chunk, type);
+			ChunkWriteLocal(&chunk, OP_STORE_LOCAL_BYTE, 0);
+			OpCode_Print(expected_result(dividend, divisor, type, is_modulo), type, &expected);
+		}
+	}
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	uint64_t expected_size;
+	char* expected_output = VMOutputTakeCapture(&expected, &expected_size);
+	VMOutputFree(&expected);
+
+	StackVM* vm = (StackVM*)safe_malloc(sizeof(StackVM));
+	StackVMInitWithStream(vm, NULL);
+	InterpretResult result = StackVMRun(vm, &chunk);
+	uint64_t size;
+	char* output = VMOutputTakeCapture(&vm->output, &size);
+	StackVMFree(vm);
+	safe_free(vm);
+
+	uint64_t failures = result != INTERPRET_OK;
+	failures += size != expected_size || memcmp(output, expected_output, size) != 0;
+	if (failures != 0)
+	{
+		printf("The divisions of %s values by %"PRIi64" differ (output: '%.*s', expected: '%.*s')!\n",
+			OperandTypeToString(type), divisor.i64, (int)size, output, (int)expected_size, expected_output);
+	}
+	if (output != NULL)
+		safe_free(output);
+	if (expected_output != NULL)
+		safe_free(expected_output);
+	ChunkFree(&chunk);
+	return failures;
+}
+
+/// @brief Compares the constant divisions of every integer type with '/' and '%', for negative divisors,
+/// powers of 2, -1, INT64_MIN and the limits of each type
+/// @return The number of failures
+uint64_t test_constant_divisions()
+{
+	const int64_t divisors[] = {
+		1, -1, 2, -2, 3, -3, 7, -7, 10, -10, 16, -16, 128, -128, 255, 641, -641, 65536, -65536,
+		INT8_MAX, INT8_MIN, UINT8_MAX, INT16_MAX, INT16_MIN, UINT16_MAX, INT32_MAX, INT32_MIN, UINT32_MAX,
+		(int64_t)1 << 62, -((int64_t)1 << 62), INT64_MAX, INT64_MIN, (int64_t)UINT64_MAX - 1
+	};
+	uint64_t dividends[DIVISOR_BOUNDARY_DIVIDENDS + DIVISOR_RANDOM_DIVIDENDS] = {
+		0, 1, (uint64_t)-1, 2, (uint64_t)-2, 7, (uint64_t)-7, 1000, (uint64_t)-1000,
+		INT8_MAX, (uint64_t)INT8_MIN, UINT8_MAX, INT16_MAX, (uint64_t)INT16_MIN, UINT16_MAX,
+		INT32_MAX, (uint64_t)INT32_MIN, UINT32_MAX, INT64_MAX, (uint64_t)INT64_MIN, UINT64_MAX - 1, UINT64_MAX
+	};
+	uint64_t state = 0x9E3779B97F4A7C15;
+	uint64_t failures = 0;
+	for (uint8_t type = OPERAND_COLTI_UI8; type <= OPERAND_COLTI_I64; type++)
+	{
+		for (size_t i = 0; i < sizeof(divisors) / sizeof(divisors[0]); i++)
+		{
+			QWORD divisor = truncate_to((uint64_t)divisors[i], (OperandType)type);
+			if (divisor.ui64 == 0)
+				continue;
+			for (size_t j = DIVISOR_BOUNDARY_DIVIDENDS; j < sizeof(dividends) / sizeof(dividends[0]); j++)
+				dividends[j] = next_random(&state);
+			failures += compare_divisions((OperandType)type, divisor, dividends, sizeof(dividends) / sizeof(dividends[0]));
+		}
+	}
+	return failures;
+}
+
+int divisor()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_constant_divisions();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The constant divisions computed the same results as '/' and '%%'." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,329 @@
+#include "precomph.h"
+#include "c_emitter.h"
+
+/// @brief The directory containing the sources of the interpreter, relative to the directory of this file
+/// (EMIT_C_SOURCE_DIR can be defined to override it)
+#define EMIT_C_SOURCE_DIR_FROM_TESTS "../colti/src"
+/// @brief The C compiler used to compile the emitted code
+#ifndef EMIT_C_COMPILER
+	#define EMIT_C_COMPILER "cc"
+#endif
+/// @brief The number of instructions of each random program
+#define EMIT_C_PROGRAM_SIZE 256
+/// @brief The maximum depth of the stack of each random program
+#define EMIT_C_MAX_DEPTH 32
+/// @brief The number of local slots used by each random program
+#define EMIT_C_LOCAL_COUNT 4
+
+/// @brief Xorshift64 random number generator
+/// @param state The state of the generator (not 0)
+/// @return The next random number
+uint64_t next_random(uint64_t* state)
+{
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return x;
+}
+
+/// @brief Returns a random value of a type, small enough for the arithmetic of the program to be well-defined
+/// @param state The state of the generator
+/// @param type The type of the value
+/// @return The value
+QWORD random_value(uint64_t* state, OperandType type)
+{
+	uint64_t bits = next_random(state);
+	QWORD value = { .ui64 = 0 };
+	switch (type)
+	{
+	break; case COLTI_BOOL:		value.b = bits & 1;
+	break; case COLTI_FLOAT:	value.f = (float)(int16_t)bits / 8;
+	break; case COLTI_DOUBLE:	value.d = (double)(int32_t)bits / 1024;
+		//Wide signed integers stay small, as their overflow is undefined
+	break; case COLTI_INT32:	value.i32 = (int16_t)bits;
+	break; case COLTI_INT64:	value.i64 = (int32_t)bits;
+	break; default:			value.ui64 = bits;
+	}
+	return value;
+}
+
+/// @brief Writes a random type-consistent program operating on 'type'.
+/// Integer divisions only divide immediates by non-zero immediates, and the
+/// multiplications that could overflow an int (after promotion) are not generated.
+/// Values are only copied through locals if their repeated sums cannot overflow a signed integer.
+/// @param chunk The chunk to which to write
+/// @param state The state of the generator
+/// @param type The type of the operands
+void write_random_program(Chunk* chunk, uint64_t* state, OperandType type)
+{
+	bool is_float = type == COLTI_FLOAT || type == COLTI_DOUBLE;
+	bool is_signed = is_float || type == COLTI_INT8 || type == COLTI_INT16 || type == COLTI_INT32 || type == COLTI_INT64;
+	bool can_multiply = type != COLTI_UINT16 && type != COLTI_INT32 && type != COLTI_INT64;
+	bool can_copy = type != COLTI_BOOL && type != COLTI_INT32 && type != COLTI_INT64;
+	uint64_t depth = 0;
+	for (uint64_t i = 0; i < EMIT_C_PROGRAM_SIZE; i++)
+	{
+		uint64_t choice = next_random(state) % 10;
+		uint16_t slot = (uint16_t)(next_random(state) % EMIT_C_LOCAL_COUNT);
+		if (depth == 0 || type == COLTI_BOOL)
+			choice = 0;
+		if (choice == 0 && depth < EMIT_C_MAX_DEPTH - 2)
+		{
+			ChunkWriteConstant(chunk, random_value(state, type));
+			depth++;
+		}
+		else if (choice == 1 && !is_float && depth < EMIT_C_MAX_DEPTH - 2)
+		{
+			QWORD divisor = random_value(state, type);
+			divisor.ui64 = (divisor.ui64 & 0x7) + 1;
+			ChunkWriteConstant(chunk, divisor);
+			ChunkWriteConstant(chunk, random_value(state, type));
+			ChunkWriteOpCode(chunk, OP_DIVIDE);
+			ChunkWriteOperand(chunk, type);
+			depth++;
+		}
+		else if (choice == 2 && is_signed)
+		{
+			ChunkWriteOpCode(chunk, OP_NEGATE);
+			ChunkWriteOperand(chunk, type);
+		}
+		else if (choice >= 3 && choice <= 5 && depth >= 2)
+		{
+			OpCode op = choice == 3 ? OP_ADD : choice == 4 ? OP_SUBTRACT
+				: can_multiply ? OP_MULTIPLY : is_float ? OP_DIVIDE : OP_ADD;
+			ChunkWriteOpCode(chunk, op);
+			ChunkWriteOperand(chunk, type);
+			depth--;
+		}
+		else if (choice == 6 && can_copy && depth < EMIT_C_MAX_DEPTH - 2)
+		{
+			ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, slot);
+			depth++;
+		}
+		else if (choice == 7 && can_copy && depth >= 2)
+		{
+			ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, slot);
+			depth--;
+		}
+		else if (choice == 8 && can_copy && depth >= 2)
+		{
+			ChunkWriteIncLocal(chunk, type, slot);
+			depth--;
+		}
+		else if (depth != 0)
+		{
+			ChunkWriteOpCode(chunk, OP_PRINT);
+			ChunkWriteOperand(chunk, type);
+		}
+	}
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, type);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+}
+
+/// @brief Writes a program printing, for each 'i' in [0, 16), a value chosen by a 'switch' on 'i % 4'
+/// (whose cases contain an 'if'), then the final value of 'i'
+/// @param chunk The chunk to which to write
+void write_branching_program(Chunk* chunk)
+{
+	QWORD value = { .ui64 = 0 };
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	//while (i != 16)
+	uint64_t header = chunk->count;
+	value.ui64 = 16;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	uint64_t exit = ChunkWriteJump(chunk, OP_JUMP_IF_EQUAL, COLTI_UINT64);
+	value.ui64 = 4;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_MODULO);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	uint64_t table = ChunkWriteJumpTable(chunk, 3);
+	uint64_t breaks[3];
+
+	//case 0: print(10)
+	ChunkPatchJumpTable(chunk, table, 0, chunk->count);
+	value.ui64 = 10;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 1);
+	breaks[0] = ChunkWriteJump(chunk, OP_JUMP, COLTI_BOOL);
+	//case 1: print(i * i)
+	ChunkPatchJumpTable(chunk, table, 1, chunk->count);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_MULTIPLY);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 1);
+	breaks[1] = ChunkWriteJump(chunk, OP_JUMP, COLTI_BOOL);
+	//case 2: print(i < 8 ? 1 : 2)
+	ChunkPatchJumpTable(chunk, table, 2, chunk->count);
+	value.ui64 = 8;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	uint64_t is_less = ChunkWriteJump(chunk, OP_JUMP_IF_LESS, COLTI_UINT64);
+	value.ui64 = 2;
+	ChunkWriteConstant(chunk, value);
+	uint64_t end_if = ChunkWriteJump(chunk, OP_JUMP, COLTI_BOOL);
+	ChunkPatchJump(chunk, is_less, chunk->count);
+	value.ui64 = 1;
+	ChunkWriteConstant(chunk, value);
+	ChunkPatchJump(chunk, end_if, chunk->count);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 1);
+	breaks[2] = ChunkWriteJump(chunk, OP_JUMP, COLTI_BOOL);
+	//default: nothing
+	ChunkPatchJumpTable(chunk, table, 3, chunk->count);
+	for (uint64_t i = 0; i < 3; i++)
+		ChunkPatchJump(chunk, breaks[i], chunk->count);
+
+	value.ui64 = 1;
+	ChunkWriteConstant(chunk, value);
+	ChunkWriteIncLocal(chunk, COLTI_UINT64, 0);
+	ChunkWriteLoop(chunk, header);
+	ChunkPatchJump(chunk, exit, chunk->count);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_UINT64);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+}
+
+/// @brief Writes the path to the directory containing the sources of the interpreter, which does not depend on the working directory
+/// @param buffer The buffer to which to write
+/// @param size The size of 'buffer'
+void get_source_directory(char* buffer, size_t size)
+{
+#ifdef EMIT_C_SOURCE_DIR
+	snprintf(buffer, size, "%s", EMIT_C_SOURCE_DIR);
+#else
+	//The sources are found from the path of this file
+	const char* file = __FILE__;
+	const char* separator = strrchr(file, '/');
+	const char* windows_separator = strrchr(file, '\\');
+	if (windows_separator != NULL && (separator == NULL || windows_separator > separator))
+		separator = windows_separator;
+	if (separator == NULL)
+		snprintf(buffer, size, "%s", EMIT_C_SOURCE_DIR_FROM_TESTS);
+	else
+		snprintf(buffer, size, "%.*s/%s", (int)(separator - file), file, EMIT_C_SOURCE_DIR_FROM_TESTS);
+#endif
+}
+
+/// @brief Writes the path to a file of the temporary directory
+/// @param buffer The buffer to which to write
+/// @param size The size of 'buffer'
+/// @param name The name of the file
+void get_temporary_path(char* buffer, size_t size, const char* name)
+{
+#ifdef COLTI_WINDOWS
+	const char* temporary = getenv("TEMP");
+	snprintf(buffer, size, "%s\\%s", temporary != NULL ? temporary : ".", name);
+#else
+	const char* temporary = getenv("TMPDIR");
+	snprintf(buffer, size, "%s/%s", temporary != NULL && temporary[0] != '\0' ? temporary : "/tmp", name);
+#endif
+}
+
+/// @brief Runs a chunk using the VM and using the C it is compiled to, and compares their outputs
+/// @param chunk The chunk to run
+/// @param name The name of the chunk
+/// @return True if both outputs are identical
+bool run_differential(Chunk* chunk, const char* name)
+{
+	StackVM vm;
+	StackVMInitWithStream(&vm, NULL);
+	InterpretResult result = StackVMRun(&vm, chunk);
+	uint64_t expected_size;
+	char* expected = VMOutputTakeCapture(&vm.output, &expected_size);
+	StackVMFree(&vm);
+
+	//The artifacts are written to the temporary directory, and removed once compared
+	char source[512];
+	char executable[512];
+	char output[512];
+	char directory[512];
+	get_temporary_path(source, sizeof(source), "emit_c_test.c");
+	get_temporary_path(executable, sizeof(executable), "emit_c_test");
+	get_temporary_path(output, sizeof(output), "emit_c_test.out");
+	get_source_directory(directory, sizeof(directory));
+
+	FILE* file = fopen(source, "w");
+	bool is_same = result == INTERPRET_OK && file != NULL && ChunkEmitC(chunk, name, file);
+	if (file != NULL)
+		fclose(file);
+	//The emitted code is compiled like the interpreter, then run
+	char* actual = NULL;
+	uint64_t actual_size = 0;
+	char command[4096];
+	snprintf(command, sizeof(command), "cd \"%s\" && "EMIT_C_COMPILER" -O2 "C_EMITTER_RUNTIME_FLAGS
+		" \"%s\" "C_EMITTER_RUNTIME_SOURCES" -lm -o \"%s\"", directory, source, executable);
+	if (is_same && system(command) == 0)
+	{
+		snprintf(command, sizeof(command), "\"%s\" > \"%s\"", executable, output);
+		if (system(command) == 0)
+		{
+			String content = StringGetFileContent(output);
+			actual_size = StringSize(&content) - 1;
+			actual = (char*)safe_malloc(actual_size + 1);
+			memcpy(actual, content.ptr, actual_size);
+			StringFree(&content);
+		}
+	}
+	remove(source);
+	remove(executable);
+	remove(output);
+	is_same = actual != NULL && actual_size == expected_size
+		&& (expected_size == 0 || memcmp(actual, expected, expected_size) == 0);
+	if (!is_same)
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "The compiled '%s' did not print the same output as the VM!" CONSOLE_COLOR_RESET "\n", name);
+	if (expected != NULL)
+		safe_free(expected);
+	if (actual != NULL)
+		safe_free(actual);
+	return is_same;
+}
+
+int emit_c_differential()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t state = 0x9E3779B97F4A7C15;
+	uint64_t failures = 0;
+	//The last program is the branching one
+	for (uint8_t type = 0; type <= OPERAND_TYPE_COUNT; type++)
+	{
+		const char* name = type == OPERAND_TYPE_COUNT ? "branches" : OperandTypeToString(type);
+		Chunk aligned;
+		ChunkInit(&aligned);
+		if (type == OPERAND_TYPE_COUNT)
+			write_branching_program(&aligned);
+		else
+			write_random_program(&aligned, &state, type);
+		failures += !run_differential(&aligned, name);
+
+		//The compact encoding decodes to the same instructions
+		Chunk compact;
+		if (ChunkToCompact(&aligned, &compact))
+		{
+			failures += !run_differential(&compact, name);
+			ChunkFree(&compact);
+		}
+		ChunkFree(&aligned);
+	}
+
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "All the compiled chunks printed the same output as the VM." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%" PRIu64 " compiled chunks did not print the same output!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures != 0;
+}
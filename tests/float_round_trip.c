@@ -0,0 +1,73 @@
+#include "precomph.h"
+#include "util/number_conversion.h"
+
+/// @brief The number of random bit patterns to test for each type
+#define ROUND_TRIP_COUNT 10000000
+
+/// @brief Xorshift64 random number generator
+/// @param state The state of the generator (not 0)
+/// @return The next random number
+uint64_t next_random(uint64_t* state)
+{
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return x;
+}
+
+int round_trip()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t state = 0x9E3779B97F4A7C15;
+	uint64_t failures = 0;
+	char buffer[FLOAT_TO_CHARS_MAX_SIZE];
+
+	for (uint64_t i = 0; i < ROUND_TRIP_COUNT; i++)
+	{
+		uint64_t bits = next_random(&state);
+		double value;
+		memcpy(&value, &bits, sizeof(double));
+		if (isnan(value))
+			continue;
+
+		StringView view = { buffer, buffer + doubleToChars(value, buffer) };
+		double parsed;
+		const char* end;
+		charsToDouble(view, &parsed, &end);
+		if (end != view.end || memcmp(&parsed, &value, sizeof(double)) != 0)
+		{
+			if (failures++ < 10)
+				printf("Double %016" PRIx64 " written as '%.*s' did not round-trip!\n", bits, (int)(view.end - view.start), view.start);
+		}
+	}
+
+	for (uint64_t i = 0; i < ROUND_TRIP_COUNT; i++)
+	{
+		uint32_t bits = (uint32_t)next_random(&state);
+		float value;
+		memcpy(&value, &bits, sizeof(float));
+		if (isnan(value))
+			continue;
+
+		StringView view = { buffer, buffer + floatToChars(value, buffer) };
+		float parsed;
+		const char* end;
+		charsToFloat(view, &parsed, &end);
+		if (end != view.end || memcmp(&parsed, &value, sizeof(float)) != 0)
+		{
+			if (failures++ < 10)
+				printf("Float %08" PRIx32 " written as '%.*s' did not round-trip!\n", bits, (int)(view.end - view.start), view.start);
+		}
+	}
+
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "All values round-tripped." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%" PRIu64 " values did not round-trip!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures != 0;
+}
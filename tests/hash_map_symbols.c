@@ -0,0 +1,123 @@
+#include "precomph.h"
+#include "structs/struct_hash_map.h"
+#include "structs/struct_symbol.h"
+#include "byte-code/verifier.h"
+
+/// @brief The number of keys that can be in the map (the keys are random in [0, HASH_MAP_TEST_KEYS))
+#define HASH_MAP_TEST_KEYS 100000
+/// @brief The number of random insertions and removals
+#define HASH_MAP_TEST_OPERATIONS 1000000
+
+/// @brief Xorshift64 random number generator
+/// @param state The state of the generator (not 0)
+/// @return The next random number
+uint64_t next_random(uint64_t* state)
+{
+	uint64_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	*state = x;
+	return x;
+}
+
+/// @brief Hashes a key of the test, giving the same hash to groups of 4 keys so that the keys must be compared
+/// @param key The key to hash
+/// @return The (weak) hash of the key
+uint64_t weak_hash(uint64_t key)
+{
+	return (key >> 2) * 0x9E3779B97F4A7C15;
+}
+
+/// @brief Inserts and removes random keys of a HashMap, checking each result against an array
+/// @return The number of failures
+uint64_t test_hash_map()
+{
+	bool* is_in = (bool*)safe_malloc(HASH_MAP_TEST_KEYS * sizeof(bool));
+	uint64_t* values = (uint64_t*)safe_malloc(HASH_MAP_TEST_KEYS * sizeof(uint64_t));
+	memset(is_in, 0, HASH_MAP_TEST_KEYS * sizeof(bool));
+	HashMap map;
+	HashMapInit(&map);
+
+	uint64_t state = 0x9E3779B97F4A7C15;
+	uint64_t failures = 0;
+	for (uint64_t i = 0; i < HASH_MAP_TEST_OPERATIONS; i++)
+	{
+		uint64_t random = next_random(&state);
+		uint64_t key = random % HASH_MAP_TEST_KEYS;
+		//Insert twice as often as remove, so that the map grows and keeps DELETED slots
+		if (random % 3 != 0)
+		{
+			failures += HashMapInsert(&map, key, weak_hash(key), random) == is_in[key];
+			is_in[key] = true;
+			values[key] = random;
+		}
+		else
+		{
+			failures += HashMapRemove(&map, key, weak_hash(key)) != is_in[key];
+			is_in[key] = false;
+		}
+	}
+	uint64_t count = 0;
+	for (uint64_t key = 0; key < HASH_MAP_TEST_KEYS; key++)
+	{
+		uint64_t value;
+		bool is_found = HashMapFind(&map, key, weak_hash(key), &value);
+		failures += is_found != is_in[key] || (is_found && value != values[key]);
+		count += is_in[key];
+	}
+	failures += count != map.count;
+	printf("HashMap: %"PRIu64" keys in %"PRIu64" slots.\n", map.count, map.capacity);
+
+	HashMapFree(&map);
+	safe_free(is_in);
+	safe_free(values);
+	return failures;
+}
+
+/// @brief Checks that equal names are interned to the same Symbol, and that the globals of a Chunk are resolved by Symbol
+/// @return The number of failures
+uint64_t test_symbols()
+{
+	uint64_t failures = 0;
+	const char* source = "counter total counter";
+	StringView first = { source, source + 7 };
+	StringView last = { source + 14, source + 21 };
+	const Symbol* counter = SymbolInternView(first);
+	failures += counter != SymbolInternView(last) || counter == SymbolIntern("total", 5);
+	failures += counter->hash != StringViewHash(first) || strcmp(counter->name, "counter") != 0;
+
+	//The names are resolved to the same slots, which survive a serialization
+	Chunk chunk;
+	ChunkInit(&chunk);
+	ChunkWriteGlobal(&chunk, OP_LOAD_GLOBAL, counter);
+	ChunkWriteGlobal(&chunk, OP_STORE_GLOBAL, SymbolIntern("total", 5));
+	ChunkWriteGlobal(&chunk, OP_LOAD_GLOBAL, SymbolInternView(last));
+	ChunkWriteGlobal(&chunk, OP_STORE_GLOBAL, counter);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += chunk.global_count != 2;
+	ChunkSerialize(&chunk, "chunk.bin");
+	Chunk loaded = ChunkDeserialize("chunk.bin");
+	failures += loaded.global_count != 2 || loaded.globals[0] != counter;
+	uint64_t error_offset;
+	failures += ChunkVerify(&loaded, &error_offset) != VERIFY_OK;
+	ChunkFree(&loaded);
+	ChunkFree(&chunk);
+	remove("chunk.bin");
+	return failures;
+}
+
+int hash_map_symbols()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_hash_map() + test_symbols();
+	SymbolTableFree();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The HashMap and the Symbols behaved as expected." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
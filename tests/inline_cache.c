@@ -0,0 +1,200 @@
+#include "precomph.h"
+#include "vm/stack_based_vm.h"
+
+/// @brief Writes a chunk calling 'add(left, right)' (whose OP_ADD_DYNAMIC is the only one of the chunk) on dynamic values
+/// of each type of 'types', printing each result. The right operand of the last call is a value of type 'last_right'.
+/// @param chunk The chunk to which to write
+/// @param types The types of the operands of the calls
+/// @param count The number of calls
+/// @param last_right The type of the right operand of the last call
+void write_dynamic_chunk(Chunk* chunk, const OperandType* types, uint64_t count, OperandType last_right)
+{
+	ChunkInit(chunk);
+	uint64_t* targets = (uint64_t*)safe_malloc(count * sizeof(uint64_t));
+	for (uint64_t i = 0; i < count; i++)
+	{
+		//Floating values are written as their bits
+		QWORD left = { .ui64 = 2 };
+		QWORD right = { .ui64 = 3 };
+		if (types[i] == COLTI_DOUBLE)
+		{
+			left.d = 2.5;
+			right.d = 0.25;
+		}
+		OperandType right_type = i + 1 == count ? last_right : types[i];
+		ChunkWriteConstant(chunk, left);
+		ChunkWriteOpCode(chunk, OP_BOX);
+		ChunkWriteOperand(chunk, types[i]);
+		ChunkWriteConstant(chunk, right);
+		ChunkWriteOpCode(chunk, OP_BOX);
+		ChunkWriteOperand(chunk, right_type);
+		targets[i] = ChunkWriteCall(chunk, OP_CALL, 0);
+		ChunkWriteOpCode(chunk, OP_PRINT);
+		ChunkWriteOperand(chunk, types[i]);
+		ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	}
+	ChunkWriteOpCode(chunk, OP_RETURN);
+
+	//The arguments are the left value and tag, then the right value and tag: the right operand is pushed first
+	uint64_t add = ChunkWriteEnter(chunk, 4, 4);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 2);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 3);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 0);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 1);
+	ChunkWriteAddDynamic(chunk);
+	//The tag is dropped, so that the value is returned
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 1);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+	for (uint64_t i = 0; i < count; i++)
+		ChunkPatchTarget(chunk, targets[i], (uint32_t)add);
+	safe_free(targets);
+}
+
+/// @brief Returns the OpCode of the dynamically typed instruction of a chunk
+/// @param chunk The chunk containing a single dynamically typed instruction
+/// @return The OpCode, or OP_RETURN if there are none
+uint8_t find_dynamic_opcode(const Chunk* chunk)
+{
+	Instruction instr;
+	for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+	{
+		if (chunk->encoding == CHUNK_ENCODING_COMPACT)
+			CompactDecodeInstruction(chunk, offset, &instr);
+		else
+			ChunkDecodeInstruction(chunk, offset, &instr);
+		if (InlineCacheIsDynamicOpCode(instr.code))
+			return instr.code;
+	}
+	return OP_RETURN;
+}
+
+/// @brief Runs a chunk, checking its result, its output, the form of its dynamically typed instruction and its cache
+/// @param chunk The chunk to run
+/// @param expected_result The expected result of the run
+/// @param expected_output The expected output
+/// @param expected_code The expected form of the dynamically typed instruction once run
+/// @param expected_count The expected 'count' of the InlineCache
+/// @param expected_deopts The expected number of deoptimizations
+/// @return The number of failures
+uint64_t run_dynamic_chunk(Chunk* chunk, InterpretResult expected_result, const char* expected_output,
+	OpCode expected_code, uint8_t expected_count, uint32_t expected_deopts)
+{
+	StackVM* vm = (StackVM*)safe_malloc(sizeof(StackVM));
+	StackVMInitWithStream(vm, NULL);
+	InterpretResult result = StackVMRun(vm, chunk);
+	uint64_t size;
+	char* output = VMOutputTakeCapture(&vm->output, &size);
+	StackVMFree(vm);
+	safe_free(vm);
+
+	uint64_t failures = result != expected_result;
+	failures += size != strlen(expected_output) || memcmp(output, expected_output, size) != 0;
+	failures += find_dynamic_opcode(chunk) != expected_code;
+	failures += chunk->cache_count != 1 || chunk->inline_caches == NULL;
+	if (chunk->cache_count == 1 && chunk->inline_caches != NULL)
+	{
+		failures += chunk->inline_caches[0].count != expected_count;
+		failures += chunk->inline_caches[0].deopt_count != expected_deopts;
+	}
+	if (failures != 0)
+		printf("Unexpected run of a dynamically typed instruction (output: '%.*s')!\n", (int)size, output);
+	if (output != NULL)
+		safe_free(output);
+	return failures;
+}
+
+/// @brief Checks the specialization, deoptimization and errors of the dynamically typed instructions, in both encodings
+/// @return The number of failures
+uint64_t test_inline_caches()
+{
+	uint64_t failures = 0;
+	const OperandType mono[] = { COLTI_INT64, COLTI_INT64 };
+	const OperandType poly[] = { COLTI_INT64, COLTI_DOUBLE, COLTI_INT64 };
+	const OperandType mega[] = { COLTI_INT64, COLTI_DOUBLE, COLTI_INT32, COLTI_INT8, COLTI_UINT8 };
+	Chunk chunk;
+
+	write_dynamic_chunk(&chunk, mono, 2, COLTI_INT64);
+	failures += run_dynamic_chunk(&chunk, INTERPRET_OK, "5\n5\n", OP_ADD_DYNAMIC_I64, 1, 0);
+	//Running again keeps the specialized form
+	failures += run_dynamic_chunk(&chunk, INTERPRET_OK, "5\n5\n", OP_ADD_DYNAMIC_I64, 1, 0);
+	ChunkFree(&chunk);
+
+	//The DOUBLE deoptimizes the INT64 form, after which the polymorphic form handles both types
+	write_dynamic_chunk(&chunk, poly, 3, COLTI_INT64);
+	Chunk compact;
+	failures += !ChunkToCompact(&chunk, &compact);
+	failures += run_dynamic_chunk(&chunk, INTERPRET_OK, "5\n2.75\n5\n", OP_ADD_DYNAMIC_POLY, 2, 1);
+	failures += run_dynamic_chunk(&compact, INTERPRET_OK, "5\n2.75\n5\n", OP_ADD_DYNAMIC_POLY, 2, 1);
+	ChunkFree(&compact);
+	ChunkFree(&chunk);
+
+	write_dynamic_chunk(&chunk, mega, 5, COLTI_UINT8);
+	failures += run_dynamic_chunk(&chunk, INTERPRET_OK, "5\n2.75\n5\n5\n5\n", OP_ADD_DYNAMIC, INLINE_CACHE_MEGAMORPHIC, 4);
+	ChunkFree(&chunk);
+
+	//The code of a read-only chunk is never rewritten
+	write_dynamic_chunk(&chunk, mono, 2, COLTI_INT64);
+	chunk.is_read_only = true;
+	failures += run_dynamic_chunk(&chunk, INTERPRET_OK, "5\n5\n", OP_ADD_DYNAMIC, 1, 0);
+	ChunkFree(&chunk);
+
+	//Operands of different types are a runtime error, even once specialized
+	write_dynamic_chunk(&chunk, mono, 2, COLTI_INT32);
+	failures += run_dynamic_chunk(&chunk, INTERPRET_RUNTIME_ERROR, "5\n", OP_ADD_DYNAMIC_I64, 1, 0);
+	ChunkFree(&chunk);
+	return failures;
+}
+
+/// @brief Checks that OP_UNBOX drops the tag of a dynamic value of the expected type, and rejects any other type
+/// (the tag of an untyped value being only checked when running)
+/// @return The number of failures
+uint64_t test_unbox()
+{
+	uint64_t failures = 0;
+	for (int i = 0; i < 2; i++)
+	{
+		Chunk chunk;
+		ChunkInit(&chunk);
+		QWORD value = { .ui64 = 42 };
+		ChunkWriteConstant(&chunk, value);
+		if (i == 0)
+		{
+			ChunkWriteOpCode(&chunk, OP_BOX);
+			ChunkWriteOperand(&chunk, COLTI_UINT16);
+		}
+		else
+		{
+			QWORD tag = { .ui64 = COLTI_UINT16 };
+			ChunkWriteConstant(&chunk, tag);
+		}
+		ChunkWriteOpCode(&chunk, OP_UNBOX);
+		ChunkWriteOperand(&chunk, i == 0 ? COLTI_UINT16 : COLTI_INT16);
+		ChunkWriteOpCode(&chunk, OP_RETURN);
+
+		StackVM* vm = (StackVM*)safe_malloc(sizeof(StackVM));
+		StackVMInitWithStream(vm, NULL);
+		InterpretResult result = StackVMRun(vm, &chunk);
+		if (i == 0)
+			failures += result != INTERPRET_OK || StackVMSize(vm) != 1 || StackVMTop(vm).ui64 != 42;
+		else
+			failures += result != INTERPRET_RUNTIME_ERROR;
+		StackVMFree(vm);
+		safe_free(vm);
+		ChunkFree(&chunk);
+	}
+	return failures;
+}
+
+int inline_cache()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_inline_caches() + test_unbox();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The inline caches behaved as expected." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
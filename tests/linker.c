@@ -0,0 +1,184 @@
+#include "precomph.h"
+#include "byte-code/linker.h"
+
+/// @brief The number of iterations of the loop written by write_unit
+#define LINKER_LOOP_ITERATIONS 3
+/// @brief The constant printed by every unit (which is too big to be an immediate, so that it is pooled)
+#define LINKER_SHARED_CONSTANT 4294967296
+
+/// @brief Writes a unit printing its own constant (LINKER_SHARED_CONSTANT + 'value'), then LINKER_SHARED_CONSTANT,
+/// then the number of iterations of a loop (so that each unit has a loop counter)
+/// @param chunk The chunk to which to write
+/// @param value The value added to the constant of the unit
+void write_unit(Chunk* chunk, int64_t value)
+{
+	ChunkInit(chunk);
+	QWORD constant = { .i64 = LINKER_SHARED_CONSTANT + value };
+	ChunkWriteConstant(chunk, constant);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	constant.i64 = LINKER_SHARED_CONSTANT;
+	ChunkWriteConstant(chunk, constant);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	//while (i != LINKER_LOOP_ITERATIONS) i++
+	constant.i64 = 0;
+	ChunkWriteConstant(chunk, constant);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 1);
+	uint64_t header = chunk->count;
+	constant.i64 = LINKER_LOOP_ITERATIONS;
+	ChunkWriteConstant(chunk, constant);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 1);
+	uint64_t exit = ChunkWriteJump(chunk, OP_JUMP_IF_EQUAL, COLTI_INT64);
+	constant.i64 = 1;
+	ChunkWriteConstant(chunk, constant);
+	ChunkWriteIncLocal(chunk, COLTI_INT64, 1);
+	ChunkWriteLoop(chunk, header);
+	ChunkPatchJump(chunk, exit, chunk->count);
+	ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 1);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(chunk, OP_RETURN);
+}
+
+/// @brief Runs an entry of an image, checking its output
+/// @param image The image containing the entry
+/// @param name The name of the entry
+/// @param expected The expected output
+/// @return The number of failures
+uint64_t run_entry(const ChunkImage* image, const char* name, const char* expected)
+{
+	uint64_t index;
+	if (!ChunkImageFindEntry(image, name, &index))
+	{
+		printf("The image does not contain the entry '%s'!\n", name);
+		return 1;
+	}
+	Chunk view;
+	ChunkImageGetEntry(image, index, &view);
+	StackVM* vm = (StackVM*)safe_malloc(sizeof(StackVM));
+	StackVMInitWithStream(vm, NULL);
+	InterpretResult result = StackVMRun(vm, &view);
+	uint64_t size;
+	char* output = VMOutputTakeCapture(&vm->output, &size);
+	StackVMFree(vm);
+	safe_free(vm);
+
+	uint64_t failures = result != INTERPRET_OK;
+	failures += size != strlen(expected) || memcmp(output, expected, size) != 0;
+	if (failures != 0)
+		printf("Unexpected run of the entry '%s' (output: '%.*s')!\n", name, (int)size, output);
+	if (output != NULL)
+		safe_free(output);
+	return failures;
+}
+
+/// @brief Checks the entries, constants and loop counters of an image linked by test_link_and_map, and runs its entries
+/// @param image The image to check
+/// @return The number of failures
+uint64_t check_image(const ChunkImage* image)
+{
+	uint64_t failures = 0;
+	//The dead unit is eliminated, and the entries are sorted by name
+	failures += image->entry_count != 3;
+	uint64_t index;
+	failures += ChunkImageFindEntry(image, "dead", &index);
+	for (uint64_t i = 1; i < image->entry_count; i++)
+		failures += strcmp(image->names + image->entries[i - 1].name_offset, image->names + image->entries[i].name_offset) >= 0;
+	//The hottest unit is laid out first
+	failures += !ChunkImageFindEntry(image, "hot", &index) || image->entries[index].code_offset != 0;
+	//The shared constant is merged, and the constant of the dead unit is not part of the pool
+	failures += image->chunk.constant_count != 4;
+	//Each unit has its own loop counter
+	failures += image->chunk.loop_count != 3;
+	if (failures != 0)
+		printf("The entries of the image are not as expected!\n");
+
+	failures += run_entry(image, "main", "4294967297\n4294967296\n3\n");
+	failures += run_entry(image, "helper", "4294967298\n4294967296\n3\n");
+	failures += run_entry(image, "hot", "4294967300\n4294967296\n3\n");
+	return failures;
+}
+
+/// @brief Links units into an image, checks and runs it, then serializes and maps it and checks it again
+/// @return The number of failures
+uint64_t test_link_and_map()
+{
+	Chunk main_unit;
+	Chunk helper;
+	Chunk dead;
+	Chunk hot;
+	write_unit(&main_unit, 1);
+	write_unit(&helper, 2);
+	write_unit(&dead, 3);
+	write_unit(&hot, 4);
+
+	Linker linker;
+	LinkerInit(&linker);
+	uint64_t main_index = LinkerAddUnit(&linker, "main", &main_unit, true);
+	uint64_t helper_index = LinkerAddUnit(&linker, "helper", &helper, false);
+	LinkerAddUnit(&linker, "dead", &dead, false);
+	uint64_t hot_index = LinkerAddUnit(&linker, "hot", &hot, true);
+	LinkerAddDependency(&linker, main_index, helper_index);
+	LinkerSetSamples(&linker, hot_index, 1000);
+
+	uint64_t failures = 0;
+	ChunkImage image;
+	if (!LinkerLink(&linker, &image))
+	{
+		printf("Could not link the units!\n");
+		failures++;
+	}
+	else
+	{
+		failures += check_image(&image);
+
+		char path[512];
+#ifdef COLTI_WINDOWS
+		const char* temporary = getenv("TEMP");
+		snprintf(path, sizeof(path), "%s\\linker_test.cimg", temporary != NULL ? temporary : ".");
+#else
+		const char* temporary = getenv("TMPDIR");
+		snprintf(path, sizeof(path), "%s/linker_test.cimg", temporary != NULL && temporary[0] != '\0' ? temporary : "/tmp");
+#endif
+		ChunkImageSerialize(&image, path);
+		ChunkImage mapped;
+		if (ChunkImageMap(&mapped, path))
+		{
+			//The mapped image is the serialized one
+			failures += mapped.chunk.count != image.chunk.count || memcmp(mapped.chunk.code, image.chunk.code, image.chunk.count) != 0;
+			failures += mapped.names_size != image.names_size || memcmp(mapped.names, image.names, image.names_size) != 0;
+			failures += memcmp(mapped.entries, image.entries, image.entry_count * sizeof(ImageEntry)) != 0;
+			failures += check_image(&mapped);
+			ChunkImageFree(&mapped);
+		}
+		else
+			failures++;
+		remove(path);
+		ChunkImageFree(&image);
+	}
+	LinkerFree(&linker);
+	ChunkFree(&main_unit);
+	ChunkFree(&helper);
+	ChunkFree(&dead);
+	ChunkFree(&hot);
+	return failures;
+}
+
+int linker()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_link_and_map();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The image was linked and mapped as expected." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
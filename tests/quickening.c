@@ -0,0 +1,293 @@
+#include "precomph.h"
+#include "vm/stack_based_vm.h"
+
+/// @brief The output of the chunk written by write_typed_chunk
+#define QUICKENING_EXPECTED_OUTPUT "42\n2.75\n7\n5\n"
+/// @brief The number of iterations of the loop written by write_typed_chunk
+#define QUICKENING_LOOP_ITERATIONS 16
+/// @brief The output of the chunk written by write_typed_chunk, with its loop
+#define QUICKENING_LOOPING_OUTPUT QUICKENING_EXPECTED_OUTPUT "16\n"
+
+/// @brief Writes a chunk printing the results of typed instructions on different types (so that it is polymorphic):
+/// an INT64 product, a DOUBLE sum and an INT64 difference (which have quickened forms), and an INT32 sum (which does not).
+/// The chunk can also print the result of a loop incrementing a local QUICKENING_LOOP_ITERATIONS times using OP_ADD_DYNAMIC.
+/// @param chunk The chunk to which to write
+/// @param is_looping True to write the loop
+void write_typed_chunk(Chunk* chunk, bool is_looping)
+{
+	ChunkInit(chunk);
+	//The left operand is the top of the stack, so the right one is pushed first
+	QWORD right = { .i64 = 6 };
+	QWORD left = { .i64 = 7 };
+	ChunkWriteConstant(chunk, right);
+	ChunkWriteConstant(chunk, left);
+	ChunkWriteOpCode(chunk, OP_MULTIPLY);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	right.d = 0.25;
+	left.d = 2.5;
+	ChunkWriteConstant(chunk, right);
+	ChunkWriteConstant(chunk, left);
+	ChunkWriteOpCode(chunk, OP_ADD);
+	ChunkWriteOperand(chunk, COLTI_DOUBLE);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_DOUBLE);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	right.i64 = 3;
+	left.i64 = 10;
+	ChunkWriteConstant(chunk, right);
+	ChunkWriteConstant(chunk, left);
+	ChunkWriteOpCode(chunk, OP_SUBTRACT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT64);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+
+	right.i64 = 2;
+	left.i64 = 3;
+	ChunkWriteConstant(chunk, right);
+	ChunkWriteConstant(chunk, left);
+	ChunkWriteOpCode(chunk, OP_ADD);
+	ChunkWriteOperand(chunk, COLTI_INT32);
+	ChunkWriteOpCode(chunk, OP_PRINT);
+	ChunkWriteOperand(chunk, COLTI_INT32);
+	ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	if (is_looping)
+	{
+		//while (i != QUICKENING_LOOP_ITERATIONS) i = i + 1 (on dynamic values)
+		right.i64 = 0;
+		ChunkWriteConstant(chunk, right);
+		ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 1);
+		uint64_t header = chunk->count;
+		right.i64 = QUICKENING_LOOP_ITERATIONS;
+		ChunkWriteConstant(chunk, right);
+		ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 1);
+		uint64_t exit = ChunkWriteJump(chunk, OP_JUMP_IF_EQUAL, COLTI_INT64);
+		right.i64 = 1;
+		ChunkWriteConstant(chunk, right);
+		ChunkWriteOpCode(chunk, OP_BOX);
+		ChunkWriteOperand(chunk, COLTI_INT64);
+		ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 1);
+		ChunkWriteOpCode(chunk, OP_BOX);
+		ChunkWriteOperand(chunk, COLTI_INT64);
+		ChunkWriteAddDynamic(chunk);
+		ChunkWriteOpCode(chunk, OP_UNBOX);
+		ChunkWriteOperand(chunk, COLTI_INT64);
+		ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 1);
+		ChunkWriteLoop(chunk, header);
+		ChunkPatchJump(chunk, exit, chunk->count);
+		ChunkWriteLocal(chunk, OP_LOAD_LOCAL_BYTE, 1);
+		ChunkWriteOpCode(chunk, OP_PRINT);
+		ChunkWriteOperand(chunk, COLTI_INT64);
+		ChunkWriteLocal(chunk, OP_STORE_LOCAL_BYTE, 0);
+	}
+	ChunkWriteOpCode(chunk, OP_RETURN);
+}
+
+/// @brief Returns the number of instructions of a chunk (using either encoding) whose OpCode is 'code'
+/// @param chunk The chunk whose instructions to count
+/// @param code The OpCode to count
+/// @return The number of instructions
+uint64_t count_opcode(const Chunk* chunk, OpCode code)
+{
+	uint64_t count = 0;
+	Instruction instr;
+	for (uint64_t offset = 0; offset < chunk->count; offset += instr.size)
+	{
+		if (chunk->encoding == CHUNK_ENCODING_COMPACT)
+			CompactDecodeInstruction(chunk, offset, &instr);
+		else
+			ChunkDecodeInstruction(chunk, offset, &instr);
+		count += instr.code == code;
+	}
+	return count;
+}
+
+/// @brief Returns the number of instructions of a chunk that are not in their quickened form, and should be
+/// @param chunk The chunk whose instructions to check
+/// @return 0 if every instruction having a quickened form was quickened (and 3 if none was)
+uint64_t count_unquickened(const Chunk* chunk)
+{
+	return (count_opcode(chunk, OP_MULTIPLY_I64) != 1) + (count_opcode(chunk, OP_ADD_DOUBLE) != 1)
+		+ (count_opcode(chunk, OP_SUBTRACT_I64) != 1);
+}
+
+/// @brief Runs a chunk, checking its output
+/// @param chunk The chunk to run
+/// @param expected The expected output
+/// @return The number of failures
+uint64_t run_chunk_expecting(Chunk* chunk, const char* expected)
+{
+	StackVM* vm = (StackVM*)safe_malloc(sizeof(StackVM));
+	StackVMInitWithStream(vm, NULL);
+	InterpretResult result = StackVMRun(vm, chunk);
+	uint64_t size;
+	char* output = VMOutputTakeCapture(&vm->output, &size);
+	StackVMFree(vm);
+	safe_free(vm);
+
+	uint64_t failures = result != INTERPRET_OK;
+	failures += size != strlen(expected) || memcmp(output, expected, size) != 0;
+	if (failures != 0)
+		printf("Unexpected run of a quickened chunk (output: '%.*s')!\n", (int)size, output);
+	if (output != NULL)
+		safe_free(output);
+	return failures;
+}
+
+/// @brief Runs a chunk, checking that its output is QUICKENING_EXPECTED_OUTPUT
+/// @param chunk The chunk to run
+/// @return The number of failures
+uint64_t run_typed_chunk(Chunk* chunk)
+{
+	return run_chunk_expecting(chunk, QUICKENING_EXPECTED_OUTPUT);
+}
+
+/// @brief Checks that the typed instructions are only quickened if quickening is enabled, in both encodings,
+/// and that the quickened code can be verified and re-encoded
+/// @return The number of failures
+uint64_t test_quickening()
+{
+	uint64_t failures = 0;
+	Chunk chunk;
+	write_typed_chunk(&chunk, false);
+	Chunk compact;
+	failures += !ChunkToCompact(&chunk, &compact);
+
+	failures += run_typed_chunk(&chunk);
+	failures += count_unquickened(&chunk) != 3;
+
+	uint64_t size = chunk.count;
+	failures += !ChunkEnableQuickening(&chunk);
+	failures += run_typed_chunk(&chunk);
+	failures += count_unquickened(&chunk) + (count_opcode(&chunk, OP_ADD) != 1) + (chunk.count != size);
+	//The quickened code runs the same, and is still valid
+	failures += run_typed_chunk(&chunk);
+	chunk.is_verified = false;
+	failures += run_typed_chunk(&chunk);
+	Chunk converted;
+	failures += !ChunkToCompact(&chunk, &converted);
+	failures += run_typed_chunk(&converted);
+	ChunkFree(&converted);
+
+	//The fused OpCodes are quickened in place
+	size = compact.count;
+	failures += !ChunkEnableQuickening(&compact);
+	failures += run_typed_chunk(&compact);
+	failures += count_unquickened(&compact) + (count_opcode(&compact, OP_ADD) != 1) + (compact.count != size);
+	failures += run_typed_chunk(&compact);
+	failures += !ChunkToAligned(&compact, &converted);
+	failures += run_typed_chunk(&converted);
+	ChunkFree(&converted);
+
+	ChunkFree(&compact);
+	ChunkFree(&chunk);
+	return failures;
+}
+
+/// @brief Checks that a mapped chunk is quickened in its private copy-on-write pages, and not in the file
+/// @return The number of failures
+uint64_t test_mapped_quickening()
+{
+	uint64_t failures = 0;
+	Chunk chunk;
+	write_typed_chunk(&chunk, false);
+	ChunkSerialize(&chunk, "quickening.bin");
+	ChunkFree(&chunk);
+
+	Chunk mapped;
+	Chunk other;
+	if (!ChunkMap(&mapped, "quickening.bin") || !ChunkMap(&other, "quickening.bin"))
+		return 1;
+	failures += !ChunkEnableQuickening(&mapped) || mapped.is_read_only;
+	failures += run_typed_chunk(&mapped);
+	failures += count_unquickened(&mapped);
+	//Another mapping of the same file does not see the rewrites
+	failures += !other.is_read_only || count_unquickened(&other) != 3;
+	failures += run_typed_chunk(&other);
+	failures += count_unquickened(&other) != 3;
+	ChunkFree(&other);
+	ChunkFree(&mapped);
+
+	//Neither does the file
+	if (!ChunkMap(&mapped, "quickening.bin"))
+		return failures + 1;
+	failures += count_unquickened(&mapped) != 3;
+	ChunkFree(&mapped);
+	remove("quickening.bin");
+	return failures;
+}
+
+/// @brief The number of times each thread runs the shared chunk
+#define QUICKENING_THREAD_RUNS 256
+/// @brief The number of threads running the shared chunk
+#define QUICKENING_THREAD_COUNT 4
+
+/// @brief The state of a thread running a shared chunk
+typedef struct
+{
+	/// @brief The chunk shared by the threads
+	Chunk* chunk;
+	/// @brief The number of failed runs
+	uint64_t failures;
+} QuickeningThread;
+
+/// @brief Runs the shared chunk of a QuickeningThread QUICKENING_THREAD_RUNS times
+/// @param arg The QuickeningThread
+void run_shared_chunk(void* arg)
+{
+	QuickeningThread* thread = (QuickeningThread*)arg;
+	for (int i = 0; i < QUICKENING_THREAD_RUNS; i++)
+		thread->failures += run_chunk_expecting(thread->chunk, QUICKENING_LOOPING_OUTPUT);
+}
+
+/// @brief Checks that threads running (verifying, quickening, counting the iterations of and caching the types of)
+/// the same chunk concurrently all compute the same output
+/// @return The number of failures
+uint64_t test_shared_quickening()
+{
+	uint64_t failures = 0;
+	Chunk chunk;
+	//The chunk is verified by the first thread running it
+	write_typed_chunk(&chunk, true);
+	failures += !ChunkEnableQuickening(&chunk);
+
+	ColtiThread threads[QUICKENING_THREAD_COUNT];
+	QuickeningThread states[QUICKENING_THREAD_COUNT];
+	for (int i = 0; i < QUICKENING_THREAD_COUNT; i++)
+	{
+		states[i].chunk = &chunk;
+		states[i].failures = 0;
+		failures += !ColtiThreadCreate(&threads[i], &run_shared_chunk, &states[i]);
+	}
+	for (int i = 0; i < QUICKENING_THREAD_COUNT; i++)
+	{
+		ColtiThreadJoin(&threads[i]);
+		failures += states[i].failures;
+	}
+	failures += count_unquickened(&chunk);
+	//No iteration is lost, and the cache only recorded INT64
+	failures += chunk.loop_counters == NULL
+		|| chunk.loop_counters[0] != QUICKENING_THREAD_COUNT * QUICKENING_THREAD_RUNS * QUICKENING_LOOP_ITERATIONS;
+	failures += chunk.inline_caches == NULL || chunk.inline_caches[0].count != 1;
+	ChunkFree(&chunk);
+	return failures;
+}
+
+int quickening()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_quickening() + test_mapped_quickening() + test_shared_quickening();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The quickened chunks behaved as expected." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,226 @@
+#include "precomph.h"
+
+/// @brief Verifies a chunk, checking the result of ChunkVerify
+/// @param chunk The chunk to verify
+/// @param expected The expected result
+/// @param name The name of the case, printed on failure
+/// @return The number of failures
+uint64_t expect_verify(Chunk* chunk, VerifyResult expected, const char* name)
+{
+	uint64_t error_offset;
+	VerifyResult result = ChunkVerify(chunk, &error_offset);
+	if (result == expected)
+		return 0;
+	printf("Unexpected verification of '%s': '%s' instead of '%s' (at offset %"PRIu64")!\n", name,
+		VerifyResultToString(result), VerifyResultToString(expected), error_offset);
+	return 1;
+}
+
+/// @brief Writes an OP_LOOP whose counter index and jump offset are not checked, as an untrusted chunk could contain
+/// @param chunk The chunk to which to write
+/// @param index The counter index
+/// @param relative The jump offset (relative to the OP_LOOP)
+void write_raw_loop(Chunk* chunk, uint32_t index, int32_t relative)
+{
+	Instruction instr = { .code = OP_LOOP, .index = index };
+	instr.immediate.i64 = relative;
+	ChunkWriteInstruction(chunk, &instr);
+}
+
+/// @brief Checks that the counter index and the jump offset of an OP_LOOP are bounded
+/// @return The number of failures
+uint64_t test_verify_loops()
+{
+	uint64_t failures = 0;
+	Chunk chunk;
+	//A loop jumping to itself is valid
+	ChunkInit(&chunk);
+	write_raw_loop(&chunk, 0, 0);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += expect_verify(&chunk, VERIFY_OK, "loop to itself");
+	ChunkFree(&chunk);
+
+	//The target would be before the start of the code
+	ChunkInit(&chunk);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	write_raw_loop(&chunk, 0, -100000000);
+	failures += expect_verify(&chunk, VERIFY_INVALID_JUMP, "loop before the code");
+	ChunkFree(&chunk);
+
+	//The counters would be allocated from the index
+	ChunkInit(&chunk);
+	write_raw_loop(&chunk, 0xEC000000, 0);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += expect_verify(&chunk, VERIFY_INVALID_COUNTER, "loop counter index");
+	ChunkFree(&chunk);
+	return failures;
+}
+
+/// @brief Checks that the cache index of a dynamically typed instruction is bounded
+/// @return The number of failures
+uint64_t test_verify_caches()
+{
+	Chunk chunk;
+	//The caches would be allocated from the index
+	ChunkInit(&chunk);
+	ChunkWriteOpCode(&chunk, OP_ADD_DYNAMIC);
+	DWORD cache = { .ui32 = 0xEC000000 };
+	ChunkWriteDWORD(&chunk, cache);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	uint64_t failures = expect_verify(&chunk, VERIFY_INVALID_CACHE, "cache index");
+	ChunkFree(&chunk);
+	return failures;
+}
+
+/// @brief Checks that the typed values of dynamic operands are accepted (as their tags are)
+/// @return The number of failures
+uint64_t test_verify_dynamic()
+{
+	Chunk chunk;
+	ChunkInit(&chunk);
+	//The boxed values are typed INT64, and their tags are untyped
+	QWORD value = { .i64 = 2 };
+	ChunkWriteConstant(&chunk, value);
+	ChunkWriteOpCode(&chunk, OP_BOX);
+	ChunkWriteOperand(&chunk, COLTI_INT64);
+	ChunkWriteConstant(&chunk, value);
+	ChunkWriteOpCode(&chunk, OP_BOX);
+	ChunkWriteOperand(&chunk, COLTI_INT64);
+	ChunkWriteAddDynamic(&chunk);
+	ChunkWriteOpCode(&chunk, OP_UNBOX);
+	ChunkWriteOperand(&chunk, COLTI_INT64);
+	ChunkWriteLocal(&chunk, OP_STORE_LOCAL_BYTE, 0);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	uint64_t failures = expect_verify(&chunk, VERIFY_OK, "typed dynamic operands");
+	ChunkFree(&chunk);
+	return failures;
+}
+
+/// @brief Checks that malformed forward jumps are rejected
+/// @return The number of failures
+uint64_t test_verify_jumps()
+{
+	uint64_t failures = 0;
+	Chunk chunk;
+	//A jump which was not patched (patching an offset which is not a jump being refused)
+	ChunkInit(&chunk);
+	uint64_t jump = ChunkWriteJump(&chunk, OP_JUMP, COLTI_BOOL);
+	uint64_t end = chunk.count;
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += ChunkPatchJump(&chunk, end, end + 1);
+	failures += ChunkPatchJump(&chunk, jump, jump);
+	failures += expect_verify(&chunk, VERIFY_INVALID_JUMP, "unpatched jump");
+	ChunkFree(&chunk);
+
+	//A jump into the bytes of an instruction
+	ChunkInit(&chunk);
+	jump = ChunkWriteJump(&chunk, OP_JUMP, COLTI_BOOL);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	ChunkPatchJump(&chunk, jump, jump + 1);
+	failures += expect_verify(&chunk, VERIFY_INVALID_JUMP, "jump into an instruction");
+	ChunkFree(&chunk);
+
+	//A jump past the end of the code
+	ChunkInit(&chunk);
+	jump = ChunkWriteJump(&chunk, OP_JUMP, COLTI_BOOL);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	ChunkPatchJump(&chunk, jump, chunk.count);
+	failures += expect_verify(&chunk, VERIFY_INVALID_JUMP, "jump past the code");
+	ChunkFree(&chunk);
+
+	//A jump into another function
+	ChunkInit(&chunk);
+	jump = ChunkWriteJump(&chunk, OP_JUMP, COLTI_BOOL);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	ChunkWriteEnter(&chunk, 0, 0);
+	uint64_t target = chunk.count;
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	ChunkPatchJump(&chunk, jump, target);
+	failures += expect_verify(&chunk, VERIFY_INVALID_JUMP, "jump into a function");
+	ChunkFree(&chunk);
+	return failures;
+}
+
+/// @brief Checks that malformed instructions, calls and stacks are rejected
+/// @return The number of failures
+uint64_t test_verify_structure()
+{
+	uint64_t failures = 0;
+	Chunk chunk;
+	//An empty chunk does not return
+	ChunkInit(&chunk);
+	failures += expect_verify(&chunk, VERIFY_MISSING_RETURN, "empty chunk");
+	ChunkFree(&chunk);
+
+	//The last instruction should not continue to the next one
+	ChunkInit(&chunk);
+	QWORD value = { .i64 = 2 };
+	ChunkWriteConstant(&chunk, value);
+	ChunkWriteLocal(&chunk, OP_STORE_LOCAL_BYTE, 0);
+	failures += expect_verify(&chunk, VERIFY_MISSING_RETURN, "missing return");
+	ChunkFree(&chunk);
+
+	//A byte which is not an OpCode
+	ChunkInit(&chunk);
+	BYTE byte = { .ui8 = 0xFF };
+	ChunkWriteBYTE(&chunk, byte);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += expect_verify(&chunk, VERIFY_INVALID_OPCODE, "invalid OpCode");
+	ChunkFree(&chunk);
+
+	//An instruction whose operands are not part of the code
+	ChunkInit(&chunk);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	ChunkWriteOpCode(&chunk, OP_CALL);
+	failures += expect_verify(&chunk, VERIFY_TRUNCATED_INSTRUCTION, "truncated instruction");
+	ChunkFree(&chunk);
+
+	//An OperandType which does not exist
+	ChunkInit(&chunk);
+	ChunkWriteConstant(&chunk, value);
+	ChunkWriteOpCode(&chunk, OP_PRINT);
+	ChunkWriteOperand(&chunk, (OperandType)0x7F);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += expect_verify(&chunk, VERIFY_INVALID_OPERAND, "invalid operand");
+	ChunkFree(&chunk);
+
+	//A constant which is not in the pool
+	ChunkInit(&chunk);
+	Instruction instr = { .code = OP_LOAD_CONST_BYTE };
+	instr.immediate.ui64 = 5;
+	ChunkWriteInstruction(&chunk, &instr);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += expect_verify(&chunk, VERIFY_INVALID_CONSTANT, "invalid constant");
+	ChunkFree(&chunk);
+
+	//A value popped from an empty stack
+	ChunkInit(&chunk);
+	ChunkWriteOpCode(&chunk, OP_PRINT);
+	ChunkWriteOperand(&chunk, COLTI_INT64);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += expect_verify(&chunk, VERIFY_STACK_UNDERFLOW, "stack underflow");
+	ChunkFree(&chunk);
+
+	//A call whose target is not an OP_ENTER
+	ChunkInit(&chunk);
+	ChunkWriteCall(&chunk, OP_CALL, 0);
+	ChunkWriteOpCode(&chunk, OP_RETURN);
+	failures += expect_verify(&chunk, VERIFY_INVALID_TARGET, "call target");
+	ChunkFree(&chunk);
+	return failures;
+}
+
+int verifier()
+{
+	printf(CONSOLE_BACKGROUND_BRIGHT_MAGENTA CONSOLE_FOREGROUND_BLACK
+		"COLTI v%s on %s" CONSOLE_COLOR_RESET "\n", COLTI_VERSION_STRING, COLTI_OS_STRING);
+	printf("Test: "CONSOLE_FOREGROUND_BRIGHT_CYAN"%s\n"CONSOLE_COLOR_RESET, COLTI_CURRENT_FILENAME);
+
+	uint64_t failures = test_verify_jumps() + test_verify_structure() + test_verify_loops()
+		+ test_verify_caches() + test_verify_dynamic();
+	if (failures == 0)
+		printf(CONSOLE_FOREGROUND_BRIGHT_GREEN "The chunks were verified as expected." CONSOLE_COLOR_RESET "\n");
+	else
+		printf(CONSOLE_FOREGROUND_BRIGHT_RED "%"PRIu64" failures!" CONSOLE_COLOR_RESET "\n", failures);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}